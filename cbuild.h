@@ -43,6 +43,9 @@ If using in multiple translation units:
 
 Note that arenas are not thread-safe, so don't pass the same arena to multiple threads.
 
+String search uses SSE2/AVX2 on x86 and NEON on arm64 when available.
+Define prb_NO_SIMD to only use the scalar code.
+
 All string formatting functions are wrappers around stb printf
 https://github.com/nothings/stb/blob/master/stb_sprintf.h
 The strings are allocated on the linear allocator everything else is using.
@@ -115,6 +118,7 @@ for (prb_Iter iter = prb_createIter(); prb_iterNext(&iter) == prb_Success;) {
 #include <linux/limits.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <sys/wait.h>
 #include <unistd.h>
 #include <spawn.h>
@@ -123,7 +127,37 @@ for (prb_Iter iter = prb_createIter(); prb_iterNext(&iter) == prb_Success;) {
 #include <time.h>
 #include <fcntl.h>
 #include <pthread.h>
+#include <sched.h>
+
+#endif
 
+#ifndef prb_NO_SIMD
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#define prb_SIMD_SSE2 1
+#include <immintrin.h>
+#if defined(__AVX2__)
+#define prb_SIMD_AVX2 1
+#define prb_AVX2_TARGET
+#define prb_avx2Supported() true
+#elif defined(__GNUC__)
+// NOTE(khvorov) The avx2 path is compiled regardless of flags and picked at runtime
+#define prb_SIMD_AVX2 1
+#define prb_AVX2_TARGET __attribute__((target("avx2")))
+#define prb_avx2Supported() __builtin_cpu_supports("avx2")
+#endif
+#if defined(__SSSE3__) || defined(__AVX__)
+#define prb_SIMD_SSSE3 1
+#define prb_SSSE3_TARGET
+#define prb_ssse3Supported() true
+#elif defined(__GNUC__)
+#define prb_SIMD_SSSE3 1
+#define prb_SSSE3_TARGET __attribute__((target("ssse3")))
+#define prb_ssse3Supported() __builtin_cpu_supports("ssse3")
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define prb_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
 #endif
 
 #define prb_BYTE 1
@@ -140,6 +174,7 @@ for (prb_Iter iter = prb_createIter(); prb_iterNext(&iter) == prb_Success;) {
 #define prb_malloc malloc
 #define prb_realloc realloc
 #define prb_free free
+#define prb_strtod strtod
 
 #if defined(_MSC_VER) && !defined(__cplusplus)
 #define prb_alignof _Alignof
@@ -281,9 +316,20 @@ typedef struct prb_Str {
     int32_t     len;
 } prb_Str;
 
+typedef struct prb_StrChunk {
+    struct prb_StrChunk* next;
+    prb_Str              str;
+    int32_t              cap;
+} prb_StrChunk;
+
+// NOTE(khvorov) A chunked string keeps its bytes in chunks and doesn't lock the arena,
+// str.len is the total length and str.ptr is only set by prb_endStr
 typedef struct prb_GrowingStr {
-    prb_Arena* arena;
-    prb_Str    str;
+    prb_Arena*    arena;
+    prb_Str       str;
+    bool          chunked;
+    prb_StrChunk* firstChunk;
+    prb_StrChunk* lastChunk;
 } prb_GrowingStr;
 
 typedef enum prb_Status {
@@ -379,6 +425,34 @@ typedef struct prb_StrFindResult {
     prb_Str afterMatch;
 } prb_StrFindResult;
 
+// NOTE(khvorov) A spec prepared once for searching many strings, see prb_createStrFinder
+typedef struct prb_StrFinder {
+    prb_StrFindSpec spec;
+    // Exact patterns that are long enough to skip ahead by, filled on first use
+    bool    raitaShiftsReady;
+    int32_t raitaShifts[256];
+    // AnyChar patterns, one bit per ascii character
+    bool     patternIsAscii;
+    uint32_t byteSet[8];
+    // Bit n of entry i is set when the character (n << 4) | i is in an ascii pattern, for shuffle lookups
+    uint8_t lowNibbleSets[16];
+    // Non-ascii characters of AnyChar patterns, open addressing with 0 as empty.
+    // Count is -1 when there are too many to fit.
+    int32_t  codepointCount;
+    uint32_t codepointSet[64];
+} prb_StrFinder;
+
+typedef enum prb_StrSplitFlag {
+    prb_StrSplitFlag_SkipEmpty = 1 << 0,
+    // Delimiters between double quotes don't split, the quotes stay in the token
+    prb_StrSplitFlag_RespectQuotes = 1 << 1,
+} prb_StrSplitFlag;
+
+typedef struct prb_StrSplitResult {
+    prb_Str* tokens;
+    int32_t  count;
+} prb_StrSplitResult;
+
 typedef struct prb_StrScanner {
     prb_Str ogstr;
     prb_Str beforeMatch;
@@ -388,6 +462,57 @@ typedef struct prb_StrScanner {
     prb_Str betweenLastMatches;
 } prb_StrScanner;
 
+typedef struct prb_Utf32Str {
+    const uint32_t* ptr;
+    int32_t         len;
+} prb_Utf32Str;
+
+typedef struct prb_Utf16Str {
+    const uint16_t* ptr;
+    int32_t         len;
+} prb_Utf16Str;
+
+// NOTE(khvorov) Bulk utf conversions stop at the first invalid character. errorOffset is where it starts
+// (in input units) and is the input length when everything is valid. The output has everything before it.
+typedef struct prb_Utf8ValidateResult {
+    bool    valid;
+    int32_t errorOffset;
+} prb_Utf8ValidateResult;
+
+typedef struct prb_Utf32Result {
+    bool         valid;
+    int32_t      errorOffset;
+    prb_Utf32Str str;
+} prb_Utf32Result;
+
+typedef struct prb_Utf16Result {
+    bool         valid;
+    int32_t      errorOffset;
+    prb_Utf16Str str;
+} prb_Utf16Result;
+
+typedef struct prb_Utf8Result {
+    bool    valid;
+    int32_t errorOffset;
+    prb_Str str;
+} prb_Utf8Result;
+
+// NOTE(khvorov) Where every line of a string starts, see prb_buildLineIndex.
+// Lines end at \n, \r\n or \r, a line break at the very end doesn't start another line.
+typedef struct prb_LineIndex {
+    prb_Str str;
+    // lineCount + 1 entries, the last one is str.len
+    int32_t* lineStarts;
+    int32_t  lineCount;
+} prb_LineIndex;
+
+typedef struct prb_LineIter {
+    prb_LineIndex* index;
+    int32_t        curLineIndex;
+    prb_Str        curLine;
+    prb_Str        curLineBreak;
+} prb_LineIter;
+
 typedef struct prb_Utf8CharIter {
     prb_Str          str;
     prb_StrDirection direction;
@@ -427,6 +552,28 @@ typedef struct prb_FileHash {
     uint64_t hash;
 } prb_FileHash;
 
+typedef struct prb_PathTrieNode {
+    // -1 for the root
+    int32_t parent;
+    // Into prb_PathTrie.names, the name ends where the next node's name starts
+    int32_t nameOffset;
+    // This node and everything under it, which are the nodes that immediately follow it
+    int32_t subtreeCount;
+} prb_PathTrieNode;
+
+// NOTE(khvorov) Nodes are in depth-first order starting from an unnamed root at index 0,
+// so the next sibling of node i is i + subtreeCount. Each node only stores its own name.
+// Both arrays are stb arrays.
+typedef struct prb_PathTrie {
+    prb_PathTrieNode* nodes;
+    char*             names;
+} prb_PathTrie;
+
+typedef struct prb_PathTrieParseResult {
+    bool         success;
+    prb_PathTrie trie;
+} prb_PathTrieParseResult;
+
 typedef enum prb_JobStatus {
     prb_JobStatus_NotLaunched,
     prb_JobStatus_Launched,
@@ -456,6 +603,187 @@ typedef enum prb_Background {
     prb_Background_Yes,
 } prb_Background;
 
+// How prb_embedFile gets a file into a program
+typedef enum prb_EmbedKind {
+    // unsigned char name[] = {0x1, 0x2, ...}; from prb_binaryToCArray
+    prb_EmbedKind_CArray,
+    // unsigned char name[] = "..."; from prb_binaryToCString
+    prb_EmbedKind_CString,
+    // unsigned char name[] = {#embed "path"}; needs a C23 compiler
+    prb_EmbedKind_CEmbedDirective,
+    // An assembly (.S) file that defines name and name_size with .incbin "path"
+    prb_EmbedKind_AsmIncbin,
+} prb_EmbedKind;
+
+typedef struct prb_EmbedFileResult {
+    bool    success;
+    prb_Str str;
+} prb_EmbedFileResult;
+
+typedef enum prb_ThreadSafe {
+    prb_ThreadSafe_No,
+    prb_ThreadSafe_Yes,
+} prb_ThreadSafe;
+
+// Interned strings are null-terminated and never move, the same string always gets the same pointer
+typedef struct prb_InternedStr {
+    prb_Str  str;
+    uint64_t hash;
+    // Dense, in the order strings were first interned
+    int32_t id;
+} prb_InternedStr;
+
+// A thread safe interner takes a lock for every call and is the only user of its arena while it's shared
+typedef struct prb_StrInterner {
+    prb_Arena*        arena;
+    prb_ThreadSafe    threadSafe;
+    volatile int32_t  lock;
+    prb_InternedStr** slots;
+    int32_t           slotsCount;
+    int32_t           count;
+} prb_StrInterner;
+
+typedef struct prb_StrMapEntry {
+    prb_Str  key;
+    uint64_t hash;
+    uint64_t value;
+} prb_StrMapEntry;
+
+// Keys aren't copied and have to outlive the map. Entries are dense and in the order keys were added,
+// adding can move them so entry pointers last until the next add.
+typedef struct prb_StrMap {
+    prb_Arena*       arena;
+    uint8_t*         ctrl;
+    int32_t*         slots;
+    int32_t          slotsCount;
+    prb_StrMapEntry* entries;
+    int32_t          count;
+} prb_StrMap;
+
+typedef struct prb_SharedStrMapTable {
+    prb_StrMapEntry** slots;
+    int32_t           slotsCount;
+} prb_SharedStrMapTable;
+
+#define prb_SHARED_STR_MAP_SHARDS 64
+
+// One shard per cache line so that adds to different shards don't slow each other down.
+// Each shard allocates out of its own chunk of the arena.
+typedef struct prb_SharedStrMapShard {
+    volatile int32_t       lock;
+    int32_t                count;
+    prb_SharedStrMapTable* table;
+    uint8_t*               chunk;
+    uint8_t*               chunkEnd;
+    uint8_t                padding[64 - 2 * sizeof(int32_t) - sizeof(prb_SharedStrMapTable*) - 2 * sizeof(uint8_t*)];
+} prb_SharedStrMapShard;
+
+// Finds don't lock, adds lock the shard the key hashes to. Keys are copied, entries never move and
+// don't change after they are added. Replaced tables stay in the arena because a reader could still be
+// going through one, they are reclaimed together with everything else when the arena is reset after the jobs are done.
+// The map is the only user of its arena while it's shared.
+typedef struct prb_SharedStrMap {
+    prb_Arena*             arena;
+    volatile int32_t       arenaLock;
+    prb_SharedStrMapShard* shards;
+} prb_SharedStrMap;
+
+typedef struct prb_MultiFindMatch {
+    int32_t patternIndex;
+    int32_t offset;
+} prb_MultiFindMatch;
+
+typedef struct prb_MultiFindResult {
+    prb_MultiFindMatch* matches;
+    int32_t             count;
+} prb_MultiFindResult;
+
+// Patterns aren't copied and have to outlive the finder
+typedef struct prb_MultiFinder {
+    prb_Str* patterns;
+    int32_t  patternsCount;
+    // Aho-Corasick automaton over the bytes that appear in patterns, all other bytes share class 0.
+    // Transitions hold the next state's row offset, bitwise-negated when that state ends a pattern.
+    uint16_t byteClasses[256];
+    int32_t  classCount;
+    int32_t  stateCount;
+    int32_t* transitions;
+    int32_t* statePatterns;
+    int32_t* outputLinks;
+    int32_t* samePatternNext;
+    // Bytes that start a pattern when they are all ascii, to skip ahead while at the root state
+    bool          rootSkip;
+    prb_StrFinder firstBytes;
+    // Sets of up to 32 patterns, nibble masks of the first teddyLen bytes with a bit per bucket
+    bool    teddy;
+    int32_t teddyLen;
+    uint8_t teddyLowMasks[3][16];
+    uint8_t teddyHighMasks[3][16];
+    uint8_t teddyBuckets[32];
+} prb_MultiFinder;
+
+typedef enum prb_RegexOp {
+    prb_RegexOp_ByteSet,
+    prb_RegexOp_Split,
+    prb_RegexOp_Jump,
+    prb_RegexOp_StrStart,
+    prb_RegexOp_StrEnd,
+    prb_RegexOp_Match,
+} prb_RegexOp;
+
+// ByteSet consumes a byte from set x, Split tries x before y, Jump goes to x
+typedef struct prb_RegexInst {
+    prb_RegexOp op;
+    int32_t     x;
+    int32_t     y;
+} prb_RegexInst;
+
+typedef struct prb_RegexByteSet {
+    uint32_t bits[8];
+} prb_RegexByteSet;
+
+typedef struct prb_RegexState prb_RegexState;
+
+// One program and anchoring of a regex. States are built as matching needs them and live in the cache arena,
+// which is reset when it fills up. A smaller cache costs less memory but rebuilds states more often.
+typedef struct prb_RegexDfa {
+    prb_RegexInst*   insts;
+    bool             unanchored;
+    prb_Arena        cache;
+    prb_RegexState** slots;
+    int32_t          slotsCount;
+    int32_t          stateCount;
+    int32_t          flushCount;
+    prb_RegexState*  startStates[2];
+} prb_RegexDfa;
+
+// Byte-based, matches are leftmost-longest. Matching fills the caches so a regex can't be shared between threads.
+typedef struct prb_Regex {
+    prb_RegexByteSet* byteSets;
+    int32_t           instCount;
+    uint8_t           byteClasses[256];
+    int32_t           classCount;
+    uint8_t           classBytes[256];
+    prb_RegexDfa      matchDfa;
+    prb_RegexDfa      searchDfa;
+    prb_RegexDfa      reverseDfa;
+    // Every match ends at the end of the string so searches only need the reverse scan
+    bool endAnchored;
+    // Closure scratch, sized for the programs
+    int32_t* stack;
+    int32_t* visited;
+    int32_t  visitStamp;
+    int32_t* seeds;
+    int32_t* entries;
+} prb_Regex;
+
+typedef struct prb_CompileRegexResult {
+    bool success;
+    // Where the pattern stopped making sense
+    int32_t    errorOffset;
+    prb_Regex* regex;
+} prb_CompileRegexResult;
+
 typedef struct prb_ParseUintResult {
     bool     success;
     uint64_t number;
@@ -477,6 +805,14 @@ typedef struct prb_ParsedNumber {
     };
 } prb_ParsedNumber;
 
+typedef struct prb_ParseNumbersResult {
+    bool success;
+    // Where the first field that isn't a number starts, str.len when all of them are
+    int32_t           errorOffset;
+    prb_ParsedNumber* numbers;
+    int32_t           count;
+} prb_ParseNumbersResult;
+
 typedef struct prb_Rng {
     uint64_t state;
     // Must be odd
@@ -498,6 +834,116 @@ typedef struct prb_CoreCountResult {
     int32_t cores;
 } prb_CoreCountResult;
 
+typedef struct prb_Action {
+    prb_Str cmd;
+    // Additional environment variables that look like this "var1=val1 var2=val2"
+    prb_Str addEnv;
+    // Leave empty to always run the action locally. Otherwise the action can be sent to a worker
+    // if all inputs and outputs are inside execRoot. Every occurrence of execRoot in cmd and addEnv
+    // will be replaced with the worker's sandbox directory.
+    prb_Str           execRoot;
+    prb_Str*          inputs;
+    int32_t           inputsCount;
+    prb_Str*          outputs;
+    int32_t           outputsCount;
+    prb_ProcessStatus status;
+    bool              ranRemotely;
+    // Wall time, set by prb_executeActions
+    float durationMs;
+} prb_Action;
+
+typedef struct prb_ExecSpec {
+    // How many actions can run on this machine at the same time. 0 means core count, negative means none
+    // (actions that no worker took are still run here one at a time).
+    int32_t localSlots;
+    // Worker addresses that look like "unix:/path/to/socket" or "tcp:host:port"
+    prb_Str* workers;
+    int32_t  workersCount;
+    // How many actions can run on each worker at the same time. 0 means 1.
+    int32_t slotsPerWorker;
+    // Must match the token the workers were started with. It's sent in plain text and the connection
+    // isn't encrypted or authenticated otherwise, so workers are only for trusted networks (or ssh tunnels).
+    prb_Str workerToken;
+} prb_ExecSpec;
+
+typedef enum prb_BuildStep {
+    prb_BuildStep_Preprocess,
+    prb_BuildStep_Compile,
+    prb_BuildStep_Archive,
+} prb_BuildStep;
+
+// For archive input is all the objects separated by spaces and flags are empty
+typedef prb_Str (*prb_BuildCmdProc)(prb_Arena* arena, void* data, prb_BuildStep step, prb_Str flags, prb_Str input, prb_Str output);
+
+typedef struct prb_StaticLibSpec {
+    prb_Str name;
+    // Sources are relative to srcDir. "dir/*.c" means every .c file directly in dir.
+    prb_Str  srcDir;
+    prb_Str* sources;
+    int32_t  sourcesCount;
+    prb_Str  flags;
+    // Files the compiler writes next to each object, given by extension (like "dwo" for -gsplit-dwarf).
+    // An object is recompiled if any of them are missing.
+    prb_Str* sideOutputExts;
+    int32_t  sideOutputExtsCount;
+    // Files that aren't sources but affect every object (like a PGO profile).
+    // Everything is recompiled when their content changes.
+    prb_Str* extraInputs;
+    int32_t  extraInputsCount;
+    // Preprocessed files and objects go here, the compile log is <objDir>-log.csv next to it
+    prb_Str objDir;
+    prb_Str libFile;
+    bool    cpp;
+    // Leave null to use clang and ar (llvm-lib on windows)
+    prb_BuildCmdProc buildCmd;
+    void*            buildCmdData;
+} prb_StaticLibSpec;
+
+typedef struct prb_ObjInfo {
+    prb_Str  compileCmd;
+    uint64_t preprocessedHash;
+    uint64_t extraInputsHash;
+    // Separated by spaces
+    prb_Str sideOutputs;
+    // Hash of the preprocessed text that came from each file (according to linemarkers), "0xhash path" per line
+    prb_Str fileHashes;
+} prb_ObjInfo;
+
+typedef enum prb_RebuildReason {
+    // Preprocessing is how changes are detected so it runs every time
+    prb_RebuildReason_AlwaysRuns,
+    prb_RebuildReason_NotInLog,
+    prb_RebuildReason_OutputMissing,
+    prb_RebuildReason_SideOutputMissing,
+    prb_RebuildReason_CmdChanged,
+    prb_RebuildReason_ExtraInputsChanged,
+    prb_RebuildReason_SourceChanged,
+    prb_RebuildReason_ObjsChanged,
+    prb_RebuildReason_Count,
+} prb_RebuildReason;
+
+// Why an action was run and how long it took
+typedef struct prb_BuildRecord {
+    prb_BuildStep     step;
+    prb_RebuildReason reason;
+    prb_Str           output;
+    // What exactly changed, one per line, like "changed /path/to/header.h" or "added arg -O2"
+    prb_Str causes;
+    float   durationMs;
+} prb_BuildRecord;
+
+typedef struct prb_StaticLib {
+    prb_StaticLibSpec spec;
+    prb_Str           logPath;
+    // Object paths from the previous log, their ids index prevLog
+    prb_StrInterner   prevLogObjs;
+    prb_ObjInfo*      prevLog;
+    prb_ProcessStatus status;
+    // Every action prb_compileStaticLibs ran for this library
+    prb_BuildRecord* records;
+    int32_t          recordsCount;
+} prb_StaticLib;
+
 // SECTION Memory
 prb_PUBLICDEC bool           prb_memeq(const void* ptr1, const void* ptr2, int32_t bytes);
 prb_PUBLICDEC int32_t        prb_getOffsetForAlignment(void* ptr, int32_t align);
@@ -533,39 +979,89 @@ prb_PUBLICDEC prb_PathEntryIter        prb_createPathEntryIter(prb_Str path);
 prb_PUBLICDEC prb_Status               prb_pathEntryIterNext(prb_PathEntryIter* iter);
 prb_PUBLICDEC void                     prb_getAllDirEntriesCustomBuffer(prb_Arena* arena, prb_Str dir, prb_Recursive mode, prb_Str** storage);
 prb_PUBLICDEC prb_Str*                 prb_getAllDirEntries(prb_Arena* arena, prb_Str dir, prb_Recursive mode);
+prb_PUBLICDEC prb_PathTrie             prb_getAllDirEntriesTrie(prb_Arena* arena, prb_Str dir, prb_Recursive mode);
+prb_PUBLICDEC prb_PathTrie             prb_createPathTrie(prb_Arena* arena, prb_Str* paths, int32_t pathsCount);
+prb_PUBLICDEC prb_Str                  prb_pathTrieGetName(prb_PathTrie* trie, int32_t node);
+prb_PUBLICDEC prb_Str                  prb_pathTrieGetPath(prb_Arena* arena, prb_PathTrie* trie, int32_t node);
+prb_PUBLICDEC int32_t                  prb_pathTrieFind(prb_PathTrie* trie, prb_Str path);
+prb_PUBLICDEC prb_Bytes                prb_pathTrieToBytes(prb_Arena* arena, prb_PathTrie* trie);
+prb_PUBLICDEC prb_PathTrieParseResult  prb_parsePathTrie(prb_Bytes bytes);
 prb_PUBLICDEC prb_FileTimestamp        prb_getLastModified(prb_Arena* arena, prb_Str path);
 prb_PUBLICDEC prb_Multitime            prb_createMultitime(void);
 prb_PUBLICDEC void                     prb_multitimeAdd(prb_Multitime* multitime, prb_FileTimestamp newTimestamp);
 prb_PUBLICDEC prb_ReadEntireFileResult prb_readEntireFile(prb_Arena* arena, prb_Str path);
 prb_PUBLICDEC prb_Status               prb_writeEntireFile(prb_Arena* arena, prb_Str path, const void* content, int32_t contentLen);
+prb_PUBLICDEC prb_Status               prb_writeChunksToFile(prb_Arena* arena, prb_Str path, prb_StrChunk* chunks);
 prb_PUBLICDEC prb_FileHash             prb_getFileHash(prb_Arena* arena, prb_Str filepath);
 
 // SECTION Strings
-prb_PUBLICDEC bool                prb_streq(prb_Str str1, prb_Str str2);
-prb_PUBLICDEC prb_Str             prb_strSlice(prb_Str str, int32_t start, int32_t onePastEnd);
-prb_PUBLICDEC const char*         prb_strGetNullTerminated(prb_Arena* arena, prb_Str str);
-prb_PUBLICDEC prb_Str             prb_strFromBytes(prb_Bytes bytes);
-prb_PUBLICDEC prb_Str             prb_strTrimSide(prb_Str str, prb_StrDirection dir);
-prb_PUBLICDEC prb_Str             prb_strTrim(prb_Str str);
-prb_PUBLICDEC prb_StrFindResult   prb_strFind(prb_Str str, prb_StrFindSpec spec);
-prb_PUBLICDEC bool                prb_strStartsWith(prb_Str str, prb_Str pattern);
-prb_PUBLICDEC bool                prb_strEndsWith(prb_Str str, prb_Str pattern);
-prb_PUBLICDEC prb_Str             prb_stringsJoin(prb_Arena* arena, prb_Str* strings, int32_t stringsCount, prb_Str sep);
-prb_PUBLICDEC prb_GrowingStr      prb_beginStr(prb_Arena* arena);
-prb_PUBLICDEC void                prb_addStrSegment(prb_GrowingStr* gstr, const char* fmt, ...) prb_ATTRIBUTE_FORMAT(2, 3);
-prb_PUBLICDEC prb_Str             prb_endStr(prb_GrowingStr* gstr);
-prb_PUBLICDEC prb_Str             prb_vfmtCustomBuffer(void* buf, int32_t bufSize, const char* fmt, va_list args);
-prb_PUBLICDEC prb_Str             prb_fmt(prb_Arena* arena, const char* fmt, ...) prb_ATTRIBUTE_FORMAT(2, 3);
-prb_PUBLICDEC prb_Status          prb_writeToStdout(prb_Str str);
-prb_PUBLICDEC prb_Status          prb_writelnToStdout(prb_Arena* arena, prb_Str str);
-prb_PUBLICDEC prb_Str             prb_colorEsc(prb_ColorID color);
-prb_PUBLICDEC prb_Utf8CharIter    prb_createUtf8CharIter(prb_Str str, prb_StrDirection direction);
-prb_PUBLICDEC prb_Status          prb_utf8CharIterNext(prb_Utf8CharIter* iter);
-prb_PUBLICDEC prb_StrScanner      prb_createStrScanner(prb_Str str);
-prb_PUBLICDEC prb_Status          prb_strScannerMove(prb_StrScanner* scanner, prb_StrFindSpec spec, prb_StrScannerSide side);
-prb_PUBLICDEC prb_ParseUintResult prb_parseUint(prb_Str digits, uint64_t base);
-prb_PUBLICDEC prb_ParsedNumber    prb_parseNumber(prb_Str str);
-prb_PUBLICDEC prb_Str             prb_binaryToCArray(prb_Arena* arena, prb_Str arrayName, void* data, int32_t dataLen);
+prb_PUBLICDEC bool                   prb_streq(prb_Str str1, prb_Str str2);
+prb_PUBLICDEC prb_Str                prb_strSlice(prb_Str str, int32_t start, int32_t onePastEnd);
+prb_PUBLICDEC const char*            prb_strGetNullTerminated(prb_Arena* arena, prb_Str str);
+prb_PUBLICDEC prb_Str                prb_strFromBytes(prb_Bytes bytes);
+prb_PUBLICDEC prb_Str                prb_strTrimSide(prb_Str str, prb_StrDirection dir);
+prb_PUBLICDEC prb_Str                prb_strTrim(prb_Str str);
+prb_PUBLICDEC prb_StrFindResult      prb_strFind(prb_Str str, prb_StrFindSpec spec);
+prb_PUBLICDEC prb_StrFinder          prb_createStrFinder(prb_StrFindSpec spec);
+prb_PUBLICDEC prb_StrFindResult      prb_strFinderFind(prb_StrFinder* finder, prb_Str str);
+prb_PUBLICDEC bool                   prb_strStartsWith(prb_Str str, prb_Str pattern);
+prb_PUBLICDEC bool                   prb_strEndsWith(prb_Str str, prb_Str pattern);
+prb_PUBLICDEC prb_Str                prb_stringsJoin(prb_Arena* arena, prb_Str* strings, int32_t stringsCount, prb_Str sep);
+prb_PUBLICDEC prb_StrSplitResult     prb_strSplit(prb_Arena* arena, prb_Str str, prb_Str delimSet, uint32_t flags);
+prb_PUBLICDEC prb_GrowingStr         prb_beginStr(prb_Arena* arena);
+prb_PUBLICDEC prb_GrowingStr         prb_beginChunkedStr(prb_Arena* arena);
+prb_PUBLICDEC void                   prb_addStrSegment(prb_GrowingStr* gstr, const char* fmt, ...) prb_ATTRIBUTE_FORMAT(2, 3);
+prb_PUBLICDEC void                   prb_addStr(prb_GrowingStr* gstr, prb_Str str);
+prb_PUBLICDEC void                   prb_addChar(prb_GrowingStr* gstr, char ch);
+prb_PUBLICDEC void                   prb_addU64(prb_GrowingStr* gstr, uint64_t value, int32_t base, int32_t minDigits);
+prb_PUBLICDEC void                   prb_addI64(prb_GrowingStr* gstr, int64_t value, int32_t base, int32_t minDigits);
+prb_PUBLICDEC void                   prb_addHex(prb_GrowingStr* gstr, uint64_t value);
+prb_PUBLICDEC void                   prb_addF64(prb_GrowingStr* gstr, double value, int32_t decimals);
+prb_PUBLICDEC prb_Str                prb_endStr(prb_GrowingStr* gstr);
+prb_PUBLICDEC prb_Str                prb_vfmtCustomBuffer(void* buf, int32_t bufSize, const char* fmt, va_list args);
+prb_PUBLICDEC prb_Str                prb_fmt(prb_Arena* arena, const char* fmt, ...) prb_ATTRIBUTE_FORMAT(2, 3);
+prb_PUBLICDEC prb_Status             prb_writeToStdout(prb_Str str);
+prb_PUBLICDEC prb_Status             prb_writelnToStdout(prb_Arena* arena, prb_Str str);
+prb_PUBLICDEC prb_Str                prb_colorEsc(prb_ColorID color);
+prb_PUBLICDEC prb_Utf8CharIter       prb_createUtf8CharIter(prb_Str str, prb_StrDirection direction);
+prb_PUBLICDEC prb_Status             prb_utf8CharIterNext(prb_Utf8CharIter* iter);
+prb_PUBLICDEC prb_Utf8ValidateResult prb_utf8Validate(prb_Str str);
+prb_PUBLICDEC prb_Utf32Result        prb_utf8ToUtf32(prb_Arena* arena, prb_Str str);
+prb_PUBLICDEC prb_Utf8Result         prb_utf32ToUtf8(prb_Arena* arena, prb_Utf32Str str);
+prb_PUBLICDEC prb_Utf16Result        prb_utf8ToUtf16(prb_Arena* arena, prb_Str str);
+prb_PUBLICDEC prb_Utf8Result         prb_utf16ToUtf8(prb_Arena* arena, prb_Utf16Str str);
+prb_PUBLICDEC prb_StrScanner         prb_createStrScanner(prb_Str str);
+prb_PUBLICDEC prb_Status             prb_strScannerMove(prb_StrScanner* scanner, prb_StrFindSpec spec, prb_StrScannerSide side);
+prb_PUBLICDEC prb_Status             prb_strScannerMoveWith(prb_StrScanner* scanner, prb_StrFinder* finder, prb_StrScannerSide side);
+prb_PUBLICDEC prb_LineIndex          prb_buildLineIndex(prb_Arena* arena, prb_Str str);
+prb_PUBLICDEC prb_LineIter           prb_createLineIter(prb_LineIndex* index);
+prb_PUBLICDEC prb_Status             prb_lineIterNext(prb_LineIter* iter);
+prb_PUBLICDEC prb_ParseUintResult    prb_parseUint(prb_Str digits, uint64_t base);
+prb_PUBLICDEC prb_ParsedNumber       prb_parseNumber(prb_Str str);
+prb_PUBLICDEC prb_ParseNumbersResult prb_parseNumbers(prb_Arena* arena, prb_Str str, prb_Str delimiters);
+prb_PUBLICDEC prb_Str                prb_binaryToCArray(prb_Arena* arena, prb_Str arrayName, void* data, int32_t dataLen);
+prb_PUBLICDEC prb_Str                prb_binaryToCString(prb_Arena* arena, prb_Str arrayName, void* data, int32_t dataLen);
+prb_PUBLICDEC prb_EmbedFileResult    prb_embedFile(prb_Arena* arena, prb_Str name, prb_Str path, prb_EmbedKind kind);
+prb_PUBLICDEC uint64_t               prb_hashBytes(const void* data, int32_t len, uint64_t seed);
+prb_PUBLICDEC uint64_t               prb_hashStr(prb_Str str);
+prb_PUBLICDEC prb_StrInterner        prb_createStrInterner(prb_Arena* arena, prb_ThreadSafe threadSafe);
+prb_PUBLICDEC prb_InternedStr*       prb_internStr(prb_StrInterner* interner, prb_Str str);
+prb_PUBLICDEC prb_InternedStr*       prb_findInternedStr(prb_StrInterner* interner, prb_Str str);
+prb_PUBLICDEC prb_StrMap             prb_createStrMap(prb_Arena* arena, int32_t expectedCount);
+prb_PUBLICDEC prb_StrMapEntry*       prb_strMapAdd(prb_StrMap* map, prb_Str key);
+prb_PUBLICDEC prb_StrMapEntry*       prb_strMapAddHashed(prb_StrMap* map, prb_Str key, uint64_t hash);
+prb_PUBLICDEC prb_StrMapEntry*       prb_strMapFind(prb_StrMap* map, prb_Str key);
+prb_PUBLICDEC prb_StrMapEntry*       prb_strMapFindHashed(prb_StrMap* map, prb_Str key, uint64_t hash);
+prb_PUBLICDEC prb_SharedStrMap       prb_createSharedStrMap(prb_Arena* arena);
+prb_PUBLICDEC prb_StrMapEntry*       prb_sharedStrMapAdd(prb_SharedStrMap* map, prb_Str key, uint64_t value);
+prb_PUBLICDEC prb_StrMapEntry*       prb_sharedStrMapFind(prb_SharedStrMap* map, prb_Str key);
+prb_PUBLICDEC prb_MultiFinder        prb_createMultiFinder(prb_Arena* arena, prb_Str* patterns, int32_t patternsCount);
+prb_PUBLICDEC prb_MultiFindResult    prb_multiFinderFindAll(prb_Arena* arena, prb_MultiFinder* finder, prb_Str str);
+prb_PUBLICDEC prb_CompileRegexResult prb_compileRegex(prb_Arena* arena, prb_Str pattern, intptr_t cacheBytes);
+prb_PUBLICDEC bool                   prb_regexMatch(prb_Regex* regex, prb_Str str);
+prb_PUBLICDEC prb_StrFindResult      prb_regexFind(prb_Regex* regex, prb_Str str);
+prb_PUBLICDEC void                   prb_sortU64(prb_Arena* arena, uint64_t* keys, uint64_t* values, int32_t count);
+prb_PUBLICDEC void                   prb_sortStrs(prb_Arena* arena, prb_Str* strs, int32_t count);
 
 // SECTION Processes
 prb_PUBLICDEC void                prb_terminate(int32_t code);
@@ -584,6 +1080,7 @@ prb_PUBLICDEC bool                prb_debuggerPresent(prb_Arena* arena);
 prb_PUBLICDEC prb_Status          prb_setenv(prb_Arena* arena, prb_Str name, prb_Str value);
 prb_PUBLICDEC prb_GetenvResult    prb_getenv(prb_Arena* arena, prb_Str name);
 prb_PUBLICDEC prb_Status          prb_unsetenv(prb_Arena* arena, prb_Str name);
+prb_PUBLICDEC void                prb_rebuildSelfIfChanged(prb_Arena* arena, prb_Str sourcePath, prb_Str flags);
 
 // SECTION Timing
 prb_PUBLICDEC prb_TimeStart prb_timeStart(void);
@@ -594,6 +1091,16 @@ prb_PUBLICDEC prb_Job    prb_createJob(prb_JobProc proc, void* data, prb_Arena*
 prb_PUBLICDEC prb_Status prb_launchJobs(prb_Job* jobs, int32_t jobsCount, prb_Background mode);
 prb_PUBLICDEC prb_Status prb_waitForJobs(prb_Job* jobs, int32_t jobsCount);
 
+// SECTION Remote execution
+prb_PUBLICDEC prb_Status prb_executeActions(prb_Arena* arena, prb_Action* actions, int32_t actionsCount, prb_ExecSpec spec);
+prb_PUBLICDEC prb_Status prb_runWorker(prb_Arena* arena, prb_Str address, prb_Str workDir, prb_Str token);
+prb_PUBLICDEC prb_Status prb_stopWorker(prb_Arena* arena, prb_Str address, prb_Str token);
+
+// SECTION Static libraries
+prb_PUBLICDEC prb_StaticLib prb_createStaticLib(prb_Arena* arena, prb_StaticLibSpec spec);
+prb_PUBLICDEC prb_Status    prb_compileStaticLibs(prb_Arena* arena, prb_StaticLib* libs, int32_t libsCount, prb_ExecSpec spec);
+prb_PUBLICDEC prb_Str       prb_explainStaticLibs(prb_Arena* arena, prb_StaticLib* libs, int32_t libsCount, int32_t maxLines);
+
 // SECTION Random numbers
 prb_PUBLICDEC prb_Rng  prb_createRng(uint32_t seed);
 prb_PUBLICDEC uint32_t prb_randomU32(prb_Rng* rng);
@@ -1026,6 +1533,19 @@ prb_stbds_shmode_func_wrapper(T*, size_t elemsize, int mode) {
 
 #ifndef prb_NO_IMPLEMENTATION
 
+// NOTE(khvorov) Only the implementation needs these so they don't end up in every file that includes the header
+#if prb_PLATFORM_LINUX
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <errno.h>
+#include <stdio.h>
+#endif
+
 //
 // SECTION Memory (implementation)
 //
@@ -1140,6 +1660,83 @@ prb_endTempMemory(prb_TempMemory temp) {
     temp.arena->tempCount -= 1;
 }
 
+static int32_t
+prb_atomicFetchAddI32(volatile int32_t* ptr, int32_t value) {
+#if prb_PLATFORM_WINDOWS
+    int32_t result = (int32_t)InterlockedExchangeAdd((volatile LONG*)ptr, (LONG)value);
+#elif prb_PLATFORM_LINUX
+    int32_t result = __atomic_fetch_add(ptr, value, __ATOMIC_SEQ_CST);
+#else
+#error unimplemented
+#endif
+    return result;
+}
+
+static bool
+prb_atomicCompareExchangeI32(volatile int32_t* ptr, int32_t expected, int32_t desired) {
+#if prb_PLATFORM_WINDOWS
+    bool result = InterlockedCompareExchange((volatile LONG*)ptr, (LONG)desired, (LONG)expected) == (LONG)expected;
+#elif prb_PLATFORM_LINUX
+    bool result = __atomic_compare_exchange_n(ptr, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#else
+#error unimplemented
+#endif
+    return result;
+}
+
+static void
+prb_atomicStoreI32(volatile int32_t* ptr, int32_t value) {
+#if prb_PLATFORM_WINDOWS
+    InterlockedExchange((volatile LONG*)ptr, (LONG)value);
+#elif prb_PLATFORM_LINUX
+    __atomic_store_n(ptr, value, __ATOMIC_SEQ_CST);
+#else
+#error unimplemented
+#endif
+}
+
+static void*
+prb_atomicLoadPtr(void* volatile* ptr) {
+#if prb_PLATFORM_WINDOWS
+    void* result = ReadPointerAcquire((PVOID const volatile*)ptr);
+#elif prb_PLATFORM_LINUX
+    void* result = __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#else
+#error unimplemented
+#endif
+    return result;
+}
+
+static void
+prb_atomicStorePtr(void* volatile* ptr, void* value) {
+#if prb_PLATFORM_WINDOWS
+    WritePointerRelease((PVOID volatile*)ptr, value);
+#elif prb_PLATFORM_LINUX
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+#else
+#error unimplemented
+#endif
+}
+
+// NOTE(khvorov) For short critical sections, waiters give up their time slice instead of spinning hard
+static void
+prb_lib_spinLock(volatile int32_t* lock) {
+    while (!prb_atomicCompareExchangeI32(lock, 0, 1)) {
+#if prb_PLATFORM_WINDOWS
+        SwitchToThread();
+#elif prb_PLATFORM_LINUX
+        sched_yield();
+#else
+#error unimplemented
+#endif
+    }
+}
+
+static void
+prb_lib_spinUnlock(volatile int32_t* lock) {
+    prb_atomicStoreI32(lock, 0);
+}
+
 //
 // SECTION Filesystem (implementation)
 //
@@ -1379,11 +1976,10 @@ prb_getAbsolutePath(prb_Arena* arena, prb_Str path) {
             }
         }
         if (addThisEntry) {
-            if (gstr.str.len == 0 || prb_charIsSep(gstr.str.ptr[gstr.str.len - 1])) {
-                prb_addStrSegment(&gstr, "%.*s", prb_LIT(iter.curEntryName));
-            } else {
-                prb_addStrSegment(&gstr, "/%.*s", prb_LIT(iter.curEntryName));
+            if (gstr.str.len > 0 && !prb_charIsSep(gstr.str.ptr[gstr.str.len - 1])) {
+                prb_addChar(&gstr, '/');
             }
+            prb_addStr(&gstr, iter.curEntryName);
         }
     }
 
@@ -1602,7 +2198,11 @@ prb_pathJoin(prb_Arena* arena, prb_Str path1, prb_Str path2) {
     if (path2StartsOnSep) {
         path2 = prb_strSlice(path2, 1, path2.len);
     }
-    prb_Str result = prb_fmt(arena, "%.*s/%.*s", prb_LIT(path1), prb_LIT(path2));
+    prb_GrowingStr gstr = prb_beginStr(arena);
+    prb_addStr(&gstr, path1);
+    prb_addChar(&gstr, '/');
+    prb_addStr(&gstr, path2);
+    prb_Str result = prb_endStr(&gstr);
     return result;
 }
 
@@ -1826,6 +2426,389 @@ prb_getAllDirEntries(prb_Arena* arena, prb_Str dir, prb_Recursive mode) {
     return entries;
 }
 
+typedef struct prb_lib_DirTrieFrame {
+    prb_TempMemory temp;
+    int32_t        node;
+    prb_Str        path;
+#if prb_PLATFORM_WINDOWS
+    HANDLE           handle;
+    WIN32_FIND_DATAW findData;
+    bool             hasEntry;
+#elif prb_PLATFORM_LINUX
+    uint8_t* buf;
+    long     bufLen;
+    long     offset;
+#else
+#error unimplemented
+#endif
+} prb_lib_DirTrieFrame;
+
+static prb_lib_DirTrieFrame
+prb_lib_openDirTrieFrame(prb_Arena* arena, prb_TempMemory temp, prb_Str path, int32_t node) {
+    prb_lib_DirTrieFrame result = {};
+    result.temp = temp;
+    result.node = node;
+    result.path = path;
+
+#if prb_PLATFORM_WINDOWS
+
+    prb_Str             pattern = prb_pathJoin(arena, path, prb_STR("*"));
+    prb_windows_WideStr pathWide = prb_windows_getWidePath(arena, pattern);
+    result.handle = FindFirstFileExW(pathWide.ptr, FindExInfoStandard, &result.findData, FindExSearchNameMatch, 0, 0);
+    result.hasEntry = result.handle != INVALID_HANDLE_VALUE;
+
+#elif prb_PLATFORM_LINUX
+
+    prb_linux_OpenResult openRes = prb_linux_open(arena, path, O_RDONLY | O_DIRECTORY, 0);
+    if (openRes.success) {
+        prb_arenaAlignFreePtr(arena, prb_alignof(prb_linux_Dirent64));
+        result.buf = (uint8_t*)prb_arenaFreePtr(arena);
+        unsigned int bufSize = (unsigned int)prb_min(prb_arenaFreeSize(arena), 1 * prb_GIGABYTE);
+        bufSize += prb_getOffsetForAlignment((void*)(uintptr_t)bufSize, prb_alignof(prb_linux_Dirent64));
+        long syscallReturn = syscall(SYS_getdents64, openRes.handle, result.buf, bufSize);
+        if (syscallReturn > 0) {
+            prb_arenaChangeUsed(arena, syscallReturn);
+            result.bufLen = syscallReturn;
+        }
+        close(openRes.handle);
+    }
+
+#else
+#error unimplemented
+#endif
+
+    return result;
+}
+
+static bool
+prb_lib_dirTrieFrameNext(prb_Arena* arena, prb_lib_DirTrieFrame* frame, prb_Recursive mode, prb_Str* name, bool* isDir) {
+    bool result = false;
+
+#if prb_PLATFORM_WINDOWS
+
+    while (frame->hasEntry && !result) {
+        prb_windows_WideStr fileNameWide = {frame->findData.cFileName, prb_arrayCount(frame->findData.cFileName)};
+        bool                isDot = fileNameWide.ptr[0] == '.' && fileNameWide.ptr[1] == '\0';
+        bool                isDoubleDot = fileNameWide.ptr[0] == '.' && fileNameWide.ptr[1] == '.' && fileNameWide.ptr[2] == '\0';
+        if (!isDot && !isDoubleDot) {
+            result = true;
+            *name = prb_windows_strFromWideStr(arena, fileNameWide);
+            *isDir = (frame->findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == FILE_ATTRIBUTE_DIRECTORY;
+        }
+        if (FindNextFileW(frame->handle, &frame->findData) == 0) {
+            FindClose(frame->handle);
+            frame->hasEntry = false;
+        }
+    }
+
+#elif prb_PLATFORM_LINUX
+
+    while (frame->offset < frame->bufLen && !result) {
+        prb_linux_Dirent64* ent = (prb_linux_Dirent64*)(frame->buf + frame->offset);
+        frame->offset += ent->d_reclen;
+        bool isDot = ent->d_name[0] == '.' && ent->d_name[1] == '\0';
+        bool isDoubleDot = ent->d_name[0] == '.' && ent->d_name[1] == '.' && ent->d_name[2] == '\0';
+        if (!isDot && !isDoubleDot) {
+            result = true;
+            *name = prb_STR(ent->d_name);
+            *isDir = ent->d_type == DT_DIR;
+            if (mode == prb_Recursive_Yes && ent->d_type == DT_UNKNOWN) {
+                *isDir = prb_isDir(arena, prb_pathJoin(arena, frame->path, *name));
+            }
+        }
+    }
+
+#else
+#error unimplemented
+#endif
+
+    return result;
+}
+
+static int32_t
+prb_lib_pathTrieAddNode(prb_PathTrie* trie, int32_t parent, prb_Str name) {
+    int32_t          result = (int32_t)prb_stbds_arrlen(trie->nodes);
+    prb_PathTrieNode node = {.parent = parent, .nameOffset = (int32_t)prb_stbds_arrlen(trie->names), .subtreeCount = 1};
+    prb_stbds_arrput(trie->nodes, node);
+    if (name.len > 0) {
+        char* dest = prb_stbds_arraddnptr(trie->names, name.len);
+        prb_memcpy(dest, name.ptr, name.len);
+    }
+    return result;
+}
+
+static void
+prb_lib_pathTrieCloseNodes(prb_PathTrie* trie, int32_t** openNodes, int32_t keep) {
+    while (prb_stbds_arrlen(*openNodes) > keep) {
+        int32_t node = prb_stbds_arrpop(*openNodes);
+        trie->nodes[node].subtreeCount = (int32_t)prb_stbds_arrlen(trie->nodes) - node;
+    }
+}
+
+prb_PUBLICDEF prb_PathTrie
+prb_getAllDirEntriesTrie(prb_Arena* arena, prb_Str dir, prb_Recursive mode) {
+    prb_PathTrie result = {.nodes = 0, .names = 0};
+    prb_lib_pathTrieAddNode(&result, -1, prb_STR(""));
+
+    if (dir.ptr && dir.len > 0) {
+        while (dir.len > 1 && prb_charIsSep(dir.ptr[dir.len - 1])) {
+            dir.len -= 1;
+        }
+        int32_t dirNode = prb_lib_pathTrieAddNode(&result, 0, dir);
+
+        // NOTE(khvorov) Depth-first so that only the listings of the current directory and its
+        // parents are alive in the arena at any point
+        prb_lib_DirTrieFrame* frames = 0;
+        prb_stbds_arrput(frames, prb_lib_openDirTrieFrame(arena, prb_beginTempMemory(arena), dir, dirNode));
+
+        while (prb_stbds_arrlen(frames) > 0) {
+            prb_lib_DirTrieFrame* frame = frames + prb_stbds_arrlen(frames) - 1;
+            prb_Str               name = {.ptr = 0, .len = 0};
+            bool                  isDir = false;
+            if (prb_lib_dirTrieFrameNext(arena, frame, mode, &name, &isDir)) {
+                int32_t node = prb_lib_pathTrieAddNode(&result, frame->node, name);
+                if (mode == prb_Recursive_Yes && isDir) {
+                    prb_TempMemory temp = prb_beginTempMemory(arena);
+                    prb_Str        path = prb_pathJoin(arena, frame->path, name);
+                    prb_stbds_arrput(frames, prb_lib_openDirTrieFrame(arena, temp, path, node));
+                }
+            } else {
+                result.nodes[frame->node].subtreeCount = (int32_t)prb_stbds_arrlen(result.nodes) - frame->node;
+                prb_endTempMemory(frame->temp);
+                prb_stbds_arrsetlen(frames, prb_stbds_arrlen(frames) - 1);
+            }
+        }
+
+        prb_stbds_arrfree(frames);
+    }
+
+    result.nodes[0].subtreeCount = (int32_t)prb_stbds_arrlen(result.nodes);
+    return result;
+}
+
+prb_PUBLICDEF prb_PathTrie
+prb_createPathTrie(prb_Arena* arena, prb_Str* paths, int32_t pathsCount) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+    prb_PathTrie   result = {.nodes = 0, .names = 0};
+    prb_lib_pathTrieAddNode(&result, -1, prb_STR(""));
+
+    // NOTE(khvorov) With separators collapsed and turned into the smallest byte, sorted paths that
+    // share a directory are next to each other, so every directory is added once
+    char     sep = '\x01';
+    prb_Str* sorted = prb_arenaAllocArray(arena, prb_Str, pathsCount);
+    for (int32_t pathIndex = 0; pathIndex < pathsCount; pathIndex++) {
+        prb_Str path = paths[pathIndex];
+        char*   copy = prb_arenaAllocArray(arena, char, path.len);
+        int32_t copyLen = 0;
+        for (int32_t charIndex = 0; charIndex < path.len; charIndex++) {
+            char ch = path.ptr[charIndex];
+            if (!prb_charIsSep(ch)) {
+                copy[copyLen++] = ch;
+            } else if (copyLen == 0 || copy[copyLen - 1] != sep) {
+                copy[copyLen++] = sep;
+            }
+        }
+        if (copyLen > 1 && copy[copyLen - 1] == sep) {
+            copyLen -= 1;
+        }
+        sorted[pathIndex] = (prb_Str) {copy, copyLen};
+    }
+    prb_sortStrs(arena, sorted, pathsCount);
+
+    // NOTE(khvorov) Nodes from the root to the last added one, their subtrees are not finished yet
+    int32_t* openNodes = 0;
+    prb_stbds_arrput(openNodes, 0);
+    for (int32_t pathIndex = 0; pathIndex < pathsCount; pathIndex++) {
+        prb_Str path = sorted[pathIndex];
+        int32_t depth = 0;
+        int32_t offset = 0;
+        while (offset < path.len) {
+            prb_Str name = prb_STR("/");
+            if (path.ptr[offset] == sep) {
+                offset += 1;
+            } else {
+                int32_t nameStart = offset;
+                while (offset < path.len && path.ptr[offset] != sep) {
+                    offset += 1;
+                }
+                name = prb_strSlice(path, nameStart, offset);
+                offset += 1;
+            }
+
+            depth += 1;
+            bool exists = depth < prb_stbds_arrlen(openNodes) && prb_streq(prb_pathTrieGetName(&result, openNodes[depth]), name);
+            if (!exists) {
+                prb_lib_pathTrieCloseNodes(&result, &openNodes, depth);
+                int32_t node = prb_lib_pathTrieAddNode(&result, openNodes[depth - 1], name);
+                prb_stbds_arrput(openNodes, node);
+            }
+        }
+    }
+    prb_lib_pathTrieCloseNodes(&result, &openNodes, 0);
+    prb_stbds_arrfree(openNodes);
+
+    prb_endTempMemory(temp);
+    return result;
+}
+
+prb_PUBLICDEF prb_Str
+prb_pathTrieGetName(prb_PathTrie* trie, int32_t node) {
+    prb_assert(node >= 0 && node < prb_stbds_arrlen(trie->nodes));
+    int32_t start = trie->nodes[node].nameOffset;
+    int32_t end = node + 1 < prb_stbds_arrlen(trie->nodes) ? trie->nodes[node + 1].nameOffset : (int32_t)prb_stbds_arrlen(trie->names);
+    prb_Str result = {.ptr = trie->names + start, .len = end - start};
+    return result;
+}
+
+static bool
+prb_lib_pathTrieNeedsSep(prb_PathTrie* trie, int32_t parent) {
+    bool result = false;
+    if (parent > 0) {
+        prb_Str parentName = prb_pathTrieGetName(trie, parent);
+        result = parentName.len == 0 || !prb_charIsSep(parentName.ptr[parentName.len - 1]);
+    }
+    return result;
+}
+
+prb_PUBLICDEF prb_Str
+prb_pathTrieGetPath(prb_Arena* arena, prb_PathTrie* trie, int32_t node) {
+    int32_t len = 0;
+    for (int32_t ancestor = node; ancestor > 0; ancestor = trie->nodes[ancestor].parent) {
+        len += prb_pathTrieGetName(trie, ancestor).len + (int32_t)prb_lib_pathTrieNeedsSep(trie, trie->nodes[ancestor].parent);
+    }
+
+    char*   buf = prb_arenaAllocArray(arena, char, len + 1);
+    int32_t offset = len;
+    for (int32_t ancestor = node; ancestor > 0; ancestor = trie->nodes[ancestor].parent) {
+        prb_Str name = prb_pathTrieGetName(trie, ancestor);
+        offset -= name.len;
+        prb_memcpy(buf + offset, name.ptr, name.len);
+        if (prb_lib_pathTrieNeedsSep(trie, trie->nodes[ancestor].parent)) {
+            offset -= 1;
+            buf[offset] = '/';
+        }
+    }
+    prb_assert(offset == 0);
+
+    prb_Str result = {.ptr = buf, .len = len};
+    return result;
+}
+
+prb_PUBLICDEF int32_t
+prb_pathTrieFind(prb_PathTrie* trie, prb_Str path) {
+    int32_t result = 0;
+    prb_Str rest = path;
+    while (rest.len > 0 && result != -1) {
+        int32_t parent = result;
+        int32_t parentEnd = parent + trie->nodes[parent].subtreeCount;
+        result = -1;
+        for (int32_t child = parent + 1; child < parentEnd && result == -1; child += trie->nodes[child].subtreeCount) {
+            // NOTE(khvorov) Names can span several entries (the directory given to prb_getAllDirEntriesTrie)
+            // so match on the name followed by a separator rather than on one path entry at a time
+            prb_Str name = prb_pathTrieGetName(trie, child);
+            if (name.len > 0 && prb_strStartsWith(rest, name)) {
+                bool atBoundary = rest.len == name.len || prb_charIsSep(name.ptr[name.len - 1]) || prb_charIsSep(rest.ptr[name.len]);
+                if (atBoundary) {
+                    result = child;
+                    rest = prb_strSlice(rest, name.len, rest.len);
+                    while (rest.len > 0 && prb_charIsSep(rest.ptr[0])) {
+                        rest = prb_strSlice(rest, 1, rest.len);
+                    }
+                }
+            }
+        }
+    }
+    return result;
+}
+
+static void
+prb_lib_addVarint(prb_GrowingStr* gstr, uint32_t value) {
+    while (value >= 0x80) {
+        prb_addChar(gstr, (char)((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    prb_addChar(gstr, (char)value);
+}
+
+static bool
+prb_lib_readVarint(prb_Bytes bytes, int32_t* offset, int32_t* value) {
+    bool     result = false;
+    uint64_t acc = 0;
+    for (int32_t shift = 0; shift < 35 && *offset < bytes.len && !result; shift += 7) {
+        uint8_t byte = bytes.data[*offset];
+        *offset += 1;
+        acc |= (uint64_t)(byte & 0x7F) << shift;
+        result = (byte & 0x80) == 0;
+    }
+    result = result && acc <= INT32_MAX;
+    *value = (int32_t)acc;
+    return result;
+}
+
+prb_PUBLICDEF prb_Bytes
+prb_pathTrieToBytes(prb_Arena* arena, prb_PathTrie* trie) {
+    // NOTE(khvorov) Parents and name offsets follow from the order of the nodes so only name
+    // lengths and subtree sizes are written, as varints, followed by all the names
+    prb_GrowingStr gstr = prb_beginStr(arena);
+    int32_t        nodesCount = (int32_t)prb_stbds_arrlen(trie->nodes);
+    prb_lib_addVarint(&gstr, (uint32_t)nodesCount);
+    prb_lib_addVarint(&gstr, (uint32_t)prb_stbds_arrlen(trie->names));
+    for (int32_t node = 0; node < nodesCount; node++) {
+        prb_lib_addVarint(&gstr, (uint32_t)prb_pathTrieGetName(trie, node).len);
+        prb_lib_addVarint(&gstr, (uint32_t)trie->nodes[node].subtreeCount);
+    }
+    prb_addStr(&gstr, (prb_Str) {trie->names, (int32_t)prb_stbds_arrlen(trie->names)});
+    prb_Str   str = prb_endStr(&gstr);
+    prb_Bytes result = {.data = (uint8_t*)str.ptr, .len = str.len};
+    return result;
+}
+
+prb_PUBLICDEF prb_PathTrieParseResult
+prb_parsePathTrie(prb_Bytes bytes) {
+    prb_PathTrieParseResult result = {.success = false, .trie = {.nodes = 0, .names = 0}};
+
+    int32_t offset = 0;
+    int32_t nodesCount = 0;
+    int32_t namesLen = 0;
+    bool    success = prb_lib_readVarint(bytes, &offset, &nodesCount) && prb_lib_readVarint(bytes, &offset, &namesLen) && nodesCount > 0;
+
+    // NOTE(khvorov) Nodes whose subtrees contain the current one, the innermost is the parent
+    int32_t* openNodes = 0;
+    int32_t  nameOffset = 0;
+    for (int32_t node = 0; node < nodesCount && success; node++) {
+        int32_t nameLen = 0;
+        int32_t subtreeCount = 0;
+        success = prb_lib_readVarint(bytes, &offset, &nameLen) && prb_lib_readVarint(bytes, &offset, &subtreeCount)
+            && subtreeCount > 0 && subtreeCount <= nodesCount - node && nameLen <= namesLen - nameOffset;
+        if (success) {
+            while (prb_stbds_arrlen(openNodes) > 0 && prb_stbds_arrlast(openNodes) + result.trie.nodes[prb_stbds_arrlast(openNodes)].subtreeCount <= node) {
+                prb_stbds_arrsetlen(openNodes, prb_stbds_arrlen(openNodes) - 1);
+            }
+            int32_t parent = prb_stbds_arrlen(openNodes) > 0 ? prb_stbds_arrlast(openNodes) : -1;
+            success = (parent == -1) == (node == 0)
+                && (parent == -1 || node + subtreeCount <= parent + result.trie.nodes[parent].subtreeCount);
+            prb_PathTrieNode trieNode = {.parent = parent, .nameOffset = nameOffset, .subtreeCount = subtreeCount};
+            prb_stbds_arrput(result.trie.nodes, trieNode);
+            prb_stbds_arrput(openNodes, node);
+            nameOffset += nameLen;
+        }
+    }
+    prb_stbds_arrfree(openNodes);
+
+    if (success && nameOffset == namesLen && bytes.len - offset == namesLen) {
+        result.success = true;
+        if (namesLen > 0) {
+            char* dest = prb_stbds_arraddnptr(result.trie.names, namesLen);
+            prb_memcpy(dest, bytes.data + offset, namesLen);
+        }
+    } else {
+        prb_stbds_arrfree(result.trie.nodes);
+        result.trie.nodes = 0;
+    }
+
+    return result;
+}
+
 prb_PUBLICDEF prb_FileTimestamp
 prb_getLastModified(prb_Arena* arena, prb_Str path) {
     prb_FileTimestamp result = {.valid = false, .timestamp = 0};
@@ -1954,6 +2937,62 @@ prb_writeEntireFile(prb_Arena* arena, prb_Str path, const void* content, int32_t
     return result;
 }
 
+prb_PUBLICDEF prb_Status
+prb_writeChunksToFile(prb_Arena* arena, prb_Str path, prb_StrChunk* chunks) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+    prb_Status     result = prb_Failure;
+    prb_Str        parent = prb_getParentDir(arena, path);
+    if (prb_createDirIfNotExists(arena, parent)) {
+#if prb_PLATFORM_WINDOWS
+        prb_windows_OpenResult handle = prb_windows_open(arena, path, GENERIC_WRITE, 0, CREATE_ALWAYS, 0);
+        if (handle.success) {
+            result = prb_Success;
+            for (prb_StrChunk* chunk = chunks; chunk && result == prb_Success; chunk = chunk->next) {
+                DWORD bytesWritten = 0;
+                if (!WriteFile(handle.handle, chunk->str.ptr, (DWORD)chunk->str.len, &bytesWritten, 0) || (int32_t)bytesWritten != chunk->str.len) {
+                    result = prb_Failure;
+                }
+            }
+            CloseHandle(handle.handle);
+        }
+#elif prb_PLATFORM_LINUX
+        prb_linux_OpenResult handle = prb_linux_open(arena, path, O_CREAT | O_TRUNC | O_WRONLY, S_IRUSR | S_IRGRP | S_IROTH | S_IWUSR);
+        if (handle.success) {
+            // NOTE(khvorov) One syscall per batch of chunks, a short write continues from where it stopped
+            result = prb_Success;
+            prb_StrChunk* chunk = chunks;
+            int32_t       chunkOffset = 0;
+            while (chunk && result == prb_Success) {
+                struct iovec  iov[64];
+                int32_t       iovCount = 0;
+                prb_StrChunk* batchChunk = chunk;
+                for (int32_t offset = chunkOffset; batchChunk && iovCount < prb_arrayCount(iov); batchChunk = batchChunk->next, offset = 0) {
+                    iov[iovCount].iov_base = (void*)(batchChunk->str.ptr + offset);
+                    iov[iovCount].iov_len = (size_t)(batchChunk->str.len - offset);
+                    iovCount += 1;
+                }
+                ssize_t written = writev(handle.handle, iov, iovCount);
+                if (written < 0) {
+                    result = errno == EINTR ? prb_Success : prb_Failure;
+                    written = 0;
+                }
+                while (chunk && written >= chunk->str.len - chunkOffset) {
+                    written -= chunk->str.len - chunkOffset;
+                    chunk = chunk->next;
+                    chunkOffset = 0;
+                }
+                chunkOffset += (int32_t)written;
+            }
+            close(handle.handle);
+        }
+#else
+#error unimplemented
+#endif
+    }
+    prb_endTempMemory(temp);
+    return result;
+}
+
 prb_PUBLICDEF prb_FileHash
 prb_getFileHash(prb_Arena* arena, prb_Str filepath) {
     prb_FileHash             result = {.valid = false, .hash = 0};
@@ -2041,95 +3080,608 @@ prb_strTrim(prb_Str str) {
     return result;
 }
 
-prb_PUBLICDEF prb_StrFindResult
-prb_strFind(prb_Str str, prb_StrFindSpec spec) {
-    prb_StrFindResult result;
-    prb_memset(&result, 0, sizeof(result));
+// NOTE(khvorov) Patterns up to this length are searched by comparing their first and last bytes
+// at every position of a vector at once
+#define prb_RAITA_MIN_PATTERN_LEN 64
 
-    prb_StrFindMode mode = spec.mode;
-    if (spec.pattern.len == 1 && mode == prb_StrFindMode_Exact) {
-        mode = prb_StrFindMode_AnyChar;
+// NOTE(khvorov) Raita string matching algorithm
+// https://en.wikipedia.org/wiki/Raita_algorithm
+static void
+prb_lib_buildRaitaShifts(const uint8_t* pat, int32_t patLen, prb_StrDirection direction, int32_t* charOffsets) {
+    for (int32_t i = 0; i < 256; ++i) {
+        charOffsets[i] = patLen;
     }
 
-    switch (mode) {
-        case prb_StrFindMode_Exact: {
-            // Raita string matching algorithm
-            // https://en.wikipedia.org/wiki/Raita_algorithm
+    {
+        int32_t from = 0;
+        int32_t to = patLen - 1;
+        int32_t delta = 1;
+        if (direction == prb_StrDirection_FromEnd) {
+            from = patLen - 1;
+            to = 0;
+            delta = -1;
+        }
 
-            if (str.len >= spec.pattern.len && spec.pattern.len > 0) {
-                uint8_t* bstr = (uint8_t*)str.ptr;
-                uint8_t* pat = (uint8_t*)spec.pattern.ptr;
-                int32_t  charOffsets[256];
+        int32_t count = 0;
+        for (int32_t i = from; i != to; i += delta) {
+            uint8_t patternChar = pat[i];
+            charOffsets[patternChar] = patLen - count++ - 1;
+        }
 
-                for (int32_t i = 0; i < 256; ++i) {
-                    charOffsets[i] = spec.pattern.len;
-                }
+        if (direction == prb_StrDirection_FromEnd) {
+            for (int32_t i = 0; i < 256; ++i) {
+                charOffsets[i] *= -1;
+            }
+        }
+    }
+}
 
-                {
-                    int32_t from = 0;
-                    int32_t to = spec.pattern.len - 1;
-                    int32_t delta = 1;
-                    if (spec.direction == prb_StrDirection_FromEnd) {
-                        from = spec.pattern.len - 1;
-                        to = 0;
-                        delta = -1;
-                    }
+static int32_t
+prb_lib_findExactRaita(const uint8_t* str, int32_t strLen, const uint8_t* pat, int32_t patLen, prb_StrDirection direction, const int32_t* charOffsets) {
+    uint8_t patFirstCh = pat[0];
+    uint8_t patMiddleCh = pat[patLen / 2];
+    uint8_t patLastCh = pat[patLen - 1];
 
-                    int32_t count = 0;
-                    for (int32_t i = from; i != to; i += delta) {
-                        uint8_t patternChar = pat[i];
-                        charOffsets[patternChar] = spec.pattern.len - count++ - 1;
-                    }
+    int32_t off = 0;
+    if (direction == prb_StrDirection_FromEnd) {
+        off = strLen - patLen;
+    }
+
+    int32_t result = -1;
+    for (;;) {
+        bool notEnoughStrLeft = false;
+        switch (direction) {
+            case prb_StrDirection_FromStart: notEnoughStrLeft = off + patLen > strLen; break;
+            case prb_StrDirection_FromEnd: notEnoughStrLeft = off < 0; break;
+        }
+
+        if (notEnoughStrLeft) {
+            break;
+        }
+
+        uint8_t strFirstChar = str[off];
+        uint8_t strLastCh = str[off + patLen - 1];
+        if (patLastCh == strLastCh && patMiddleCh == str[off + patLen / 2] && patFirstCh == strFirstChar
+            && prb_memeq(pat + 1, str + off + 1, patLen - 2)) {
+            result = off;
+            break;
+        }
+
+        uint8_t relChar = strLastCh;
+        if (direction == prb_StrDirection_FromEnd) {
+            relChar = strFirstChar;
+        }
+        off += charOffsets[relChar];
+    }
+
+    return result;
+}
+
+// NOTE(khvorov) Checks offsets in [from, onePastTo) one by one
+static int32_t
+prb_lib_findExactScalar(const uint8_t* str, int32_t from, int32_t onePastTo, const uint8_t* pat, int32_t patLen, prb_StrDirection direction) {
+    int32_t result = -1;
+    uint8_t patFirstCh = pat[0];
+    uint8_t patLastCh = pat[patLen - 1];
+    for (int32_t index = 0; index < onePastTo - from && result == -1; index++) {
+        int32_t off = from + index;
+        if (direction == prb_StrDirection_FromEnd) {
+            off = onePastTo - 1 - index;
+        }
+        if (str[off] == patFirstCh && str[off + patLen - 1] == patLastCh && (patLen <= 2 || prb_memeq(str + off + 1, pat + 1, patLen - 2))) {
+            result = off;
+        }
+    }
+    return result;
+}
+
+static int32_t
+prb_lib_highestBit(uint64_t value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index = 0;
+    _BitScanReverse64(&index, value);
+    int32_t result = (int32_t)index;
+#else
+    int32_t result = 63 - __builtin_clzll(value);
+#endif
+    return result;
+}
+
+static int32_t
+prb_lib_lowestBit(uint64_t value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index = 0;
+    _BitScanForward64(&index, value);
+    int32_t result = (int32_t)index;
+#else
+    int32_t result = __builtin_ctzll(value);
+#endif
+    return result;
+}
+
+#if prb_SIMD_SSE2 || prb_SIMD_NEON
+
+// NOTE(khvorov) Every set lane in the mask is a position where both the first and the last byte of the pattern matched.
+// NEON has no movemask so its masks have 4 bits per lane.
+static int32_t
+prb_lib_checkCandidates(const uint8_t* str, int32_t blockOff, uint64_t mask, int32_t bitsPerLane, const uint8_t* pat, int32_t patLen, prb_StrDirection direction) {
+    int32_t  result = -1;
+    uint64_t laneBits = ((uint64_t)1 << bitsPerLane) - 1;
+    while (mask != 0 && result == -1) {
+        int32_t bit = direction == prb_StrDirection_FromStart ? prb_lib_lowestBit(mask) : prb_lib_highestBit(mask);
+        int32_t lane = bit / bitsPerLane;
+        int32_t off = blockOff + lane;
+        if (patLen <= 2 || prb_memeq(str + off + 1, pat + 1, patLen - 2)) {
+            result = off;
+        }
+        mask &= ~(laneBits << (lane * bitsPerLane));
+    }
+    return result;
+}
+
+// NOTE(khvorov) Blocks are laid out from the start or from the end depending on direction,
+// whatever offsets are left over on the other side are checked by the scalar loop
+static int32_t
+prb_lib_findExactTail(const uint8_t* str, int32_t strLen, int32_t blocksBytes, const uint8_t* pat, int32_t patLen, prb_StrDirection direction) {
+    int32_t offsetCount = strLen - patLen + 1;
+    int32_t result = -1;
+    switch (direction) {
+        case prb_StrDirection_FromStart: result = prb_lib_findExactScalar(str, blocksBytes, offsetCount, pat, patLen, direction); break;
+        case prb_StrDirection_FromEnd: result = prb_lib_findExactScalar(str, 0, offsetCount - blocksBytes, pat, patLen, direction); break;
+    }
+    return result;
+}
+
+#endif
+
+#if prb_SIMD_SSE2
+
+static int32_t
+prb_lib_findExactSse2(const uint8_t* str, int32_t strLen, const uint8_t* pat, int32_t patLen, prb_StrDirection direction) {
+    int32_t offsetCount = strLen - patLen + 1;
+    int32_t blockCount = offsetCount / 16;
+    __m128i patFirst = _mm_set1_epi8((char)pat[0]);
+    __m128i patLast = _mm_set1_epi8((char)pat[patLen - 1]);
+
+    int32_t result = -1;
+    for (int32_t blockIndex = 0; blockIndex < blockCount && result == -1; blockIndex++) {
+        int32_t off = blockIndex * 16;
+        if (direction == prb_StrDirection_FromEnd) {
+            off = offsetCount - (blockIndex + 1) * 16;
+        }
+        __m128i  strFirst = _mm_loadu_si128((const __m128i*)(str + off));
+        __m128i  strLast = _mm_loadu_si128((const __m128i*)(str + off + patLen - 1));
+        __m128i  eq = _mm_and_si128(_mm_cmpeq_epi8(strFirst, patFirst), _mm_cmpeq_epi8(strLast, patLast));
+        uint64_t mask = (uint32_t)_mm_movemask_epi8(eq);
+        if (mask != 0) {
+            result = prb_lib_checkCandidates(str, off, mask, 1, pat, patLen, direction);
+        }
+    }
+
+    if (result == -1) {
+        result = prb_lib_findExactTail(str, strLen, blockCount * 16, pat, patLen, direction);
+    }
+    return result;
+}
+
+#endif
+
+#if prb_SIMD_AVX2
+
+prb_AVX2_TARGET static int32_t
+prb_lib_findExactAvx2(const uint8_t* str, int32_t strLen, const uint8_t* pat, int32_t patLen, prb_StrDirection direction) {
+    int32_t offsetCount = strLen - patLen + 1;
+    int32_t blockCount = offsetCount / 32;
+    __m256i patFirst = _mm256_set1_epi8((char)pat[0]);
+    __m256i patLast = _mm256_set1_epi8((char)pat[patLen - 1]);
+
+    int32_t result = -1;
+    for (int32_t blockIndex = 0; blockIndex < blockCount && result == -1; blockIndex++) {
+        int32_t off = blockIndex * 32;
+        if (direction == prb_StrDirection_FromEnd) {
+            off = offsetCount - (blockIndex + 1) * 32;
+        }
+        __m256i  strFirst = _mm256_loadu_si256((const __m256i*)(str + off));
+        __m256i  strLast = _mm256_loadu_si256((const __m256i*)(str + off + patLen - 1));
+        __m256i  eq = _mm256_and_si256(_mm256_cmpeq_epi8(strFirst, patFirst), _mm256_cmpeq_epi8(strLast, patLast));
+        uint64_t mask = (uint32_t)_mm256_movemask_epi8(eq);
+        if (mask != 0) {
+            result = prb_lib_checkCandidates(str, off, mask, 1, pat, patLen, direction);
+        }
+    }
+
+    if (result == -1) {
+        result = prb_lib_findExactTail(str, strLen, blockCount * 32, pat, patLen, direction);
+    }
+    return result;
+}
+
+#endif
+
+#if prb_SIMD_NEON
+
+static int32_t
+prb_lib_findExactNeon(const uint8_t* str, int32_t strLen, const uint8_t* pat, int32_t patLen, prb_StrDirection direction) {
+    int32_t    offsetCount = strLen - patLen + 1;
+    int32_t    blockCount = offsetCount / 16;
+    uint8x16_t patFirst = vdupq_n_u8(pat[0]);
+    uint8x16_t patLast = vdupq_n_u8(pat[patLen - 1]);
+
+    int32_t result = -1;
+    for (int32_t blockIndex = 0; blockIndex < blockCount && result == -1; blockIndex++) {
+        int32_t off = blockIndex * 16;
+        if (direction == prb_StrDirection_FromEnd) {
+            off = offsetCount - (blockIndex + 1) * 16;
+        }
+        uint8x16_t strFirst = vld1q_u8(str + off);
+        uint8x16_t strLast = vld1q_u8(str + off + patLen - 1);
+        uint8x16_t eq = vandq_u8(vceqq_u8(strFirst, patFirst), vceqq_u8(strLast, patLast));
+        uint64_t   mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+        if (mask != 0) {
+            result = prb_lib_checkCandidates(str, off, mask, 4, pat, patLen, direction);
+        }
+    }
+
+    if (result == -1) {
+        result = prb_lib_findExactTail(str, strLen, blockCount * 16, pat, patLen, direction);
+    }
+    return result;
+}
+
+#endif
+
+static int32_t
+prb_lib_findExactVector(const uint8_t* str, int32_t strLen, const uint8_t* pat, int32_t patLen, prb_StrDirection direction) {
+#if prb_SIMD_AVX2
+    int32_t result = prb_avx2Supported() ? prb_lib_findExactAvx2(str, strLen, pat, patLen, direction) : prb_lib_findExactSse2(str, strLen, pat, patLen, direction);
+#elif prb_SIMD_SSE2
+    int32_t result = prb_lib_findExactSse2(str, strLen, pat, patLen, direction);
+#elif prb_SIMD_NEON
+    int32_t result = prb_lib_findExactNeon(str, strLen, pat, patLen, direction);
+#else
+    int32_t result = prb_lib_findExactScalar(str, 0, strLen - patLen + 1, pat, patLen, direction);
+#endif
+    return result;
+}
+
+// NOTE(khvorov) Long patterns let Raita skip far enough that the shift table pays for itself.
+// Without vectors it's worth it for anything but short strings.
+static bool
+prb_lib_useRaita(int32_t strLen, int32_t patLen) {
+#if prb_SIMD_SSE2 || prb_SIMD_NEON
+    prb_unused(strLen);
+    bool result = patLen > prb_RAITA_MIN_PATTERN_LEN;
+#else
+    bool result = patLen > 1 && strLen >= 256;
+#endif
+    return result;
+}
+
+static int32_t
+prb_lib_findByteSetScalar(const uint8_t* str, int32_t from, int32_t onePastTo, const uint32_t* byteSet, prb_StrDirection direction) {
+    int32_t result = -1;
+    for (int32_t index = 0; index < onePastTo - from && result == -1; index++) {
+        int32_t off = from + index;
+        if (direction == prb_StrDirection_FromEnd) {
+            off = onePastTo - 1 - index;
+        }
+        uint8_t byte = str[off];
+        if (byteSet[byte >> 5] & ((uint32_t)1 << (byte & 31))) {
+            result = off;
+        }
+    }
+    return result;
+}
+
+// NOTE(khvorov) Set membership for 16 or 32 bytes at once: the low nibble of every byte picks the set of
+// high nibbles that go with it, the high nibble picks its own bit (none for non-ascii) and the two are and-ed.
+// Whatever doesn't fill a whole vector is left to the scalar loop.
+
+#if prb_SIMD_SSSE3
+
+prb_SSSE3_TARGET static int32_t
+prb_lib_findByteSetSsse3(const uint8_t* str, int32_t strLen, prb_StrFinder* finder, prb_StrDirection direction) {
+    int32_t blockCount = strLen / 16;
+    __m128i lowTable = _mm_loadu_si128((const __m128i*)finder->lowNibbleSets);
+    __m128i highTable = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, (char)128, 0, 0, 0, 0, 0, 0, 0, 0);
+    __m128i nibble = _mm_set1_epi8(0x0F);
+
+    int32_t result = -1;
+    for (int32_t blockIndex = 0; blockIndex < blockCount && result == -1; blockIndex++) {
+        int32_t off = blockIndex * 16;
+        if (direction == prb_StrDirection_FromEnd) {
+            off = strLen - (blockIndex + 1) * 16;
+        }
+        __m128i  bytes = _mm_loadu_si128((const __m128i*)(str + off));
+        __m128i  lowBits = _mm_shuffle_epi8(lowTable, _mm_and_si128(bytes, nibble));
+        __m128i  highBits = _mm_shuffle_epi8(highTable, _mm_and_si128(_mm_srli_epi16(bytes, 4), nibble));
+        __m128i  miss = _mm_cmpeq_epi8(_mm_and_si128(lowBits, highBits), _mm_setzero_si128());
+        uint64_t mask = ~(uint32_t)_mm_movemask_epi8(miss) & 0xFFFF;
+        if (mask != 0) {
+            result = off + (direction == prb_StrDirection_FromStart ? prb_lib_lowestBit(mask) : prb_lib_highestBit(mask));
+        }
+    }
+
+    if (result == -1) {
+        switch (direction) {
+            case prb_StrDirection_FromStart: result = prb_lib_findByteSetScalar(str, blockCount * 16, strLen, finder->byteSet, direction); break;
+            case prb_StrDirection_FromEnd: result = prb_lib_findByteSetScalar(str, 0, strLen - blockCount * 16, finder->byteSet, direction); break;
+        }
+    }
+    return result;
+}
+
+#endif
+
+#if prb_SIMD_AVX2
+
+prb_AVX2_TARGET static int32_t
+prb_lib_findByteSetAvx2(const uint8_t* str, int32_t strLen, prb_StrFinder* finder, prb_StrDirection direction) {
+    int32_t blockCount = strLen / 32;
+    __m256i lowTable = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)finder->lowNibbleSets));
+    __m256i highTable = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, (char)128, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 4, 8, 16, 32, 64, (char)128, 0, 0, 0, 0, 0, 0, 0, 0);
+    __m256i nibble = _mm256_set1_epi8(0x0F);
+
+    int32_t result = -1;
+    for (int32_t blockIndex = 0; blockIndex < blockCount && result == -1; blockIndex++) {
+        int32_t off = blockIndex * 32;
+        if (direction == prb_StrDirection_FromEnd) {
+            off = strLen - (blockIndex + 1) * 32;
+        }
+        __m256i  bytes = _mm256_loadu_si256((const __m256i*)(str + off));
+        __m256i  lowBits = _mm256_shuffle_epi8(lowTable, _mm256_and_si256(bytes, nibble));
+        __m256i  highBits = _mm256_shuffle_epi8(highTable, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), nibble));
+        __m256i  miss = _mm256_cmpeq_epi8(_mm256_and_si256(lowBits, highBits), _mm256_setzero_si256());
+        uint64_t mask = ~(uint32_t)_mm256_movemask_epi8(miss) & 0xFFFFFFFF;
+        if (mask != 0) {
+            result = off + (direction == prb_StrDirection_FromStart ? prb_lib_lowestBit(mask) : prb_lib_highestBit(mask));
+        }
+    }
+
+    if (result == -1) {
+        switch (direction) {
+            case prb_StrDirection_FromStart: result = prb_lib_findByteSetScalar(str, blockCount * 32, strLen, finder->byteSet, direction); break;
+            case prb_StrDirection_FromEnd: result = prb_lib_findByteSetScalar(str, 0, strLen - blockCount * 32, finder->byteSet, direction); break;
+        }
+    }
+    return result;
+}
+
+#endif
+
+#if prb_SIMD_NEON
+
+static int32_t
+prb_lib_findByteSetNeon(const uint8_t* str, int32_t strLen, prb_StrFinder* finder, prb_StrDirection direction) {
+    int32_t       blockCount = strLen / 16;
+    uint8x16_t    lowTable = vld1q_u8(finder->lowNibbleSets);
+    const uint8_t highBytes[16] = {1, 2, 4, 8, 16, 32, 64, 128, 0, 0, 0, 0, 0, 0, 0, 0};
+    uint8x16_t    highTable = vld1q_u8(highBytes);
+    uint8x16_t    nibble = vdupq_n_u8(0x0F);
+
+    int32_t result = -1;
+    for (int32_t blockIndex = 0; blockIndex < blockCount && result == -1; blockIndex++) {
+        int32_t off = blockIndex * 16;
+        if (direction == prb_StrDirection_FromEnd) {
+            off = strLen - (blockIndex + 1) * 16;
+        }
+        uint8x16_t bytes = vld1q_u8(str + off);
+        uint8x16_t lowBits = vqtbl1q_u8(lowTable, vandq_u8(bytes, nibble));
+        uint8x16_t highBits = vqtbl1q_u8(highTable, vshrq_n_u8(bytes, 4));
+        uint8x16_t hit = vtstq_u8(lowBits, highBits);
+        uint64_t   mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hit), 4)), 0);
+        if (mask != 0) {
+            result = off + (direction == prb_StrDirection_FromStart ? prb_lib_lowestBit(mask) : prb_lib_highestBit(mask)) / 4;
+        }
+    }
+
+    if (result == -1) {
+        switch (direction) {
+            case prb_StrDirection_FromStart: result = prb_lib_findByteSetScalar(str, blockCount * 16, strLen, finder->byteSet, direction); break;
+            case prb_StrDirection_FromEnd: result = prb_lib_findByteSetScalar(str, 0, strLen - blockCount * 16, finder->byteSet, direction); break;
+        }
+    }
+    return result;
+}
+
+#endif
+
+static int32_t
+prb_lib_findByteSet(const uint8_t* str, int32_t strLen, prb_StrFinder* finder, prb_StrDirection direction) {
+    // NOTE(khvorov) Sets like whitespace match every few bytes, which the vector setup doesn't pay off for
+    int32_t prefixLen = prb_min(strLen, 16);
+    int32_t result = -1;
+    switch (direction) {
+        case prb_StrDirection_FromStart: result = prb_lib_findByteSetScalar(str, 0, prefixLen, finder->byteSet, direction); break;
+        case prb_StrDirection_FromEnd: result = prb_lib_findByteSetScalar(str, strLen - prefixLen, strLen, finder->byteSet, direction); break;
+    }
+
+    if (result == -1 && strLen > prefixLen) {
+        const uint8_t* rest = direction == prb_StrDirection_FromStart ? str + prefixLen : str;
+        int32_t        restLen = strLen - prefixLen;
+#if prb_SIMD_AVX2
+        if (prb_avx2Supported()) {
+            result = prb_lib_findByteSetAvx2(rest, restLen, finder, direction);
+        } else
+#endif
+#if prb_SIMD_SSSE3
+            if (prb_ssse3Supported()) {
+            result = prb_lib_findByteSetSsse3(rest, restLen, finder, direction);
+        } else
+#endif
+        {
+#if prb_SIMD_NEON
+            result = prb_lib_findByteSetNeon(rest, restLen, finder, direction);
+#else
+            result = prb_lib_findByteSetScalar(rest, 0, restLen, finder->byteSet, direction);
+#endif
+        }
+        if (result != -1 && direction == prb_StrDirection_FromStart) {
+            result += prefixLen;
+        }
+    }
+    return result;
+}
 
-                    if (spec.direction == prb_StrDirection_FromEnd) {
-                        for (int32_t i = 0; i < 256; ++i) {
-                            charOffsets[i] *= -1;
+static uint32_t
+prb_lib_codepointSlot(uint32_t codepoint) {
+    uint32_t result = (codepoint * 2654435761u) >> 26;
+    return result;
+}
+
+static bool
+prb_lib_codepointSetHas(prb_StrFinder* finder, uint32_t codepoint) {
+    bool     result = false;
+    uint32_t slot = prb_lib_codepointSlot(codepoint);
+    for (;;) {
+        uint32_t entry = finder->codepointSet[slot];
+        if (entry == codepoint || entry == 0) {
+            result = entry == codepoint;
+            break;
+        }
+        slot = (slot + 1) % prb_arrayCount(finder->codepointSet);
+    }
+    return result;
+}
+
+static void
+prb_lib_addToByteSet(prb_StrFinder* finder, uint8_t byte) {
+    finder->byteSet[byte >> 5] |= (uint32_t)1 << (byte & 31);
+    finder->lowNibbleSets[byte & 0x0F] |= (uint8_t)(1 << (byte >> 4));
+}
+
+// NOTE(khvorov) Only does the work the mode needs so that one-off prb_strFind calls stay cheap
+static void
+prb_lib_initStrFinder(prb_StrFinder* finder, prb_StrFindSpec spec) {
+    // NOTE(khvorov) An ascii byte is also a full utf8 character so searching for the byte is the same
+    if (spec.pattern.len == 1 && spec.mode == prb_StrFindMode_Exact && (uint8_t)spec.pattern.ptr[0] >= 0b10000000) {
+        spec.mode = prb_StrFindMode_AnyChar;
+    }
+
+    finder->spec = spec;
+    finder->raitaShiftsReady = false;
+    finder->patternIsAscii = false;
+
+    if (spec.mode == prb_StrFindMode_AnyChar) {
+        finder->patternIsAscii = true;
+        for (int32_t patIndex = 0; patIndex < spec.pattern.len && finder->patternIsAscii; patIndex++) {
+            finder->patternIsAscii = (uint8_t)spec.pattern.ptr[patIndex] < 0b10000000;
+        }
+
+        prb_memset(finder->byteSet, 0, sizeof(finder->byteSet));
+        if (finder->patternIsAscii) {
+            prb_memset(finder->lowNibbleSets, 0, sizeof(finder->lowNibbleSets));
+            for (int32_t patIndex = 0; patIndex < spec.pattern.len; patIndex++) {
+                prb_lib_addToByteSet(finder, (uint8_t)spec.pattern.ptr[patIndex]);
+            }
+        } else {
+            // NOTE(khvorov) Invalid utf8 in the pattern never matches, same as before there was a set
+            finder->codepointCount = 0;
+            prb_memset(finder->codepointSet, 0, sizeof(finder->codepointSet));
+            for (prb_Utf8CharIter patIter = prb_createUtf8CharIter(spec.pattern, prb_StrDirection_FromStart);
+                 prb_utf8CharIterNext(&patIter) == prb_Success && finder->codepointCount != -1;) {
+                if (patIter.curIsValid) {
+                    uint32_t ch = patIter.curUtf32Char;
+                    if (ch < 0b10000000) {
+                        finder->byteSet[ch >> 5] |= (uint32_t)1 << (ch & 31);
+                    } else if (!prb_lib_codepointSetHas(finder, ch)) {
+                        if (finder->codepointCount < prb_arrayCount(finder->codepointSet) / 2) {
+                            uint32_t slot = prb_lib_codepointSlot(ch);
+                            while (finder->codepointSet[slot] != 0) {
+                                slot = (slot + 1) % prb_arrayCount(finder->codepointSet);
+                            }
+                            finder->codepointSet[slot] = ch;
+                            finder->codepointCount += 1;
+                        } else {
+                            finder->codepointCount = -1;
                         }
                     }
                 }
+            }
+        }
+    }
 
-                uint8_t patFirstCh = pat[0];
-                uint8_t patMiddleCh = pat[spec.pattern.len / 2];
-                uint8_t patLastCh = pat[spec.pattern.len - 1];
+    if (spec.mode == prb_StrFindMode_LineBreak) {
+        prb_memset(finder->byteSet, 0, sizeof(finder->byteSet));
+        prb_memset(finder->lowNibbleSets, 0, sizeof(finder->lowNibbleSets));
+        prb_lib_addToByteSet(finder, '\n');
+        prb_lib_addToByteSet(finder, '\r');
+    }
+}
 
-                int32_t off = 0;
-                if (spec.direction == prb_StrDirection_FromEnd) {
-                    off = str.len - spec.pattern.len;
-                }
+prb_PUBLICDEF prb_StrFindResult
+prb_strFind(prb_Str str, prb_StrFindSpec spec) {
+    prb_StrFinder finder;
+    prb_lib_initStrFinder(&finder, spec);
+    prb_StrFindResult result = prb_strFinderFind(&finder, str);
+    return result;
+}
 
-                for (;;) {
-                    bool notEnoughStrLeft = false;
-                    switch (spec.direction) {
-                        case prb_StrDirection_FromStart: notEnoughStrLeft = off + spec.pattern.len > str.len; break;
-                        case prb_StrDirection_FromEnd: notEnoughStrLeft = off < 0; break;
-                    }
+prb_PUBLICDEF prb_StrFinder
+prb_createStrFinder(prb_StrFindSpec spec) {
+    prb_StrFinder result;
+    prb_memset(&result, 0, sizeof(result));
+    prb_lib_initStrFinder(&result, spec);
+    return result;
+}
 
-                    if (notEnoughStrLeft) {
-                        break;
-                    }
+prb_PUBLICDEF prb_StrFindResult
+prb_strFinderFind(prb_StrFinder* finder, prb_Str str) {
+    prb_StrFindResult result;
+    prb_memset(&result, 0, sizeof(result));
+    prb_StrFindSpec spec = finder->spec;
 
-                    uint8_t strFirstChar = bstr[off];
-                    uint8_t strLastCh = bstr[off + spec.pattern.len - 1];
-                    if (patLastCh == strLastCh && patMiddleCh == bstr[off + spec.pattern.len / 2] && patFirstCh == strFirstChar
-                        && prb_memeq(pat + 1, bstr + off + 1, spec.pattern.len - 2)) {
-                        result.found = true;
-                        result.beforeMatch = prb_strSlice(str, 0, off);
-                        result.match = prb_strSlice(str, off, off + spec.pattern.len);
-                        result.afterMatch = prb_strSlice(str, off + spec.pattern.len, str.len);
-                        break;
+    switch (spec.mode) {
+        case prb_StrFindMode_Exact: {
+            if (str.len >= spec.pattern.len && spec.pattern.len > 0) {
+                const uint8_t* bstr = (const uint8_t*)str.ptr;
+                const uint8_t* pat = (const uint8_t*)spec.pattern.ptr;
+
+                int32_t off = -1;
+                if (prb_lib_useRaita(str.len, spec.pattern.len)) {
+                    if (!finder->raitaShiftsReady) {
+                        prb_lib_buildRaitaShifts(pat, spec.pattern.len, spec.direction, finder->raitaShifts);
+                        finder->raitaShiftsReady = true;
                     }
+                    off = prb_lib_findExactRaita(bstr, str.len, pat, spec.pattern.len, spec.direction, finder->raitaShifts);
+                } else {
+                    off = prb_lib_findExactVector(bstr, str.len, pat, spec.pattern.len, spec.direction);
+                }
 
-                    uint8_t relChar = strLastCh;
-                    if (spec.direction == prb_StrDirection_FromEnd) {
-                        relChar = strFirstChar;
-                    }
-                    off += charOffsets[relChar];
+                if (off != -1) {
+                    result.found = true;
+                    result.beforeMatch = prb_strSlice(str, 0, off);
+                    result.match = prb_strSlice(str, off, off + spec.pattern.len);
+                    result.afterMatch = prb_strSlice(str, off + spec.pattern.len, str.len);
                 }
             }
         } break;
 
         case prb_StrFindMode_AnyChar: {
-            if (str.len > 0) {
+            if (str.len > 0 && finder->patternIsAscii) {
+                // NOTE(khvorov) Ascii bytes never show up inside multibyte utf8 characters
+                int32_t off = prb_lib_findByteSet((const uint8_t*)str.ptr, str.len, finder, spec.direction);
+                if (off != -1) {
+                    result.found = true;
+                    result.beforeMatch = prb_strSlice(str, 0, off);
+                    result.match = prb_strSlice(str, off, off + 1);
+                    result.afterMatch = prb_strSlice(str, off + 1, str.len);
+                }
+            } else if (str.len > 0 && finder->codepointCount != -1) {
+                for (prb_Utf8CharIter iter = prb_createUtf8CharIter(str, spec.direction);
+                     prb_utf8CharIterNext(&iter) == prb_Success && !result.found;) {
+                    if (iter.curIsValid) {
+                        uint32_t ch = iter.curUtf32Char;
+                        bool     inSet = ch < 0b10000000 ? (finder->byteSet[ch >> 5] & ((uint32_t)1 << (ch & 31))) != 0 : prb_lib_codepointSetHas(finder, ch);
+                        if (inSet) {
+                            result.found = true;
+                            result.beforeMatch = prb_strSlice(str, 0, iter.curByteOffset);
+                            result.match = prb_strSlice(str, iter.curByteOffset, iter.curByteOffset + iter.curUtf8Bytes);
+                            result.afterMatch = prb_strSlice(str, iter.curByteOffset + iter.curUtf8Bytes, str.len);
+                        }
+                    }
+                }
+            } else if (str.len > 0) {
                 for (prb_Utf8CharIter iter = prb_createUtf8CharIter(str, spec.direction);
                      prb_utf8CharIterNext(&iter) == prb_Success && !result.found;) {
                     if (iter.curIsValid) {
@@ -2152,23 +3704,10 @@ prb_strFind(prb_Str str, prb_StrFindSpec spec) {
 
         case prb_StrFindMode_LineBreak: {
             if (str.len > 0) {
-                int32_t start = 0;
-                int32_t onePastEnd = str.len;
-                int32_t delta = 1;
-                if (spec.direction == prb_StrDirection_FromEnd) {
-                    start = str.len - 1;
-                    onePastEnd = -1;
-                    delta = -1;
-                }
-
-                bool    found = false;
-                int32_t index = start;
-                for (; index != onePastEnd; index += delta) {
-                    char ch = str.ptr[index];
-                    if (ch == '\n' || ch == '\r') {
-                        found = true;
-                        break;
-                    }
+                int32_t index = prb_lib_findByteSet((const uint8_t*)str.ptr, str.len, finder, spec.direction);
+                bool    found = index != -1;
+                if (!found) {
+                    index = spec.direction == prb_StrDirection_FromStart ? str.len : -1;
                 }
 
                 int32_t lineEndLen = 0;
@@ -2231,57 +3770,445 @@ prb_stringsJoin(prb_Arena* arena, prb_Str* strings, int32_t stringsCount, prb_St
     prb_GrowingStr gstr = prb_beginStr(arena);
     for (int32_t strIndex = 0; strIndex < stringsCount; strIndex++) {
         prb_Str str = strings[strIndex];
-        prb_addStrSegment(&gstr, "%.*s", str.len, str.ptr);
+        prb_addStr(&gstr, str);
         if (strIndex < stringsCount - 1) {
-            prb_addStrSegment(&gstr, "%.*s", sep.len, sep.ptr);
+            prb_addStr(&gstr, sep);
         }
     }
     prb_Str result = prb_endStr(&gstr);
     return result;
 }
 
-prb_PUBLICDEF prb_GrowingStr
-prb_beginStr(prb_Arena* arena) {
-    prb_assert(!arena->lockedForStr);
-    arena->lockedForStr = true;
-    prb_Str        str = {(const char*)prb_arenaFreePtr(arena), 0};
-    prb_GrowingStr result = {arena, str};
+// NOTE(khvorov) One bit per byte of a 64-byte chunk for the bytes in a finder's ascii set
+static uint64_t
+prb_lib_byteSetMask64Scalar(const uint8_t* chunk, const uint32_t* byteSet) {
+    uint64_t result = 0;
+    for (int32_t index = 0; index < 64; index++) {
+        uint8_t byte = chunk[index];
+        if (byteSet[byte >> 5] & ((uint32_t)1 << (byte & 31))) {
+            result |= (uint64_t)1 << index;
+        }
+    }
     return result;
 }
 
-prb_PUBLICDEF void
-prb_addStrSegment(prb_GrowingStr* gstr, const char* fmt, ...) {
-    prb_assert(gstr->arena->lockedForStr);
-    va_list args;
-    va_start(args, fmt);
-    prb_Str seg = prb_vfmtCustomBuffer((uint8_t*)prb_arenaFreePtr(gstr->arena), (int32_t)prb_min(prb_arenaFreeSize(gstr->arena), INT32_MAX), fmt, args);
-    prb_arenaChangeUsed(gstr->arena, seg.len);
-    gstr->str.len += seg.len;
-    va_end(args);
+#if prb_SIMD_SSSE3
+
+prb_SSSE3_TARGET static uint64_t
+prb_lib_byteSetMask64Ssse3(const uint8_t* chunk, const uint8_t* lowNibbleSets) {
+    __m128i  lowTable = _mm_loadu_si128((const __m128i*)lowNibbleSets);
+    __m128i  highTable = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, (char)128, 0, 0, 0, 0, 0, 0, 0, 0);
+    __m128i  nibble = _mm_set1_epi8(0x0F);
+    uint64_t result = 0;
+    for (int32_t blockIndex = 0; blockIndex < 4; blockIndex++) {
+        __m128i  bytes = _mm_loadu_si128((const __m128i*)(chunk + blockIndex * 16));
+        __m128i  lowBits = _mm_shuffle_epi8(lowTable, _mm_and_si128(bytes, nibble));
+        __m128i  highBits = _mm_shuffle_epi8(highTable, _mm_and_si128(_mm_srli_epi16(bytes, 4), nibble));
+        __m128i  miss = _mm_cmpeq_epi8(_mm_and_si128(lowBits, highBits), _mm_setzero_si128());
+        uint64_t mask = ~(uint32_t)_mm_movemask_epi8(miss) & 0xFFFF;
+        result |= mask << (blockIndex * 16);
+    }
+    return result;
 }
 
-prb_PUBLICDEF prb_Str
-prb_endStr(prb_GrowingStr* gstr) {
-    prb_assert(gstr->arena->lockedForStr);
-    gstr->arena->lockedForStr = false;
-    prb_arenaAllocAndZero(gstr->arena, 1, 1);  // NOTE(khvorov) Null terminator
-    prb_Str result = gstr->str;
-    prb_memset(gstr, 0, sizeof(*gstr));
+#endif
+
+#if prb_SIMD_AVX2
+
+prb_AVX2_TARGET static uint64_t
+prb_lib_byteSetMask64Avx2(const uint8_t* chunk, const uint8_t* lowNibbleSets) {
+    __m256i  lowTable = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)lowNibbleSets));
+    __m256i  highTable = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, (char)128, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 4, 8, 16, 32, 64, (char)128, 0, 0, 0, 0, 0, 0, 0, 0);
+    __m256i  nibble = _mm256_set1_epi8(0x0F);
+    uint64_t result = 0;
+    for (int32_t blockIndex = 0; blockIndex < 2; blockIndex++) {
+        __m256i  bytes = _mm256_loadu_si256((const __m256i*)(chunk + blockIndex * 32));
+        __m256i  lowBits = _mm256_shuffle_epi8(lowTable, _mm256_and_si256(bytes, nibble));
+        __m256i  highBits = _mm256_shuffle_epi8(highTable, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), nibble));
+        __m256i  miss = _mm256_cmpeq_epi8(_mm256_and_si256(lowBits, highBits), _mm256_setzero_si256());
+        uint64_t mask = ~(uint32_t)_mm256_movemask_epi8(miss);
+        result |= mask << (blockIndex * 32);
+    }
     return result;
 }
 
-prb_PUBLICDEF prb_Str
-prb_vfmtCustomBuffer(void* buf, int32_t bufSize, const char* fmt, va_list args) {
-    int32_t len = prb_stbsp_vsnprintf((char*)buf, bufSize, fmt, args);
-    prb_Str result = {(const char*)buf, len};
+#endif
+
+#if prb_SIMD_NEON
+
+static uint64_t
+prb_lib_byteSetMask64Neon(const uint8_t* chunk, const uint8_t* lowNibbleSets) {
+    uint8x16_t    lowTable = vld1q_u8(lowNibbleSets);
+    const uint8_t highBytes[16] = {1, 2, 4, 8, 16, 32, 64, 128, 0, 0, 0, 0, 0, 0, 0, 0};
+    uint8x16_t    highTable = vld1q_u8(highBytes);
+    uint8x16_t    nibble = vdupq_n_u8(0x0F);
+    const uint8_t laneBitBytes[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t    laneBits = vld1q_u8(laneBitBytes);
+    uint64_t      result = 0;
+    for (int32_t blockIndex = 0; blockIndex < 4; blockIndex++) {
+        uint8x16_t bytes = vld1q_u8(chunk + blockIndex * 16);
+        uint8x16_t lowBits = vqtbl1q_u8(lowTable, vandq_u8(bytes, nibble));
+        uint8x16_t highBits = vqtbl1q_u8(highTable, vshrq_n_u8(bytes, 4));
+        uint8x16_t hitBits = vandq_u8(vtstq_u8(lowBits, highBits), laneBits);
+        uint64_t   mask = (uint64_t)vaddv_u8(vget_low_u8(hitBits)) | ((uint64_t)vaddv_u8(vget_high_u8(hitBits)) << 8);
+        result |= mask << (blockIndex * 16);
+    }
     return result;
 }
 
-prb_PUBLICDEF prb_Str
-prb_fmt(prb_Arena* arena, const char* fmt, ...) {
-    prb_assert(!arena->lockedForStr);
-    va_list args;
-    va_start(args, fmt);
+#endif
+
+static uint64_t
+prb_lib_byteSetMask64(const uint8_t* chunk, prb_StrFinder* finder) {
+    uint64_t result = 0;
+#if prb_SIMD_AVX2
+    if (prb_avx2Supported()) {
+        result = prb_lib_byteSetMask64Avx2(chunk, finder->lowNibbleSets);
+    } else
+#endif
+#if prb_SIMD_SSSE3
+        if (prb_ssse3Supported()) {
+        result = prb_lib_byteSetMask64Ssse3(chunk, finder->lowNibbleSets);
+    } else
+#endif
+    {
+#if prb_SIMD_NEON
+        result = prb_lib_byteSetMask64Neon(chunk, finder->lowNibbleSets);
+#else
+        result = prb_lib_byteSetMask64Scalar(chunk, finder->byteSet);
+#endif
+    }
+    return result;
+}
+
+static void
+prb_lib_addSplitToken(prb_StrSplitResult* result, intptr_t cap, prb_Str str, int32_t start, int32_t onePastEnd, uint32_t flags) {
+    if (onePastEnd > start || !(flags & prb_StrSplitFlag_SkipEmpty)) {
+        prb_assert(result->count < cap);
+        result->tokens[result->count++] = prb_strSlice(str, start, onePastEnd);
+    }
+}
+
+prb_PUBLICDEF prb_StrSplitResult
+prb_strSplit(prb_Arena* arena, prb_Str str, prb_Str delimSet, uint32_t flags) {
+    prb_assert(!arena->lockedForStr);
+    prb_arenaAlignFreePtr(arena, prb_alignof(prb_Str));
+
+    // NOTE(khvorov) Written straight into the arena's free space and checked per token, so the arena only
+    // needs room for the tokens there actually are
+    prb_StrSplitResult result = {.tokens = (prb_Str*)prb_arenaFreePtr(arena), .count = 0};
+    intptr_t           cap = prb_arenaFreeSize(arena) / (intptr_t)sizeof(prb_Str);
+
+    // NOTE(khvorov) Delimiters are single ascii bytes, which is what arguments, env and flag lists are split on
+    prb_StrFinder delims = {};
+    prb_StrFinder quotes = {};
+    for (int32_t delimIndex = 0; delimIndex < delimSet.len; delimIndex++) {
+        uint8_t delim = (uint8_t)delimSet.ptr[delimIndex];
+        prb_assert(delim < 0b10000000 && (delim != '"' || !(flags & prb_StrSplitFlag_RespectQuotes)));
+        prb_lib_addToByteSet(&delims, delim);
+    }
+    prb_lib_addToByteSet(&quotes, '"');
+
+    // NOTE(khvorov) Every chunk is turned into a delimiter bitmask in one go, tokens are read off its set bits
+    int32_t  tokenStart = 0;
+    uint64_t inQuotes = 0;
+    for (int32_t chunkStart = 0; chunkStart < str.len; chunkStart += 64) {
+        const uint8_t* chunk = (const uint8_t*)str.ptr + chunkStart;
+        int32_t        chunkLen = prb_min(str.len - chunkStart, 64);
+        uint8_t        padded[64];
+        uint64_t       inChunk = UINT64_MAX;
+        if (chunkLen < 64) {
+            prb_memset(padded, 0, sizeof(padded));
+            prb_memcpy(padded, chunk, (size_t)chunkLen);
+            chunk = padded;
+            inChunk = ((uint64_t)1 << chunkLen) - 1;
+        }
+
+        uint64_t delimMask = prb_lib_byteSetMask64(chunk, &delims) & inChunk;
+        if (flags & prb_StrSplitFlag_RespectQuotes) {
+            // NOTE(khvorov) Prefix xor of the quote bits sets everything from an opening quote up to the closing one
+            uint64_t quoted = prb_lib_byteSetMask64(chunk, &quotes) & inChunk;
+            for (int32_t shift = 1; shift < 64; shift *= 2) {
+                quoted ^= quoted << shift;
+            }
+            quoted ^= inQuotes;
+            delimMask &= ~quoted;
+            inQuotes = (uint64_t)0 - (quoted >> 63);
+        }
+
+        for (; delimMask != 0; delimMask &= delimMask - 1) {
+            int32_t delimAt = chunkStart + prb_lib_lowestBit(delimMask);
+            prb_lib_addSplitToken(&result, cap, str, tokenStart, delimAt, flags);
+            tokenStart = delimAt + 1;
+        }
+    }
+    prb_lib_addSplitToken(&result, cap, str, tokenStart, str.len, flags);
+
+    prb_arenaChangeUsed(arena, (intptr_t)result.count * (intptr_t)sizeof(prb_Str));
+    return result;
+}
+
+prb_PUBLICDEF prb_GrowingStr
+prb_beginStr(prb_Arena* arena) {
+    prb_assert(!arena->lockedForStr);
+    arena->lockedForStr = true;
+    prb_Str        str = {(const char*)prb_arenaFreePtr(arena), 0};
+    prb_GrowingStr result = {.arena = arena, .str = str, .chunked = false, .firstChunk = 0, .lastChunk = 0};
+    return result;
+}
+
+prb_PUBLICDEF prb_GrowingStr
+prb_beginChunkedStr(prb_Arena* arena) {
+    prb_GrowingStr result = {.arena = arena, .str = {0, 0}, .chunked = true, .firstChunk = 0, .lastChunk = 0};
+    return result;
+}
+
+// NOTE(khvorov) Room that can be written to without allocating
+static prb_Str
+prb_lib_growingStrRoom(prb_GrowingStr* gstr) {
+    prb_Str result = {0, 0};
+    if (!gstr->chunked) {
+        prb_assert(gstr->arena->lockedForStr);
+        result.ptr = (const char*)prb_arenaFreePtr(gstr->arena);
+        result.len = (int32_t)prb_min(prb_arenaFreeSize(gstr->arena), INT32_MAX);
+    } else if (gstr->lastChunk) {
+        result.ptr = gstr->lastChunk->str.ptr + gstr->lastChunk->str.len;
+        result.len = gstr->lastChunk->cap - gstr->lastChunk->str.len;
+    }
+    return result;
+}
+
+static char*
+prb_lib_growingStrReserve(prb_GrowingStr* gstr, int32_t len) {
+    prb_Str room = prb_lib_growingStrRoom(gstr);
+    if (room.len < len) {
+        prb_assert(gstr->chunked && !gstr->arena->lockedForStr);
+        prb_StrChunk* last = gstr->lastChunk;
+        if (last && last->str.ptr + last->cap == prb_arenaFreePtr(gstr->arena) && prb_arenaFreeSize(gstr->arena) >= len - room.len) {
+            // NOTE(khvorov) Nothing was allocated since the last chunk so it can just grow
+            prb_arenaChangeUsed(gstr->arena, len - room.len);
+            last->cap += len - room.len;
+        } else {
+            // NOTE(khvorov) Chunks double up to a limit so that long strings don't need many of them
+            int32_t cap = prb_max(len, prb_clamp(last ? last->cap * 2 : 0, 256, 64 * prb_KILOBYTE));
+            prb_arenaAlignFreePtr(gstr->arena, prb_alignof(prb_StrChunk));
+            prb_StrChunk* chunk = (prb_StrChunk*)prb_arenaFreePtr(gstr->arena);
+            prb_arenaChangeUsed(gstr->arena, (intptr_t)sizeof(prb_StrChunk) + cap);
+            chunk->next = 0;
+            chunk->str.ptr = (const char*)(chunk + 1);
+            chunk->str.len = 0;
+            chunk->cap = cap;
+            if (last) {
+                last->next = chunk;
+            } else {
+                gstr->firstChunk = chunk;
+            }
+            gstr->lastChunk = chunk;
+        }
+        room = prb_lib_growingStrRoom(gstr);
+    }
+    prb_assert(room.len >= len);
+    char* result = (char*)room.ptr;
+    return result;
+}
+
+static void
+prb_lib_growingStrCommit(prb_GrowingStr* gstr, int32_t len) {
+    // NOTE(khvorov) An empty append to a fresh chunked string doesn't reserve a chunk
+    if (len > 0) {
+        if (gstr->chunked) {
+            gstr->lastChunk->str.len += len;
+        } else {
+            prb_arenaChangeUsed(gstr->arena, len);
+        }
+        gstr->str.len += len;
+    }
+}
+
+prb_PUBLICDEF void
+prb_addStrSegment(prb_GrowingStr* gstr, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    va_list argsCopy;
+    va_copy(argsCopy, args);
+
+    // NOTE(khvorov) The formatter wants room for a null terminator and reports the full length when it doesn't get it
+    prb_Str room = prb_lib_growingStrRoom(gstr);
+    int32_t len = prb_stbsp_vsnprintf(room.len > 0 ? (char*)room.ptr : 0, room.len, fmt, args);
+    if (len + 1 > room.len) {
+        char* dest = prb_lib_growingStrReserve(gstr, len + 1);
+        prb_stbsp_vsnprintf(dest, len + 1, fmt, argsCopy);
+    }
+    prb_lib_growingStrCommit(gstr, len);
+
+    va_end(argsCopy);
+    va_end(args);
+}
+
+// NOTE(khvorov) The typed appenders below write straight into the string without going through the format interpreter
+
+prb_PUBLICDEF void
+prb_addStr(prb_GrowingStr* gstr, prb_Str str) {
+    // NOTE(khvorov) Empty strings can have null pointers and so can a fresh chunked string
+    if (str.len > 0) {
+        char* dest = prb_lib_growingStrReserve(gstr, str.len);
+        prb_memcpy(dest, str.ptr, str.len);
+        prb_lib_growingStrCommit(gstr, str.len);
+    }
+}
+
+prb_PUBLICDEF void
+prb_addChar(prb_GrowingStr* gstr, char ch) {
+    char* dest = prb_lib_growingStrReserve(gstr, 1);
+    dest[0] = ch;
+    prb_lib_growingStrCommit(gstr, 1);
+}
+
+static const char prb_lib_digitPairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// NOTE(khvorov) Writes digits from the end of the buffer, returns where they start
+static int32_t
+prb_lib_writeDigits(char* buf, int32_t bufLen, uint64_t value, int32_t base, int32_t minDigits) {
+    prb_assert(base >= 2 && base <= 16);
+    int32_t at = bufLen;
+    if (base == 10) {
+        while (value >= 100) {
+            uint64_t pair = value % 100;
+            value /= 100;
+            at -= 2;
+            prb_memcpy(buf + at, prb_lib_digitPairs + pair * 2, 2);
+        }
+        if (value >= 10) {
+            at -= 2;
+            prb_memcpy(buf + at, prb_lib_digitPairs + value * 2, 2);
+        } else {
+            buf[--at] = (char)('0' + value);
+        }
+    } else if ((base & (base - 1)) == 0) {
+        int32_t  shift = prb_lib_highestBit((uint32_t)base);
+        uint64_t mask = (uint64_t)base - 1;
+        do {
+            buf[--at] = "0123456789ABCDEF"[value & mask];
+            value >>= shift;
+        } while (value > 0);
+    } else {
+        do {
+            buf[--at] = "0123456789ABCDEF"[value % (uint64_t)base];
+            value /= (uint64_t)base;
+        } while (value > 0);
+    }
+    int32_t minStart = bufLen - prb_clamp(minDigits, 0, bufLen);
+    while (at > minStart) {
+        buf[--at] = '0';
+    }
+    return at;
+}
+
+prb_PUBLICDEF void
+prb_addU64(prb_GrowingStr* gstr, uint64_t value, int32_t base, int32_t minDigits) {
+    char    buf[64];
+    int32_t start = prb_lib_writeDigits(buf, prb_arrayCount(buf), value, base, minDigits);
+    // NOTE(khvorov) The buffer fits any number in any base, padding past it goes in front
+    for (int32_t padded = prb_arrayCount(buf); padded < minDigits; padded++) {
+        prb_addChar(gstr, '0');
+    }
+    prb_Str digits = {buf + start, prb_arrayCount(buf) - start};
+    prb_addStr(gstr, digits);
+}
+
+prb_PUBLICDEF void
+prb_addI64(prb_GrowingStr* gstr, int64_t value, int32_t base, int32_t minDigits) {
+    uint64_t magnitude = (uint64_t)value;
+    if (value < 0) {
+        prb_addChar(gstr, '-');
+        magnitude = ~magnitude + 1;
+    }
+    prb_addU64(gstr, magnitude, base, minDigits);
+}
+
+prb_PUBLICDEF void
+prb_addHex(prb_GrowingStr* gstr, uint64_t value) {
+    prb_addStr(gstr, prb_STR("0x"));
+    prb_addU64(gstr, value, 16, 0);
+}
+
+prb_PUBLICDEF void
+prb_addF64(prb_GrowingStr* gstr, double value, int32_t decimals) {
+    prb_assert(decimals >= 0);
+    uint64_t bits = 0;
+    prb_memcpy(&bits, &value, sizeof(bits));
+    bool   negative = (bits >> 63) != 0;
+    double magnitude = negative ? -value : value;
+
+    // NOTE(khvorov) Scaling by a power of ten is exact enough when the result is well below 2^53, otherwise
+    // (and when the fraction is too close to a half to round by) the format interpreter deals with it
+    static const double powersOfTen[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9};
+    bool                handled = false;
+    if (decimals < prb_arrayCount(powersOfTen) && magnitude < 1e12 / powersOfTen[decimals]) {
+        double   scaled = magnitude * powersOfTen[decimals];
+        uint64_t whole = (uint64_t)scaled;
+        double   fraction = scaled - (double)whole;
+        if (fraction < 0.499 || fraction > 0.501) {
+            whole += fraction > 0.5;
+            uint64_t powerOfTen = (uint64_t)powersOfTen[decimals];
+            if (negative) {
+                prb_addChar(gstr, '-');
+            }
+            prb_addU64(gstr, whole / powerOfTen, 10, 1);
+            if (decimals > 0) {
+                prb_addChar(gstr, '.');
+                prb_addU64(gstr, whole % powerOfTen, 10, decimals);
+            }
+            handled = true;
+        }
+    }
+    if (!handled) {
+        prb_addStrSegment(gstr, "%.*f", decimals, value);
+    }
+}
+
+prb_PUBLICDEF prb_Str
+prb_endStr(prb_GrowingStr* gstr) {
+    prb_Str result = gstr->str;
+    if (!gstr->chunked) {
+        prb_assert(gstr->arena->lockedForStr);
+        gstr->arena->lockedForStr = false;
+        prb_arenaAllocAndZero(gstr->arena, 1, 1);  // NOTE(khvorov) Null terminator
+    } else if (gstr->firstChunk && gstr->firstChunk == gstr->lastChunk && gstr->firstChunk->str.len < gstr->firstChunk->cap) {
+        // NOTE(khvorov) Already contiguous
+        char* nullTerminator = (char*)gstr->firstChunk->str.ptr + gstr->firstChunk->str.len;
+        nullTerminator[0] = '\0';
+        result.ptr = gstr->firstChunk->str.ptr;
+    } else {
+        prb_assert(!gstr->arena->lockedForStr);
+        char* dest = (char*)prb_arenaFreePtr(gstr->arena);
+        prb_arenaChangeUsed(gstr->arena, (intptr_t)result.len + 1);
+        result.ptr = dest;
+        for (prb_StrChunk* chunk = gstr->firstChunk; chunk; chunk = chunk->next) {
+            prb_memcpy(dest, chunk->str.ptr, (size_t)chunk->str.len);
+            dest += chunk->str.len;
+        }
+        dest[0] = '\0';
+    }
+    prb_memset(gstr, 0, sizeof(*gstr));
+    return result;
+}
+
+prb_PUBLICDEF prb_Str
+prb_vfmtCustomBuffer(void* buf, int32_t bufSize, const char* fmt, va_list args) {
+    int32_t len = prb_stbsp_vsnprintf((char*)buf, bufSize, fmt, args);
+    prb_Str result = {(const char*)buf, len};
+    return result;
+}
+
+prb_PUBLICDEF prb_Str
+prb_fmt(prb_Arena* arena, const char* fmt, ...) {
+    prb_assert(!arena->lockedForStr);
+    va_list args;
+    va_start(args, fmt);
     prb_Str result = prb_vfmtCustomBuffer(prb_arenaFreePtr(arena), (int32_t)prb_min(prb_arenaFreeSize(arena), INT32_MAX), fmt, args);
     prb_arenaChangeUsed(arena, result.len);
     prb_arenaAllocAndZero(arena, 1, 1);  // NOTE(khvorov) Null terminator
@@ -2472,812 +4399,5445 @@ prb_utf8CharIterNext(prb_Utf8CharIter* iter) {
     return result;
 }
 
-prb_PUBLICDEF prb_StrScanner
-prb_createStrScanner(prb_Str str) {
-    prb_assert(str.ptr && str.len >= 0);
-    prb_Str nullSlice = prb_strSlice(str, 0, 0);
-    prb_StrScanner iter = {
-        .ogstr = str,
-        .beforeMatch = nullSlice,
-        .match = nullSlice,
-        .afterMatch = str,
-        .matchCount = 0,
-        .betweenLastMatches = nullSlice,
-    };
-    iter.match.len = 0;
-    return iter;
-}
-
-prb_PUBLICDEF prb_Status
-prb_strScannerMove(prb_StrScanner* scanner, prb_StrFindSpec spec, prb_StrScannerSide side) {
-    prb_Status result = prb_Failure;
-
-    prb_Str search = scanner->afterMatch;
-    if (side == prb_StrScannerSide_BeforeMatch) {
-        search = scanner->beforeMatch;
-    }
-
-    prb_StrFindResult find = prb_strFind(search, spec);
-    if (find.found) {
-        scanner->betweenLastMatches = find.beforeMatch;
-        if (side == prb_StrScannerSide_BeforeMatch) {
-            scanner->betweenLastMatches = find.afterMatch;
+// NOTE(khvorov) Strict utf8: no overlong encodings, no surrogates, nothing past U+10FFFF.
+// Returns how many bytes the character at the start of str takes, 0 if it isn't valid.
+static int32_t
+prb_lib_utf8Decode(const uint8_t* str, int32_t len, uint32_t* codepoint) {
+    int32_t result = 0;
+    uint8_t lead = str[0];
+    if (lead < 0x80) {
+        *codepoint = lead;
+        result = 1;
+    } else {
+        int32_t  seqLen = 0;
+        uint32_t min = 0;
+        if (lead >= 0xC2 && lead < 0xE0) {
+            seqLen = 2;
+            min = 0x80;
+        } else if (lead >= 0xE0 && lead < 0xF0) {
+            seqLen = 3;
+            min = 0x800;
+        } else if (lead >= 0xF0 && lead < 0xF5) {
+            seqLen = 4;
+            min = 0x10000;
         }
 
-        scanner->match = find.match;
-        scanner->matchCount += 1;
-
-        scanner->beforeMatch = (prb_Str) {scanner->ogstr.ptr, (int32_t)(scanner->match.ptr - scanner->ogstr.ptr)};
-        const char* afterStart = scanner->match.ptr + scanner->match.len;
-        scanner->afterMatch = (prb_Str) {afterStart, (int32_t)((scanner->ogstr.ptr + scanner->ogstr.len) - afterStart)};
-
-        result = prb_Success;
+        if (seqLen > 0 && seqLen <= len) {
+            uint32_t ch = lead & (0x7F >> seqLen);
+            bool     contsValid = true;
+            for (int32_t byteIndex = 1; byteIndex < seqLen && contsValid; byteIndex++) {
+                contsValid = (str[byteIndex] & 0xC0) == 0x80;
+                ch = (ch << 6) | (str[byteIndex] & 0x3F);
+            }
+            if (contsValid && ch >= min && ch <= 0x10FFFF && (ch < 0xD800 || ch > 0xDFFF)) {
+                *codepoint = ch;
+                result = seqLen;
+            }
+        }
     }
-
     return result;
 }
 
-prb_PUBLICDEF prb_ParseUintResult
-prb_parseUint(prb_Str digits, uint64_t base) {
-    prb_assert(base == 16 || base == 10);
-    prb_ParseUintResult result = {.success = false, .number = 0};
-    if (digits.len > 0) {
-        result.success = true;
-        for (int32_t digitsIndex = 0; digitsIndex < digits.len && result.success; digitsIndex++) {
-            uint64_t value = 0;
-            char     ch = digits.ptr[digitsIndex];
-            if (ch >= '0' && ch <= '9') {
-                value = (uint64_t)(ch - '0');
-            } else if (base == 16 && ch >= 'A' && ch <= 'F') {
-                value = (uint64_t)(ch - 'A' + 10);
-            } else if (base == 16 && ch >= 'a' && ch <= 'f') {
-                value = (uint64_t)(ch - 'a' + 10);
-            } else {
-                result.success = false;
-            }
-            result.number = result.number * base + value;
-        }
+static int32_t
+prb_lib_utf8Encode(uint32_t ch, uint8_t* out) {
+    int32_t result = 0;
+    if (ch < 0x80) {
+        out[0] = (uint8_t)ch;
+        result = 1;
+    } else if (ch < 0x800) {
+        out[0] = (uint8_t)(0xC0 | (ch >> 6));
+        out[1] = (uint8_t)(0x80 | (ch & 0x3F));
+        result = 2;
+    } else if (ch < 0x10000) {
+        out[0] = (uint8_t)(0xE0 | (ch >> 12));
+        out[1] = (uint8_t)(0x80 | ((ch >> 6) & 0x3F));
+        out[2] = (uint8_t)(0x80 | (ch & 0x3F));
+        result = 3;
+    } else {
+        out[0] = (uint8_t)(0xF0 | (ch >> 18));
+        out[1] = (uint8_t)(0x80 | ((ch >> 12) & 0x3F));
+        out[2] = (uint8_t)(0x80 | ((ch >> 6) & 0x3F));
+        out[3] = (uint8_t)(0x80 | (ch & 0x3F));
+        result = 4;
     }
     return result;
 }
 
-prb_PUBLICDEF prb_ParsedNumber
-prb_parseNumber(prb_Str str) {
-    prb_ParsedNumber number;
-    prb_memset(&number, 0, sizeof(number));
+// NOTE(khvorov) Block validation from "Validating UTF-8 In Less Than One Instruction Per Byte" (Keiser, Lemire).
+// Every byte is classified by the high nibble of the byte before it, the low nibble of the byte before it and
+// its own high nibble, and the three lookups are and-ed together. What's left is an error unless it's two
+// continuation bytes that a 3 or 4 byte lead two or three bytes back asks for.
 
-    bool leadingMinus = false;
-    if (str.len > 0) {
-        leadingMinus = str.ptr[0] == '-';
-        if (leadingMinus) {
-            str = prb_strSlice(str, 1, str.len);
-        }
-    }
+#if prb_SIMD_SSSE3 || prb_SIMD_AVX2 || prb_SIMD_NEON
 
-    prb_ParseUintResult intParse = {.success = false, .number = 0};
-    bool                isReal = false;
-    double              realValue = 0.0;
-    if (str.len > 0) {
-        // NOTE(khvorov) Hex integer
-        if (prb_strStartsWith(str, prb_STR("0x"))) {
-            prb_Str digits = prb_strSlice(str, 2, str.len);
-            intParse = prb_parseUint(digits, 16);
-        } else {
-            prb_StrFindSpec dotFindSpec = {
-                .mode = prb_StrFindMode_AnyChar,
-                .direction = prb_StrDirection_FromStart,
-                .pattern = prb_STR("."),
-                .alwaysMatchEnd = false,
-            };
-            prb_StrFindResult dotFind = prb_strFind(str, dotFindSpec);
-            if (dotFind.found) {
-                // NOTE(khvorov) Real number
-                prb_ParseUintResult leftOfDot = {.success = false, .number = 0};
-                if (dotFind.beforeMatch.len == 0) {
-                    leftOfDot.success = true;
-                } else {
-                    leftOfDot = prb_parseUint(dotFind.beforeMatch, 10);
-                }
+enum {
+    prb_lib_Utf8Err_TooShort = 1 << 0,
+    prb_lib_Utf8Err_TooLong = 1 << 1,
+    prb_lib_Utf8Err_Overlong3 = 1 << 2,
+    prb_lib_Utf8Err_TooLarge = 1 << 3,
+    prb_lib_Utf8Err_Surrogate = 1 << 4,
+    prb_lib_Utf8Err_Overlong2 = 1 << 5,
+    prb_lib_Utf8Err_TooLarge1000 = 1 << 6,
+    prb_lib_Utf8Err_Overlong4 = 1 << 6,
+    prb_lib_Utf8Err_TwoConts = 1 << 7,
+    prb_lib_Utf8Err_Carry = prb_lib_Utf8Err_TooShort | prb_lib_Utf8Err_TooLong | prb_lib_Utf8Err_TwoConts,
+};
 
-                if (leftOfDot.success) {
-                    realValue = (double)leftOfDot.number;
+static const uint8_t prb_lib_utf8Byte1High[16] = {
+    prb_lib_Utf8Err_TooLong,
+    prb_lib_Utf8Err_TooLong,
+    prb_lib_Utf8Err_TooLong,
+    prb_lib_Utf8Err_TooLong,
+    prb_lib_Utf8Err_TooLong,
+    prb_lib_Utf8Err_TooLong,
+    prb_lib_Utf8Err_TooLong,
+    prb_lib_Utf8Err_TooLong,
+    prb_lib_Utf8Err_TwoConts,
+    prb_lib_Utf8Err_TwoConts,
+    prb_lib_Utf8Err_TwoConts,
+    prb_lib_Utf8Err_TwoConts,
+    prb_lib_Utf8Err_TooShort | prb_lib_Utf8Err_Overlong2,
+    prb_lib_Utf8Err_TooShort,
+    prb_lib_Utf8Err_TooShort | prb_lib_Utf8Err_Overlong3 | prb_lib_Utf8Err_Surrogate,
+    prb_lib_Utf8Err_TooShort | prb_lib_Utf8Err_TooLarge | prb_lib_Utf8Err_TooLarge1000 | prb_lib_Utf8Err_Overlong4,
+};
 
-                    prb_ParseUintResult rightOfDot = {.success = false, .number = 0};
-                    if (dotFind.afterMatch.len == 0) {
-                        rightOfDot.success = true;
-                    } else {
-                        rightOfDot = prb_parseUint(dotFind.afterMatch, 10);
-                    }
+static const uint8_t prb_lib_utf8Byte1Low[16] = {
+    prb_lib_Utf8Err_Carry | prb_lib_Utf8Err_Overlong3 | prb_lib_Utf8Err_Overlong2 | prb_lib_Utf8Err_Overlong4,
+    prb_lib_Utf8Err_Carry | prb_lib_Utf8Err_Overlong2,
+    prb_lib_Utf8Err_Carry,
+    prb_lib_Utf8Err_Carry,
+    prb_lib_Utf8Err_Carry | prb_lib_Utf8Err_TooLarge,
+    prb_lib_Utf8Err_Carry | prb_lib_Utf8Err_TooLarge | prb_lib_Utf8Err_TooLarge1000,
+    prb_lib_Utf8Err_Carry | prb_lib_Utf8Err_TooLarge | prb_lib_Utf8Err_TooLarge1000,
+    prb_lib_Utf8Err_Carry | prb_lib_Utf8Err_TooLarge | prb_lib_Utf8Err_TooLarge1000,
+    prb_lib_Utf8Err_Carry | prb_lib_Utf8Err_TooLarge | prb_lib_Utf8Err_TooLarge1000,
+    prb_lib_Utf8Err_Carry | prb_lib_Utf8Err_TooLarge | prb_lib_Utf8Err_TooLarge1000,
+    prb_lib_Utf8Err_Carry | prb_lib_Utf8Err_TooLarge | prb_lib_Utf8Err_TooLarge1000,
+    prb_lib_Utf8Err_Carry | prb_lib_Utf8Err_TooLarge | prb_lib_Utf8Err_TooLarge1000,
+    prb_lib_Utf8Err_Carry | prb_lib_Utf8Err_TooLarge | prb_lib_Utf8Err_TooLarge1000,
+    prb_lib_Utf8Err_Carry | prb_lib_Utf8Err_TooLarge | prb_lib_Utf8Err_TooLarge1000 | prb_lib_Utf8Err_Surrogate,
+    prb_lib_Utf8Err_Carry | prb_lib_Utf8Err_TooLarge | prb_lib_Utf8Err_TooLarge1000,
+    prb_lib_Utf8Err_Carry | prb_lib_Utf8Err_TooLarge | prb_lib_Utf8Err_TooLarge1000,
+};
 
-                    if (rightOfDot.success) {
-                        isReal = true;
-                        int32_t  digitsLeft = dotFind.afterMatch.len - 1;
-                        uint64_t divisor = 10;
-                        while (digitsLeft > 0) {
-                            divisor *= 10;
-                            digitsLeft -= 1;
-                        }
-                        double fraction = (double)rightOfDot.number / (double)divisor;
-                        realValue += fraction;
-                    }
-                }
-            } else {
-                // NOTE(khvorov) Decimal integer
-                intParse = prb_parseUint(str, 10);
-            }
+static const uint8_t prb_lib_utf8Byte2High[16] = {
+    prb_lib_Utf8Err_TooShort,
+    prb_lib_Utf8Err_TooShort,
+    prb_lib_Utf8Err_TooShort,
+    prb_lib_Utf8Err_TooShort,
+    prb_lib_Utf8Err_TooShort,
+    prb_lib_Utf8Err_TooShort,
+    prb_lib_Utf8Err_TooShort,
+    prb_lib_Utf8Err_TooShort,
+    prb_lib_Utf8Err_TooLong | prb_lib_Utf8Err_Overlong2 | prb_lib_Utf8Err_TwoConts | prb_lib_Utf8Err_Overlong3 | prb_lib_Utf8Err_TooLarge1000 | prb_lib_Utf8Err_Overlong4,
+    prb_lib_Utf8Err_TooLong | prb_lib_Utf8Err_Overlong2 | prb_lib_Utf8Err_TwoConts | prb_lib_Utf8Err_Overlong3 | prb_lib_Utf8Err_TooLarge,
+    prb_lib_Utf8Err_TooLong | prb_lib_Utf8Err_Overlong2 | prb_lib_Utf8Err_TwoConts | prb_lib_Utf8Err_Surrogate | prb_lib_Utf8Err_TooLarge,
+    prb_lib_Utf8Err_TooLong | prb_lib_Utf8Err_Overlong2 | prb_lib_Utf8Err_TwoConts | prb_lib_Utf8Err_Surrogate | prb_lib_Utf8Err_TooLarge,
+    prb_lib_Utf8Err_TooShort,
+    prb_lib_Utf8Err_TooShort,
+    prb_lib_Utf8Err_TooShort,
+    prb_lib_Utf8Err_TooShort,
+};
+
+// NOTE(khvorov) Anything at or above these in the last 3 bytes of a block needs bytes from the next one
+static const uint8_t prb_lib_utf8IncompleteMax[16] = {255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1};
+
+#endif
+
+// NOTE(khvorov) The kernels return how many bytes from the start they checked, stopping
+// at the first block with an error in it so that the scalar loop can find where exactly it is
+
+#if prb_SIMD_SSSE3
+
+prb_SSSE3_TARGET static int32_t
+prb_lib_utf8ValidBlocksSsse3(const uint8_t* str, int32_t len) {
+    __m128i byte1High = _mm_loadu_si128((const __m128i*)prb_lib_utf8Byte1High);
+    __m128i byte1Low = _mm_loadu_si128((const __m128i*)prb_lib_utf8Byte1Low);
+    __m128i byte2High = _mm_loadu_si128((const __m128i*)prb_lib_utf8Byte2High);
+    __m128i incompleteMax = _mm_loadu_si128((const __m128i*)prb_lib_utf8IncompleteMax);
+    __m128i nibble = _mm_set1_epi8(0x0F);
+    __m128i zero = _mm_setzero_si128();
+
+    __m128i prev = zero;
+    __m128i prevIncomplete = zero;
+    int32_t blockCount = len / 16;
+    int32_t blockIndex = 0;
+    for (; blockIndex < blockCount; blockIndex++) {
+        __m128i input = _mm_loadu_si128((const __m128i*)(str + blockIndex * 16));
+        __m128i error = prevIncomplete;
+        if (_mm_movemask_epi8(input) != 0) {
+            __m128i prev1 = _mm_alignr_epi8(input, prev, 15);
+            __m128i prev2 = _mm_alignr_epi8(input, prev, 14);
+            __m128i prev3 = _mm_alignr_epi8(input, prev, 13);
+            __m128i special = _mm_and_si128(
+                _mm_and_si128(
+                    _mm_shuffle_epi8(byte1High, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+                    _mm_shuffle_epi8(byte1Low, _mm_and_si128(prev1, nibble))
+                ),
+                _mm_shuffle_epi8(byte2High, _mm_and_si128(_mm_srli_epi16(input, 4), nibble))
+            );
+            __m128i mustBeCont = _mm_or_si128(_mm_subs_epu8(prev2, _mm_set1_epi8(0xE0 - 0x80)), _mm_subs_epu8(prev3, _mm_set1_epi8(0xF0 - 0x80)));
+            error = _mm_xor_si128(_mm_and_si128(mustBeCont, _mm_set1_epi8((char)0x80)), special);
+            prevIncomplete = _mm_subs_epu8(input, incompleteMax);
+        } else {
+            prevIncomplete = zero;
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(error, zero)) != 0xFFFF) {
+            break;
         }
+        prev = input;
     }
+    return blockIndex * 16;
+}
 
-    if (intParse.success) {
-        if (leadingMinus) {
-            // NOTE(khvorov) Won't be supporting parsing INT64_MIN for fear of undefined behaviour
-            if (intParse.number <= (((uint64_t)INT64_MAX))) {
-                number.kind = prb_ParsedNumberKind_I64;
-                number.parsedI64 = -((int64_t)intParse.number);
-            }
+#endif
+
+#if prb_SIMD_AVX2
+
+prb_AVX2_TARGET static int32_t
+prb_lib_utf8ValidBlocksAvx2(const uint8_t* str, int32_t len) {
+    __m256i byte1High = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)prb_lib_utf8Byte1High));
+    __m256i byte1Low = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)prb_lib_utf8Byte1Low));
+    __m256i byte2High = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)prb_lib_utf8Byte2High));
+    __m256i incompleteMax = _mm256_setr_m128i(_mm_set1_epi8((char)255), _mm_loadu_si128((const __m128i*)prb_lib_utf8IncompleteMax));
+    __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i zero = _mm256_setzero_si256();
+
+    __m256i prev = zero;
+    __m256i prevIncomplete = zero;
+    int32_t blockCount = len / 32;
+    int32_t blockIndex = 0;
+    for (; blockIndex < blockCount; blockIndex++) {
+        __m256i input = _mm256_loadu_si256((const __m256i*)(str + blockIndex * 32));
+        __m256i error = prevIncomplete;
+        if (_mm256_movemask_epi8(input) != 0) {
+            // NOTE(khvorov) alignr works within 128-bit lanes so the lane boundary comes from a permute
+            __m256i prevHigh = _mm256_permute2x128_si256(prev, input, 0x21);
+            __m256i prev1 = _mm256_alignr_epi8(input, prevHigh, 15);
+            __m256i prev2 = _mm256_alignr_epi8(input, prevHigh, 14);
+            __m256i prev3 = _mm256_alignr_epi8(input, prevHigh, 13);
+            __m256i special = _mm256_and_si256(
+                _mm256_and_si256(
+                    _mm256_shuffle_epi8(byte1High, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+                    _mm256_shuffle_epi8(byte1Low, _mm256_and_si256(prev1, nibble))
+                ),
+                _mm256_shuffle_epi8(byte2High, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble))
+            );
+            __m256i mustBeCont = _mm256_or_si256(_mm256_subs_epu8(prev2, _mm256_set1_epi8(0xE0 - 0x80)), _mm256_subs_epu8(prev3, _mm256_set1_epi8(0xF0 - 0x80)));
+            error = _mm256_xor_si256(_mm256_and_si256(mustBeCont, _mm256_set1_epi8((char)0x80)), special);
+            prevIncomplete = _mm256_subs_epu8(input, incompleteMax);
         } else {
-            number.kind = prb_ParsedNumberKind_U64;
-            number.parsedU64 = intParse.number;
+            prevIncomplete = zero;
         }
-    } else if (isReal) {
-        number.kind = prb_ParsedNumberKind_F64;
-        number.parsedF64 = realValue;
-        if (leadingMinus) {
-            number.parsedF64 *= -1.0;
+        if ((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(error, zero)) != 0xFFFFFFFF) {
+            break;
         }
+        prev = input;
     }
-
-    return number;
+    return blockIndex * 32;
 }
 
-prb_PUBLICDEF prb_Str
-prb_binaryToCArray(prb_Arena* arena, prb_Str arrayName, void* data, int32_t dataLen) {
-    prb_GrowingStr arrayGstr = prb_beginStr(arena);
-    prb_addStrSegment(&arrayGstr, "unsigned char %.*s[] = {\n    ", prb_LIT(arrayName));
-    for (int32_t byteIndex = 0; byteIndex < dataLen; byteIndex++) {
-        uint8_t byte = ((uint8_t*)data)[byteIndex];
-        prb_addStrSegment(&arrayGstr, "0x%x", byte);
-        if (byteIndex != dataLen - 1) {
-            prb_addStrSegment(&arrayGstr, ",");
-            if ((byteIndex + 1) % 10 == 0) {
-                prb_addStrSegment(&arrayGstr, "\n    ");
-            } else {
-                prb_addStrSegment(&arrayGstr, " ");
-            }
+#endif
+
+#if prb_SIMD_NEON
+
+static int32_t
+prb_lib_utf8ValidBlocksNeon(const uint8_t* str, int32_t len) {
+    uint8x16_t byte1High = vld1q_u8(prb_lib_utf8Byte1High);
+    uint8x16_t byte1Low = vld1q_u8(prb_lib_utf8Byte1Low);
+    uint8x16_t byte2High = vld1q_u8(prb_lib_utf8Byte2High);
+    uint8x16_t incompleteMax = vld1q_u8(prb_lib_utf8IncompleteMax);
+    uint8x16_t nibble = vdupq_n_u8(0x0F);
+
+    uint8x16_t prev = vdupq_n_u8(0);
+    uint8x16_t prevIncomplete = vdupq_n_u8(0);
+    int32_t    blockCount = len / 16;
+    int32_t    blockIndex = 0;
+    for (; blockIndex < blockCount; blockIndex++) {
+        uint8x16_t input = vld1q_u8(str + blockIndex * 16);
+        uint8x16_t error = prevIncomplete;
+        if (vmaxvq_u8(input) >= 0x80) {
+            uint8x16_t prev1 = vextq_u8(prev, input, 15);
+            uint8x16_t prev2 = vextq_u8(prev, input, 14);
+            uint8x16_t prev3 = vextq_u8(prev, input, 13);
+            uint8x16_t special = vandq_u8(
+                vandq_u8(vqtbl1q_u8(byte1High, vshrq_n_u8(prev1, 4)), vqtbl1q_u8(byte1Low, vandq_u8(prev1, nibble))),
+                vqtbl1q_u8(byte2High, vshrq_n_u8(input, 4))
+            );
+            uint8x16_t mustBeCont = vorrq_u8(vqsubq_u8(prev2, vdupq_n_u8(0xE0 - 0x80)), vqsubq_u8(prev3, vdupq_n_u8(0xF0 - 0x80)));
+            error = veorq_u8(vandq_u8(mustBeCont, vdupq_n_u8(0x80)), special);
+            prevIncomplete = vqsubq_u8(input, incompleteMax);
         } else {
-            prb_addStrSegment(&arrayGstr, "\n");
+            prevIncomplete = vdupq_n_u8(0);
         }
+        if (vmaxvq_u8(error) != 0) {
+            break;
+        }
+        prev = input;
     }
-    prb_addStrSegment(&arrayGstr, "};");
-    prb_Str arrayStr = prb_endStr(&arrayGstr);
-    return arrayStr;
+    return blockIndex * 16;
 }
 
-//
-// SECTION Processes (implementation)
-//
+#endif
 
-#if prb_PLATFORM_WINDOWS
+static int32_t
+prb_lib_utf8ValidBlocks(const uint8_t* str, int32_t len) {
+    int32_t result = 0;
+#if prb_SIMD_AVX2
+    if (prb_avx2Supported()) {
+        result = prb_lib_utf8ValidBlocksAvx2(str, len);
+    } else
+#endif
+#if prb_SIMD_SSSE3
+        if (prb_ssse3Supported()) {
+        result = prb_lib_utf8ValidBlocksSsse3(str, len);
+    } else
+#endif
+    {
+#if prb_SIMD_NEON
+        result = prb_lib_utf8ValidBlocksNeon(str, len);
+#else
+        prb_unused(str);
+        prb_unused(len);
+#endif
+    }
 
-static void
-prb_windows_waitForProcess(prb_Process* handle) {
-    WaitForSingleObject(handle->processInfo.hProcess, INFINITE);
-    handle->status = prb_ProcessStatus_CompletedFailed;
-    DWORD exitCode = 0;
-    if (GetExitCodeProcess(handle->processInfo.hProcess, &exitCode)) {
-        if (exitCode == 0) {
-            handle->status = prb_ProcessStatus_CompletedSuccess;
+    // NOTE(khvorov) The blocks may end in the middle of a character, go back to where it starts
+    // (a lead byte at most 3 bytes back whose sequence isn't over yet)
+    int32_t blocksEnd = result;
+    for (int32_t back = 1; back <= 3 && blocksEnd - back >= 0; back++) {
+        uint8_t byte = str[blocksEnd - back];
+        if (byte < 0x80) {
+            break;
+        }
+        if (byte >= 0xC0) {
+            result = blocksEnd - back;
+            break;
         }
     }
-    CloseHandle(handle->processInfo.hProcess);
-    CloseHandle(handle->processInfo.hThread);
+    return result;
 }
 
-typedef struct prb_windows_GetAffinityResult {
-    bool      success;
-    DWORD_PTR affinity;
-    int32_t   setBits;
-} prb_windows_GetAffinityResult;
+// NOTE(khvorov) How many leading bytes are ascii, checked 16 at a time
+static int32_t
+prb_lib_asciiPrefixLen(const uint8_t* str, int32_t len) {
+    int32_t result = 0;
+#if prb_SIMD_SSE2
+    while (result + 16 <= len && _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(str + result))) == 0) {
+        result += 16;
+    }
+#elif prb_SIMD_NEON
+    while (result + 16 <= len && vmaxvq_u8(vld1q_u8(str + result)) < 0x80) {
+        result += 16;
+    }
+#endif
+    while (result < len && str[result] < 0x80) {
+        result += 1;
+    }
+    return result;
+}
 
-static prb_windows_GetAffinityResult
-prb_windows_getAffinity(void) {
-    prb_windows_GetAffinityResult result = {.success = false, .affinity = 0, .setBits = 0};
-    HANDLE                        thisProc = GetCurrentProcess();
-    DWORD_PTR                     procAffinity = 0;
-    DWORD_PTR                     sysAffinity = 0;
-    if (GetProcessAffinityMask(thisProc, &procAffinity, &sysAffinity)) {
-        result.success = true;
-        result.affinity = procAffinity;
-        for (size_t bitIndex = 0; bitIndex < sizeof(DWORD_PTR) * 8; bitIndex++) {
-            DWORD_PTR mask = 1ULL << bitIndex;
-            result.setBits += (result.affinity & mask) != 0;
+prb_PUBLICDEF prb_Utf8ValidateResult
+prb_utf8Validate(prb_Str str) {
+    const uint8_t* bytes = (const uint8_t*)str.ptr;
+    int32_t        at = prb_lib_utf8ValidBlocks(bytes, str.len);
+    bool           valid = true;
+    while (at < str.len && valid) {
+        uint32_t ch = 0;
+        int32_t  chBytes = prb_lib_utf8Decode(bytes + at, str.len - at, &ch);
+        if (chBytes == 0) {
+            valid = false;
+        } else {
+            at += chBytes;
         }
     }
+    prb_Utf8ValidateResult result = {.valid = valid, .errorOffset = at};
     return result;
 }
 
-#elif prb_PLATFORM_LINUX
+prb_PUBLICDEF prb_Utf32Result
+prb_utf8ToUtf32(prb_Arena* arena, prb_Str str) {
+    prb_assert(!arena->lockedForStr);
+    prb_arenaAlignFreePtr(arena, prb_alignof(uint32_t));
+    prb_assert(prb_arenaFreeSize(arena) >= ((intptr_t)str.len + 1) * (intptr_t)sizeof(uint32_t));
+    uint32_t*      out = (uint32_t*)prb_arenaFreePtr(arena);
+    const uint8_t* bytes = (const uint8_t*)str.ptr;
+
+    int32_t at = 0;
+    int32_t outLen = 0;
+    bool    valid = true;
+    while (at < str.len && valid) {
+        int32_t asciiLen = prb_lib_asciiPrefixLen(bytes + at, str.len - at);
+        int32_t asciiIndex = 0;
+#if prb_SIMD_SSE2
+        for (; asciiIndex + 16 <= asciiLen; asciiIndex += 16) {
+            __m128i chars = _mm_loadu_si128((const __m128i*)(bytes + at + asciiIndex));
+            __m128i low = _mm_unpacklo_epi8(chars, _mm_setzero_si128());
+            __m128i high = _mm_unpackhi_epi8(chars, _mm_setzero_si128());
+            _mm_storeu_si128((__m128i*)(out + outLen + asciiIndex), _mm_unpacklo_epi16(low, _mm_setzero_si128()));
+            _mm_storeu_si128((__m128i*)(out + outLen + asciiIndex + 4), _mm_unpackhi_epi16(low, _mm_setzero_si128()));
+            _mm_storeu_si128((__m128i*)(out + outLen + asciiIndex + 8), _mm_unpacklo_epi16(high, _mm_setzero_si128()));
+            _mm_storeu_si128((__m128i*)(out + outLen + asciiIndex + 12), _mm_unpackhi_epi16(high, _mm_setzero_si128()));
+        }
+#elif prb_SIMD_NEON
+        for (; asciiIndex + 16 <= asciiLen; asciiIndex += 16) {
+            uint8x16_t chars = vld1q_u8(bytes + at + asciiIndex);
+            uint16x8_t low = vmovl_u8(vget_low_u8(chars));
+            uint16x8_t high = vmovl_u8(vget_high_u8(chars));
+            vst1q_u32(out + outLen + asciiIndex, vmovl_u16(vget_low_u16(low)));
+            vst1q_u32(out + outLen + asciiIndex + 4, vmovl_u16(vget_high_u16(low)));
+            vst1q_u32(out + outLen + asciiIndex + 8, vmovl_u16(vget_low_u16(high)));
+            vst1q_u32(out + outLen + asciiIndex + 12, vmovl_u16(vget_high_u16(high)));
+        }
+#endif
+        for (; asciiIndex < asciiLen; asciiIndex++) {
+            out[outLen + asciiIndex] = bytes[at + asciiIndex];
+        }
+        at += asciiLen;
+        outLen += asciiLen;
+
+        // NOTE(khvorov) Non-ascii runs one character at a time until the next ascii byte
+        while (at < str.len && bytes[at] >= 0x80 && valid) {
+            int32_t chBytes = prb_lib_utf8Decode(bytes + at, str.len - at, out + outLen);
+            if (chBytes == 0) {
+                valid = false;
+            } else {
+                at += chBytes;
+                outLen += 1;
+            }
+        }
+    }
+    out[outLen] = 0;
+    prb_arenaChangeUsed(arena, ((intptr_t)outLen + 1) * (intptr_t)sizeof(uint32_t));
 
-static prb_Bytes
-prb_linux_readFromProc(prb_Arena* arena, prb_Str filename) {
-    prb_linux_OpenResult handle = prb_linux_open(arena, prb_fmt(arena, "/proc/%.*s", prb_LIT(filename)), O_RDONLY, 0);
-    prb_assert(handle.success);
-    prb_Bytes content = prb_linux_readFromHandle(arena, handle.handle);
-    prb_assert(content.len > 0);
-    close(handle.handle);
-    return content;
+    prb_Utf32Result result = {.valid = valid, .errorOffset = at, .str = {out, outLen}};
+    return result;
 }
 
-static void
-prb_linux_waitForProcess(prb_Process* handle) {
-    int32_t status = 0;
-    pid_t waitResult = waitpid(handle->pid, &status, 0);
-    handle->status = prb_ProcessStatus_CompletedFailed;
-    if (waitResult == handle->pid && status == 0) {
-        handle->status = prb_ProcessStatus_CompletedSuccess;
+prb_PUBLICDEF prb_Utf8Result
+prb_utf32ToUtf8(prb_Arena* arena, prb_Utf32Str str) {
+    prb_assert(!arena->lockedForStr);
+    prb_assert(prb_arenaFreeSize(arena) >= (intptr_t)str.len * 4 + 1);
+    uint8_t* out = (uint8_t*)prb_arenaFreePtr(arena);
+
+    int32_t at = 0;
+    int32_t outLen = 0;
+    bool    valid = true;
+    while (at < str.len && valid) {
+#if prb_SIMD_SSE2
+        // NOTE(khvorov) 16 ascii characters at a time, packing can't overflow when every value is under 0x80
+        while (at + 16 <= str.len) {
+            __m128i c0 = _mm_loadu_si128((const __m128i*)(str.ptr + at));
+            __m128i c1 = _mm_loadu_si128((const __m128i*)(str.ptr + at + 4));
+            __m128i c2 = _mm_loadu_si128((const __m128i*)(str.ptr + at + 8));
+            __m128i c3 = _mm_loadu_si128((const __m128i*)(str.ptr + at + 12));
+            __m128i all = _mm_or_si128(_mm_or_si128(c0, c1), _mm_or_si128(c2, c3));
+            __m128i nonAscii = _mm_and_si128(all, _mm_set1_epi32(~0x7F));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(nonAscii, _mm_setzero_si128())) != 0xFFFF) {
+                break;
+            }
+            __m128i packed = _mm_packus_epi16(_mm_packs_epi32(c0, c1), _mm_packs_epi32(c2, c3));
+            _mm_storeu_si128((__m128i*)(out + outLen), packed);
+            at += 16;
+            outLen += 16;
+        }
+#endif
+        if (at < str.len) {
+            uint32_t ch = str.ptr[at];
+            if (ch > 0x10FFFF || (ch >= 0xD800 && ch <= 0xDFFF)) {
+                valid = false;
+            } else {
+                outLen += prb_lib_utf8Encode(ch, out + outLen);
+                at += 1;
+            }
+        }
     }
-}
+    out[outLen] = 0;
+    prb_arenaChangeUsed(arena, outLen + 1);
 
-typedef struct prb_linux_GetAffinityResult {
-    bool success;
-    uint8_t* affinity;
-    int32_t size;
-    int32_t setBits;
-} prb_linux_GetAffinityResult;
+    prb_Utf8Result result = {.valid = valid, .errorOffset = at, .str = {(const char*)out, outLen}};
+    return result;
+}
 
-static prb_linux_GetAffinityResult
-prb_linux_getAffinity(prb_Arena* arena) {
-    // NOTE(khvorov) The syscall is picky about alignment and can't handle buffers that are too big.
-    // I don't know how big is too big but a megabyte is apparently not too big.
-    prb_linux_GetAffinityResult result = {};
-    int32_t reqAlign = prb_alignof(unsigned long);
-    prb_arenaAlignFreePtr(arena, reqAlign);
-    result.affinity = (uint8_t*)prb_arenaFreePtr(arena);
-    int32_t arenaSize = (int32_t)prb_min(prb_arenaFreeSize(arena), INT32_MAX);
-    int32_t arenaSizeAligned = arenaSize & (~(reqAlign - 1));
-    int32_t sizeReduced = prb_min(arenaSizeAligned, prb_MEGABYTE);
-    result.size = syscall(SYS_sched_getaffinity, 0, sizeReduced, result.affinity);
-    if (result.size > 0) {
-        result.success = true;
-        for (int32_t byteIndex = 0; byteIndex < result.size; byteIndex++) {
-            uint8_t byte = ((uint8_t*)result.affinity)[byteIndex];
-            for (int32_t bitIndex = 0; bitIndex < 8; bitIndex++) {
-                uint8_t mask = 1 << bitIndex;
-                result.setBits += (byte & mask) != 0;
+prb_PUBLICDEF prb_Utf16Result
+prb_utf8ToUtf16(prb_Arena* arena, prb_Str str) {
+    prb_assert(!arena->lockedForStr);
+    prb_arenaAlignFreePtr(arena, prb_alignof(uint16_t));
+    prb_assert(prb_arenaFreeSize(arena) >= ((intptr_t)str.len + 1) * (intptr_t)sizeof(uint16_t));
+    uint16_t*      out = (uint16_t*)prb_arenaFreePtr(arena);
+    const uint8_t* bytes = (const uint8_t*)str.ptr;
+
+    int32_t at = 0;
+    int32_t outLen = 0;
+    bool    valid = true;
+    while (at < str.len && valid) {
+        int32_t asciiLen = prb_lib_asciiPrefixLen(bytes + at, str.len - at);
+        int32_t asciiIndex = 0;
+#if prb_SIMD_SSE2
+        for (; asciiIndex + 16 <= asciiLen; asciiIndex += 16) {
+            __m128i chars = _mm_loadu_si128((const __m128i*)(bytes + at + asciiIndex));
+            _mm_storeu_si128((__m128i*)(out + outLen + asciiIndex), _mm_unpacklo_epi8(chars, _mm_setzero_si128()));
+            _mm_storeu_si128((__m128i*)(out + outLen + asciiIndex + 8), _mm_unpackhi_epi8(chars, _mm_setzero_si128()));
+        }
+#elif prb_SIMD_NEON
+        for (; asciiIndex + 16 <= asciiLen; asciiIndex += 16) {
+            uint8x16_t chars = vld1q_u8(bytes + at + asciiIndex);
+            vst1q_u16(out + outLen + asciiIndex, vmovl_u8(vget_low_u8(chars)));
+            vst1q_u16(out + outLen + asciiIndex + 8, vmovl_u8(vget_high_u8(chars)));
+        }
+#endif
+        for (; asciiIndex < asciiLen; asciiIndex++) {
+            out[outLen + asciiIndex] = bytes[at + asciiIndex];
+        }
+        at += asciiLen;
+        outLen += asciiLen;
+
+        while (at < str.len && bytes[at] >= 0x80 && valid) {
+            uint32_t ch = 0;
+            int32_t  chBytes = prb_lib_utf8Decode(bytes + at, str.len - at, &ch);
+            if (chBytes == 0) {
+                valid = false;
+            } else {
+                // NOTE(khvorov) Surrogate pairs take 4 utf8 bytes so the output never outgrows the input
+                if (ch >= 0x10000) {
+                    ch -= 0x10000;
+                    out[outLen++] = (uint16_t)(0xD800 | (ch >> 10));
+                    out[outLen++] = (uint16_t)(0xDC00 | (ch & 0x3FF));
+                } else {
+                    out[outLen++] = (uint16_t)ch;
+                }
+                at += chBytes;
             }
         }
     }
+    out[outLen] = 0;
+    prb_arenaChangeUsed(arena, ((intptr_t)outLen + 1) * (intptr_t)sizeof(uint16_t));
+
+    prb_Utf16Result result = {.valid = valid, .errorOffset = at, .str = {out, outLen}};
     return result;
 }
 
+prb_PUBLICDEF prb_Utf8Result
+prb_utf16ToUtf8(prb_Arena* arena, prb_Utf16Str str) {
+    prb_assert(!arena->lockedForStr);
+    prb_assert(prb_arenaFreeSize(arena) >= (intptr_t)str.len * 3 + 1);
+    uint8_t* out = (uint8_t*)prb_arenaFreePtr(arena);
+
+    int32_t at = 0;
+    int32_t outLen = 0;
+    bool    valid = true;
+    while (at < str.len && valid) {
+#if prb_SIMD_SSE2
+        while (at + 16 <= str.len) {
+            __m128i c0 = _mm_loadu_si128((const __m128i*)(str.ptr + at));
+            __m128i c1 = _mm_loadu_si128((const __m128i*)(str.ptr + at + 8));
+            __m128i nonAscii = _mm_and_si128(_mm_or_si128(c0, c1), _mm_set1_epi16(~0x7F));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(nonAscii, _mm_setzero_si128())) != 0xFFFF) {
+                break;
+            }
+            _mm_storeu_si128((__m128i*)(out + outLen), _mm_packus_epi16(c0, c1));
+            at += 16;
+            outLen += 16;
+        }
 #endif
+        if (at < str.len) {
+            uint32_t ch = str.ptr[at];
+            int32_t  units = 1;
+            if (ch >= 0xD800 && ch <= 0xDBFF && at + 1 < str.len && str.ptr[at + 1] >= 0xDC00 && str.ptr[at + 1] <= 0xDFFF) {
+                ch = 0x10000 + ((ch - 0xD800) << 10) + (str.ptr[at + 1] - 0xDC00);
+                units = 2;
+            }
+            if (ch >= 0xD800 && ch <= 0xDFFF) {
+                valid = false;
+            } else {
+                outLen += prb_lib_utf8Encode(ch, out + outLen);
+                at += units;
+            }
+        }
+    }
+    out[outLen] = 0;
+    prb_arenaChangeUsed(arena, outLen + 1);
 
-prb_PUBLICDEF void
-prb_terminate(int32_t code) {
-#if prb_PLATFORM_WINDOWS
-    ExitProcess((UINT)code);
-#elif prb_PLATFORM_LINUX
-    exit(code);
-#else
-#error unimplemented
-#endif
+    prb_Utf8Result result = {.valid = valid, .errorOffset = at, .str = {(const char*)out, outLen}};
+    return result;
 }
 
-prb_PUBLICDEF prb_Str
-prb_getCmdline(prb_Arena* arena) {
-    prb_Str result = {.ptr = 0, .len = 0};
+prb_PUBLICDEF prb_StrScanner
+prb_createStrScanner(prb_Str str) {
+    prb_assert(str.ptr && str.len >= 0);
+    prb_Str nullSlice = prb_strSlice(str, 0, 0);
+    prb_StrScanner iter = {
+        .ogstr = str,
+        .beforeMatch = nullSlice,
+        .match = nullSlice,
+        .afterMatch = str,
+        .matchCount = 0,
+        .betweenLastMatches = nullSlice,
+    };
+    iter.match.len = 0;
+    return iter;
+}
 
-#if prb_PLATFORM_WINDOWS
+prb_PUBLICDEF prb_Status
+prb_strScannerMove(prb_StrScanner* scanner, prb_StrFindSpec spec, prb_StrScannerSide side) {
+    prb_StrFinder finder;
+    prb_lib_initStrFinder(&finder, spec);
+    prb_Status result = prb_strScannerMoveWith(scanner, &finder, side);
+    return result;
+}
 
-    LPWSTR  wstr = GetCommandLineW();
-    int32_t len = 0;
-    while (wstr[len]) {
-        len += 1;
-    }
-    result = prb_windows_strFromWideStr(arena, (prb_windows_WideStr) {wstr, len});
+prb_PUBLICDEF prb_Status
+prb_strScannerMoveWith(prb_StrScanner* scanner, prb_StrFinder* finder, prb_StrScannerSide side) {
+    prb_Status result = prb_Failure;
 
-#elif prb_PLATFORM_LINUX
+    prb_Str search = scanner->afterMatch;
+    if (side == prb_StrScannerSide_BeforeMatch) {
+        search = scanner->beforeMatch;
+    }
 
-    prb_Bytes procSelfContent = prb_linux_readFromProc(arena, prb_STR("self/cmdline"));
-    for (int32_t byteIndex = 0; byteIndex < procSelfContent.len - 1; byteIndex++) {
-        if (procSelfContent.data[byteIndex] == '\0') {
-            procSelfContent.data[byteIndex] = ' ';
+    prb_StrFindResult find = prb_strFinderFind(finder, search);
+    if (find.found) {
+        scanner->betweenLastMatches = find.beforeMatch;
+        if (side == prb_StrScannerSide_BeforeMatch) {
+            scanner->betweenLastMatches = find.afterMatch;
         }
-    }
 
-    result = (prb_Str) {(const char*)procSelfContent.data, procSelfContent.len - 1};
+        scanner->match = find.match;
+        scanner->matchCount += 1;
 
-#elif
-#error unimplemented
-#endif
+        scanner->beforeMatch = (prb_Str) {scanner->ogstr.ptr, (int32_t)(scanner->match.ptr - scanner->ogstr.ptr)};
+        const char* afterStart = scanner->match.ptr + scanner->match.len;
+        scanner->afterMatch = (prb_Str) {afterStart, (int32_t)((scanner->ogstr.ptr + scanner->ogstr.len) - afterStart)};
+
+        result = prb_Success;
+    }
 
     return result;
 }
 
-prb_PUBLICDEF prb_Str*
-prb_getCmdArgs(prb_Arena* arena) {
-    prb_Str* result = 0;
+// NOTE(khvorov) Line starts are written straight into the arena's free space and committed at the end,
+// so the whole index is one array no matter how many lines there turn out to be
+typedef struct prb_lib_LineStarts {
+    const uint8_t* str;
+    int32_t        strLen;
+    int32_t*       starts;
+    int32_t        count;
+    intptr_t       cap;
+} prb_lib_LineStarts;
 
-#if prb_PLATFORM_WINDOWS
+static void
+prb_lib_addLineBreak(prb_lib_LineStarts* lines, int32_t pos) {
+    bool isCrOfCrlf = lines->str[pos] == '\r' && pos + 1 < lines->strLen && lines->str[pos + 1] == '\n';
+    if (!isCrOfCrlf && pos + 1 < lines->strLen) {
+        prb_assert(lines->count < lines->cap);
+        lines->starts[lines->count++] = pos + 1;
+    }
+}
 
-    prb_Str         str = prb_getCmdline(arena);
-    prb_StrFindSpec spec = {
-        .mode = prb_StrFindMode_AnyChar,
-        .direction = prb_StrDirection_FromStart,
-        .pattern = prb_STR(" "),
-        .alwaysMatchEnd = true,
-    };
-    prb_StrScanner scanner = prb_createStrScanner(str);
-    while (prb_strScannerMove(&scanner, spec, prb_StrScannerSide_AfterMatch)) {
-        if (scanner.betweenLastMatches.len > 0) {
-            prb_stbds_arrput(result, scanner.betweenLastMatches);
+static void
+prb_lib_addLineBreaksScalar(prb_lib_LineStarts* lines, int32_t from) {
+    for (int32_t pos = from; pos < lines->strLen; pos++) {
+        uint8_t ch = lines->str[pos];
+        if (ch == '\n' || ch == '\r') {
+            prb_lib_addLineBreak(lines, pos);
         }
     }
+}
 
-#elif prb_PLATFORM_LINUX
+#if prb_SIMD_SSE2 || prb_SIMD_NEON
 
-    prb_Bytes procSelfContent = prb_linux_readFromProc(arena, prb_STR("self/cmdline"));
-    prb_Str procSelfContentLeft = {(const char*)procSelfContent.data, procSelfContent.len};
-    for (int32_t byteIndex = 0; byteIndex < procSelfContent.len; byteIndex++) {
-        if (procSelfContent.data[byteIndex] == '\0') {
-            int32_t processed = procSelfContent.len - procSelfContentLeft.len;
-            prb_Str arg = {procSelfContentLeft.ptr, byteIndex - processed};
-            prb_stbds_arrput(result, arg);
-            procSelfContentLeft = prb_strSlice(procSelfContentLeft, arg.len + 1, procSelfContentLeft.len);
-        }
+static void
+prb_lib_addLineBreaksFromMask(prb_lib_LineStarts* lines, int32_t blockOff, uint64_t mask, int32_t bitsPerLane) {
+    uint64_t laneMask = ((uint64_t)1 << bitsPerLane) - 1;
+    while (mask != 0) {
+        int32_t lane = prb_lib_lowestBit(mask) / bitsPerLane;
+        mask &= ~(laneMask << (lane * bitsPerLane));
+        prb_lib_addLineBreak(lines, blockOff + lane);
     }
+}
 
-#elif
-#error unimplemented
 #endif
 
-    return result;
+#if prb_SIMD_SSE2
+
+static void
+prb_lib_addLineBreaksSse2(prb_lib_LineStarts* lines) {
+    int32_t blockCount = lines->strLen / 16;
+    __m128i lf = _mm_set1_epi8('\n');
+    __m128i cr = _mm_set1_epi8('\r');
+    for (int32_t blockIndex = 0; blockIndex < blockCount; blockIndex++) {
+        int32_t  off = blockIndex * 16;
+        __m128i  bytes = _mm_loadu_si128((const __m128i*)(lines->str + off));
+        __m128i  eq = _mm_or_si128(_mm_cmpeq_epi8(bytes, lf), _mm_cmpeq_epi8(bytes, cr));
+        uint64_t mask = (uint32_t)_mm_movemask_epi8(eq);
+        prb_lib_addLineBreaksFromMask(lines, off, mask, 1);
+    }
+    prb_lib_addLineBreaksScalar(lines, blockCount * 16);
 }
 
-prb_PUBLICDEF const char**
-prb_getArgArrayFromStr(prb_Arena* arena, prb_Str str) {
-    const char** args = 0;
+#endif
 
-    {
-        prb_StrScanner  scanner = prb_createStrScanner(str);
-        prb_StrFindSpec space = {
-            .mode = prb_StrFindMode_AnyChar,
-            .direction = prb_StrDirection_FromStart,
-            .pattern = prb_STR(" "),
-            .alwaysMatchEnd = true,
-        };
-        while (prb_strScannerMove(&scanner, space, prb_StrScannerSide_AfterMatch)) {
-            if (scanner.betweenLastMatches.len > 0) {
-                const char* argNull = prb_fmt(arena, "%.*s", prb_LIT(scanner.betweenLastMatches)).ptr;
-                prb_stbds_arrput(args, argNull);
-            }
+#if prb_SIMD_AVX2
+
+prb_AVX2_TARGET static void
+prb_lib_addLineBreaksAvx2(prb_lib_LineStarts* lines) {
+    int32_t blockCount = lines->strLen / 32;
+    __m256i lf = _mm256_set1_epi8('\n');
+    __m256i cr = _mm256_set1_epi8('\r');
+    for (int32_t blockIndex = 0; blockIndex < blockCount; blockIndex++) {
+        int32_t  off = blockIndex * 32;
+        __m256i  bytes = _mm256_loadu_si256((const __m256i*)(lines->str + off));
+        __m256i  eq = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, lf), _mm256_cmpeq_epi8(bytes, cr));
+        uint64_t mask = (uint32_t)_mm256_movemask_epi8(eq);
+        prb_lib_addLineBreaksFromMask(lines, off, mask, 1);
+    }
+    prb_lib_addLineBreaksScalar(lines, blockCount * 32);
+}
+
+#endif
+
+#if prb_SIMD_NEON
+
+static void
+prb_lib_addLineBreaksNeon(prb_lib_LineStarts* lines) {
+    int32_t    blockCount = lines->strLen / 16;
+    uint8x16_t lf = vdupq_n_u8('\n');
+    uint8x16_t cr = vdupq_n_u8('\r');
+    for (int32_t blockIndex = 0; blockIndex < blockCount; blockIndex++) {
+        int32_t    off = blockIndex * 16;
+        uint8x16_t bytes = vld1q_u8(lines->str + off);
+        uint8x16_t eq = vorrq_u8(vceqq_u8(bytes, lf), vceqq_u8(bytes, cr));
+        uint64_t   mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+        prb_lib_addLineBreaksFromMask(lines, off, mask, 4);
+    }
+    prb_lib_addLineBreaksScalar(lines, blockCount * 16);
+}
+
+#endif
+
+prb_PUBLICDEF prb_LineIndex
+prb_buildLineIndex(prb_Arena* arena, prb_Str str) {
+    prb_assert(!arena->lockedForStr);
+    prb_arenaAlignFreePtr(arena, prb_alignof(int32_t));
+
+    prb_lib_LineStarts lines = {};
+    lines.str = (const uint8_t*)str.ptr;
+    lines.strLen = str.len;
+    lines.starts = (int32_t*)prb_arenaFreePtr(arena);
+    lines.cap = prb_arenaFreeSize(arena) / (intptr_t)sizeof(int32_t) - 1;
+
+    if (str.len > 0) {
+        prb_assert(lines.cap > 0);
+        lines.starts[lines.count++] = 0;
+#if prb_SIMD_AVX2
+        if (prb_avx2Supported()) {
+            prb_lib_addLineBreaksAvx2(&lines);
+        } else
+#endif
+        {
+#if prb_SIMD_SSE2
+            prb_lib_addLineBreaksSse2(&lines);
+#elif prb_SIMD_NEON
+            prb_lib_addLineBreaksNeon(&lines);
+#else
+            prb_lib_addLineBreaksScalar(&lines, 0);
+#endif
         }
     }
+    lines.starts[lines.count] = str.len;
+    prb_arenaChangeUsed(arena, (intptr_t)(lines.count + 1) * (intptr_t)sizeof(int32_t));
 
-    // NOTE(khvorov) Arg array needs a null at the end
-    prb_stbds_arrsetcap(args, (size_t)(prb_stbds_arrlen(args) + 1));
-    args[prb_stbds_arrlen(args)] = 0;
+    prb_LineIndex result = {.str = str, .lineStarts = lines.starts, .lineCount = lines.count};
+    return result;
+}
 
-    return args;
+prb_PUBLICDEF prb_LineIter
+prb_createLineIter(prb_LineIndex* index) {
+    prb_LineIter result = {.index = index, .curLineIndex = -1, .curLine = {}, .curLineBreak = {}};
+    return result;
 }
 
-prb_PUBLICDEF prb_CoreCountResult
-prb_getCoreCount(prb_Arena* arena) {
-    prb_TempMemory      temp = prb_beginTempMemory(arena);
-    prb_CoreCountResult result = {.success = false, .cores = 0};
-#if prb_PLATFORM_WINDOWS
-    SYSTEM_INFO sysinfo;
-    prb_memset(&sysinfo, 0, sizeof(sysinfo));
-    GetSystemInfo(&sysinfo);
-    result.success = true;
-    result.cores = (int32_t)sysinfo.dwNumberOfProcessors;
-#elif prb_PLATFORM_LINUX
-    prb_Str cpuinfo = prb_strFromBytes(prb_linux_readFromProc(arena, prb_STR("cpuinfo")));
-    prb_StrScanner scanner = prb_createStrScanner(cpuinfo);
-    prb_StrFindSpec spec = {};
-    spec.pattern = prb_STR("processor");
-    spec.direction = prb_StrDirection_FromEnd;
-    if (prb_strScannerMove(&scanner, spec, prb_StrScannerSide_AfterMatch)) {
-        spec.pattern = prb_STR(":");
-        spec.direction = prb_StrDirection_FromStart;
-        if (prb_strScannerMove(&scanner, spec, prb_StrScannerSide_AfterMatch)) {
-            spec.mode = prb_StrFindMode_LineBreak;
-            if (prb_strScannerMove(&scanner, spec, prb_StrScannerSide_AfterMatch)) {
-                prb_Str coresStr = prb_strTrim(scanner.betweenLastMatches);
-                prb_ParseUintResult parse = prb_parseUint(coresStr, 10);
-                if (parse.success) {
-                    result.success = true;
-                    // NOTE(khvorov) This number is the last CPU index + 1
-                    // Sibling count is not accurate on boards with multiple sockets
-                    result.cores = parse.number + 1;
-                }
-            }
+prb_PUBLICDEF prb_Status
+prb_lineIterNext(prb_LineIter* iter) {
+    prb_Status result = prb_Failure;
+    if (iter->curLineIndex + 1 < iter->index->lineCount) {
+        iter->curLineIndex += 1;
+        prb_Str str = iter->index->str;
+        int32_t start = iter->index->lineStarts[iter->curLineIndex];
+        int32_t onePastEnd = iter->index->lineStarts[iter->curLineIndex + 1];
+        int32_t contentEnd = onePastEnd;
+        if (contentEnd > start && str.ptr[contentEnd - 1] == '\n') {
+            contentEnd -= 1;
         }
+        if (contentEnd > start && str.ptr[contentEnd - 1] == '\r') {
+            contentEnd -= 1;
+        }
+        iter->curLine = prb_strSlice(str, start, contentEnd);
+        iter->curLineBreak = prb_strSlice(str, contentEnd, onePastEnd);
+        result = prb_Success;
     }
-#else
-#error unimplemented
-#endif
-    prb_endTempMemory(temp);
     return result;
 }
 
-prb_PUBLICDEF prb_CoreCountResult
-prb_getAllowExecutionCoreCount(prb_Arena* arena) {
-    prb_CoreCountResult result = {.success = false, .cores = 0};
-    prb_TempMemory      temp = prb_beginTempMemory(arena);
+// NOTE(khvorov) 8 ascii digits at a time, from "Fast number parsing without fallback" (Mushtak, Lemire)
+// and simdjson. Loads are little-endian which is all the platforms here.
+static uint64_t
+prb_lib_loadU64(const char* ptr) {
+    uint64_t result = 0;
+    prb_memcpy(&result, ptr, sizeof(result));
+    return result;
+}
 
-#if prb_PLATFORM_WINDOWS
-    prb_windows_GetAffinityResult affinityRes = prb_windows_getAffinity();
-    if (affinityRes.success) {
-        result.success = true;
-        result.cores = affinityRes.setBits;
+static bool
+prb_lib_isEightDigits(uint64_t chars) {
+    bool result = (((chars & 0xF0F0F0F0F0F0F0F0) | (((chars + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) == 0x3333333333333333);
+    return result;
+}
+
+static uint32_t
+prb_lib_parseEightDigits(uint64_t chars) {
+    uint64_t mask = 0x000000FF000000FF;
+    uint64_t mul1 = 0x000F424000000064;  // NOTE(khvorov) 100 + (1000000 << 32)
+    uint64_t mul2 = 0x0000271000000001;  // NOTE(khvorov) 1 + (10000 << 32)
+    chars -= 0x3030303030303030;
+    chars = (chars * 10) + (chars >> 8);
+    chars = (((chars & mask) * mul1) + (((chars >> 16) & mask) * mul2)) >> 32;
+    uint32_t result = (uint32_t)chars;
+    return result;
+}
+
+// NOTE(khvorov) Consumes the run of decimal digits at the start of str, the value wraps past 64 bits
+static int32_t
+prb_lib_parseDecimalRun(const char* str, int32_t len, uint64_t* value) {
+    int32_t  at = 0;
+    uint64_t number = *value;
+    while (at + 8 <= len) {
+        uint64_t chars = prb_lib_loadU64(str + at);
+        if (!prb_lib_isEightDigits(chars)) {
+            break;
+        }
+        number = number * 100000000 + prb_lib_parseEightDigits(chars);
+        at += 8;
     }
-#elif prb_PLATFORM_LINUX
-    prb_linux_GetAffinityResult affinityRes = prb_linux_getAffinity(arena);
-    if (affinityRes.success) {
-        result.success = true;
-        result.cores = affinityRes.setBits;
+    while (at < len && str[at] >= '0' && str[at] <= '9') {
+        number = number * 10 + (uint64_t)(str[at] - '0');
+        at += 1;
+    }
+    *value = number;
+    return at;
+}
+
+// NOTE(khvorov) 0xFF for anything that isn't a hex digit
+static const uint8_t prb_lib_hexDigitValues[256] = {
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 0,   1,   2,   3,   4,   5,   6,   7,   8,   9,   255, 255, 255, 255, 255, 255,
+    255, 10,  11,  12,  13,  14,  15,  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 10,  11,  12,  13,  14,  15,  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+};
+
+prb_PUBLICDEF prb_ParseUintResult
+prb_parseUint(prb_Str digits, uint64_t base) {
+    prb_assert(base == 16 || base == 10);
+    prb_ParseUintResult result = {.success = false, .number = 0};
+    if (digits.len > 0) {
+        int32_t leadingZeros = 0;
+        while (leadingZeros < digits.len && digits.ptr[leadingZeros] == '0') {
+            leadingZeros += 1;
+        }
+        prb_Str significant = prb_strSlice(digits, leadingZeros, digits.len);
+
+        switch (base) {
+            case 10: {
+                // NOTE(khvorov) 19 digits always fit, the 20th has to be checked
+                uint64_t number = 0;
+                int32_t  head = prb_min(significant.len, 19);
+                if (prb_lib_parseDecimalRun(significant.ptr, head, &number) == head) {
+                    result.success = true;
+                    if (significant.len == 20) {
+                        char ch = significant.ptr[19];
+                        result.success = ch >= '0' && ch <= '9' && number <= (UINT64_MAX - (uint64_t)(ch - '0')) / 10;
+                        number = number * 10 + (uint64_t)(ch - '0');
+                    } else if (significant.len > 20) {
+                        result.success = false;
+                    }
+                    result.number = result.success ? number : 0;
+                }
+            } break;
+
+            case 16: {
+                uint8_t  invalid = 0;
+                uint64_t number = 0;
+                for (int32_t digitIndex = 0; digitIndex < significant.len; digitIndex++) {
+                    uint8_t value = prb_lib_hexDigitValues[(uint8_t)significant.ptr[digitIndex]];
+                    invalid |= value;
+                    number = (number << 4) | (value & 0x0F);
+                }
+                result.success = (invalid & 0xF0) == 0 && significant.len <= 16;
+                result.number = result.success ? number : 0;
+            } break;
+        }
     }
+    return result;
+}
+
+// NOTE(khvorov) 128-bit approximations of 5^q for q in [-342, 308] with the most significant bit set,
+// truncated for positive q and rounded up for negative q. From "Number Parsing at a Gigabyte per Second" (Lemire)
+// and the fast_float library's table generation script.
+static const uint64_t prb_lib_powersOfFive128[] = {
+    0xeef453d6923bd65a, 0x113faa2906a13b3f,  // 5^-342
+    0x9558b4661b6565f8, 0x4ac7ca59a424c507,  // 5^-341
+    0xbaaee17fa23ebf76, 0x5d79bcf00d2df649,  // 5^-340
+    0xe95a99df8ace6f53, 0xf4d82c2c107973dc,  // 5^-339
+    0x91d8a02bb6c10594, 0x79071b9b8a4be869,  // 5^-338
+    0xb64ec836a47146f9, 0x9748e2826cdee284,  // 5^-337
+    0xe3e27a444d8d98b7, 0xfd1b1b2308169b25,  // 5^-336
+    0x8e6d8c6ab0787f72, 0xfe30f0f5e50e20f7,  // 5^-335
+    0xb208ef855c969f4f, 0xbdbd2d335e51a935,  // 5^-334
+    0xde8b2b66b3bc4723, 0xad2c788035e61382,  // 5^-333
+    0x8b16fb203055ac76, 0x4c3bcb5021afcc31,  // 5^-332
+    0xaddcb9e83c6b1793, 0xdf4abe242a1bbf3d,  // 5^-331
+    0xd953e8624b85dd78, 0xd71d6dad34a2af0d,  // 5^-330
+    0x87d4713d6f33aa6b, 0x8672648c40e5ad68,  // 5^-329
+    0xa9c98d8ccb009506, 0x680efdaf511f18c2,  // 5^-328
+    0xd43bf0effdc0ba48, 0x0212bd1b2566def2,  // 5^-327
+    0x84a57695fe98746d, 0x014bb630f7604b57,  // 5^-326
+    0xa5ced43b7e3e9188, 0x419ea3bd35385e2d,  // 5^-325
+    0xcf42894a5dce35ea, 0x52064cac828675b9,  // 5^-324
+    0x818995ce7aa0e1b2, 0x7343efebd1940993,  // 5^-323
+    0xa1ebfb4219491a1f, 0x1014ebe6c5f90bf8,  // 5^-322
+    0xca66fa129f9b60a6, 0xd41a26e077774ef6,  // 5^-321
+    0xfd00b897478238d0, 0x8920b098955522b4,  // 5^-320
+    0x9e20735e8cb16382, 0x55b46e5f5d5535b0,  // 5^-319
+    0xc5a890362fddbc62, 0xeb2189f734aa831d,  // 5^-318
+    0xf712b443bbd52b7b, 0xa5e9ec7501d523e4,  // 5^-317
+    0x9a6bb0aa55653b2d, 0x47b233c92125366e,  // 5^-316
+    0xc1069cd4eabe89f8, 0x999ec0bb696e840a,  // 5^-315
+    0xf148440a256e2c76, 0xc00670ea43ca250d,  // 5^-314
+    0x96cd2a865764dbca, 0x380406926a5e5728,  // 5^-313
+    0xbc807527ed3e12bc, 0xc605083704f5ecf2,  // 5^-312
+    0xeba09271e88d976b, 0xf7864a44c633682e,  // 5^-311
+    0x93445b8731587ea3, 0x7ab3ee6afbe0211d,  // 5^-310
+    0xb8157268fdae9e4c, 0x5960ea05bad82964,  // 5^-309
+    0xe61acf033d1a45df, 0x6fb92487298e33bd,  // 5^-308
+    0x8fd0c16206306bab, 0xa5d3b6d479f8e056,  // 5^-307
+    0xb3c4f1ba87bc8696, 0x8f48a4899877186c,  // 5^-306
+    0xe0b62e2929aba83c, 0x331acdabfe94de87,  // 5^-305
+    0x8c71dcd9ba0b4925, 0x9ff0c08b7f1d0b14,  // 5^-304
+    0xaf8e5410288e1b6f, 0x07ecf0ae5ee44dd9,  // 5^-303
+    0xdb71e91432b1a24a, 0xc9e82cd9f69d6150,  // 5^-302
+    0x892731ac9faf056e, 0xbe311c083a225cd2,  // 5^-301
+    0xab70fe17c79ac6ca, 0x6dbd630a48aaf406,  // 5^-300
+    0xd64d3d9db981787d, 0x092cbbccdad5b108,  // 5^-299
+    0x85f0468293f0eb4e, 0x25bbf56008c58ea5,  // 5^-298
+    0xa76c582338ed2621, 0xaf2af2b80af6f24e,  // 5^-297
+    0xd1476e2c07286faa, 0x1af5af660db4aee1,  // 5^-296
+    0x82cca4db847945ca, 0x50d98d9fc890ed4d,  // 5^-295
+    0xa37fce126597973c, 0xe50ff107bab528a0,  // 5^-294
+    0xcc5fc196fefd7d0c, 0x1e53ed49a96272c8,  // 5^-293
+    0xff77b1fcbebcdc4f, 0x25e8e89c13bb0f7a,  // 5^-292
+    0x9faacf3df73609b1, 0x77b191618c54e9ac,  // 5^-291
+    0xc795830d75038c1d, 0xd59df5b9ef6a2417,  // 5^-290
+    0xf97ae3d0d2446f25, 0x4b0573286b44ad1d,  // 5^-289
+    0x9becce62836ac577, 0x4ee367f9430aec32,  // 5^-288
+    0xc2e801fb244576d5, 0x229c41f793cda73f,  // 5^-287
+    0xf3a20279ed56d48a, 0x6b43527578c1110f,  // 5^-286
+    0x9845418c345644d6, 0x830a13896b78aaa9,  // 5^-285
+    0xbe5691ef416bd60c, 0x23cc986bc656d553,  // 5^-284
+    0xedec366b11c6cb8f, 0x2cbfbe86b7ec8aa8,  // 5^-283
+    0x94b3a202eb1c3f39, 0x7bf7d71432f3d6a9,  // 5^-282
+    0xb9e08a83a5e34f07, 0xdaf5ccd93fb0cc53,  // 5^-281
+    0xe858ad248f5c22c9, 0xd1b3400f8f9cff68,  // 5^-280
+    0x91376c36d99995be, 0x23100809b9c21fa1,  // 5^-279
+    0xb58547448ffffb2d, 0xabd40a0c2832a78a,  // 5^-278
+    0xe2e69915b3fff9f9, 0x16c90c8f323f516c,  // 5^-277
+    0x8dd01fad907ffc3b, 0xae3da7d97f6792e3,  // 5^-276
+    0xb1442798f49ffb4a, 0x99cd11cfdf41779c,  // 5^-275
+    0xdd95317f31c7fa1d, 0x40405643d711d583,  // 5^-274
+    0x8a7d3eef7f1cfc52, 0x482835ea666b2572,  // 5^-273
+    0xad1c8eab5ee43b66, 0xda3243650005eecf,  // 5^-272
+    0xd863b256369d4a40, 0x90bed43e40076a82,  // 5^-271
+    0x873e4f75e2224e68, 0x5a7744a6e804a291,  // 5^-270
+    0xa90de3535aaae202, 0x711515d0a205cb36,  // 5^-269
+    0xd3515c2831559a83, 0x0d5a5b44ca873e03,  // 5^-268
+    0x8412d9991ed58091, 0xe858790afe9486c2,  // 5^-267
+    0xa5178fff668ae0b6, 0x626e974dbe39a872,  // 5^-266
+    0xce5d73ff402d98e3, 0xfb0a3d212dc8128f,  // 5^-265
+    0x80fa687f881c7f8e, 0x7ce66634bc9d0b99,  // 5^-264
+    0xa139029f6a239f72, 0x1c1fffc1ebc44e80,  // 5^-263
+    0xc987434744ac874e, 0xa327ffb266b56220,  // 5^-262
+    0xfbe9141915d7a922, 0x4bf1ff9f0062baa8,  // 5^-261
+    0x9d71ac8fada6c9b5, 0x6f773fc3603db4a9,  // 5^-260
+    0xc4ce17b399107c22, 0xcb550fb4384d21d3,  // 5^-259
+    0xf6019da07f549b2b, 0x7e2a53a146606a48,  // 5^-258
+    0x99c102844f94e0fb, 0x2eda7444cbfc426d,  // 5^-257
+    0xc0314325637a1939, 0xfa911155fefb5308,  // 5^-256
+    0xf03d93eebc589f88, 0x793555ab7eba27ca,  // 5^-255
+    0x96267c7535b763b5, 0x4bc1558b2f3458de,  // 5^-254
+    0xbbb01b9283253ca2, 0x9eb1aaedfb016f16,  // 5^-253
+    0xea9c227723ee8bcb, 0x465e15a979c1cadc,  // 5^-252
+    0x92a1958a7675175f, 0x0bfacd89ec191ec9,  // 5^-251
+    0xb749faed14125d36, 0xcef980ec671f667b,  // 5^-250
+    0xe51c79a85916f484, 0x82b7e12780e7401a,  // 5^-249
+    0x8f31cc0937ae58d2, 0xd1b2ecb8b0908810,  // 5^-248
+    0xb2fe3f0b8599ef07, 0x861fa7e6dcb4aa15,  // 5^-247
+    0xdfbdcece67006ac9, 0x67a791e093e1d49a,  // 5^-246
+    0x8bd6a141006042bd, 0xe0c8bb2c5c6d24e0,  // 5^-245
+    0xaecc49914078536d, 0x58fae9f773886e18,  // 5^-244
+    0xda7f5bf590966848, 0xaf39a475506a899e,  // 5^-243
+    0x888f99797a5e012d, 0x6d8406c952429603,  // 5^-242
+    0xaab37fd7d8f58178, 0xc8e5087ba6d33b83,  // 5^-241
+    0xd5605fcdcf32e1d6, 0xfb1e4a9a90880a64,  // 5^-240
+    0x855c3be0a17fcd26, 0x5cf2eea09a55067f,  // 5^-239
+    0xa6b34ad8c9dfc06f, 0xf42faa48c0ea481e,  // 5^-238
+    0xd0601d8efc57b08b, 0xf13b94daf124da26,  // 5^-237
+    0x823c12795db6ce57, 0x76c53d08d6b70858,  // 5^-236
+    0xa2cb1717b52481ed, 0x54768c4b0c64ca6e,  // 5^-235
+    0xcb7ddcdda26da268, 0xa9942f5dcf7dfd09,  // 5^-234
+    0xfe5d54150b090b02, 0xd3f93b35435d7c4c,  // 5^-233
+    0x9efa548d26e5a6e1, 0xc47bc5014a1a6daf,  // 5^-232
+    0xc6b8e9b0709f109a, 0x359ab6419ca1091b,  // 5^-231
+    0xf867241c8cc6d4c0, 0xc30163d203c94b62,  // 5^-230
+    0x9b407691d7fc44f8, 0x79e0de63425dcf1d,  // 5^-229
+    0xc21094364dfb5636, 0x985915fc12f542e4,  // 5^-228
+    0xf294b943e17a2bc4, 0x3e6f5b7b17b2939d,  // 5^-227
+    0x979cf3ca6cec5b5a, 0xa705992ceecf9c42,  // 5^-226
+    0xbd8430bd08277231, 0x50c6ff782a838353,  // 5^-225
+    0xece53cec4a314ebd, 0xa4f8bf5635246428,  // 5^-224
+    0x940f4613ae5ed136, 0x871b7795e136be99,  // 5^-223
+    0xb913179899f68584, 0x28e2557b59846e3f,  // 5^-222
+    0xe757dd7ec07426e5, 0x331aeada2fe589cf,  // 5^-221
+    0x9096ea6f3848984f, 0x3ff0d2c85def7621,  // 5^-220
+    0xb4bca50b065abe63, 0x0fed077a756b53a9,  // 5^-219
+    0xe1ebce4dc7f16dfb, 0xd3e8495912c62894,  // 5^-218
+    0x8d3360f09cf6e4bd, 0x64712dd7abbbd95c,  // 5^-217
+    0xb080392cc4349dec, 0xbd8d794d96aacfb3,  // 5^-216
+    0xdca04777f541c567, 0xecf0d7a0fc5583a0,  // 5^-215
+    0x89e42caaf9491b60, 0xf41686c49db57244,  // 5^-214
+    0xac5d37d5b79b6239, 0x311c2875c522ced5,  // 5^-213
+    0xd77485cb25823ac7, 0x7d633293366b828b,  // 5^-212
+    0x86a8d39ef77164bc, 0xae5dff9c02033197,  // 5^-211
+    0xa8530886b54dbdeb, 0xd9f57f830283fdfc,  // 5^-210
+    0xd267caa862a12d66, 0xd072df63c324fd7b,  // 5^-209
+    0x8380dea93da4bc60, 0x4247cb9e59f71e6d,  // 5^-208
+    0xa46116538d0deb78, 0x52d9be85f074e608,  // 5^-207
+    0xcd795be870516656, 0x67902e276c921f8b,  // 5^-206
+    0x806bd9714632dff6, 0x00ba1cd8a3db53b6,  // 5^-205
+    0xa086cfcd97bf97f3, 0x80e8a40eccd228a4,  // 5^-204
+    0xc8a883c0fdaf7df0, 0x6122cd128006b2cd,  // 5^-203
+    0xfad2a4b13d1b5d6c, 0x796b805720085f81,  // 5^-202
+    0x9cc3a6eec6311a63, 0xcbe3303674053bb0,  // 5^-201
+    0xc3f490aa77bd60fc, 0xbedbfc4411068a9c,  // 5^-200
+    0xf4f1b4d515acb93b, 0xee92fb5515482d44,  // 5^-199
+    0x991711052d8bf3c5, 0x751bdd152d4d1c4a,  // 5^-198
+    0xbf5cd54678eef0b6, 0xd262d45a78a0635d,  // 5^-197
+    0xef340a98172aace4, 0x86fb897116c87c34,  // 5^-196
+    0x9580869f0e7aac0e, 0xd45d35e6ae3d4da0,  // 5^-195
+    0xbae0a846d2195712, 0x8974836059cca109,  // 5^-194
+    0xe998d258869facd7, 0x2bd1a438703fc94b,  // 5^-193
+    0x91ff83775423cc06, 0x7b6306a34627ddcf,  // 5^-192
+    0xb67f6455292cbf08, 0x1a3bc84c17b1d542,  // 5^-191
+    0xe41f3d6a7377eeca, 0x20caba5f1d9e4a93,  // 5^-190
+    0x8e938662882af53e, 0x547eb47b7282ee9c,  // 5^-189
+    0xb23867fb2a35b28d, 0xe99e619a4f23aa43,  // 5^-188
+    0xdec681f9f4c31f31, 0x6405fa00e2ec94d4,  // 5^-187
+    0x8b3c113c38f9f37e, 0xde83bc408dd3dd04,  // 5^-186
+    0xae0b158b4738705e, 0x9624ab50b148d445,  // 5^-185
+    0xd98ddaee19068c76, 0x3badd624dd9b0957,  // 5^-184
+    0x87f8a8d4cfa417c9, 0xe54ca5d70a80e5d6,  // 5^-183
+    0xa9f6d30a038d1dbc, 0x5e9fcf4ccd211f4c,  // 5^-182
+    0xd47487cc8470652b, 0x7647c3200069671f,  // 5^-181
+    0x84c8d4dfd2c63f3b, 0x29ecd9f40041e073,  // 5^-180
+    0xa5fb0a17c777cf09, 0xf468107100525890,  // 5^-179
+    0xcf79cc9db955c2cc, 0x7182148d4066eeb4,  // 5^-178
+    0x81ac1fe293d599bf, 0xc6f14cd848405530,  // 5^-177
+    0xa21727db38cb002f, 0xb8ada00e5a506a7c,  // 5^-176
+    0xca9cf1d206fdc03b, 0xa6d90811f0e4851c,  // 5^-175
+    0xfd442e4688bd304a, 0x908f4a166d1da663,  // 5^-174
+    0x9e4a9cec15763e2e, 0x9a598e4e043287fe,  // 5^-173
+    0xc5dd44271ad3cdba, 0x40eff1e1853f29fd,  // 5^-172
+    0xf7549530e188c128, 0xd12bee59e68ef47c,  // 5^-171
+    0x9a94dd3e8cf578b9, 0x82bb74f8301958ce,  // 5^-170
+    0xc13a148e3032d6e7, 0xe36a52363c1faf01,  // 5^-169
+    0xf18899b1bc3f8ca1, 0xdc44e6c3cb279ac1,  // 5^-168
+    0x96f5600f15a7b7e5, 0x29ab103a5ef8c0b9,  // 5^-167
+    0xbcb2b812db11a5de, 0x7415d448f6b6f0e7,  // 5^-166
+    0xebdf661791d60f56, 0x111b495b3464ad21,  // 5^-165
+    0x936b9fcebb25c995, 0xcab10dd900beec34,  // 5^-164
+    0xb84687c269ef3bfb, 0x3d5d514f40eea742,  // 5^-163
+    0xe65829b3046b0afa, 0x0cb4a5a3112a5112,  // 5^-162
+    0x8ff71a0fe2c2e6dc, 0x47f0e785eaba72ab,  // 5^-161
+    0xb3f4e093db73a093, 0x59ed216765690f56,  // 5^-160
+    0xe0f218b8d25088b8, 0x306869c13ec3532c,  // 5^-159
+    0x8c974f7383725573, 0x1e414218c73a13fb,  // 5^-158
+    0xafbd2350644eeacf, 0xe5d1929ef90898fa,  // 5^-157
+    0xdbac6c247d62a583, 0xdf45f746b74abf39,  // 5^-156
+    0x894bc396ce5da772, 0x6b8bba8c328eb783,  // 5^-155
+    0xab9eb47c81f5114f, 0x066ea92f3f326564,  // 5^-154
+    0xd686619ba27255a2, 0xc80a537b0efefebd,  // 5^-153
+    0x8613fd0145877585, 0xbd06742ce95f5f36,  // 5^-152
+    0xa798fc4196e952e7, 0x2c48113823b73704,  // 5^-151
+    0xd17f3b51fca3a7a0, 0xf75a15862ca504c5,  // 5^-150
+    0x82ef85133de648c4, 0x9a984d73dbe722fb,  // 5^-149
+    0xa3ab66580d5fdaf5, 0xc13e60d0d2e0ebba,  // 5^-148
+    0xcc963fee10b7d1b3, 0x318df905079926a8,  // 5^-147
+    0xffbbcfe994e5c61f, 0xfdf17746497f7052,  // 5^-146
+    0x9fd561f1fd0f9bd3, 0xfeb6ea8bedefa633,  // 5^-145
+    0xc7caba6e7c5382c8, 0xfe64a52ee96b8fc0,  // 5^-144
+    0xf9bd690a1b68637b, 0x3dfdce7aa3c673b0,  // 5^-143
+    0x9c1661a651213e2d, 0x06bea10ca65c084e,  // 5^-142
+    0xc31bfa0fe5698db8, 0x486e494fcff30a62,  // 5^-141
+    0xf3e2f893dec3f126, 0x5a89dba3c3efccfa,  // 5^-140
+    0x986ddb5c6b3a76b7, 0xf89629465a75e01c,  // 5^-139
+    0xbe89523386091465, 0xf6bbb397f1135823,  // 5^-138
+    0xee2ba6c0678b597f, 0x746aa07ded582e2c,  // 5^-137
+    0x94db483840b717ef, 0xa8c2a44eb4571cdc,  // 5^-136
+    0xba121a4650e4ddeb, 0x92f34d62616ce413,  // 5^-135
+    0xe896a0d7e51e1566, 0x77b020baf9c81d17,  // 5^-134
+    0x915e2486ef32cd60, 0x0ace1474dc1d122e,  // 5^-133
+    0xb5b5ada8aaff80b8, 0x0d819992132456ba,  // 5^-132
+    0xe3231912d5bf60e6, 0x10e1fff697ed6c69,  // 5^-131
+    0x8df5efabc5979c8f, 0xca8d3ffa1ef463c1,  // 5^-130
+    0xb1736b96b6fd83b3, 0xbd308ff8a6b17cb2,  // 5^-129
+    0xddd0467c64bce4a0, 0xac7cb3f6d05ddbde,  // 5^-128
+    0x8aa22c0dbef60ee4, 0x6bcdf07a423aa96b,  // 5^-127
+    0xad4ab7112eb3929d, 0x86c16c98d2c953c6,  // 5^-126
+    0xd89d64d57a607744, 0xe871c7bf077ba8b7,  // 5^-125
+    0x87625f056c7c4a8b, 0x11471cd764ad4972,  // 5^-124
+    0xa93af6c6c79b5d2d, 0xd598e40d3dd89bcf,  // 5^-123
+    0xd389b47879823479, 0x4aff1d108d4ec2c3,  // 5^-122
+    0x843610cb4bf160cb, 0xcedf722a585139ba,  // 5^-121
+    0xa54394fe1eedb8fe, 0xc2974eb4ee658828,  // 5^-120
+    0xce947a3da6a9273e, 0x733d226229feea32,  // 5^-119
+    0x811ccc668829b887, 0x0806357d5a3f525f,  // 5^-118
+    0xa163ff802a3426a8, 0xca07c2dcb0cf26f7,  // 5^-117
+    0xc9bcff6034c13052, 0xfc89b393dd02f0b5,  // 5^-116
+    0xfc2c3f3841f17c67, 0xbbac2078d443ace2,  // 5^-115
+    0x9d9ba7832936edc0, 0xd54b944b84aa4c0d,  // 5^-114
+    0xc5029163f384a931, 0x0a9e795e65d4df11,  // 5^-113
+    0xf64335bcf065d37d, 0x4d4617b5ff4a16d5,  // 5^-112
+    0x99ea0196163fa42e, 0x504bced1bf8e4e45,  // 5^-111
+    0xc06481fb9bcf8d39, 0xe45ec2862f71e1d6,  // 5^-110
+    0xf07da27a82c37088, 0x5d767327bb4e5a4c,  // 5^-109
+    0x964e858c91ba2655, 0x3a6a07f8d510f86f,  // 5^-108
+    0xbbe226efb628afea, 0x890489f70a55368b,  // 5^-107
+    0xeadab0aba3b2dbe5, 0x2b45ac74ccea842e,  // 5^-106
+    0x92c8ae6b464fc96f, 0x3b0b8bc90012929d,  // 5^-105
+    0xb77ada0617e3bbcb, 0x09ce6ebb40173744,  // 5^-104
+    0xe55990879ddcaabd, 0xcc420a6a101d0515,  // 5^-103
+    0x8f57fa54c2a9eab6, 0x9fa946824a12232d,  // 5^-102
+    0xb32df8e9f3546564, 0x47939822dc96abf9,  // 5^-101
+    0xdff9772470297ebd, 0x59787e2b93bc56f7,  // 5^-100
+    0x8bfbea76c619ef36, 0x57eb4edb3c55b65a,  // 5^-99
+    0xaefae51477a06b03, 0xede622920b6b23f1,  // 5^-98
+    0xdab99e59958885c4, 0xe95fab368e45eced,  // 5^-97
+    0x88b402f7fd75539b, 0x11dbcb0218ebb414,  // 5^-96
+    0xaae103b5fcd2a881, 0xd652bdc29f26a119,  // 5^-95
+    0xd59944a37c0752a2, 0x4be76d3346f0495f,  // 5^-94
+    0x857fcae62d8493a5, 0x6f70a4400c562ddb,  // 5^-93
+    0xa6dfbd9fb8e5b88e, 0xcb4ccd500f6bb952,  // 5^-92
+    0xd097ad07a71f26b2, 0x7e2000a41346a7a7,  // 5^-91
+    0x825ecc24c873782f, 0x8ed400668c0c28c8,  // 5^-90
+    0xa2f67f2dfa90563b, 0x728900802f0f32fa,  // 5^-89
+    0xcbb41ef979346bca, 0x4f2b40a03ad2ffb9,  // 5^-88
+    0xfea126b7d78186bc, 0xe2f610c84987bfa8,  // 5^-87
+    0x9f24b832e6b0f436, 0x0dd9ca7d2df4d7c9,  // 5^-86
+    0xc6ede63fa05d3143, 0x91503d1c79720dbb,  // 5^-85
+    0xf8a95fcf88747d94, 0x75a44c6397ce912a,  // 5^-84
+    0x9b69dbe1b548ce7c, 0xc986afbe3ee11aba,  // 5^-83
+    0xc24452da229b021b, 0xfbe85badce996168,  // 5^-82
+    0xf2d56790ab41c2a2, 0xfae27299423fb9c3,  // 5^-81
+    0x97c560ba6b0919a5, 0xdccd879fc967d41a,  // 5^-80
+    0xbdb6b8e905cb600f, 0x5400e987bbc1c920,  // 5^-79
+    0xed246723473e3813, 0x290123e9aab23b68,  // 5^-78
+    0x9436c0760c86e30b, 0xf9a0b6720aaf6521,  // 5^-77
+    0xb94470938fa89bce, 0xf808e40e8d5b3e69,  // 5^-76
+    0xe7958cb87392c2c2, 0xb60b1d1230b20e04,  // 5^-75
+    0x90bd77f3483bb9b9, 0xb1c6f22b5e6f48c2,  // 5^-74
+    0xb4ecd5f01a4aa828, 0x1e38aeb6360b1af3,  // 5^-73
+    0xe2280b6c20dd5232, 0x25c6da63c38de1b0,  // 5^-72
+    0x8d590723948a535f, 0x579c487e5a38ad0e,  // 5^-71
+    0xb0af48ec79ace837, 0x2d835a9df0c6d851,  // 5^-70
+    0xdcdb1b2798182244, 0xf8e431456cf88e65,  // 5^-69
+    0x8a08f0f8bf0f156b, 0x1b8e9ecb641b58ff,  // 5^-68
+    0xac8b2d36eed2dac5, 0xe272467e3d222f3f,  // 5^-67
+    0xd7adf884aa879177, 0x5b0ed81dcc6abb0f,  // 5^-66
+    0x86ccbb52ea94baea, 0x98e947129fc2b4e9,  // 5^-65
+    0xa87fea27a539e9a5, 0x3f2398d747b36224,  // 5^-64
+    0xd29fe4b18e88640e, 0x8eec7f0d19a03aad,  // 5^-63
+    0x83a3eeeef9153e89, 0x1953cf68300424ac,  // 5^-62
+    0xa48ceaaab75a8e2b, 0x5fa8c3423c052dd7,  // 5^-61
+    0xcdb02555653131b6, 0x3792f412cb06794d,  // 5^-60
+    0x808e17555f3ebf11, 0xe2bbd88bbee40bd0,  // 5^-59
+    0xa0b19d2ab70e6ed6, 0x5b6aceaeae9d0ec4,  // 5^-58
+    0xc8de047564d20a8b, 0xf245825a5a445275,  // 5^-57
+    0xfb158592be068d2e, 0xeed6e2f0f0d56712,  // 5^-56
+    0x9ced737bb6c4183d, 0x55464dd69685606b,  // 5^-55
+    0xc428d05aa4751e4c, 0xaa97e14c3c26b886,  // 5^-54
+    0xf53304714d9265df, 0xd53dd99f4b3066a8,  // 5^-53
+    0x993fe2c6d07b7fab, 0xe546a8038efe4029,  // 5^-52
+    0xbf8fdb78849a5f96, 0xde98520472bdd033,  // 5^-51
+    0xef73d256a5c0f77c, 0x963e66858f6d4440,  // 5^-50
+    0x95a8637627989aad, 0xdde7001379a44aa8,  // 5^-49
+    0xbb127c53b17ec159, 0x5560c018580d5d52,  // 5^-48
+    0xe9d71b689dde71af, 0xaab8f01e6e10b4a6,  // 5^-47
+    0x9226712162ab070d, 0xcab3961304ca70e8,  // 5^-46
+    0xb6b00d69bb55c8d1, 0x3d607b97c5fd0d22,  // 5^-45
+    0xe45c10c42a2b3b05, 0x8cb89a7db77c506a,  // 5^-44
+    0x8eb98a7a9a5b04e3, 0x77f3608e92adb242,  // 5^-43
+    0xb267ed1940f1c61c, 0x55f038b237591ed3,  // 5^-42
+    0xdf01e85f912e37a3, 0x6b6c46dec52f6688,  // 5^-41
+    0x8b61313bbabce2c6, 0x2323ac4b3b3da015,  // 5^-40
+    0xae397d8aa96c1b77, 0xabec975e0a0d081a,  // 5^-39
+    0xd9c7dced53c72255, 0x96e7bd358c904a21,  // 5^-38
+    0x881cea14545c7575, 0x7e50d64177da2e54,  // 5^-37
+    0xaa242499697392d2, 0xdde50bd1d5d0b9e9,  // 5^-36
+    0xd4ad2dbfc3d07787, 0x955e4ec64b44e864,  // 5^-35
+    0x84ec3c97da624ab4, 0xbd5af13bef0b113e,  // 5^-34
+    0xa6274bbdd0fadd61, 0xecb1ad8aeacdd58e,  // 5^-33
+    0xcfb11ead453994ba, 0x67de18eda5814af2,  // 5^-32
+    0x81ceb32c4b43fcf4, 0x80eacf948770ced7,  // 5^-31
+    0xa2425ff75e14fc31, 0xa1258379a94d028d,  // 5^-30
+    0xcad2f7f5359a3b3e, 0x096ee45813a04330,  // 5^-29
+    0xfd87b5f28300ca0d, 0x8bca9d6e188853fc,  // 5^-28
+    0x9e74d1b791e07e48, 0x775ea264cf55347e,  // 5^-27
+    0xc612062576589dda, 0x95364afe032a819e,  // 5^-26
+    0xf79687aed3eec551, 0x3a83ddbd83f52205,  // 5^-25
+    0x9abe14cd44753b52, 0xc4926a9672793543,  // 5^-24
+    0xc16d9a0095928a27, 0x75b7053c0f178294,  // 5^-23
+    0xf1c90080baf72cb1, 0x5324c68b12dd6339,  // 5^-22
+    0x971da05074da7bee, 0xd3f6fc16ebca5e04,  // 5^-21
+    0xbce5086492111aea, 0x88f4bb1ca6bcf585,  // 5^-20
+    0xec1e4a7db69561a5, 0x2b31e9e3d06c32e6,  // 5^-19
+    0x9392ee8e921d5d07, 0x3aff322e62439fd0,  // 5^-18
+    0xb877aa3236a4b449, 0x09befeb9fad487c3,  // 5^-17
+    0xe69594bec44de15b, 0x4c2ebe687989a9b4,  // 5^-16
+    0x901d7cf73ab0acd9, 0x0f9d37014bf60a11,  // 5^-15
+    0xb424dc35095cd80f, 0x538484c19ef38c95,  // 5^-14
+    0xe12e13424bb40e13, 0x2865a5f206b06fba,  // 5^-13
+    0x8cbccc096f5088cb, 0xf93f87b7442e45d4,  // 5^-12
+    0xafebff0bcb24aafe, 0xf78f69a51539d749,  // 5^-11
+    0xdbe6fecebdedd5be, 0xb573440e5a884d1c,  // 5^-10
+    0x89705f4136b4a597, 0x31680a88f8953031,  // 5^-9
+    0xabcc77118461cefc, 0xfdc20d2b36ba7c3e,  // 5^-8
+    0xd6bf94d5e57a42bc, 0x3d32907604691b4d,  // 5^-7
+    0x8637bd05af6c69b5, 0xa63f9a49c2c1b110,  // 5^-6
+    0xa7c5ac471b478423, 0x0fcf80dc33721d54,  // 5^-5
+    0xd1b71758e219652b, 0xd3c36113404ea4a9,  // 5^-4
+    0x83126e978d4fdf3b, 0x645a1cac083126ea,  // 5^-3
+    0xa3d70a3d70a3d70a, 0x3d70a3d70a3d70a4,  // 5^-2
+    0xcccccccccccccccc, 0xcccccccccccccccd,  // 5^-1
+    0x8000000000000000, 0x0000000000000000,  // 5^0
+    0xa000000000000000, 0x0000000000000000,  // 5^1
+    0xc800000000000000, 0x0000000000000000,  // 5^2
+    0xfa00000000000000, 0x0000000000000000,  // 5^3
+    0x9c40000000000000, 0x0000000000000000,  // 5^4
+    0xc350000000000000, 0x0000000000000000,  // 5^5
+    0xf424000000000000, 0x0000000000000000,  // 5^6
+    0x9896800000000000, 0x0000000000000000,  // 5^7
+    0xbebc200000000000, 0x0000000000000000,  // 5^8
+    0xee6b280000000000, 0x0000000000000000,  // 5^9
+    0x9502f90000000000, 0x0000000000000000,  // 5^10
+    0xba43b74000000000, 0x0000000000000000,  // 5^11
+    0xe8d4a51000000000, 0x0000000000000000,  // 5^12
+    0x9184e72a00000000, 0x0000000000000000,  // 5^13
+    0xb5e620f480000000, 0x0000000000000000,  // 5^14
+    0xe35fa931a0000000, 0x0000000000000000,  // 5^15
+    0x8e1bc9bf04000000, 0x0000000000000000,  // 5^16
+    0xb1a2bc2ec5000000, 0x0000000000000000,  // 5^17
+    0xde0b6b3a76400000, 0x0000000000000000,  // 5^18
+    0x8ac7230489e80000, 0x0000000000000000,  // 5^19
+    0xad78ebc5ac620000, 0x0000000000000000,  // 5^20
+    0xd8d726b7177a8000, 0x0000000000000000,  // 5^21
+    0x878678326eac9000, 0x0000000000000000,  // 5^22
+    0xa968163f0a57b400, 0x0000000000000000,  // 5^23
+    0xd3c21bcecceda100, 0x0000000000000000,  // 5^24
+    0x84595161401484a0, 0x0000000000000000,  // 5^25
+    0xa56fa5b99019a5c8, 0x0000000000000000,  // 5^26
+    0xcecb8f27f4200f3a, 0x0000000000000000,  // 5^27
+    0x813f3978f8940984, 0x4000000000000000,  // 5^28
+    0xa18f07d736b90be5, 0x5000000000000000,  // 5^29
+    0xc9f2c9cd04674ede, 0xa400000000000000,  // 5^30
+    0xfc6f7c4045812296, 0x4d00000000000000,  // 5^31
+    0x9dc5ada82b70b59d, 0xf020000000000000,  // 5^32
+    0xc5371912364ce305, 0x6c28000000000000,  // 5^33
+    0xf684df56c3e01bc6, 0xc732000000000000,  // 5^34
+    0x9a130b963a6c115c, 0x3c7f400000000000,  // 5^35
+    0xc097ce7bc90715b3, 0x4b9f100000000000,  // 5^36
+    0xf0bdc21abb48db20, 0x1e86d40000000000,  // 5^37
+    0x96769950b50d88f4, 0x1314448000000000,  // 5^38
+    0xbc143fa4e250eb31, 0x17d955a000000000,  // 5^39
+    0xeb194f8e1ae525fd, 0x5dcfab0800000000,  // 5^40
+    0x92efd1b8d0cf37be, 0x5aa1cae500000000,  // 5^41
+    0xb7abc627050305ad, 0xf14a3d9e40000000,  // 5^42
+    0xe596b7b0c643c719, 0x6d9ccd05d0000000,  // 5^43
+    0x8f7e32ce7bea5c6f, 0xe4820023a2000000,  // 5^44
+    0xb35dbf821ae4f38b, 0xdda2802c8a800000,  // 5^45
+    0xe0352f62a19e306e, 0xd50b2037ad200000,  // 5^46
+    0x8c213d9da502de45, 0x4526f422cc340000,  // 5^47
+    0xaf298d050e4395d6, 0x9670b12b7f410000,  // 5^48
+    0xdaf3f04651d47b4c, 0x3c0cdd765f114000,  // 5^49
+    0x88d8762bf324cd0f, 0xa5880a69fb6ac800,  // 5^50
+    0xab0e93b6efee0053, 0x8eea0d047a457a00,  // 5^51
+    0xd5d238a4abe98068, 0x72a4904598d6d880,  // 5^52
+    0x85a36366eb71f041, 0x47a6da2b7f864750,  // 5^53
+    0xa70c3c40a64e6c51, 0x999090b65f67d924,  // 5^54
+    0xd0cf4b50cfe20765, 0xfff4b4e3f741cf6d,  // 5^55
+    0x82818f1281ed449f, 0xbff8f10e7a8921a4,  // 5^56
+    0xa321f2d7226895c7, 0xaff72d52192b6a0d,  // 5^57
+    0xcbea6f8ceb02bb39, 0x9bf4f8a69f764490,  // 5^58
+    0xfee50b7025c36a08, 0x02f236d04753d5b4,  // 5^59
+    0x9f4f2726179a2245, 0x01d762422c946590,  // 5^60
+    0xc722f0ef9d80aad6, 0x424d3ad2b7b97ef5,  // 5^61
+    0xf8ebad2b84e0d58b, 0xd2e0898765a7deb2,  // 5^62
+    0x9b934c3b330c8577, 0x63cc55f49f88eb2f,  // 5^63
+    0xc2781f49ffcfa6d5, 0x3cbf6b71c76b25fb,  // 5^64
+    0xf316271c7fc3908a, 0x8bef464e3945ef7a,  // 5^65
+    0x97edd871cfda3a56, 0x97758bf0e3cbb5ac,  // 5^66
+    0xbde94e8e43d0c8ec, 0x3d52eeed1cbea317,  // 5^67
+    0xed63a231d4c4fb27, 0x4ca7aaa863ee4bdd,  // 5^68
+    0x945e455f24fb1cf8, 0x8fe8caa93e74ef6a,  // 5^69
+    0xb975d6b6ee39e436, 0xb3e2fd538e122b44,  // 5^70
+    0xe7d34c64a9c85d44, 0x60dbbca87196b616,  // 5^71
+    0x90e40fbeea1d3a4a, 0xbc8955e946fe31cd,  // 5^72
+    0xb51d13aea4a488dd, 0x6babab6398bdbe41,  // 5^73
+    0xe264589a4dcdab14, 0xc696963c7eed2dd1,  // 5^74
+    0x8d7eb76070a08aec, 0xfc1e1de5cf543ca2,  // 5^75
+    0xb0de65388cc8ada8, 0x3b25a55f43294bcb,  // 5^76
+    0xdd15fe86affad912, 0x49ef0eb713f39ebe,  // 5^77
+    0x8a2dbf142dfcc7ab, 0x6e3569326c784337,  // 5^78
+    0xacb92ed9397bf996, 0x49c2c37f07965404,  // 5^79
+    0xd7e77a8f87daf7fb, 0xdc33745ec97be906,  // 5^80
+    0x86f0ac99b4e8dafd, 0x69a028bb3ded71a3,  // 5^81
+    0xa8acd7c0222311bc, 0xc40832ea0d68ce0c,  // 5^82
+    0xd2d80db02aabd62b, 0xf50a3fa490c30190,  // 5^83
+    0x83c7088e1aab65db, 0x792667c6da79e0fa,  // 5^84
+    0xa4b8cab1a1563f52, 0x577001b891185938,  // 5^85
+    0xcde6fd5e09abcf26, 0xed4c0226b55e6f86,  // 5^86
+    0x80b05e5ac60b6178, 0x544f8158315b05b4,  // 5^87
+    0xa0dc75f1778e39d6, 0x696361ae3db1c721,  // 5^88
+    0xc913936dd571c84c, 0x03bc3a19cd1e38e9,  // 5^89
+    0xfb5878494ace3a5f, 0x04ab48a04065c723,  // 5^90
+    0x9d174b2dcec0e47b, 0x62eb0d64283f9c76,  // 5^91
+    0xc45d1df942711d9a, 0x3ba5d0bd324f8394,  // 5^92
+    0xf5746577930d6500, 0xca8f44ec7ee36479,  // 5^93
+    0x9968bf6abbe85f20, 0x7e998b13cf4e1ecb,  // 5^94
+    0xbfc2ef456ae276e8, 0x9e3fedd8c321a67e,  // 5^95
+    0xefb3ab16c59b14a2, 0xc5cfe94ef3ea101e,  // 5^96
+    0x95d04aee3b80ece5, 0xbba1f1d158724a12,  // 5^97
+    0xbb445da9ca61281f, 0x2a8a6e45ae8edc97,  // 5^98
+    0xea1575143cf97226, 0xf52d09d71a3293bd,  // 5^99
+    0x924d692ca61be758, 0x593c2626705f9c56,  // 5^100
+    0xb6e0c377cfa2e12e, 0x6f8b2fb00c77836c,  // 5^101
+    0xe498f455c38b997a, 0x0b6dfb9c0f956447,  // 5^102
+    0x8edf98b59a373fec, 0x4724bd4189bd5eac,  // 5^103
+    0xb2977ee300c50fe7, 0x58edec91ec2cb657,  // 5^104
+    0xdf3d5e9bc0f653e1, 0x2f2967b66737e3ed,  // 5^105
+    0x8b865b215899f46c, 0xbd79e0d20082ee74,  // 5^106
+    0xae67f1e9aec07187, 0xecd8590680a3aa11,  // 5^107
+    0xda01ee641a708de9, 0xe80e6f4820cc9495,  // 5^108
+    0x884134fe908658b2, 0x3109058d147fdcdd,  // 5^109
+    0xaa51823e34a7eede, 0xbd4b46f0599fd415,  // 5^110
+    0xd4e5e2cdc1d1ea96, 0x6c9e18ac7007c91a,  // 5^111
+    0x850fadc09923329e, 0x03e2cf6bc604ddb0,  // 5^112
+    0xa6539930bf6bff45, 0x84db8346b786151c,  // 5^113
+    0xcfe87f7cef46ff16, 0xe612641865679a63,  // 5^114
+    0x81f14fae158c5f6e, 0x4fcb7e8f3f60c07e,  // 5^115
+    0xa26da3999aef7749, 0xe3be5e330f38f09d,  // 5^116
+    0xcb090c8001ab551c, 0x5cadf5bfd3072cc5,  // 5^117
+    0xfdcb4fa002162a63, 0x73d9732fc7c8f7f6,  // 5^118
+    0x9e9f11c4014dda7e, 0x2867e7fddcdd9afa,  // 5^119
+    0xc646d63501a1511d, 0xb281e1fd541501b8,  // 5^120
+    0xf7d88bc24209a565, 0x1f225a7ca91a4226,  // 5^121
+    0x9ae757596946075f, 0x3375788de9b06958,  // 5^122
+    0xc1a12d2fc3978937, 0x0052d6b1641c83ae,  // 5^123
+    0xf209787bb47d6b84, 0xc0678c5dbd23a49a,  // 5^124
+    0x9745eb4d50ce6332, 0xf840b7ba963646e0,  // 5^125
+    0xbd176620a501fbff, 0xb650e5a93bc3d898,  // 5^126
+    0xec5d3fa8ce427aff, 0xa3e51f138ab4cebe,  // 5^127
+    0x93ba47c980e98cdf, 0xc66f336c36b10137,  // 5^128
+    0xb8a8d9bbe123f017, 0xb80b0047445d4184,  // 5^129
+    0xe6d3102ad96cec1d, 0xa60dc059157491e5,  // 5^130
+    0x9043ea1ac7e41392, 0x87c89837ad68db2f,  // 5^131
+    0xb454e4a179dd1877, 0x29babe4598c311fb,  // 5^132
+    0xe16a1dc9d8545e94, 0xf4296dd6fef3d67a,  // 5^133
+    0x8ce2529e2734bb1d, 0x1899e4a65f58660c,  // 5^134
+    0xb01ae745b101e9e4, 0x5ec05dcff72e7f8f,  // 5^135
+    0xdc21a1171d42645d, 0x76707543f4fa1f73,  // 5^136
+    0x899504ae72497eba, 0x6a06494a791c53a8,  // 5^137
+    0xabfa45da0edbde69, 0x0487db9d17636892,  // 5^138
+    0xd6f8d7509292d603, 0x45a9d2845d3c42b6,  // 5^139
+    0x865b86925b9bc5c2, 0x0b8a2392ba45a9b2,  // 5^140
+    0xa7f26836f282b732, 0x8e6cac7768d7141e,  // 5^141
+    0xd1ef0244af2364ff, 0x3207d795430cd926,  // 5^142
+    0x8335616aed761f1f, 0x7f44e6bd49e807b8,  // 5^143
+    0xa402b9c5a8d3a6e7, 0x5f16206c9c6209a6,  // 5^144
+    0xcd036837130890a1, 0x36dba887c37a8c0f,  // 5^145
+    0x802221226be55a64, 0xc2494954da2c9789,  // 5^146
+    0xa02aa96b06deb0fd, 0xf2db9baa10b7bd6c,  // 5^147
+    0xc83553c5c8965d3d, 0x6f92829494e5acc7,  // 5^148
+    0xfa42a8b73abbf48c, 0xcb772339ba1f17f9,  // 5^149
+    0x9c69a97284b578d7, 0xff2a760414536efb,  // 5^150
+    0xc38413cf25e2d70d, 0xfef5138519684aba,  // 5^151
+    0xf46518c2ef5b8cd1, 0x7eb258665fc25d69,  // 5^152
+    0x98bf2f79d5993802, 0xef2f773ffbd97a61,  // 5^153
+    0xbeeefb584aff8603, 0xaafb550ffacfd8fa,  // 5^154
+    0xeeaaba2e5dbf6784, 0x95ba2a53f983cf38,  // 5^155
+    0x952ab45cfa97a0b2, 0xdd945a747bf26183,  // 5^156
+    0xba756174393d88df, 0x94f971119aeef9e4,  // 5^157
+    0xe912b9d1478ceb17, 0x7a37cd5601aab85d,  // 5^158
+    0x91abb422ccb812ee, 0xac62e055c10ab33a,  // 5^159
+    0xb616a12b7fe617aa, 0x577b986b314d6009,  // 5^160
+    0xe39c49765fdf9d94, 0xed5a7e85fda0b80b,  // 5^161
+    0x8e41ade9fbebc27d, 0x14588f13be847307,  // 5^162
+    0xb1d219647ae6b31c, 0x596eb2d8ae258fc8,  // 5^163
+    0xde469fbd99a05fe3, 0x6fca5f8ed9aef3bb,  // 5^164
+    0x8aec23d680043bee, 0x25de7bb9480d5854,  // 5^165
+    0xada72ccc20054ae9, 0xaf561aa79a10ae6a,  // 5^166
+    0xd910f7ff28069da4, 0x1b2ba1518094da04,  // 5^167
+    0x87aa9aff79042286, 0x90fb44d2f05d0842,  // 5^168
+    0xa99541bf57452b28, 0x353a1607ac744a53,  // 5^169
+    0xd3fa922f2d1675f2, 0x42889b8997915ce8,  // 5^170
+    0x847c9b5d7c2e09b7, 0x69956135febada11,  // 5^171
+    0xa59bc234db398c25, 0x43fab9837e699095,  // 5^172
+    0xcf02b2c21207ef2e, 0x94f967e45e03f4bb,  // 5^173
+    0x8161afb94b44f57d, 0x1d1be0eebac278f5,  // 5^174
+    0xa1ba1ba79e1632dc, 0x6462d92a69731732,  // 5^175
+    0xca28a291859bbf93, 0x7d7b8f7503cfdcfe,  // 5^176
+    0xfcb2cb35e702af78, 0x5cda735244c3d43e,  // 5^177
+    0x9defbf01b061adab, 0x3a0888136afa64a7,  // 5^178
+    0xc56baec21c7a1916, 0x088aaa1845b8fdd0,  // 5^179
+    0xf6c69a72a3989f5b, 0x8aad549e57273d45,  // 5^180
+    0x9a3c2087a63f6399, 0x36ac54e2f678864b,  // 5^181
+    0xc0cb28a98fcf3c7f, 0x84576a1bb416a7dd,  // 5^182
+    0xf0fdf2d3f3c30b9f, 0x656d44a2a11c51d5,  // 5^183
+    0x969eb7c47859e743, 0x9f644ae5a4b1b325,  // 5^184
+    0xbc4665b596706114, 0x873d5d9f0dde1fee,  // 5^185
+    0xeb57ff22fc0c7959, 0xa90cb506d155a7ea,  // 5^186
+    0x9316ff75dd87cbd8, 0x09a7f12442d588f2,  // 5^187
+    0xb7dcbf5354e9bece, 0x0c11ed6d538aeb2f,  // 5^188
+    0xe5d3ef282a242e81, 0x8f1668c8a86da5fa,  // 5^189
+    0x8fa475791a569d10, 0xf96e017d694487bc,  // 5^190
+    0xb38d92d760ec4455, 0x37c981dcc395a9ac,  // 5^191
+    0xe070f78d3927556a, 0x85bbe253f47b1417,  // 5^192
+    0x8c469ab843b89562, 0x93956d7478ccec8e,  // 5^193
+    0xaf58416654a6babb, 0x387ac8d1970027b2,  // 5^194
+    0xdb2e51bfe9d0696a, 0x06997b05fcc0319e,  // 5^195
+    0x88fcf317f22241e2, 0x441fece3bdf81f03,  // 5^196
+    0xab3c2fddeeaad25a, 0xd527e81cad7626c3,  // 5^197
+    0xd60b3bd56a5586f1, 0x8a71e223d8d3b074,  // 5^198
+    0x85c7056562757456, 0xf6872d5667844e49,  // 5^199
+    0xa738c6bebb12d16c, 0xb428f8ac016561db,  // 5^200
+    0xd106f86e69d785c7, 0xe13336d701beba52,  // 5^201
+    0x82a45b450226b39c, 0xecc0024661173473,  // 5^202
+    0xa34d721642b06084, 0x27f002d7f95d0190,  // 5^203
+    0xcc20ce9bd35c78a5, 0x31ec038df7b441f4,  // 5^204
+    0xff290242c83396ce, 0x7e67047175a15271,  // 5^205
+    0x9f79a169bd203e41, 0x0f0062c6e984d386,  // 5^206
+    0xc75809c42c684dd1, 0x52c07b78a3e60868,  // 5^207
+    0xf92e0c3537826145, 0xa7709a56ccdf8a82,  // 5^208
+    0x9bbcc7a142b17ccb, 0x88a66076400bb691,  // 5^209
+    0xc2abf989935ddbfe, 0x6acff893d00ea435,  // 5^210
+    0xf356f7ebf83552fe, 0x0583f6b8c4124d43,  // 5^211
+    0x98165af37b2153de, 0xc3727a337a8b704a,  // 5^212
+    0xbe1bf1b059e9a8d6, 0x744f18c0592e4c5c,  // 5^213
+    0xeda2ee1c7064130c, 0x1162def06f79df73,  // 5^214
+    0x9485d4d1c63e8be7, 0x8addcb5645ac2ba8,  // 5^215
+    0xb9a74a0637ce2ee1, 0x6d953e2bd7173692,  // 5^216
+    0xe8111c87c5c1ba99, 0xc8fa8db6ccdd0437,  // 5^217
+    0x910ab1d4db9914a0, 0x1d9c9892400a22a2,  // 5^218
+    0xb54d5e4a127f59c8, 0x2503beb6d00cab4b,  // 5^219
+    0xe2a0b5dc971f303a, 0x2e44ae64840fd61d,  // 5^220
+    0x8da471a9de737e24, 0x5ceaecfed289e5d2,  // 5^221
+    0xb10d8e1456105dad, 0x7425a83e872c5f47,  // 5^222
+    0xdd50f1996b947518, 0xd12f124e28f77719,  // 5^223
+    0x8a5296ffe33cc92f, 0x82bd6b70d99aaa6f,  // 5^224
+    0xace73cbfdc0bfb7b, 0x636cc64d1001550b,  // 5^225
+    0xd8210befd30efa5a, 0x3c47f7e05401aa4e,  // 5^226
+    0x8714a775e3e95c78, 0x65acfaec34810a71,  // 5^227
+    0xa8d9d1535ce3b396, 0x7f1839a741a14d0d,  // 5^228
+    0xd31045a8341ca07c, 0x1ede48111209a050,  // 5^229
+    0x83ea2b892091e44d, 0x934aed0aab460432,  // 5^230
+    0xa4e4b66b68b65d60, 0xf81da84d5617853f,  // 5^231
+    0xce1de40642e3f4b9, 0x36251260ab9d668e,  // 5^232
+    0x80d2ae83e9ce78f3, 0xc1d72b7c6b426019,  // 5^233
+    0xa1075a24e4421730, 0xb24cf65b8612f81f,  // 5^234
+    0xc94930ae1d529cfc, 0xdee033f26797b627,  // 5^235
+    0xfb9b7cd9a4a7443c, 0x169840ef017da3b1,  // 5^236
+    0x9d412e0806e88aa5, 0x8e1f289560ee864e,  // 5^237
+    0xc491798a08a2ad4e, 0xf1a6f2bab92a27e2,  // 5^238
+    0xf5b5d7ec8acb58a2, 0xae10af696774b1db,  // 5^239
+    0x9991a6f3d6bf1765, 0xacca6da1e0a8ef29,  // 5^240
+    0xbff610b0cc6edd3f, 0x17fd090a58d32af3,  // 5^241
+    0xeff394dcff8a948e, 0xddfc4b4cef07f5b0,  // 5^242
+    0x95f83d0a1fb69cd9, 0x4abdaf101564f98e,  // 5^243
+    0xbb764c4ca7a4440f, 0x9d6d1ad41abe37f1,  // 5^244
+    0xea53df5fd18d5513, 0x84c86189216dc5ed,  // 5^245
+    0x92746b9be2f8552c, 0x32fd3cf5b4e49bb4,  // 5^246
+    0xb7118682dbb66a77, 0x3fbc8c33221dc2a1,  // 5^247
+    0xe4d5e82392a40515, 0x0fabaf3feaa5334a,  // 5^248
+    0x8f05b1163ba6832d, 0x29cb4d87f2a7400e,  // 5^249
+    0xb2c71d5bca9023f8, 0x743e20e9ef511012,  // 5^250
+    0xdf78e4b2bd342cf6, 0x914da9246b255416,  // 5^251
+    0x8bab8eefb6409c1a, 0x1ad089b6c2f7548e,  // 5^252
+    0xae9672aba3d0c320, 0xa184ac2473b529b1,  // 5^253
+    0xda3c0f568cc4f3e8, 0xc9e5d72d90a2741e,  // 5^254
+    0x8865899617fb1871, 0x7e2fa67c7a658892,  // 5^255
+    0xaa7eebfb9df9de8d, 0xddbb901b98feeab7,  // 5^256
+    0xd51ea6fa85785631, 0x552a74227f3ea565,  // 5^257
+    0x8533285c936b35de, 0xd53a88958f87275f,  // 5^258
+    0xa67ff273b8460356, 0x8a892abaf368f137,  // 5^259
+    0xd01fef10a657842c, 0x2d2b7569b0432d85,  // 5^260
+    0x8213f56a67f6b29b, 0x9c3b29620e29fc73,  // 5^261
+    0xa298f2c501f45f42, 0x8349f3ba91b47b8f,  // 5^262
+    0xcb3f2f7642717713, 0x241c70a936219a73,  // 5^263
+    0xfe0efb53d30dd4d7, 0xed238cd383aa0110,  // 5^264
+    0x9ec95d1463e8a506, 0xf4363804324a40aa,  // 5^265
+    0xc67bb4597ce2ce48, 0xb143c6053edcd0d5,  // 5^266
+    0xf81aa16fdc1b81da, 0xdd94b7868e94050a,  // 5^267
+    0x9b10a4e5e9913128, 0xca7cf2b4191c8326,  // 5^268
+    0xc1d4ce1f63f57d72, 0xfd1c2f611f63a3f0,  // 5^269
+    0xf24a01a73cf2dccf, 0xbc633b39673c8cec,  // 5^270
+    0x976e41088617ca01, 0xd5be0503e085d813,  // 5^271
+    0xbd49d14aa79dbc82, 0x4b2d8644d8a74e18,  // 5^272
+    0xec9c459d51852ba2, 0xddf8e7d60ed1219e,  // 5^273
+    0x93e1ab8252f33b45, 0xcabb90e5c942b503,  // 5^274
+    0xb8da1662e7b00a17, 0x3d6a751f3b936243,  // 5^275
+    0xe7109bfba19c0c9d, 0x0cc512670a783ad4,  // 5^276
+    0x906a617d450187e2, 0x27fb2b80668b24c5,  // 5^277
+    0xb484f9dc9641e9da, 0xb1f9f660802dedf6,  // 5^278
+    0xe1a63853bbd26451, 0x5e7873f8a0396973,  // 5^279
+    0x8d07e33455637eb2, 0xdb0b487b6423e1e8,  // 5^280
+    0xb049dc016abc5e5f, 0x91ce1a9a3d2cda62,  // 5^281
+    0xdc5c5301c56b75f7, 0x7641a140cc7810fb,  // 5^282
+    0x89b9b3e11b6329ba, 0xa9e904c87fcb0a9d,  // 5^283
+    0xac2820d9623bf429, 0x546345fa9fbdcd44,  // 5^284
+    0xd732290fbacaf133, 0xa97c177947ad4095,  // 5^285
+    0x867f59a9d4bed6c0, 0x49ed8eabcccc485d,  // 5^286
+    0xa81f301449ee8c70, 0x5c68f256bfff5a74,  // 5^287
+    0xd226fc195c6a2f8c, 0x73832eec6fff3111,  // 5^288
+    0x83585d8fd9c25db7, 0xc831fd53c5ff7eab,  // 5^289
+    0xa42e74f3d032f525, 0xba3e7ca8b77f5e55,  // 5^290
+    0xcd3a1230c43fb26f, 0x28ce1bd2e55f35eb,  // 5^291
+    0x80444b5e7aa7cf85, 0x7980d163cf5b81b3,  // 5^292
+    0xa0555e361951c366, 0xd7e105bcc332621f,  // 5^293
+    0xc86ab5c39fa63440, 0x8dd9472bf3fefaa7,  // 5^294
+    0xfa856334878fc150, 0xb14f98f6f0feb951,  // 5^295
+    0x9c935e00d4b9d8d2, 0x6ed1bf9a569f33d3,  // 5^296
+    0xc3b8358109e84f07, 0x0a862f80ec4700c8,  // 5^297
+    0xf4a642e14c6262c8, 0xcd27bb612758c0fa,  // 5^298
+    0x98e7e9cccfbd7dbd, 0x8038d51cb897789c,  // 5^299
+    0xbf21e44003acdd2c, 0xe0470a63e6bd56c3,  // 5^300
+    0xeeea5d5004981478, 0x1858ccfce06cac74,  // 5^301
+    0x95527a5202df0ccb, 0x0f37801e0c43ebc8,  // 5^302
+    0xbaa718e68396cffd, 0xd30560258f54e6ba,  // 5^303
+    0xe950df20247c83fd, 0x47c6b82ef32a2069,  // 5^304
+    0x91d28b7416cdd27e, 0x4cdc331d57fa5441,  // 5^305
+    0xb6472e511c81471d, 0xe0133fe4adf8e952,  // 5^306
+    0xe3d8f9e563a198e5, 0x58180fddd97723a6,  // 5^307
+    0x8e679c2f5e44ff8f, 0x570f09eaa7ea7648,  // 5^308
+};
+
+static uint64_t
+prb_lib_mul128(uint64_t a, uint64_t b, uint64_t* high) {
+#if defined(_MSC_VER) && !defined(__clang__) && (defined(_M_X64) || defined(_M_ARM64))
+    uint64_t result = a * b;
+    *high = __umulh(a, b);
 #else
-#error unimplemented
+    __uint128_t product = (__uint128_t)a * b;
+    uint64_t    result = (uint64_t)product;
+    *high = (uint64_t)(product >> 64);
 #endif
+    return result;
+}
 
-    prb_endTempMemory(temp);
+static int32_t
+prb_lib_leadingZeros(uint64_t value) {
+    int32_t result = 63 - prb_lib_highestBit(value);
     return result;
 }
 
-prb_PUBLICDEF prb_Status
-prb_allowExecutionOnCores(prb_Arena* arena, int32_t coreCount) {
-    prb_Status     result = prb_Failure;
-    prb_TempMemory temp = prb_beginTempMemory(arena);
-    if (coreCount >= 1) {
-#if prb_PLATFORM_WINDOWS
-        prb_windows_GetAffinityResult affinityRes = prb_windows_getAffinity();
-        if (affinityRes.success) {
-            DWORD_PTR newAffinityMask = affinityRes.affinity;
-            int32_t   coreDelta = coreCount - affinityRes.setBits;
-            for (int32_t bitIndex = 0; bitIndex < (int32_t)sizeof(DWORD_PTR) * 8 && coreDelta != 0; bitIndex++) {
-                DWORD_PTR mask = ((DWORD_PTR)1) << bitIndex;
-                bool      coreIsScheduled = (newAffinityMask & mask) == mask;
-                if (coreIsScheduled) {
-                    if (coreDelta > 0) {
-                        newAffinityMask = newAffinityMask | mask;
-                        coreDelta -= 1;
-                    } else {
-                        newAffinityMask = newAffinityMask & (~mask);
-                        coreDelta += 1;
-                    }
-                }
+// NOTE(khvorov) Correctly rounded w * 10^q (w != 0) with the Eisel-Lemire algorithm.
+// Returns false in the rare cases where the 128-bit product isn't enough to decide.
+static bool
+prb_lib_eiselLemire(uint64_t w, int64_t q, double* out) {
+    bool     result = true;
+    uint64_t mantissa = 0;
+    int32_t  power2 = 0;
+    if (q < -342) {
+        power2 = 0;
+    } else if (q > 308) {
+        power2 = 0x7FF;
+    } else {
+        int32_t lz = prb_lib_leadingZeros(w);
+        w <<= lz;
+
+        int32_t  index = 2 * (int32_t)(q + 342);
+        uint64_t productHigh = 0;
+        uint64_t productLow = prb_lib_mul128(w, prb_lib_powersOfFive128[index], &productHigh);
+        uint64_t precisionMask = UINT64_MAX >> 55;
+        if ((productHigh & precisionMask) == precisionMask) {
+            uint64_t secondHigh = 0;
+            prb_lib_mul128(w, prb_lib_powersOfFive128[index + 1], &secondHigh);
+            productLow += secondHigh;
+            if (secondHigh > productLow) {
+                productHigh += 1;
             }
+        }
 
-            if (coreCount != affinityRes.setBits) {
-                if (SetProcessAffinityMask(GetCurrentProcess(), newAffinityMask)) {
-                    result = prb_Success;
+        if (productLow == UINT64_MAX && (q < -27 || q > 55)) {
+            result = false;
+        } else {
+            int32_t upperBit = (int32_t)(productHigh >> 63);
+            int32_t shift = upperBit + 64 - 52 - 3;
+            mantissa = productHigh >> shift;
+            power2 = (int32_t)(((152170 + 65536) * q) >> 16) + 63 + upperBit - lz + 1023;
+
+            if (power2 <= 0) {
+                // NOTE(khvorov) Subnormal
+                if (-power2 + 1 >= 64) {
+                    mantissa = 0;
+                    power2 = 0;
+                } else {
+                    mantissa >>= -power2 + 1;
+                    mantissa += mantissa & 1;
+                    mantissa >>= 1;
+                    power2 = mantissa < ((uint64_t)1 << 52) ? 0 : 1;
                 }
             } else {
-                result = prb_Success;
+                // NOTE(khvorov) Exactly halfway between two doubles, round to even
+                if (productLow <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 && (mantissa << shift) == productHigh) {
+                    mantissa &= ~(uint64_t)1;
+                }
+                mantissa += mantissa & 1;
+                mantissa >>= 1;
+                if (mantissa >= ((uint64_t)2 << 52)) {
+                    mantissa = (uint64_t)1 << 52;
+                    power2 += 1;
+                }
+                mantissa &= ~((uint64_t)1 << 52);
+                if (power2 >= 0x7FF) {
+                    power2 = 0x7FF;
+                    mantissa = 0;
+                }
             }
         }
+    }
 
-#elif prb_PLATFORM_LINUX
+    uint64_t bits = mantissa | ((uint64_t)power2 << 52);
+    prb_memcpy(out, &bits, sizeof(*out));
+    return result;
+}
 
-        prb_linux_GetAffinityResult affinityRes = prb_linux_getAffinity(arena);
-        if (affinityRes.success) {
-            if (coreCount > affinityRes.setBits) {
-                int32_t coresToSchedule = coreCount - affinityRes.setBits;
-                for (int32_t byteIndex = 0; byteIndex < affinityRes.size && coresToSchedule > 0; byteIndex++) {
-                    uint8_t byte = affinityRes.affinity[byteIndex];
-                    for (int32_t bitIndex = 0; bitIndex < 8 && coresToSchedule > 0; bitIndex++) {
-                        uint8_t mask = 1 << bitIndex;
-                        bool coreIsScheduled = (byte & mask) != 0;
-                        if (!coreIsScheduled) {
-                            byte = byte | mask;
-                            affinityRes.affinity[byteIndex] = byte;
-                            coresToSchedule -= 1;
-                        }
-                    }
-                }
-            } else if (coreCount < affinityRes.setBits) {
-                int32_t coresToUnschedule = affinityRes.setBits - coreCount;
-                for (int32_t byteIndex = 0; byteIndex < affinityRes.size && coresToUnschedule > 0; byteIndex++) {
-                    uint8_t byte = affinityRes.affinity[byteIndex];
-                    for (int32_t bitIndex = 0; bitIndex < 8 && coresToUnschedule > 0; bitIndex++) {
-                        uint8_t mask = 1 << bitIndex;
-                        bool coreIsScheduled = (byte & mask) != 0;
-                        if (coreIsScheduled) {
-                            byte = byte & (~mask);
-                            affinityRes.affinity[byteIndex] = byte;
-                            coresToUnschedule -= 1;
-                        }
-                    }
-                }
+// NOTE(khvorov) digits[.digits][(e|E)[+|-]digits] without a sign. The whole string has to be the number.
+static bool
+prb_lib_parseDecimalFloat(prb_Str str, double* out) {
+    uint64_t mantissa = 0;
+    int32_t  at = prb_lib_parseDecimalRun(str.ptr, str.len, &mantissa);
+    int32_t  digitCount = at;
+    int64_t  exponent = 0;
+    if (at < str.len && str.ptr[at] == '.') {
+        at += 1;
+        int32_t fractionLen = prb_lib_parseDecimalRun(str.ptr + at, str.len - at, &mantissa);
+        at += fractionLen;
+        digitCount += fractionLen;
+        exponent = -fractionLen;
+    }
+
+    bool valid = true;
+    if (at < str.len && (str.ptr[at] == 'e' || str.ptr[at] == 'E')) {
+        at += 1;
+        bool negative = false;
+        if (at < str.len && (str.ptr[at] == '+' || str.ptr[at] == '-')) {
+            negative = str.ptr[at] == '-';
+            at += 1;
+        }
+        int64_t explicitExp = 0;
+        int32_t expStart = at;
+        for (; at < str.len && str.ptr[at] >= '0' && str.ptr[at] <= '9'; at++) {
+            // NOTE(khvorov) Anything this big is 0 or infinity anyway
+            if (explicitExp < 0x10000) {
+                explicitExp = explicitExp * 10 + (str.ptr[at] - '0');
             }
+        }
+        valid = at > expStart && digitCount > 0;
+        exponent += negative ? -explicitExp : explicitExp;
+    }
+    valid = valid && at == str.len;
 
-            if (coreCount != affinityRes.setBits) {
-                int setAffinityResult = syscall(SYS_sched_setaffinity, 0, affinityRes.size, affinityRes.affinity);
-                if (setAffinityResult == 0) {
-                    result = prb_Success;
-                }
+    if (valid) {
+        // NOTE(khvorov) Leading zeros don't count towards the 19 digits that fit
+        if (digitCount > 19) {
+            for (int32_t index = 0; index < str.len && (str.ptr[index] == '0' || str.ptr[index] == '.'); index++) {
+                digitCount -= str.ptr[index] == '0';
+            }
+        }
+
+        double   powersOfTen[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+        uint64_t maxExactMantissa = (uint64_t)1 << 53;
+        if (mantissa == 0 && digitCount <= 19) {
+            *out = 0.0;
+        } else if (digitCount <= 19 && exponent >= -22 && exponent <= 22 && mantissa <= maxExactMantissa) {
+            // NOTE(khvorov) Both operands are exact doubles so the one rounding the operation does is the right one
+            double value = (double)mantissa;
+            if (exponent < 0) {
+                value /= powersOfTen[-exponent];
             } else {
-                result = prb_Success;
+                value *= powersOfTen[exponent];
+            }
+            *out = value;
+        } else if (digitCount > 19 || !prb_lib_eiselLemire(mantissa, exponent, out)) {
+            // NOTE(khvorov) The mantissa got truncated or the fast algorithm couldn't decide
+            char  buf[128];
+            char* copy = str.len < prb_arrayCount(buf) ? buf : (char*)prb_malloc((size_t)str.len + 1);
+            prb_memcpy(copy, str.ptr, (size_t)str.len);
+            copy[str.len] = '\0';
+            *out = prb_strtod(copy, 0);
+            if (copy != buf) {
+                prb_free(copy);
             }
         }
-#else
-#error unimplemented
-#endif
     }
-    prb_endTempMemory(temp);
-    return result;
+    return valid;
 }
 
-prb_PUBLICDEF prb_Process
-prb_createProcess(prb_Str cmd, prb_ProcessSpec spec) {
-    prb_Process proc;
-    prb_memset(&proc, 0, sizeof(proc));
-    proc.cmd = cmd;
-    proc.spec = spec;
-    return proc;
-}
+prb_PUBLICDEF prb_ParsedNumber
+prb_parseNumber(prb_Str str) {
+    prb_ParsedNumber number;
+    prb_memset(&number, 0, sizeof(number));
 
-prb_PUBLICDEF prb_Status
-prb_launchProcesses(prb_Arena* arena, prb_Process* procs, int32_t procCount, prb_Background mode) {
-    prb_Status     result = prb_Success;
-    prb_TempMemory temp = prb_beginTempMemory(arena);
+    bool leadingMinus = false;
+    if (str.len > 0) {
+        leadingMinus = str.ptr[0] == '-';
+        if (leadingMinus) {
+            str = prb_strSlice(str, 1, str.len);
+        }
+    }
 
-    for (int32_t procIndex = 0; procIndex < procCount; procIndex++) {
-        prb_Process* proc = procs + procIndex;
-        if (proc->status == prb_ProcessStatus_NotLaunched) {
-            prb_ProcessSpec spec = proc->spec;
+    prb_ParseUintResult intParse = {.success = false, .number = 0};
+    bool                isReal = false;
+    double              realValue = 0.0;
+    if (str.len > 0) {
+        // NOTE(khvorov) Hex integer
+        if (prb_strStartsWith(str, prb_STR("0x"))) {
+            prb_Str digits = prb_strSlice(str, 2, str.len);
+            intParse = prb_parseUint(digits, 16);
+        } else {
+            uint64_t leadingDigits = 0;
+            if (prb_lib_parseDecimalRun(str.ptr, str.len, &leadingDigits) == str.len) {
+                // NOTE(khvorov) Decimal integer, only long ones can overflow
+                if (str.len <= 19) {
+                    intParse.success = true;
+                    intParse.number = leadingDigits;
+                } else {
+                    intParse = prb_parseUint(str, 10);
+                }
+            } else {
+                // NOTE(khvorov) Real number
+                isReal = prb_lib_parseDecimalFloat(str, &realValue);
+            }
+        }
+    }
 
-#if prb_PLATFORM_WINDOWS
+    if (intParse.success) {
+        if (leadingMinus) {
+            // NOTE(khvorov) Won't be supporting parsing INT64_MIN for fear of undefined behaviour
+            if (intParse.number <= (((uint64_t)INT64_MAX))) {
+                number.kind = prb_ParsedNumberKind_I64;
+                number.parsedI64 = -((int64_t)intParse.number);
+            }
+        } else {
+            number.kind = prb_ParsedNumberKind_U64;
+            number.parsedU64 = intParse.number;
+        }
+    } else if (isReal) {
+        number.kind = prb_ParsedNumberKind_F64;
+        number.parsedF64 = realValue;
+        if (leadingMinus) {
+            number.parsedF64 *= -1.0;
+        }
+    }
 
-            STARTUPINFOW startupInfo;
-            prb_memset(&startupInfo, 0, sizeof(startupInfo));
-            startupInfo.cb = sizeof(STARTUPINFOW);
+    return number;
+}
 
-            bool    redirectSuccessful = true;
-            BOOL    inheritHandles = spec.redirectStdout || spec.redirectStderr;
-            HANDLE  handlesToClose[2] = {0, 0};
-            int32_t handlesToCloseCount = 0;
+prb_PUBLICDEF prb_ParseNumbersResult
+prb_parseNumbers(prb_Arena* arena, prb_Str str, prb_Str delimiters) {
+    prb_assert(!arena->lockedForStr);
+    prb_arenaAlignFreePtr(arena, prb_alignof(prb_ParsedNumber));
 
-            if (inheritHandles) {
-                startupInfo.dwFlags = STARTF_USESTDHANDLES;
+    // NOTE(khvorov) Written straight into the arena's free space, there can't be more numbers than every other byte
+    prb_ParseNumbersResult result = {.success = true, .errorOffset = str.len, .numbers = (prb_ParsedNumber*)prb_arenaFreePtr(arena), .count = 0};
+    prb_assert(prb_arenaFreeSize(arena) >= ((intptr_t)str.len / 2 + 1) * (intptr_t)sizeof(prb_ParsedNumber));
 
-                SECURITY_ATTRIBUTES securityAttr = {
-                    .nLength = sizeof(securityAttr),
-                    .lpSecurityDescriptor = NULL,
-                    .bInheritHandle = TRUE,
-                };
+    prb_StrFindSpec spec = {};
+    spec.mode = prb_StrFindMode_AnyChar;
+    spec.pattern = delimiters;
+    spec.alwaysMatchEnd = true;
+    prb_StrFinder finder = prb_createStrFinder(spec);
+
+    // NOTE(khvorov) Plain decimal fields are parsed in the same pass that finds their end
+    bool digitFastPath = finder.patternIsAscii;
+    for (uint8_t digit = '0'; digit <= '9'; digit++) {
+        digitFastPath = digitFastPath && !(finder.byteSet[digit >> 5] & ((uint32_t)1 << (digit & 31)));
+    }
 
-                prb_Str stdoutPath = spec.stdoutFilepath;
-                if (stdoutPath.ptr == 0 || stdoutPath.len == 0) {
-                    stdoutPath = prb_STR("NUL");
-                }
+    // NOTE(khvorov) Runs of delimiters count as one so that whitespace-separated columns work
+    for (int32_t fieldStart = 0; fieldStart < str.len && result.success;) {
+        int32_t  fieldLen = str.len - fieldStart;
+        int32_t  delimLen = 1;
+        uint64_t digitsValue = 0;
+        int32_t  digitCount = digitFastPath ? prb_lib_parseDecimalRun(str.ptr + fieldStart, prb_min(fieldLen, 19), &digitsValue) : 0;
+        uint8_t  afterDigits = digitCount < fieldLen ? (uint8_t)str.ptr[fieldStart + digitCount] : 0;
+        if (digitCount > 0 && (digitCount == fieldLen || (finder.byteSet[afterDigits >> 5] & ((uint32_t)1 << (afterDigits & 31))))) {
+            prb_ParsedNumber number = {.kind = prb_ParsedNumberKind_U64, .parsedU64 = digitsValue};
+            result.numbers[result.count++] = number;
+            fieldLen = digitCount;
+        } else {
+            if (finder.patternIsAscii) {
+                int32_t delimOffset = prb_lib_findByteSet((const uint8_t*)str.ptr + fieldStart, fieldLen, &finder, prb_StrDirection_FromStart);
+                fieldLen = delimOffset == -1 ? fieldLen : delimOffset;
+            } else {
+                prb_StrFindResult find = prb_strFinderFind(&finder, prb_strSlice(str, fieldStart, str.len));
+                fieldLen = find.beforeMatch.len;
+                delimLen = find.match.len;
+            }
+
+            if (fieldLen > 0) {
+                prb_ParsedNumber number = prb_parseNumber(prb_strSlice(str, fieldStart, fieldStart + fieldLen));
+                if (number.kind == prb_ParsedNumberKind_None) {
+                    result.success = false;
+                    result.errorOffset = fieldStart;
+                } else {
+                    result.numbers[result.count++] = number;
+                }
+            }
+        }
+        fieldStart += fieldLen + delimLen;
+    }
+    prb_arenaChangeUsed(arena, (intptr_t)result.count * (intptr_t)sizeof(prb_ParsedNumber));
+
+    return result;
+}
+
+// NOTE(khvorov) Generated sources for big assets (fonts, ICU data) go through here, so instead of formatting
+// every byte each one is a copy from a table and the whole output is reserved upfront
+prb_PUBLICDEF prb_Str
+prb_binaryToCArray(prb_Arena* arena, prb_Str arrayName, void* data, int32_t dataLen) {
+    // NOTE(khvorov) Every byte as "%x" would print it followed by ", ", the length is in the last char
+    char byteTexts[256][8];
+    for (int32_t byte = 0; byte < 256; byte++) {
+        char*   text = byteTexts[byte];
+        int32_t len = 0;
+        text[len++] = '0';
+        text[len++] = 'x';
+        if (byte >= 16) {
+            text[len++] = "0123456789abcdef"[byte >> 4];
+        }
+        text[len++] = "0123456789abcdef"[byte & 15];
+        text[len++] = ',';
+        text[len++] = ' ';
+        text[7] = (char)len;
+    }
+
+    prb_GrowingStr arrayGstr = prb_beginStr(arena);
+    prb_addStr(&arrayGstr, prb_STR("unsigned char "));
+    prb_addStr(&arrayGstr, arrayName);
+    prb_addStr(&arrayGstr, prb_STR("[] = {\n    "));
+
+    // NOTE(khvorov) 6 bytes of text per byte and 4 spaces of indent per line of 10 at most.
+    // Has to fit in a string so data past about 300MB needs one of the other forms
+    intptr_t textLen = (intptr_t)dataLen * 7 + 8;
+    prb_assert(textLen <= INT32_MAX);
+    char*          dest = prb_lib_growingStrReserve(&arrayGstr, (int32_t)textLen);
+    int32_t        written = 0;
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (int32_t byteIndex = 0; byteIndex < dataLen; byteIndex++) {
+        const char* text = byteTexts[bytes[byteIndex]];
+        prb_memcpy(dest + written, text, 8);
+        written += text[7];
+        if (byteIndex == dataLen - 1) {
+            dest[written - 2] = '\n';
+            written -= 1;
+        } else if ((byteIndex + 1) % 10 == 0) {
+            prb_memcpy(dest + written - 1, "\n    ", 5);
+            written += 4;
+        }
+    }
+    prb_lib_growingStrCommit(&arrayGstr, written);
+
+    prb_addStr(&arrayGstr, prb_STR("};"));
+    prb_Str arrayStr = prb_endStr(&arrayGstr);
+    return arrayStr;
+}
+
+// NOTE(khvorov) Compilers get through one long string literal much faster than through an initializer list.
+// Octal escapes are always 3 digits so that a digit that follows isn't taken as part of one.
+// The array ends up one byte longer than the data because of the null terminator.
+// MSVC caps string literals at 64KB so it needs one of the other forms for anything bigger.
+prb_PUBLICDEF prb_Str
+prb_binaryToCString(prb_Arena* arena, prb_Str arrayName, void* data, int32_t dataLen) {
+    char byteTexts[256][4];
+    for (int32_t byte = 0; byte < 256; byte++) {
+        char* text = byteTexts[byte];
+        if (byte >= 0x20 && byte < 0x7F && byte != '"' && byte != '\\' && byte != '?') {
+            text[0] = (char)byte;
+            text[1] = text[2] = text[3] = 0;
+        } else {
+            text[0] = '\\';
+            text[1] = (char)('0' + (byte >> 6));
+            text[2] = (char)('0' + ((byte >> 3) & 7));
+            text[3] = (char)('0' + (byte & 7));
+        }
+    }
+
+    prb_GrowingStr arrayGstr = prb_beginStr(arena);
+    prb_addStr(&arrayGstr, prb_STR("unsigned char "));
+    prb_addStr(&arrayGstr, arrayName);
+    prb_addStr(&arrayGstr, prb_STR("[] =\n    \""));
+
+    int32_t  bytesPerLine = 128;
+    intptr_t textLen = (intptr_t)dataLen * 4 + ((intptr_t)dataLen / bytesPerLine + 1) * 7;
+    prb_assert(textLen <= INT32_MAX);
+    char*          dest = prb_lib_growingStrReserve(&arrayGstr, (int32_t)textLen);
+    int32_t        written = 0;
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (int32_t byteIndex = 0; byteIndex < dataLen; byteIndex++) {
+        uint8_t     byte = bytes[byteIndex];
+        const char* text = byteTexts[byte];
+        prb_memcpy(dest + written, text, 4);
+        written += text[0] == '\\' ? 4 : 1;
+        if ((byteIndex + 1) % bytesPerLine == 0 && byteIndex != dataLen - 1) {
+            prb_memcpy(dest + written, "\"\n    \"", 7);
+            written += 7;
+        }
+    }
+    prb_lib_growingStrCommit(&arrayGstr, written);
+
+    prb_addStr(&arrayGstr, prb_STR("\";"));
+    prb_Str arrayStr = prb_endStr(&arrayGstr);
+    return arrayStr;
+}
+
+prb_PUBLICDEF prb_EmbedFileResult
+prb_embedFile(prb_Arena* arena, prb_Str name, prb_Str path, prb_EmbedKind kind) {
+    prb_EmbedFileResult result = {.success = false, .str = {0, 0}};
+    switch (kind) {
+        case prb_EmbedKind_CArray:
+        case prb_EmbedKind_CString: {
+            prb_ReadEntireFileResult readRes = prb_readEntireFile(arena, path);
+            if (readRes.success) {
+                result.success = true;
+                if (kind == prb_EmbedKind_CArray) {
+                    result.str = prb_binaryToCArray(arena, name, readRes.content.data, readRes.content.len);
+                } else {
+                    result.str = prb_binaryToCString(arena, name, readRes.content.data, readRes.content.len);
+                }
+            }
+        } break;
+
+        // NOTE(khvorov) The compiler (or assembler) reads the file itself. Absolute paths with forward slashes
+        // work wherever the generated file ends up and need no escaping on windows.
+        case prb_EmbedKind_CEmbedDirective:
+        case prb_EmbedKind_AsmIncbin: {
+            if (prb_isFile(arena, path)) {
+                result.success = true;
+                prb_Str        absPath = prb_getAbsolutePath(arena, path);
+                char*          slashPath = (char*)prb_strGetNullTerminated(arena, absPath);
+                prb_GrowingStr gstr = prb_beginStr(arena);
+                for (int32_t index = 0; index < absPath.len; index++) {
+                    slashPath[index] = slashPath[index] == '\\' ? '/' : slashPath[index];
+                }
+                prb_Str quotedPath = prb_STR(slashPath);
+                if (kind == prb_EmbedKind_CEmbedDirective) {
+                    prb_addStr(&gstr, prb_STR("unsigned char "));
+                    prb_addStr(&gstr, name);
+                    prb_addStr(&gstr, prb_STR("[] = {\n#embed \""));
+                    prb_addStr(&gstr, quotedPath);
+                    prb_addStr(&gstr, prb_STR("\"\n};\n"));
+                } else {
+                    // NOTE(khvorov) C sees these as extern const unsigned char name[] and extern const uint64_t name_size
+                    prb_addStrSegment(
+                        &gstr,
+                        "#if defined(_WIN32)\n"
+                        "    .section .rdata,\"dr\"\n"
+                        "#else\n"
+                        "    .section .note.GNU-stack,\"\",@progbits\n"
+                        "    .section .rodata\n"
+                        "#endif\n"
+                        "    .global %.*s\n"
+                        "    .global %.*s_size\n"
+                        "    .balign 16\n"
+                        "%.*s:\n"
+                        "    .incbin \"%.*s\"\n"
+                        "%.*s_end:\n"
+                        "    .balign 8\n"
+                        "%.*s_size:\n"
+                        "    .quad %.*s_end - %.*s\n",
+                        prb_LIT(name),
+                        prb_LIT(name),
+                        prb_LIT(name),
+                        prb_LIT(quotedPath),
+                        prb_LIT(name),
+                        prb_LIT(name),
+                        prb_LIT(name),
+                        prb_LIT(name)
+                    );
+                }
+                result.str = prb_endStr(&gstr);
+            }
+        } break;
+    }
+    return result;
+}
+
+// NOTE(khvorov) In-memory hash along the lines of wyhash: 16 bytes per multiply with the halves of the
+// 128-bit product folded together. Not stable across versions, stored hashes use prb_stbds_hash_bytes.
+static uint64_t
+prb_lib_hashMix(uint64_t a, uint64_t b) {
+    uint64_t high = 0;
+    uint64_t low = prb_lib_mul128(a, b, &high);
+    uint64_t result = low ^ high;
+    return result;
+}
+
+prb_PUBLICDEF uint64_t
+prb_hashBytes(const void* data, int32_t len, uint64_t seed) {
+    prb_assert(len >= 0);
+    const uint64_t secret[] = {0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL, 0x8ebc6af09c88c6e3ULL};
+    const char*    bytes = (const char*)data;
+    uint64_t       state = seed ^ prb_lib_hashMix(seed ^ secret[0], secret[1]);
+
+    int32_t at = 0;
+    for (; len - at > 16; at += 16) {
+        state = prb_lib_hashMix(prb_lib_loadU64(bytes + at) ^ secret[1], prb_lib_loadU64(bytes + at + 8) ^ state);
+    }
+
+    // NOTE(khvorov) The last 1 to 16 bytes, overlapping loads cover the lengths in between
+    int32_t  rest = len - at;
+    uint64_t a = 0;
+    uint64_t b = 0;
+    if (rest >= 8) {
+        a = prb_lib_loadU64(bytes + at);
+        b = prb_lib_loadU64(bytes + len - 8);
+    } else if (rest >= 4) {
+        uint32_t first = 0;
+        uint32_t last = 0;
+        prb_memcpy(&first, bytes + at, sizeof(first));
+        prb_memcpy(&last, bytes + len - 4, sizeof(last));
+        a = ((uint64_t)first << 32) | last;
+    } else if (rest > 0) {
+        a = ((uint64_t)(uint8_t)bytes[at] << 16) | ((uint64_t)(uint8_t)bytes[at + rest / 2] << 8) | (uint8_t)bytes[len - 1];
+    }
+    uint64_t result = prb_lib_hashMix(secret[2] ^ (uint64_t)len, prb_lib_hashMix(a ^ secret[1], b ^ state));
+    return result;
+}
+
+prb_PUBLICDEF uint64_t
+prb_hashStr(prb_Str str) {
+    uint64_t result = prb_hashBytes(str.ptr, str.len, 0);
+    return result;
+}
+
+prb_PUBLICDEF prb_StrInterner
+prb_createStrInterner(prb_Arena* arena, prb_ThreadSafe threadSafe) {
+    prb_StrInterner result = {.arena = arena, .threadSafe = threadSafe, .lock = 0, .slots = 0, .slotsCount = 64, .count = 0};
+    result.slots = prb_arenaAllocArray(arena, prb_InternedStr*, result.slotsCount);
+    return result;
+}
+
+// NOTE(khvorov) Open addressing with linear probing, returns the slot with the string or the empty one where it would go
+static int32_t
+prb_lib_internerSlot(prb_StrInterner* interner, prb_Str str, uint64_t hash) {
+    int32_t mask = interner->slotsCount - 1;
+    int32_t result = (int32_t)(hash & (uint64_t)mask);
+    for (;;) {
+        prb_InternedStr* entry = interner->slots[result];
+        if (!entry || (entry->hash == hash && prb_streq(entry->str, str))) {
+            break;
+        }
+        result = (result + 1) & mask;
+    }
+    return result;
+}
+
+prb_PUBLICDEF prb_InternedStr*
+prb_internStr(prb_StrInterner* interner, prb_Str str) {
+    if (interner->threadSafe == prb_ThreadSafe_Yes) {
+        prb_lib_spinLock(&interner->lock);
+    }
+
+    uint64_t         hash = prb_hashStr(str);
+    int32_t          slot = prb_lib_internerSlot(interner, str, hash);
+    prb_InternedStr* result = interner->slots[slot];
+    if (!result) {
+        // NOTE(khvorov) Old tables stay in the arena, together they are no bigger than the current one
+        if ((interner->count + 1) * 4 > interner->slotsCount * 3) {
+            prb_InternedStr** oldSlots = interner->slots;
+            int32_t           oldSlotsCount = interner->slotsCount;
+            interner->slotsCount *= 2;
+            interner->slots = prb_arenaAllocArray(interner->arena, prb_InternedStr*, interner->slotsCount);
+            for (int32_t oldSlot = 0; oldSlot < oldSlotsCount; oldSlot++) {
+                prb_InternedStr* entry = oldSlots[oldSlot];
+                if (entry) {
+                    interner->slots[prb_lib_internerSlot(interner, entry->str, entry->hash)] = entry;
+                }
+            }
+            slot = prb_lib_internerSlot(interner, str, hash);
+        }
+
+        result = prb_arenaAllocArray(interner->arena, prb_InternedStr, 1);
+        char* copy = (char*)prb_arenaAllocAndZero(interner->arena, str.len + 1, 1);
+        prb_memcpy(copy, str.ptr, (size_t)str.len);
+        result->str = (prb_Str) {copy, str.len};
+        result->hash = hash;
+        result->id = interner->count++;
+        interner->slots[slot] = result;
+    }
+
+    if (interner->threadSafe == prb_ThreadSafe_Yes) {
+        prb_lib_spinUnlock(&interner->lock);
+    }
+    return result;
+}
+
+prb_PUBLICDEF prb_InternedStr*
+prb_findInternedStr(prb_StrInterner* interner, prb_Str str) {
+    if (interner->threadSafe == prb_ThreadSafe_Yes) {
+        prb_lib_spinLock(&interner->lock);
+    }
+    prb_InternedStr* result = 0;
+    if (interner->slotsCount > 0) {
+        result = interner->slots[prb_lib_internerSlot(interner, str, prb_hashStr(str))];
+    }
+    if (interner->threadSafe == prb_ThreadSafe_Yes) {
+        prb_lib_spinUnlock(&interner->lock);
+    }
+    return result;
+}
+
+// NOTE(khvorov) Control bytes are 0x80 for empty slots and the top 7 bits of the hash for full ones.
+// The first group is repeated past the end so that a group can start at any slot.
+static uint32_t
+prb_lib_strMapGroupMatch(const uint8_t* group, uint8_t ctrl) {
+#if prb_SIMD_SSE2
+    uint32_t result = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)group), _mm_set1_epi8((char)ctrl)));
+#elif prb_SIMD_NEON
+    const uint8_t laneBitBytes[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t    hitBits = vandq_u8(vceqq_u8(vld1q_u8(group), vdupq_n_u8(ctrl)), vld1q_u8(laneBitBytes));
+    uint32_t      result = (uint32_t)vaddv_u8(vget_low_u8(hitBits)) | ((uint32_t)vaddv_u8(vget_high_u8(hitBits)) << 8);
+#else
+    uint32_t result = 0;
+    for (int32_t lane = 0; lane < 16; lane++) {
+        result |= (uint32_t)(group[lane] == ctrl) << lane;
+    }
+#endif
+    return result;
+}
+
+static void
+prb_lib_strMapSetCtrl(prb_StrMap* map, int32_t slot, uint8_t ctrl) {
+    map->ctrl[slot] = ctrl;
+    if (slot < 16) {
+        map->ctrl[map->slotsCount + slot] = ctrl;
+    }
+}
+
+// NOTE(khvorov) Probes a group of 16 slots at a time, returns the slot with the key or the empty one where it would go
+static int32_t
+prb_lib_strMapSlot(prb_StrMap* map, prb_Str key, uint64_t hash) {
+    int32_t mask = map->slotsCount - 1;
+    uint8_t tag = (uint8_t)(hash >> 57);
+    int32_t result = -1;
+    for (int32_t groupStart = (int32_t)(hash & (uint64_t)mask); result == -1; groupStart = (groupStart + 16) & mask) {
+        const uint8_t* group = map->ctrl + groupStart;
+        for (uint32_t hits = prb_lib_strMapGroupMatch(group, tag); hits != 0 && result == -1; hits &= hits - 1) {
+            int32_t          slot = (groupStart + prb_lib_lowestBit(hits)) & mask;
+            prb_StrMapEntry* entry = map->entries + map->slots[slot];
+            if (entry->hash == hash && prb_streq(entry->key, key)) {
+                result = slot;
+            }
+        }
+        if (result == -1) {
+            uint32_t empties = prb_lib_strMapGroupMatch(group, 0x80);
+            if (empties != 0) {
+                result = (groupStart + prb_lib_lowestBit(empties)) & mask;
+            }
+        }
+    }
+    return result;
+}
+
+// NOTE(khvorov) The table is kept at most 7/8 full so every probe runs into an empty slot eventually.
+// Entries are allocated for the same count so they grow together, old arrays stay in the arena.
+static void
+prb_lib_strMapAllocSlots(prb_StrMap* map, int32_t slotsCount) {
+    prb_StrMapEntry* oldEntries = map->entries;
+    map->slotsCount = slotsCount;
+    map->ctrl = (uint8_t*)prb_arenaAllocAndZero(map->arena, slotsCount + 16, 16);
+    prb_memset(map->ctrl, 0x80, (size_t)(slotsCount + 16));
+    map->slots = prb_arenaAllocArray(map->arena, int32_t, slotsCount);
+    map->entries = prb_arenaAllocArray(map->arena, prb_StrMapEntry, slotsCount / 8 * 7);
+    if (map->count > 0) {
+        prb_memcpy(map->entries, oldEntries, (size_t)map->count * sizeof(prb_StrMapEntry));
+    }
+    for (int32_t entryIndex = 0; entryIndex < map->count; entryIndex++) {
+        prb_StrMapEntry* entry = map->entries + entryIndex;
+        int32_t          slot = prb_lib_strMapSlot(map, entry->key, entry->hash);
+        prb_lib_strMapSetCtrl(map, slot, (uint8_t)(entry->hash >> 57));
+        map->slots[slot] = entryIndex;
+    }
+}
+
+prb_PUBLICDEF prb_StrMap
+prb_createStrMap(prb_Arena* arena, int32_t expectedCount) {
+    prb_StrMap result = {.arena = arena, .ctrl = 0, .slots = 0, .slotsCount = 0, .entries = 0, .count = 0};
+    int32_t    slotsCount = 16;
+    while (slotsCount / 8 * 7 < expectedCount) {
+        slotsCount *= 2;
+    }
+    prb_lib_strMapAllocSlots(&result, slotsCount);
+    return result;
+}
+
+prb_PUBLICDEF prb_StrMapEntry*
+prb_strMapAdd(prb_StrMap* map, prb_Str key) {
+    prb_StrMapEntry* result = prb_strMapAddHashed(map, key, prb_hashStr(key));
+    return result;
+}
+
+// NOTE(khvorov) The hash has to be prb_hashStr of the key, interned strings already have it
+prb_PUBLICDEF prb_StrMapEntry*
+prb_strMapAddHashed(prb_StrMap* map, prb_Str key, uint64_t hash) {
+    int32_t slot = prb_lib_strMapSlot(map, key, hash);
+    if (map->ctrl[slot] == 0x80) {
+        if (map->count + 1 > map->slotsCount / 8 * 7) {
+            prb_lib_strMapAllocSlots(map, map->slotsCount * 2);
+            slot = prb_lib_strMapSlot(map, key, hash);
+        }
+        prb_StrMapEntry entry = {.key = key, .hash = hash, .value = 0};
+        map->entries[map->count] = entry;
+        prb_lib_strMapSetCtrl(map, slot, (uint8_t)(hash >> 57));
+        map->slots[slot] = map->count++;
+    }
+    prb_StrMapEntry* result = map->entries + map->slots[slot];
+    return result;
+}
+
+prb_PUBLICDEF prb_StrMapEntry*
+prb_strMapFind(prb_StrMap* map, prb_Str key) {
+    prb_StrMapEntry* result = prb_strMapFindHashed(map, key, prb_hashStr(key));
+    return result;
+}
+
+prb_PUBLICDEF prb_StrMapEntry*
+prb_strMapFindHashed(prb_StrMap* map, prb_Str key, uint64_t hash) {
+    prb_StrMapEntry* result = 0;
+    if (map->slotsCount > 0) {
+        int32_t slot = prb_lib_strMapSlot(map, key, hash);
+        if (map->ctrl[slot] != 0x80) {
+            result = map->entries + map->slots[slot];
+        }
+    }
+    return result;
+}
+
+prb_PUBLICDEF prb_SharedStrMap
+prb_createSharedStrMap(prb_Arena* arena) {
+    prb_SharedStrMap result = {};
+    result.arena = arena;
+    // NOTE(khvorov) The map struct itself can be anywhere so the shards go in the arena where they can be aligned to a cache line
+    result.shards = (prb_SharedStrMapShard*)prb_arenaAllocAndZero(arena, prb_SHARED_STR_MAP_SHARDS * (int32_t)sizeof(prb_SharedStrMapShard), 64);
+    return result;
+}
+
+// NOTE(khvorov) Shards are picked by the top bits of the hash and slots by the bottom ones
+static prb_SharedStrMapShard*
+prb_lib_sharedStrMapShard(prb_SharedStrMap* map, uint64_t hash) {
+    prb_SharedStrMapShard* result = map->shards + (hash >> 58);
+    return result;
+}
+
+static prb_StrMapEntry*
+prb_lib_sharedStrMapProbe(prb_SharedStrMapTable* table, prb_Str key, uint64_t hash, int32_t* slotOut) {
+    prb_StrMapEntry* result = 0;
+    int32_t          mask = table->slotsCount - 1;
+    int32_t          slot = (int32_t)(hash & (uint64_t)mask);
+    for (;;) {
+        prb_StrMapEntry* entry = (prb_StrMapEntry*)prb_atomicLoadPtr((void* volatile*)(table->slots + slot));
+        if (!entry || (entry->hash == hash && prb_streq(entry->key, key))) {
+            result = entry;
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    *slotOut = slot;
+    return result;
+}
+
+// NOTE(khvorov) Called with the shard locked. The arena lock is only taken for a new chunk or an allocation
+// too big to come out of one (bigger tables).
+static void*
+prb_lib_sharedStrMapAlloc(prb_SharedStrMap* map, prb_SharedStrMapShard* shard, int32_t size, int32_t align) {
+    int32_t chunkSize = 4 * prb_KILOBYTE;
+    void*   result = 0;
+    if (size > chunkSize / 4) {
+        prb_lib_spinLock(&map->arenaLock);
+        result = prb_arenaAllocAndZero(map->arena, size, align);
+        prb_lib_spinUnlock(&map->arenaLock);
+    } else {
+        int32_t offset = shard->chunk ? prb_getOffsetForAlignment(shard->chunk, align) : 0;
+        if (!shard->chunk || offset + size > shard->chunkEnd - shard->chunk) {
+            prb_lib_spinLock(&map->arenaLock);
+            shard->chunk = (uint8_t*)prb_arenaAllocAndZero(map->arena, chunkSize, 64);
+            prb_lib_spinUnlock(&map->arenaLock);
+            shard->chunkEnd = shard->chunk + chunkSize;
+            offset = 0;
+        }
+        result = shard->chunk + offset;
+        shard->chunk += offset + size;
+    }
+    return result;
+}
+
+// NOTE(khvorov) The bigger table is filled before it's published so readers only ever see complete tables
+prb_PUBLICDEF prb_StrMapEntry*
+prb_sharedStrMapAdd(prb_SharedStrMap* map, prb_Str key, uint64_t value) {
+    uint64_t               hash = prb_hashStr(key);
+    prb_SharedStrMapShard* shard = prb_lib_sharedStrMapShard(map, hash);
+    prb_lib_spinLock(&shard->lock);
+
+    prb_SharedStrMapTable* table = shard->table;
+    prb_StrMapEntry*       result = 0;
+    int32_t                slot = 0;
+    if (table) {
+        result = prb_lib_sharedStrMapProbe(table, key, hash, &slot);
+    }
+
+    if (!result) {
+        if (!table || (shard->count + 1) * 4 > table->slotsCount * 3) {
+            int32_t                slotsCount = table ? table->slotsCount * 2 : 16;
+            prb_SharedStrMapTable* newTable = (prb_SharedStrMapTable*)prb_lib_sharedStrMapAlloc(map, shard, (int32_t)sizeof(prb_SharedStrMapTable), prb_alignof(prb_SharedStrMapTable));
+            newTable->slotsCount = slotsCount;
+            newTable->slots = (prb_StrMapEntry**)prb_lib_sharedStrMapAlloc(map, shard, slotsCount * (int32_t)sizeof(prb_StrMapEntry*), prb_alignof(prb_StrMapEntry*));
+            for (int32_t oldSlot = 0; table && oldSlot < table->slotsCount; oldSlot++) {
+                prb_StrMapEntry* entry = table->slots[oldSlot];
+                if (entry) {
+                    int32_t newSlot = 0;
+                    prb_lib_sharedStrMapProbe(newTable, entry->key, entry->hash, &newSlot);
+                    newTable->slots[newSlot] = entry;
+                }
+            }
+            prb_atomicStorePtr((void* volatile*)&shard->table, newTable);
+            table = newTable;
+            prb_lib_sharedStrMapProbe(table, key, hash, &slot);
+        }
+
+        result = (prb_StrMapEntry*)prb_lib_sharedStrMapAlloc(map, shard, (int32_t)sizeof(prb_StrMapEntry), prb_alignof(prb_StrMapEntry));
+        char* keyCopy = (char*)prb_lib_sharedStrMapAlloc(map, shard, key.len + 1, 1);
+        prb_memcpy(keyCopy, key.ptr, (size_t)key.len);
+        result->key = (prb_Str) {keyCopy, key.len};
+        result->hash = hash;
+        result->value = value;
+        prb_atomicStorePtr((void* volatile*)(table->slots + slot), result);
+        shard->count += 1;
+    }
+
+    prb_lib_spinUnlock(&shard->lock);
+    return result;
+}
+
+prb_PUBLICDEF prb_StrMapEntry*
+prb_sharedStrMapFind(prb_SharedStrMap* map, prb_Str key) {
+    uint64_t               hash = prb_hashStr(key);
+    prb_SharedStrMapShard* shard = prb_lib_sharedStrMapShard(map, hash);
+    prb_SharedStrMapTable* table = (prb_SharedStrMapTable*)prb_atomicLoadPtr((void* volatile*)&shard->table);
+    prb_StrMapEntry*       result = 0;
+    if (table) {
+        int32_t slot = 0;
+        result = prb_lib_sharedStrMapProbe(table, key, hash, &slot);
+    }
+    return result;
+}
+
+prb_PUBLICDEF prb_MultiFinder
+prb_createMultiFinder(prb_Arena* arena, prb_Str* patterns, int32_t patternsCount) {
+    prb_assert(patternsCount > 0);
+    prb_MultiFinder result = {};
+    result.patterns = patterns;
+    result.patternsCount = patternsCount;
+
+    // NOTE(khvorov) Rows are only as wide as the alphabet of the patterns
+    int64_t totalLen = 0;
+    int32_t minLen = INT32_MAX;
+    result.classCount = 1;
+    for (int32_t patIndex = 0; patIndex < patternsCount; patIndex++) {
+        prb_Str pattern = patterns[patIndex];
+        prb_assert(pattern.len > 0);
+        totalLen += pattern.len;
+        minLen = prb_min(minLen, pattern.len);
+        for (int32_t byteIndex = 0; byteIndex < pattern.len; byteIndex++) {
+            uint8_t byte = (uint8_t)pattern.ptr[byteIndex];
+            if (result.byteClasses[byte] == 0) {
+                result.byteClasses[byte] = (uint16_t)result.classCount++;
+            }
+        }
+    }
+
+    int32_t maxStates = (int32_t)totalLen + 1;
+    prb_assert((totalLen + 1) * result.classCount <= INT32_MAX);
+    result.transitions = prb_arenaAllocArray(arena, int32_t, maxStates * result.classCount);
+    result.statePatterns = prb_arenaAllocArray(arena, int32_t, maxStates);
+    result.outputLinks = prb_arenaAllocArray(arena, int32_t, maxStates);
+    result.samePatternNext = prb_arenaAllocArray(arena, int32_t, patternsCount);
+    for (int32_t state = 0; state < maxStates; state++) {
+        result.statePatterns[state] = -1;
+    }
+    for (int32_t patIndex = 0; patIndex < patternsCount; patIndex++) {
+        result.samePatternNext[patIndex] = -1;
+    }
+
+    // NOTE(khvorov) The trie first. The root is state 0 and can't be anyone's child so 0 doubles as a missing edge.
+    // Patterns that are the same string are chained in index order on the state they end at.
+    result.stateCount = 1;
+    for (int32_t patIndex = 0; patIndex < patternsCount; patIndex++) {
+        prb_Str pattern = patterns[patIndex];
+        int32_t state = 0;
+        for (int32_t byteIndex = 0; byteIndex < pattern.len; byteIndex++) {
+            int32_t* edge = result.transitions + state * result.classCount + result.byteClasses[(uint8_t)pattern.ptr[byteIndex]];
+            if (*edge == 0) {
+                *edge = result.stateCount++;
+            }
+            state = *edge;
+        }
+        int32_t* last = result.statePatterns + state;
+        while (*last != -1) {
+            last = result.samePatternNext + *last;
+        }
+        *last = patIndex;
+    }
+
+    // NOTE(khvorov) Breadth-first so that the fail state of every state already has its complete row
+    {
+        prb_TempMemory temp = prb_beginTempMemory(arena);
+        int32_t*       failStates = prb_arenaAllocArray(arena, int32_t, result.stateCount);
+        int32_t*       queue = prb_arenaAllocArray(arena, int32_t, result.stateCount);
+        int32_t        queueHead = 0;
+        int32_t        queueTail = 0;
+        queue[queueTail++] = 0;
+        result.outputLinks[0] = -1;
+        while (queueHead < queueTail) {
+            int32_t  state = queue[queueHead++];
+            int32_t* row = result.transitions + state * result.classCount;
+            int32_t* failRow = result.transitions + failStates[state] * result.classCount;
+            for (int32_t classIndex = 0; classIndex < result.classCount; classIndex++) {
+                int32_t child = row[classIndex];
+                if (child != 0) {
+                    int32_t fail = state == 0 ? 0 : failRow[classIndex];
+                    failStates[child] = fail;
+                    result.outputLinks[child] = result.statePatterns[fail] != -1 ? fail : result.outputLinks[fail];
+                    queue[queueTail++] = child;
+                } else if (state != 0) {
+                    row[classIndex] = failRow[classIndex];
+                }
+            }
+        }
+        prb_endTempMemory(temp);
+    }
+
+    // NOTE(khvorov) Row offsets save a multiply per byte and the sign saves a lookup to see if there is a match
+    for (int32_t index = 0; index < result.stateCount * result.classCount; index++) {
+        int32_t next = result.transitions[index];
+        bool    matches = result.statePatterns[next] != -1 || result.outputLinks[next] != -1;
+        result.transitions[index] = matches ? ~(next * result.classCount) : next * result.classCount;
+    }
+
+    result.rootSkip = true;
+    for (int32_t patIndex = 0; patIndex < patternsCount; patIndex++) {
+        uint8_t first = (uint8_t)patterns[patIndex].ptr[0];
+        result.rootSkip = result.rootSkip && first < 0b10000000;
+        prb_lib_addToByteSet(&result.firstBytes, first);
+    }
+
+#if prb_SIMD_SSSE3 || prb_SIMD_AVX2 || prb_SIMD_NEON
+    result.teddy = patternsCount <= (int32_t)prb_arrayCount(result.teddyBuckets);
+#endif
+    if (result.teddy) {
+        result.teddyLen = prb_min(minLen, 3);
+
+        // NOTE(khvorov) With more patterns than the 8 buckets, ones with close prefixes share a bucket
+        // so that a candidate is checked against fewer patterns that can't be there
+        int32_t  order[prb_arrayCount(result.teddyBuckets)] = {};
+        uint32_t prefixes[prb_arrayCount(result.teddyBuckets)] = {};
+        for (int32_t patIndex = 0; patIndex < patternsCount; patIndex++) {
+            for (int32_t byteIndex = 0; byteIndex < result.teddyLen; byteIndex++) {
+                prefixes[patIndex] = (prefixes[patIndex] << 8) | (uint8_t)patterns[patIndex].ptr[byteIndex];
+            }
+            int32_t rank = patIndex;
+            for (; rank > 0 && prefixes[order[rank - 1]] > prefixes[patIndex]; rank--) {
+                order[rank] = order[rank - 1];
+            }
+            order[rank] = patIndex;
+        }
+
+        for (int32_t rank = 0; rank < patternsCount; rank++) {
+            int32_t patIndex = order[rank];
+            uint8_t bucket = (uint8_t)(1 << (rank * 8 / patternsCount));
+            result.teddyBuckets[patIndex] = bucket;
+            for (int32_t byteIndex = 0; byteIndex < result.teddyLen; byteIndex++) {
+                uint8_t byte = (uint8_t)patterns[patIndex].ptr[byteIndex];
+                result.teddyLowMasks[byteIndex][byte & 0x0F] |= bucket;
+                result.teddyHighMasks[byteIndex][byte >> 4] |= bucket;
+            }
+        }
+    }
+
+    return result;
+}
+
+// NOTE(khvorov) Kept in order of offset and then pattern index. Aho-Corasick finds matches by where they end
+// so a match might move back past the few that end earlier but start later.
+static void
+prb_lib_pushMultiFindMatch(prb_MultiFindResult* result, int32_t capacity, int32_t patternIndex, int32_t offset) {
+    prb_assert(result->count < capacity);
+    int32_t index = result->count++;
+    for (; index > 0; index--) {
+        prb_MultiFindMatch prev = result->matches[index - 1];
+        if (prev.offset < offset || (prev.offset == offset && prev.patternIndex < patternIndex)) {
+            break;
+        }
+        result->matches[index] = prev;
+    }
+    result->matches[index].patternIndex = patternIndex;
+    result->matches[index].offset = offset;
+}
+
+static void
+prb_lib_multiFindAhoCorasick(prb_MultiFinder* finder, prb_Str str, prb_MultiFindResult* result, int32_t capacity) {
+    const int32_t*  transitions = finder->transitions;
+    const uint16_t* byteClasses = finder->byteClasses;
+    int32_t         row = 0;
+    for (int32_t at = 0; at < str.len; at++) {
+        if (row == 0 && finder->rootSkip) {
+            int32_t skip = prb_lib_findByteSet((const uint8_t*)str.ptr + at, str.len - at, &finder->firstBytes, prb_StrDirection_FromStart);
+            if (skip == -1) {
+                break;
+            }
+            at += skip;
+        }
+
+        row = transitions[row + byteClasses[(uint8_t)str.ptr[at]]];
+        if (row < 0) {
+            row = ~row;
+            for (int32_t state = row / finder->classCount; state != -1; state = finder->outputLinks[state]) {
+                for (int32_t patIndex = finder->statePatterns[state]; patIndex != -1; patIndex = finder->samePatternNext[patIndex]) {
+                    prb_lib_pushMultiFindMatch(result, capacity, patIndex, at + 1 - finder->patterns[patIndex].len);
+                }
+            }
+        }
+    }
+}
+
+static void
+prb_lib_teddyVerify(prb_MultiFinder* finder, prb_Str str, int32_t at, uint8_t buckets, prb_MultiFindResult* result, int32_t capacity) {
+    for (int32_t patIndex = 0; patIndex < finder->patternsCount; patIndex++) {
+        prb_Str pattern = finder->patterns[patIndex];
+        if ((finder->teddyBuckets[patIndex] & buckets) && pattern.len <= str.len - at && prb_memeq(str.ptr + at, pattern.ptr, pattern.len)) {
+            prb_lib_pushMultiFindMatch(result, capacity, patIndex, at);
+        }
+    }
+}
+
+static void
+prb_lib_teddyScalar(prb_MultiFinder* finder, prb_Str str, int32_t from, prb_MultiFindResult* result, int32_t capacity) {
+    for (int32_t at = from; at <= str.len - finder->teddyLen; at++) {
+        uint8_t buckets = 0xFF;
+        for (int32_t byteIndex = 0; byteIndex < finder->teddyLen; byteIndex++) {
+            uint8_t byte = (uint8_t)str.ptr[at + byteIndex];
+            buckets &= finder->teddyLowMasks[byteIndex][byte & 0x0F] & finder->teddyHighMasks[byteIndex][byte >> 4];
+        }
+        if (buckets != 0) {
+            prb_lib_teddyVerify(finder, str, at, buckets, result, capacity);
+        }
+    }
+}
+
+// NOTE(khvorov) Teddy: every position gets the buckets whose patterns could start there by and-ing nibble lookups
+// of its first teddyLen bytes. Vector kernels return where they stopped, the scalar version does the tail.
+
+#if prb_SIMD_SSSE3
+
+prb_SSSE3_TARGET static int32_t
+prb_lib_teddySsse3(prb_MultiFinder* finder, prb_Str str, prb_MultiFindResult* result, int32_t capacity) {
+    __m128i lowMasks[3];
+    __m128i highMasks[3];
+    for (int32_t byteIndex = 0; byteIndex < finder->teddyLen; byteIndex++) {
+        lowMasks[byteIndex] = _mm_loadu_si128((const __m128i*)finder->teddyLowMasks[byteIndex]);
+        highMasks[byteIndex] = _mm_loadu_si128((const __m128i*)finder->teddyHighMasks[byteIndex]);
+    }
+    __m128i nibble = _mm_set1_epi8(0x0F);
+
+    int32_t at = 0;
+    for (; at + 16 + finder->teddyLen - 1 <= str.len; at += 16) {
+        __m128i buckets = _mm_set1_epi8((char)0xFF);
+        for (int32_t byteIndex = 0; byteIndex < finder->teddyLen; byteIndex++) {
+            __m128i bytes = _mm_loadu_si128((const __m128i*)(str.ptr + at + byteIndex));
+            __m128i lowBits = _mm_shuffle_epi8(lowMasks[byteIndex], _mm_and_si128(bytes, nibble));
+            __m128i highBits = _mm_shuffle_epi8(highMasks[byteIndex], _mm_and_si128(_mm_srli_epi16(bytes, 4), nibble));
+            buckets = _mm_and_si128(buckets, _mm_and_si128(lowBits, highBits));
+        }
+        uint64_t mask = ~(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(buckets, _mm_setzero_si128())) & 0xFFFF;
+        if (mask != 0) {
+            uint8_t laneBuckets[16];
+            _mm_storeu_si128((__m128i*)laneBuckets, buckets);
+            for (; mask != 0; mask &= mask - 1) {
+                int32_t lane = prb_lib_lowestBit(mask);
+                prb_lib_teddyVerify(finder, str, at + lane, laneBuckets[lane], result, capacity);
+            }
+        }
+    }
+    return at;
+}
+
+#endif
+
+#if prb_SIMD_AVX2
+
+prb_AVX2_TARGET static int32_t
+prb_lib_teddyAvx2(prb_MultiFinder* finder, prb_Str str, prb_MultiFindResult* result, int32_t capacity) {
+    __m256i lowMasks[3];
+    __m256i highMasks[3];
+    for (int32_t byteIndex = 0; byteIndex < finder->teddyLen; byteIndex++) {
+        lowMasks[byteIndex] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)finder->teddyLowMasks[byteIndex]));
+        highMasks[byteIndex] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)finder->teddyHighMasks[byteIndex]));
+    }
+    __m256i nibble = _mm256_set1_epi8(0x0F);
+
+    int32_t at = 0;
+    for (; at + 32 + finder->teddyLen - 1 <= str.len; at += 32) {
+        __m256i buckets = _mm256_set1_epi8((char)0xFF);
+        for (int32_t byteIndex = 0; byteIndex < finder->teddyLen; byteIndex++) {
+            __m256i bytes = _mm256_loadu_si256((const __m256i*)(str.ptr + at + byteIndex));
+            __m256i lowBits = _mm256_shuffle_epi8(lowMasks[byteIndex], _mm256_and_si256(bytes, nibble));
+            __m256i highBits = _mm256_shuffle_epi8(highMasks[byteIndex], _mm256_and_si256(_mm256_srli_epi16(bytes, 4), nibble));
+            buckets = _mm256_and_si256(buckets, _mm256_and_si256(lowBits, highBits));
+        }
+        uint64_t mask = ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(buckets, _mm256_setzero_si256()));
+        if (mask != 0) {
+            uint8_t laneBuckets[32];
+            _mm256_storeu_si256((__m256i*)laneBuckets, buckets);
+            for (; mask != 0; mask &= mask - 1) {
+                int32_t lane = prb_lib_lowestBit(mask);
+                prb_lib_teddyVerify(finder, str, at + lane, laneBuckets[lane], result, capacity);
+            }
+        }
+    }
+    return at;
+}
+
+#endif
+
+#if prb_SIMD_NEON
+
+static int32_t
+prb_lib_teddyNeon(prb_MultiFinder* finder, prb_Str str, prb_MultiFindResult* result, int32_t capacity) {
+    uint8x16_t lowMasks[3];
+    uint8x16_t highMasks[3];
+    for (int32_t byteIndex = 0; byteIndex < finder->teddyLen; byteIndex++) {
+        lowMasks[byteIndex] = vld1q_u8(finder->teddyLowMasks[byteIndex]);
+        highMasks[byteIndex] = vld1q_u8(finder->teddyHighMasks[byteIndex]);
+    }
+    uint8x16_t nibble = vdupq_n_u8(0x0F);
+
+    int32_t at = 0;
+    for (; at + 16 + finder->teddyLen - 1 <= str.len; at += 16) {
+        uint8x16_t buckets = vdupq_n_u8(0xFF);
+        for (int32_t byteIndex = 0; byteIndex < finder->teddyLen; byteIndex++) {
+            uint8x16_t bytes = vld1q_u8((const uint8_t*)str.ptr + at + byteIndex);
+            uint8x16_t lowBits = vqtbl1q_u8(lowMasks[byteIndex], vandq_u8(bytes, nibble));
+            uint8x16_t highBits = vqtbl1q_u8(highMasks[byteIndex], vshrq_n_u8(bytes, 4));
+            buckets = vandq_u8(buckets, vandq_u8(lowBits, highBits));
+        }
+        uint8x16_t hit = vtstq_u8(buckets, buckets);
+        uint64_t   mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hit), 4)), 0);
+        if (mask != 0) {
+            uint8_t laneBuckets[16];
+            vst1q_u8(laneBuckets, buckets);
+            while (mask != 0) {
+                int32_t lane = prb_lib_lowestBit(mask) / 4;
+                mask &= ~((uint64_t)0xF << (lane * 4));
+                prb_lib_teddyVerify(finder, str, at + lane, laneBuckets[lane], result, capacity);
+            }
+        }
+    }
+    return at;
+}
+
+#endif
+
+prb_PUBLICDEF prb_MultiFindResult
+prb_multiFinderFindAll(prb_Arena* arena, prb_MultiFinder* finder, prb_Str str) {
+    prb_assert(!arena->lockedForStr);
+    prb_arenaAlignFreePtr(arena, prb_alignof(prb_MultiFindMatch));
+
+    // NOTE(khvorov) Written straight into the arena's free space, overlapping matches are all reported
+    prb_MultiFindResult result = {.matches = (prb_MultiFindMatch*)prb_arenaFreePtr(arena), .count = 0};
+    int32_t             capacity = (int32_t)prb_min(prb_arenaFreeSize(arena) / (intptr_t)sizeof(prb_MultiFindMatch), INT32_MAX);
+
+    int32_t teddyFrom = -1;
+    if (finder->teddy) {
+#if prb_SIMD_AVX2
+        if (prb_avx2Supported()) {
+            teddyFrom = prb_lib_teddyAvx2(finder, str, &result, capacity);
+        } else
+#endif
+#if prb_SIMD_SSSE3
+            if (prb_ssse3Supported()) {
+            teddyFrom = prb_lib_teddySsse3(finder, str, &result, capacity);
+        } else
+#endif
+        {
+#if prb_SIMD_NEON
+            teddyFrom = prb_lib_teddyNeon(finder, str, &result, capacity);
+#endif
+        }
+    }
+
+    if (teddyFrom == -1) {
+        prb_lib_multiFindAhoCorasick(finder, str, &result, capacity);
+    } else {
+        prb_lib_teddyScalar(finder, str, teddyFrom, &result, capacity);
+    }
+
+    prb_arenaChangeUsed(arena, (intptr_t)result.count * (intptr_t)sizeof(prb_MultiFindMatch));
+    return result;
+}
+
+typedef enum prb_lib_RegexNodeKind {
+    prb_lib_RegexNodeKind_Empty,
+    prb_lib_RegexNodeKind_ByteSet,
+    prb_lib_RegexNodeKind_Concat,
+    prb_lib_RegexNodeKind_Alt,
+    prb_lib_RegexNodeKind_Repeat,
+    prb_lib_RegexNodeKind_StrStart,
+    prb_lib_RegexNodeKind_StrEnd,
+} prb_lib_RegexNodeKind;
+
+// NOTE(khvorov) Children are node indices, max of -1 repeats without a limit
+typedef struct prb_lib_RegexNode {
+    prb_lib_RegexNodeKind kind;
+    int32_t               a;
+    int32_t               b;
+    int32_t               min;
+    int32_t               max;
+} prb_lib_RegexNode;
+
+typedef struct prb_lib_RegexParser {
+    prb_Str            pattern;
+    int32_t            at;
+    bool               failed;
+    int32_t            errorOffset;
+    prb_lib_RegexNode* nodes;
+    prb_RegexByteSet*  byteSets;
+    prb_RegexInst*     insts;
+} prb_lib_RegexParser;
+
+struct prb_RegexState {
+    // Program counters in priority order, -1 separates threads that started at different positions
+    int32_t*         entries;
+    int32_t          entryCount;
+    bool             atStart;
+    bool             starting;
+    bool             hasMatch;
+    bool             matchesAtEnd;
+    bool             dead;
+    uint64_t         hash;
+    prb_RegexState** next;
+};
+
+static void
+prb_lib_regexFail(prb_lib_RegexParser* parser) {
+    if (!parser->failed) {
+        parser->failed = true;
+        parser->errorOffset = parser->at;
+    }
+}
+
+static int32_t
+prb_lib_regexAddNode(prb_lib_RegexParser* parser, prb_lib_RegexNodeKind kind, int32_t a, int32_t b) {
+    prb_lib_RegexNode node = {.kind = kind, .a = a, .b = b, .min = 0, .max = 0};
+    int32_t           result = (int32_t)prb_stbds_arrlen(parser->nodes);
+    prb_stbds_arrput(parser->nodes, node);
+    return result;
+}
+
+static int32_t
+prb_lib_regexAddByteSet(prb_lib_RegexParser* parser, prb_RegexByteSet set) {
+    int32_t setIndex = (int32_t)prb_stbds_arrlen(parser->byteSets);
+    prb_stbds_arrput(parser->byteSets, set);
+    int32_t result = prb_lib_regexAddNode(parser, prb_lib_RegexNodeKind_ByteSet, setIndex, 0);
+    return result;
+}
+
+static void
+prb_lib_regexSetAddRange(prb_RegexByteSet* set, int32_t first, int32_t last) {
+    for (int32_t byte = first; byte <= last; byte++) {
+        set->bits[byte >> 5] |= (uint32_t)1 << (byte & 31);
+    }
+}
+
+static bool
+prb_lib_regexSetHas(prb_RegexByteSet* set, uint8_t byte) {
+    bool result = (set->bits[byte >> 5] & ((uint32_t)1 << (byte & 31))) != 0;
+    return result;
+}
+
+static bool
+prb_lib_regexPeek(prb_lib_RegexParser* parser, char ch) {
+    bool result = parser->at < parser->pattern.len && parser->pattern.ptr[parser->at] == ch;
+    return result;
+}
+
+// NOTE(khvorov) Escapes that stand for a byte or a class, the same inside and outside brackets
+static prb_RegexByteSet
+prb_lib_regexParseEscape(prb_lib_RegexParser* parser) {
+    prb_RegexByteSet result = {};
+    if (parser->at >= parser->pattern.len) {
+        prb_lib_regexFail(parser);
+    } else {
+        char ch = parser->pattern.ptr[parser->at++];
+        switch (ch) {
+            case 'd':
+            case 'D': prb_lib_regexSetAddRange(&result, '0', '9'); break;
+            case 'w':
+            case 'W': {
+                prb_lib_regexSetAddRange(&result, '0', '9');
+                prb_lib_regexSetAddRange(&result, 'a', 'z');
+                prb_lib_regexSetAddRange(&result, 'A', 'Z');
+                prb_lib_regexSetAddRange(&result, '_', '_');
+            } break;
+            case 's':
+            case 'S': {
+                prb_lib_regexSetAddRange(&result, '\t', '\r');
+                prb_lib_regexSetAddRange(&result, ' ', ' ');
+            } break;
+            case 'n': prb_lib_regexSetAddRange(&result, '\n', '\n'); break;
+            case 'r': prb_lib_regexSetAddRange(&result, '\r', '\r'); break;
+            case 't': prb_lib_regexSetAddRange(&result, '\t', '\t'); break;
+            case 'x': {
+                prb_ParseUintResult hex = prb_parseUint(prb_strSlice(parser->pattern, parser->at, prb_min(parser->at + 2, parser->pattern.len)), 16);
+                if (hex.success && parser->at + 2 <= parser->pattern.len) {
+                    prb_lib_regexSetAddRange(&result, (int32_t)hex.number, (int32_t)hex.number);
+                    parser->at += 2;
+                } else {
+                    prb_lib_regexFail(parser);
+                }
+            } break;
+            default: {
+                bool isAlnum = (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9');
+                if (isAlnum) {
+                    parser->at -= 1;
+                    prb_lib_regexFail(parser);
+                } else {
+                    prb_lib_regexSetAddRange(&result, (uint8_t)ch, (uint8_t)ch);
+                }
+            } break;
+        }
+        if (ch == 'D' || ch == 'W' || ch == 'S') {
+            for (int32_t word = 0; word < 8; word++) {
+                result.bits[word] = ~result.bits[word];
+            }
+        }
+    }
+    return result;
+}
+
+static prb_RegexByteSet
+prb_lib_regexParseClass(prb_lib_RegexParser* parser) {
+    prb_RegexByteSet result = {};
+    bool             negate = prb_lib_regexPeek(parser, '^');
+    parser->at += negate;
+    for (bool first = true; !parser->failed; first = false) {
+        if (parser->at >= parser->pattern.len) {
+            prb_lib_regexFail(parser);
+        } else if (prb_lib_regexPeek(parser, ']') && !first) {
+            parser->at += 1;
+            break;
+        } else if (prb_lib_regexPeek(parser, '\\')) {
+            parser->at += 1;
+            prb_RegexByteSet escaped = prb_lib_regexParseEscape(parser);
+            for (int32_t word = 0; word < 8; word++) {
+                result.bits[word] |= escaped.bits[word];
+            }
+        } else {
+            uint8_t rangeFirst = (uint8_t)parser->pattern.ptr[parser->at++];
+            uint8_t rangeLast = rangeFirst;
+            if (prb_lib_regexPeek(parser, '-') && parser->at + 1 < parser->pattern.len && parser->pattern.ptr[parser->at + 1] != ']') {
+                rangeLast = (uint8_t)parser->pattern.ptr[parser->at + 1];
+                parser->at += 2;
+                if (rangeLast < rangeFirst) {
+                    prb_lib_regexFail(parser);
+                }
+            }
+            prb_lib_regexSetAddRange(&result, rangeFirst, rangeLast);
+        }
+    }
+    if (negate) {
+        for (int32_t word = 0; word < 8; word++) {
+            result.bits[word] = ~result.bits[word];
+        }
+    }
+    return result;
+}
+
+static int32_t prb_lib_regexParseAlt(prb_lib_RegexParser* parser);
+
+static int32_t
+prb_lib_regexParseAtom(prb_lib_RegexParser* parser) {
+    int32_t result = -1;
+    char    ch = parser->pattern.ptr[parser->at++];
+    switch (ch) {
+        case '(': {
+            if (parser->at + 1 < parser->pattern.len && parser->pattern.ptr[parser->at] == '?' && parser->pattern.ptr[parser->at + 1] == ':') {
+                parser->at += 2;
+            }
+            result = prb_lib_regexParseAlt(parser);
+            if (prb_lib_regexPeek(parser, ')')) {
+                parser->at += 1;
+            } else {
+                prb_lib_regexFail(parser);
+            }
+        } break;
+        case '.': {
+            prb_RegexByteSet set = {};
+            prb_lib_regexSetAddRange(&set, 0, 255);
+            set.bits['\n' >> 5] &= ~((uint32_t)1 << ('\n' & 31));
+            result = prb_lib_regexAddByteSet(parser, set);
+        } break;
+        case '[': result = prb_lib_regexAddByteSet(parser, prb_lib_regexParseClass(parser)); break;
+        case '\\': result = prb_lib_regexAddByteSet(parser, prb_lib_regexParseEscape(parser)); break;
+        case '^': result = prb_lib_regexAddNode(parser, prb_lib_RegexNodeKind_StrStart, 0, 0); break;
+        case '$': result = prb_lib_regexAddNode(parser, prb_lib_RegexNodeKind_StrEnd, 0, 0); break;
+        case '*':
+        case '+':
+        case '?':
+        case '{': {
+            parser->at -= 1;
+            prb_lib_regexFail(parser);
+        } break;
+        default: {
+            prb_RegexByteSet set = {};
+            prb_lib_regexSetAddRange(&set, (uint8_t)ch, (uint8_t)ch);
+            result = prb_lib_regexAddByteSet(parser, set);
+        } break;
+    }
+    return result;
+}
+
+static int32_t
+prb_lib_regexParseBound(prb_lib_RegexParser* parser) {
+    int32_t result = -1;
+    int32_t digitsStart = parser->at;
+    while (parser->at < parser->pattern.len && parser->pattern.ptr[parser->at] >= '0' && parser->pattern.ptr[parser->at] <= '9') {
+        parser->at += 1;
+    }
+    prb_ParseUintResult bound = prb_parseUint(prb_strSlice(parser->pattern, digitsStart, parser->at), 10);
+    if (bound.success && bound.number <= 1000) {
+        result = (int32_t)bound.number;
+    }
+    return result;
+}
+
+static int32_t
+prb_lib_regexParseRepeat(prb_lib_RegexParser* parser) {
+    int32_t result = prb_lib_regexParseAtom(parser);
+    while (!parser->failed && parser->at < parser->pattern.len) {
+        int32_t min = 0;
+        int32_t max = -1;
+        char    ch = parser->pattern.ptr[parser->at];
+        if (ch == '*') {
+            parser->at += 1;
+        } else if (ch == '+') {
+            parser->at += 1;
+            min = 1;
+        } else if (ch == '?') {
+            parser->at += 1;
+            max = 1;
+        } else if (ch == '{') {
+            parser->at += 1;
+            min = prb_lib_regexParseBound(parser);
+            max = min;
+            if (prb_lib_regexPeek(parser, ',')) {
+                parser->at += 1;
+                max = prb_lib_regexPeek(parser, '}') ? -1 : prb_lib_regexParseBound(parser);
+                if (max != -1 && max < min) {
+                    min = -1;
+                }
+            }
+            if (min == -1 || !prb_lib_regexPeek(parser, '}')) {
+                prb_lib_regexFail(parser);
+            }
+            parser->at += 1;
+        } else {
+            break;
+        }
+
+        // NOTE(khvorov) Lazy quantifiers only change which match a backtracker finds first, leftmost-longest ignores them
+        if (prb_lib_regexPeek(parser, '?')) {
+            parser->at += 1;
+        }
+        int32_t repeat = prb_lib_regexAddNode(parser, prb_lib_RegexNodeKind_Repeat, result, 0);
+        parser->nodes[repeat].min = min;
+        parser->nodes[repeat].max = max;
+        result = repeat;
+    }
+    return result;
+}
+
+static int32_t
+prb_lib_regexParseConcat(prb_lib_RegexParser* parser) {
+    int32_t result = -1;
+    while (!parser->failed && parser->at < parser->pattern.len && !prb_lib_regexPeek(parser, '|') && !prb_lib_regexPeek(parser, ')')) {
+        int32_t repeat = prb_lib_regexParseRepeat(parser);
+        result = result == -1 ? repeat : prb_lib_regexAddNode(parser, prb_lib_RegexNodeKind_Concat, result, repeat);
+    }
+    if (result == -1) {
+        result = prb_lib_regexAddNode(parser, prb_lib_RegexNodeKind_Empty, 0, 0);
+    }
+    return result;
+}
+
+static int32_t
+prb_lib_regexParseAlt(prb_lib_RegexParser* parser) {
+    int32_t result = prb_lib_regexParseConcat(parser);
+    while (!parser->failed && prb_lib_regexPeek(parser, '|')) {
+        parser->at += 1;
+        int32_t rhs = prb_lib_regexParseConcat(parser);
+        result = prb_lib_regexAddNode(parser, prb_lib_RegexNodeKind_Alt, result, rhs);
+    }
+    return result;
+}
+
+static bool
+prb_lib_regexEndAnchored(prb_lib_RegexParser* parser, int32_t nodeIndex) {
+    prb_lib_RegexNode node = parser->nodes[nodeIndex];
+    bool              result = false;
+    switch (node.kind) {
+        case prb_lib_RegexNodeKind_StrEnd: result = true; break;
+        case prb_lib_RegexNodeKind_Concat: result = prb_lib_regexEndAnchored(parser, node.b); break;
+        case prb_lib_RegexNodeKind_Alt: result = prb_lib_regexEndAnchored(parser, node.a) && prb_lib_regexEndAnchored(parser, node.b); break;
+        case prb_lib_RegexNodeKind_Repeat: result = node.min > 0 && prb_lib_regexEndAnchored(parser, node.a); break;
+        default: break;
+    }
+    return result;
+}
+
+static int32_t
+prb_lib_regexEmit(prb_lib_RegexParser* parser, prb_RegexOp op, int32_t x, int32_t y) {
+    prb_RegexInst inst = {.op = op, .x = x, .y = y};
+    int32_t       result = (int32_t)prb_stbds_arrlen(parser->insts);
+    prb_stbds_arrput(parser->insts, inst);
+    return result;
+}
+
+// NOTE(khvorov) Thompson construction. The reverse program matches reversed strings, concatenations
+// go the other way and the string anchors swap.
+static void
+prb_lib_regexCompileNode(prb_lib_RegexParser* parser, int32_t nodeIndex, bool reverse) {
+    prb_lib_RegexNode node = parser->nodes[nodeIndex];
+    if (prb_stbds_arrlen(parser->insts) > 100000) {
+        parser->failed = true;
+        parser->errorOffset = parser->pattern.len;
+    } else {
+        switch (node.kind) {
+            case prb_lib_RegexNodeKind_Empty: break;
+            case prb_lib_RegexNodeKind_ByteSet: prb_lib_regexEmit(parser, prb_RegexOp_ByteSet, node.a, 0); break;
+            case prb_lib_RegexNodeKind_Concat: {
+                prb_lib_regexCompileNode(parser, reverse ? node.b : node.a, reverse);
+                prb_lib_regexCompileNode(parser, reverse ? node.a : node.b, reverse);
+            } break;
+            case prb_lib_RegexNodeKind_Alt: {
+                int32_t split = prb_lib_regexEmit(parser, prb_RegexOp_Split, 0, 0);
+                parser->insts[split].x = (int32_t)prb_stbds_arrlen(parser->insts);
+                prb_lib_regexCompileNode(parser, node.a, reverse);
+                int32_t jump = prb_lib_regexEmit(parser, prb_RegexOp_Jump, 0, 0);
+                parser->insts[split].y = (int32_t)prb_stbds_arrlen(parser->insts);
+                prb_lib_regexCompileNode(parser, node.b, reverse);
+                parser->insts[jump].x = (int32_t)prb_stbds_arrlen(parser->insts);
+            } break;
+            case prb_lib_RegexNodeKind_Repeat: {
+                for (int32_t index = 0; index < node.min; index++) {
+                    prb_lib_regexCompileNode(parser, node.a, reverse);
+                }
+                if (node.max == -1) {
+                    int32_t split = prb_lib_regexEmit(parser, prb_RegexOp_Split, 0, 0);
+                    parser->insts[split].x = split + 1;
+                    prb_lib_regexCompileNode(parser, node.a, reverse);
+                    prb_lib_regexEmit(parser, prb_RegexOp_Jump, split, 0);
+                    parser->insts[split].y = (int32_t)prb_stbds_arrlen(parser->insts);
+                } else {
+                    // NOTE(khvorov) Optional copies all skip to the end
+                    int32_t* splits = 0;
+                    for (int32_t index = node.min; index < node.max; index++) {
+                        int32_t split = prb_lib_regexEmit(parser, prb_RegexOp_Split, 0, 0);
+                        parser->insts[split].x = split + 1;
+                        prb_stbds_arrput(splits, split);
+                        prb_lib_regexCompileNode(parser, node.a, reverse);
+                    }
+                    for (int32_t index = 0; index < prb_stbds_arrlen(splits); index++) {
+                        parser->insts[splits[index]].y = (int32_t)prb_stbds_arrlen(parser->insts);
+                    }
+                    prb_stbds_arrfree(splits);
+                }
+            } break;
+            case prb_lib_RegexNodeKind_StrStart: prb_lib_regexEmit(parser, reverse ? prb_RegexOp_StrEnd : prb_RegexOp_StrStart, 0, 0); break;
+            case prb_lib_RegexNodeKind_StrEnd: prb_lib_regexEmit(parser, reverse ? prb_RegexOp_StrStart : prb_RegexOp_StrEnd, 0, 0); break;
+        }
+    }
+}
+
+static void
+prb_lib_regexResetDfa(prb_RegexDfa* dfa) {
+    dfa->cache.used = 0;
+    dfa->stateCount = 0;
+    dfa->flushCount += 1;
+    dfa->startStates[0] = 0;
+    dfa->startStates[1] = 0;
+    // NOTE(khvorov) A state is at least a few hundred bytes so the table can't fill up before the arena does
+    dfa->slotsCount = 1;
+    while (dfa->slotsCount * 256 < dfa->cache.size) {
+        dfa->slotsCount *= 2;
+    }
+    dfa->slots = prb_arenaAllocArray(&dfa->cache, prb_RegexState*, dfa->slotsCount);
+}
+
+static void
+prb_lib_regexInitDfa(prb_Arena* arena, prb_Regex* regex, prb_RegexDfa* dfa, prb_RegexInst* insts, bool unanchored, intptr_t cacheBytes) {
+    dfa->insts = insts;
+    dfa->unanchored = unanchored;
+    intptr_t biggestState = (intptr_t)sizeof(prb_RegexState) + (intptr_t)(2 * regex->instCount + 2) * (intptr_t)sizeof(int32_t)
+        + (intptr_t)regex->classCount * (intptr_t)sizeof(prb_RegexState*) + 64;
+    // NOTE(khvorov) Room for a few of the biggest states so that matching still moves forward between resets
+    dfa->cache = prb_createArenaFromArena(arena, prb_max(cacheBytes, 16 * biggestState));
+    dfa->flushCount = -1;
+    prb_lib_regexResetDfa(dfa);
+}
+
+// NOTE(khvorov) Follows empty transitions from the seeds in priority order and keeps the instructions that consume bytes,
+// matches and end-of-string checks. Once a thread matches, the threads that started after it can't be leftmost.
+static int32_t
+prb_lib_regexClosure(prb_Regex* regex, prb_RegexInst* insts, int32_t* seeds, int32_t seedCount, bool atStart, int32_t* out) {
+    regex->visitStamp += 1;
+    int32_t outCount = 0;
+    bool    groupHasMatch = false;
+    for (int32_t seedIndex = 0; seedIndex < seedCount && !(groupHasMatch && seeds[seedIndex] == -1); seedIndex++) {
+        int32_t seed = seeds[seedIndex];
+        if (seed == -1) {
+            if (outCount > 0 && out[outCount - 1] != -1) {
+                out[outCount++] = -1;
+            }
+        } else {
+            int32_t stackCount = 0;
+            regex->stack[stackCount++] = seed;
+            while (stackCount > 0) {
+                int32_t pc = regex->stack[--stackCount];
+                if (regex->visited[pc] != regex->visitStamp) {
+                    regex->visited[pc] = regex->visitStamp;
+                    prb_RegexInst inst = insts[pc];
+                    switch (inst.op) {
+                        case prb_RegexOp_ByteSet:
+                        case prb_RegexOp_StrEnd: out[outCount++] = pc; break;
+                        case prb_RegexOp_Match: {
+                            out[outCount++] = pc;
+                            groupHasMatch = true;
+                        } break;
+                        case prb_RegexOp_Split: {
+                            regex->stack[stackCount++] = inst.y;
+                            regex->stack[stackCount++] = inst.x;
+                        } break;
+                        case prb_RegexOp_Jump: regex->stack[stackCount++] = inst.x; break;
+                        case prb_RegexOp_StrStart: {
+                            if (atStart) {
+                                regex->stack[stackCount++] = pc + 1;
+                            }
+                        } break;
+                    }
+                }
+            }
+        }
+    }
+    if (outCount > 0 && out[outCount - 1] == -1) {
+        outCount -= 1;
+    }
+    return outCount;
+}
+
+// NOTE(khvorov) Whether a match is reachable through end-of-string checks when there is no input left
+static bool
+prb_lib_regexMatchesAtEnd(prb_Regex* regex, prb_RegexInst* insts, int32_t* entries, int32_t entryCount, bool atStart) {
+    int32_t* ends = regex->seeds;
+    int32_t  endCount = 0;
+    bool     result = false;
+    for (int32_t entryIndex = 0; entryIndex < entryCount && !result; entryIndex++) {
+        int32_t pc = entries[entryIndex];
+        if (pc != -1) {
+            result = insts[pc].op == prb_RegexOp_Match;
+            if (insts[pc].op == prb_RegexOp_StrEnd) {
+                ends[endCount++] = pc + 1;
+            }
+        }
+    }
+    // NOTE(khvorov) Passes every $ by running the closure repeatedly, each round gets past at least one
+    for (int32_t round = 0; round < regex->instCount && endCount > 0 && !result; round++) {
+        int32_t* closed = regex->entries + 2 * regex->instCount + 2;
+        int32_t  closedCount = prb_lib_regexClosure(regex, insts, ends, endCount, atStart, closed);
+        endCount = 0;
+        for (int32_t closedIndex = 0; closedIndex < closedCount && !result; closedIndex++) {
+            int32_t pc = closed[closedIndex];
+            if (pc != -1) {
+                result = insts[pc].op == prb_RegexOp_Match;
+                if (insts[pc].op == prb_RegexOp_StrEnd) {
+                    ends[endCount++] = pc + 1;
+                }
+            }
+        }
+    }
+    return result;
+}
+
+static prb_RegexState*
+prb_lib_regexIntern(prb_Regex* regex, prb_RegexDfa* dfa, int32_t* entries, int32_t entryCount, bool atStart, bool starting) {
+    uint64_t hash = prb_hashBytes(entries, entryCount * (int32_t)sizeof(int32_t), (uint64_t)atStart | ((uint64_t)starting << 1));
+    int32_t  mask = dfa->slotsCount - 1;
+    int32_t  slot = (int32_t)(hash & (uint64_t)mask);
+    for (prb_RegexState* existing = dfa->slots[slot]; existing; existing = dfa->slots[slot]) {
+        if (existing->hash == hash && existing->atStart == atStart && existing->starting == starting && existing->entryCount == entryCount
+            && prb_memeq(existing->entries, entries, entryCount * (int32_t)sizeof(int32_t))) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    prb_RegexState* result = dfa->slots[slot];
+    if (!result) {
+        intptr_t stateBytes = (intptr_t)sizeof(prb_RegexState) + (intptr_t)entryCount * (intptr_t)sizeof(int32_t)
+            + (intptr_t)regex->classCount * (intptr_t)sizeof(prb_RegexState*) + 64;
+        if (prb_arenaFreeSize(&dfa->cache) < stateBytes || (dfa->stateCount + 1) * 4 > dfa->slotsCount * 3) {
+            prb_lib_regexResetDfa(dfa);
+            slot = (int32_t)(hash & (uint64_t)(dfa->slotsCount - 1));
+        }
+
+        result = prb_arenaAllocArray(&dfa->cache, prb_RegexState, 1);
+        result->entries = prb_arenaAllocArray(&dfa->cache, int32_t, entryCount);
+        prb_memcpy(result->entries, entries, (size_t)entryCount * sizeof(int32_t));
+        result->entryCount = entryCount;
+        result->atStart = atStart;
+        result->starting = starting;
+        result->hasMatch = false;
+        for (int32_t entryIndex = 0; entryIndex < entryCount; entryIndex++) {
+            result->hasMatch = result->hasMatch || (entries[entryIndex] != -1 && dfa->insts[entries[entryIndex]].op == prb_RegexOp_Match);
+        }
+        result->matchesAtEnd = result->hasMatch || prb_lib_regexMatchesAtEnd(regex, dfa->insts, entries, entryCount, atStart);
+        result->dead = entryCount == 0 && !starting;
+        result->hash = hash;
+        result->next = prb_arenaAllocArray(&dfa->cache, prb_RegexState*, regex->classCount);
+        dfa->slots[slot] = result;
+        dfa->stateCount += 1;
+    }
+    return result;
+}
+
+static prb_RegexState*
+prb_lib_regexStartState(prb_Regex* regex, prb_RegexDfa* dfa, bool atStart) {
+    prb_RegexState* result = dfa->startStates[atStart];
+    if (!result) {
+        int32_t entry = 0;
+        int32_t entryCount = prb_lib_regexClosure(regex, dfa->insts, &entry, 1, atStart, regex->entries);
+        result = prb_lib_regexIntern(regex, dfa, regex->entries, entryCount, atStart, dfa->unanchored);
+        dfa->startStates[atStart] = result;
+    }
+    return result;
+}
+
+// NOTE(khvorov) Unanchored searches start a new lowest-priority thread after every byte until something matches
+static prb_RegexState*
+prb_lib_regexStep(prb_Regex* regex, prb_RegexDfa* dfa, prb_RegexState* state, int32_t byteClass) {
+    uint8_t byte = regex->classBytes[byteClass];
+    int32_t seedCount = 0;
+    for (int32_t entryIndex = 0; entryIndex < state->entryCount; entryIndex++) {
+        int32_t pc = state->entries[entryIndex];
+        if (pc == -1) {
+            regex->seeds[seedCount++] = -1;
+        } else if (dfa->insts[pc].op == prb_RegexOp_ByteSet && prb_lib_regexSetHas(regex->byteSets + dfa->insts[pc].x, byte)) {
+            regex->seeds[seedCount++] = pc + 1;
+        }
+    }
+    bool starting = state->starting && !state->hasMatch;
+    if (starting) {
+        regex->seeds[seedCount++] = -1;
+        regex->seeds[seedCount++] = 0;
+    }
+
+    int32_t         entryCount = prb_lib_regexClosure(regex, dfa->insts, regex->seeds, seedCount, false, regex->entries);
+    int32_t         flushCount = dfa->flushCount;
+    prb_RegexState* result = prb_lib_regexIntern(regex, dfa, regex->entries, entryCount, false, starting);
+    if (dfa->flushCount == flushCount) {
+        state->next[byteClass] = result;
+    }
+    return result;
+}
+
+static prb_RegexState*
+prb_lib_regexNext(prb_Regex* regex, prb_RegexDfa* dfa, prb_RegexState* state, uint8_t byte) {
+    int32_t         byteClass = regex->byteClasses[byte];
+    prb_RegexState* result = state->next[byteClass];
+    if (!result) {
+        result = prb_lib_regexStep(regex, dfa, state, byteClass);
+    }
+    return result;
+}
+
+// NOTE(khvorov) The state caches of the 3 DFAs are taken from the arena here and split cacheBytes between them
+// (64KB when it's 0), though each gets at least enough for 16 of the biggest states the pattern can have
+prb_PUBLICDEF prb_CompileRegexResult
+prb_compileRegex(prb_Arena* arena, prb_Str pattern, intptr_t cacheBytes) {
+    prb_CompileRegexResult result = {.success = false, .errorOffset = 0, .regex = 0};
+    prb_lib_RegexParser    parser = {};
+    parser.pattern = pattern;
+
+    int32_t root = prb_lib_regexParseAlt(&parser);
+    if (!parser.failed && parser.at < pattern.len) {
+        prb_lib_regexFail(&parser);
+    }
+
+    prb_RegexInst* forward = 0;
+    if (!parser.failed) {
+        prb_lib_regexCompileNode(&parser, root, false);
+        prb_lib_regexEmit(&parser, prb_RegexOp_Match, 0, 0);
+        forward = parser.insts;
+        parser.insts = 0;
+        prb_lib_regexCompileNode(&parser, root, true);
+        prb_lib_regexEmit(&parser, prb_RegexOp_Match, 0, 0);
+    }
+
+    if (parser.failed) {
+        result.errorOffset = parser.errorOffset;
+    } else {
+        result.success = true;
+        prb_Regex* regex = prb_arenaAllocArray(arena, prb_Regex, 1);
+        result.regex = regex;
+        regex->instCount = (int32_t)prb_stbds_arrlen(forward);
+        regex->endAnchored = prb_lib_regexEndAnchored(&parser, root);
+
+        int32_t setCount = (int32_t)prb_stbds_arrlen(parser.byteSets);
+        regex->byteSets = prb_arenaAllocArray(arena, prb_RegexByteSet, prb_max(setCount, 1));
+        if (setCount > 0) {
+            prb_memcpy(regex->byteSets, parser.byteSets, (size_t)setCount * sizeof(prb_RegexByteSet));
+        }
+
+        // NOTE(khvorov) Bytes that every set treats the same share a class, each set splits the classes it cuts through
+        regex->classCount = 1;
+        for (int32_t setIndex = 0; setIndex < setCount; setIndex++) {
+            int32_t splitClasses[256][2];
+            prb_memset(splitClasses, 0xFF, sizeof(splitClasses));
+            int32_t newClassCount = 0;
+            for (int32_t byte = 0; byte < 256; byte++) {
+                int32_t* newClass = &splitClasses[regex->byteClasses[byte]][prb_lib_regexSetHas(regex->byteSets + setIndex, (uint8_t)byte)];
+                if (*newClass == -1) {
+                    *newClass = newClassCount++;
+                }
+                regex->byteClasses[byte] = (uint8_t)*newClass;
+            }
+            regex->classCount = newClassCount;
+        }
+        for (int32_t byte = 255; byte >= 0; byte--) {
+            regex->classBytes[regex->byteClasses[byte]] = (uint8_t)byte;
+        }
+
+        prb_RegexInst* insts = prb_arenaAllocArray(arena, prb_RegexInst, regex->instCount * 2);
+        prb_memcpy(insts, forward, (size_t)regex->instCount * sizeof(prb_RegexInst));
+        prb_memcpy(insts + regex->instCount, parser.insts, (size_t)regex->instCount * sizeof(prb_RegexInst));
+        regex->stack = prb_arenaAllocArray(arena, int32_t, 2 * regex->instCount + 2);
+        regex->visited = prb_arenaAllocArray(arena, int32_t, regex->instCount);
+        regex->seeds = prb_arenaAllocArray(arena, int32_t, 2 * regex->instCount + 2);
+        regex->entries = prb_arenaAllocArray(arena, int32_t, 4 * regex->instCount + 4);
+        intptr_t dfaBytes = (cacheBytes > 0 ? cacheBytes : 64 * prb_KILOBYTE) / 3;
+        prb_lib_regexInitDfa(arena, regex, &regex->matchDfa, insts, false, dfaBytes);
+        prb_lib_regexInitDfa(arena, regex, &regex->searchDfa, insts, true, dfaBytes);
+        prb_lib_regexInitDfa(arena, regex, &regex->reverseDfa, insts + regex->instCount, false, dfaBytes);
+    }
+
+    prb_stbds_arrfree(forward);
+    prb_stbds_arrfree(parser.insts);
+    prb_stbds_arrfree(parser.nodes);
+    prb_stbds_arrfree(parser.byteSets);
+    return result;
+}
+
+prb_PUBLICDEF bool
+prb_regexMatch(prb_Regex* regex, prb_Str str) {
+    prb_RegexDfa*   dfa = &regex->matchDfa;
+    prb_RegexState* state = prb_lib_regexStartState(regex, dfa, true);
+    for (int32_t at = 0; at < str.len && !state->dead; at++) {
+        state = prb_lib_regexNext(regex, dfa, state, (uint8_t)str.ptr[at]);
+    }
+    bool result = state->matchesAtEnd;
+    return result;
+}
+
+// NOTE(khvorov) The forward search finds where the leftmost-longest match ends,
+// the longest reverse match from there is where it starts. Patterns ending in $ skip the forward search.
+prb_PUBLICDEF prb_StrFindResult
+prb_regexFind(prb_Regex* regex, prb_Str str) {
+    prb_StrFindResult result = {};
+
+    int32_t         matchEnd = regex->endAnchored ? str.len : -1;
+    prb_RegexState* state = prb_lib_regexStartState(regex, &regex->searchDfa, true);
+    for (int32_t at = 0; !regex->endAnchored; at++) {
+        if (state->hasMatch || (at == str.len && state->matchesAtEnd)) {
+            matchEnd = at;
+        }
+        if (at == str.len || state->dead) {
+            break;
+        }
+        state = prb_lib_regexNext(regex, &regex->searchDfa, state, (uint8_t)str.ptr[at]);
+    }
+
+    if (matchEnd != -1) {
+        int32_t matchStart = -1;
+        state = prb_lib_regexStartState(regex, &regex->reverseDfa, matchEnd == str.len);
+        for (int32_t at = matchEnd;; at--) {
+            if (state->hasMatch || (at == 0 && state->matchesAtEnd)) {
+                matchStart = at;
+            }
+            if (at == 0 || state->dead) {
+                break;
+            }
+            state = prb_lib_regexNext(regex, &regex->reverseDfa, state, (uint8_t)str.ptr[at - 1]);
+        }
+        prb_assert(matchStart != -1 || regex->endAnchored);
+
+        if (matchStart != -1) {
+            result.found = true;
+            result.beforeMatch = prb_strSlice(str, 0, matchStart);
+            result.match = prb_strSlice(str, matchStart, matchEnd);
+            result.afterMatch = prb_strSlice(str, matchEnd, str.len);
+        }
+    }
+    return result;
+}
+
+// NOTE(khvorov) LSD radix sort, a byte per pass. All histograms come from one read of the keys and
+// passes where every key has the same byte are skipped, so small keys only pay for the bytes they use.
+// Values are optional and move with their keys.
+prb_PUBLICDEF void
+prb_sortU64(prb_Arena* arena, uint64_t* keys, uint64_t* values, int32_t count) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+    int32_t*       byteCounts = prb_arenaAllocArray(arena, int32_t, 8 * 256);
+    for (int32_t keyIndex = 0; keyIndex < count; keyIndex++) {
+        uint64_t key = keys[keyIndex];
+        for (int32_t byteIndex = 0; byteIndex < 8; byteIndex++) {
+            byteCounts[byteIndex * 256 + ((key >> (byteIndex * 8)) & 0xFF)] += 1;
+        }
+    }
+
+    uint64_t* srcKeys = keys;
+    uint64_t* dstKeys = prb_arenaAllocArray(arena, uint64_t, count);
+    uint64_t* srcValues = values;
+    uint64_t* dstValues = values ? prb_arenaAllocArray(arena, uint64_t, count) : 0;
+    for (int32_t byteIndex = 0; byteIndex < 8 && count > 0; byteIndex++) {
+        int32_t* counts = byteCounts + byteIndex * 256;
+        int32_t  shift = byteIndex * 8;
+        if (counts[(keys[0] >> shift) & 0xFF] != count) {
+            int32_t offsets[256];
+            int32_t offset = 0;
+            for (int32_t byte = 0; byte < 256; byte++) {
+                offsets[byte] = offset;
+                offset += counts[byte];
+            }
+            for (int32_t keyIndex = 0; keyIndex < count; keyIndex++) {
+                int32_t dest = offsets[(srcKeys[keyIndex] >> shift) & 0xFF]++;
+                dstKeys[dest] = srcKeys[keyIndex];
+                if (values) {
+                    dstValues[dest] = srcValues[keyIndex];
+                }
+            }
+            uint64_t* swapKeys = srcKeys;
+            srcKeys = dstKeys;
+            dstKeys = swapKeys;
+            uint64_t* swapValues = srcValues;
+            srcValues = dstValues;
+            dstValues = swapValues;
+        }
+    }
+
+    if (srcKeys != keys) {
+        prb_memcpy(keys, srcKeys, (size_t)count * sizeof(uint64_t));
+        if (values) {
+            prb_memcpy(values, srcValues, (size_t)count * sizeof(uint64_t));
+        }
+    }
+    prb_endTempMemory(temp);
+}
+
+// NOTE(khvorov) The first depth bytes are already known to be the same
+static bool
+prb_lib_strLessFrom(prb_Str str1, prb_Str str2, int32_t depth) {
+    int32_t common = prb_min(str1.len, str2.len) - depth;
+    int     cmp = common > 0 ? prb_memcmp(str1.ptr + depth, str2.ptr + depth, (size_t)common) : 0;
+    bool    result = cmp < 0 || (cmp == 0 && str1.len < str2.len);
+    return result;
+}
+
+typedef struct prb_lib_StrSortRange {
+    int32_t start;
+    int32_t count;
+    int32_t depth;
+} prb_lib_StrSortRange;
+
+// NOTE(khvorov) MSD radix sort with the current byte of every string cached before it's distributed
+// (Karkkainen and Rantala), small ranges are insertion sorted. Ranges wait on a stack so that
+// long shared prefixes don't recurse. Bytes compare unsigned and a prefix goes before the longer string.
+prb_PUBLICDEF void
+prb_sortStrs(prb_Arena* arena, prb_Str* strs, int32_t count) {
+    prb_TempMemory        temp = prb_beginTempMemory(arena);
+    prb_Str*              scratch = prb_arenaAllocArray(arena, prb_Str, count);
+    uint16_t*             cachedBytes = prb_arenaAllocArray(arena, uint16_t, count);
+    prb_lib_StrSortRange* ranges = 0;
+    prb_lib_StrSortRange  all = {.start = 0, .count = count, .depth = 0};
+    prb_stbds_arrput(ranges, all);
+
+    while (prb_stbds_arrlen(ranges) > 0) {
+        prb_lib_StrSortRange range = prb_stbds_arrpop(ranges);
+        prb_Str*             rangeStrs = strs + range.start;
+        if (range.count < 32) {
+            for (int32_t strIndex = 1; strIndex < range.count; strIndex++) {
+                prb_Str str = rangeStrs[strIndex];
+                int32_t dest = strIndex;
+                while (dest > 0 && prb_lib_strLessFrom(str, rangeStrs[dest - 1], range.depth)) {
+                    rangeStrs[dest] = rangeStrs[dest - 1];
+                    dest -= 1;
+                }
+                rangeStrs[dest] = str;
+            }
+        } else {
+            // NOTE(khvorov) Bucket 0 is for strings that have ended, they are all the same
+            int32_t bucketCounts[257] = {};
+            for (int32_t strIndex = 0; strIndex < range.count; strIndex++) {
+                prb_Str  str = rangeStrs[strIndex];
+                uint16_t bucket = str.len > range.depth ? (uint16_t)((uint8_t)str.ptr[range.depth] + 1) : 0;
+                cachedBytes[strIndex] = bucket;
+                bucketCounts[bucket] += 1;
+            }
+
+            if (bucketCounts[cachedBytes[0]] == range.count) {
+                if (cachedBytes[0] != 0) {
+                    // NOTE(khvorov) Skip the rest of a shared prefix (like a common root directory) in
+                    // one pass rather than one pass per byte
+                    prb_Str first = rangeStrs[0];
+                    int32_t common = first.len;
+                    for (int32_t strIndex = 1; strIndex < range.count; strIndex++) {
+                        prb_Str str = rangeStrs[strIndex];
+                        int32_t limit = prb_min(common, str.len);
+                        int32_t matched = range.depth + 1;
+                        while (matched < limit && str.ptr[matched] == first.ptr[matched]) {
+                            matched += 1;
+                        }
+                        common = matched;
+                    }
+                    range.depth = common;
+                    prb_stbds_arrput(ranges, range);
+                }
+            } else {
+                int32_t offsets[257];
+                int32_t offset = 0;
+                for (int32_t bucket = 0; bucket < 257; bucket++) {
+                    offsets[bucket] = offset;
+                    offset += bucketCounts[bucket];
+                }
+                for (int32_t strIndex = 0; strIndex < range.count; strIndex++) {
+                    scratch[offsets[cachedBytes[strIndex]]++] = rangeStrs[strIndex];
+                }
+                prb_memcpy(rangeStrs, scratch, (size_t)range.count * sizeof(prb_Str));
+
+                int32_t bucketStart = bucketCounts[0];
+                for (int32_t bucket = 1; bucket < 257; bucket++) {
+                    if (bucketCounts[bucket] > 1) {
+                        prb_lib_StrSortRange bucketRange = {.start = range.start + bucketStart, .count = bucketCounts[bucket], .depth = range.depth + 1};
+                        prb_stbds_arrput(ranges, bucketRange);
+                    }
+                    bucketStart += bucketCounts[bucket];
+                }
+            }
+        }
+    }
+
+    prb_stbds_arrfree(ranges);
+    prb_endTempMemory(temp);
+}
+
+//
+// SECTION Processes (implementation)
+//
+
+#if prb_PLATFORM_WINDOWS
+
+static void
+prb_windows_waitForProcess(prb_Process* handle) {
+    WaitForSingleObject(handle->processInfo.hProcess, INFINITE);
+    handle->status = prb_ProcessStatus_CompletedFailed;
+    DWORD exitCode = 0;
+    if (GetExitCodeProcess(handle->processInfo.hProcess, &exitCode)) {
+        if (exitCode == 0) {
+            handle->status = prb_ProcessStatus_CompletedSuccess;
+        }
+    }
+    CloseHandle(handle->processInfo.hProcess);
+    CloseHandle(handle->processInfo.hThread);
+}
+
+typedef struct prb_windows_GetAffinityResult {
+    bool      success;
+    DWORD_PTR affinity;
+    int32_t   setBits;
+} prb_windows_GetAffinityResult;
+
+static prb_windows_GetAffinityResult
+prb_windows_getAffinity(void) {
+    prb_windows_GetAffinityResult result = {.success = false, .affinity = 0, .setBits = 0};
+    HANDLE                        thisProc = GetCurrentProcess();
+    DWORD_PTR                     procAffinity = 0;
+    DWORD_PTR                     sysAffinity = 0;
+    if (GetProcessAffinityMask(thisProc, &procAffinity, &sysAffinity)) {
+        result.success = true;
+        result.affinity = procAffinity;
+        for (size_t bitIndex = 0; bitIndex < sizeof(DWORD_PTR) * 8; bitIndex++) {
+            DWORD_PTR mask = 1ULL << bitIndex;
+            result.setBits += (result.affinity & mask) != 0;
+        }
+    }
+    return result;
+}
+
+#elif prb_PLATFORM_LINUX
+
+static prb_Bytes
+prb_linux_readFromProc(prb_Arena* arena, prb_Str filename) {
+    prb_linux_OpenResult handle = prb_linux_open(arena, prb_fmt(arena, "/proc/%.*s", prb_LIT(filename)), O_RDONLY, 0);
+    prb_assert(handle.success);
+    prb_Bytes content = prb_linux_readFromHandle(arena, handle.handle);
+    prb_assert(content.len > 0);
+    close(handle.handle);
+    return content;
+}
+
+static void
+prb_linux_waitForProcess(prb_Process* handle) {
+    int32_t status = 0;
+    pid_t waitResult = waitpid(handle->pid, &status, 0);
+    handle->status = prb_ProcessStatus_CompletedFailed;
+    if (waitResult == handle->pid && status == 0) {
+        handle->status = prb_ProcessStatus_CompletedSuccess;
+    }
+}
+
+typedef struct prb_linux_GetAffinityResult {
+    bool success;
+    uint8_t* affinity;
+    int32_t size;
+    int32_t setBits;
+} prb_linux_GetAffinityResult;
+
+static prb_linux_GetAffinityResult
+prb_linux_getAffinity(prb_Arena* arena) {
+    // NOTE(khvorov) The syscall is picky about alignment and can't handle buffers that are too big.
+    // I don't know how big is too big but a megabyte is apparently not too big.
+    prb_linux_GetAffinityResult result = {};
+    int32_t reqAlign = prb_alignof(unsigned long);
+    prb_arenaAlignFreePtr(arena, reqAlign);
+    result.affinity = (uint8_t*)prb_arenaFreePtr(arena);
+    int32_t arenaSize = (int32_t)prb_min(prb_arenaFreeSize(arena), INT32_MAX);
+    int32_t arenaSizeAligned = arenaSize & (~(reqAlign - 1));
+    int32_t sizeReduced = prb_min(arenaSizeAligned, prb_MEGABYTE);
+    result.size = syscall(SYS_sched_getaffinity, 0, sizeReduced, result.affinity);
+    if (result.size > 0) {
+        result.success = true;
+        for (int32_t byteIndex = 0; byteIndex < result.size; byteIndex++) {
+            uint8_t byte = ((uint8_t*)result.affinity)[byteIndex];
+            for (int32_t bitIndex = 0; bitIndex < 8; bitIndex++) {
+                uint8_t mask = 1 << bitIndex;
+                result.setBits += (byte & mask) != 0;
+            }
+        }
+    }
+    return result;
+}
+
+#endif
+
+prb_PUBLICDEF void
+prb_terminate(int32_t code) {
+#if prb_PLATFORM_WINDOWS
+    ExitProcess((UINT)code);
+#elif prb_PLATFORM_LINUX
+    exit(code);
+#else
+#error unimplemented
+#endif
+}
+
+prb_PUBLICDEF prb_Str
+prb_getCmdline(prb_Arena* arena) {
+    prb_Str result = {.ptr = 0, .len = 0};
+
+#if prb_PLATFORM_WINDOWS
+
+    LPWSTR  wstr = GetCommandLineW();
+    int32_t len = 0;
+    while (wstr[len]) {
+        len += 1;
+    }
+    result = prb_windows_strFromWideStr(arena, (prb_windows_WideStr) {wstr, len});
+
+#elif prb_PLATFORM_LINUX
+
+    prb_Bytes procSelfContent = prb_linux_readFromProc(arena, prb_STR("self/cmdline"));
+    for (int32_t byteIndex = 0; byteIndex < procSelfContent.len - 1; byteIndex++) {
+        if (procSelfContent.data[byteIndex] == '\0') {
+            procSelfContent.data[byteIndex] = ' ';
+        }
+    }
+
+    result = (prb_Str) {(const char*)procSelfContent.data, procSelfContent.len - 1};
+
+#elif
+#error unimplemented
+#endif
+
+    return result;
+}
+
+prb_PUBLICDEF prb_Str*
+prb_getCmdArgs(prb_Arena* arena) {
+    prb_Str* result = 0;
+
+#if prb_PLATFORM_WINDOWS
+
+    prb_StrSplitResult split = prb_strSplit(arena, prb_getCmdline(arena), prb_STR(" "), prb_StrSplitFlag_SkipEmpty);
+    for (int32_t argIndex = 0; argIndex < split.count; argIndex++) {
+        prb_stbds_arrput(result, split.tokens[argIndex]);
+    }
+
+#elif prb_PLATFORM_LINUX
+
+    // NOTE(khvorov) Every arg ends with a null, empty args are kept
+    prb_Str procSelfContent = prb_strFromBytes(prb_linux_readFromProc(arena, prb_STR("self/cmdline")));
+    if (procSelfContent.len > 0) {
+        prb_Str            nullDelim = {"\0", 1};
+        prb_StrSplitResult split = prb_strSplit(arena, prb_strSlice(procSelfContent, 0, procSelfContent.len - 1), nullDelim, 0);
+        for (int32_t argIndex = 0; argIndex < split.count; argIndex++) {
+            prb_stbds_arrput(result, split.tokens[argIndex]);
+        }
+    }
+
+#elif
+#error unimplemented
+#endif
+
+    return result;
+}
+
+prb_PUBLICDEF const char**
+prb_getArgArrayFromStr(prb_Arena* arena, prb_Str str) {
+    const char** args = 0;
+
+    {
+        prb_StrSplitResult split = prb_strSplit(arena, str, prb_STR(" "), prb_StrSplitFlag_SkipEmpty);
+        for (int32_t argIndex = 0; argIndex < split.count; argIndex++) {
+            const char* argNull = prb_strGetNullTerminated(arena, split.tokens[argIndex]);
+            prb_stbds_arrput(args, argNull);
+        }
+    }
+
+    // NOTE(khvorov) Arg array needs a null at the end
+    prb_stbds_arrsetcap(args, (size_t)(prb_stbds_arrlen(args) + 1));
+    args[prb_stbds_arrlen(args)] = 0;
+
+    return args;
+}
+
+prb_PUBLICDEF prb_CoreCountResult
+prb_getCoreCount(prb_Arena* arena) {
+    prb_TempMemory      temp = prb_beginTempMemory(arena);
+    prb_CoreCountResult result = {.success = false, .cores = 0};
+#if prb_PLATFORM_WINDOWS
+    SYSTEM_INFO sysinfo;
+    prb_memset(&sysinfo, 0, sizeof(sysinfo));
+    GetSystemInfo(&sysinfo);
+    result.success = true;
+    result.cores = (int32_t)sysinfo.dwNumberOfProcessors;
+#elif prb_PLATFORM_LINUX
+    prb_Str cpuinfo = prb_strFromBytes(prb_linux_readFromProc(arena, prb_STR("cpuinfo")));
+    prb_StrScanner scanner = prb_createStrScanner(cpuinfo);
+    prb_StrFindSpec spec = {};
+    spec.pattern = prb_STR("processor");
+    spec.direction = prb_StrDirection_FromEnd;
+    if (prb_strScannerMove(&scanner, spec, prb_StrScannerSide_AfterMatch)) {
+        spec.pattern = prb_STR(":");
+        spec.direction = prb_StrDirection_FromStart;
+        if (prb_strScannerMove(&scanner, spec, prb_StrScannerSide_AfterMatch)) {
+            spec.mode = prb_StrFindMode_LineBreak;
+            if (prb_strScannerMove(&scanner, spec, prb_StrScannerSide_AfterMatch)) {
+                prb_Str coresStr = prb_strTrim(scanner.betweenLastMatches);
+                prb_ParseUintResult parse = prb_parseUint(coresStr, 10);
+                if (parse.success) {
+                    result.success = true;
+                    // NOTE(khvorov) This number is the last CPU index + 1
+                    // Sibling count is not accurate on boards with multiple sockets
+                    result.cores = parse.number + 1;
+                }
+            }
+        }
+    }
+#else
+#error unimplemented
+#endif
+    prb_endTempMemory(temp);
+    return result;
+}
+
+prb_PUBLICDEF prb_CoreCountResult
+prb_getAllowExecutionCoreCount(prb_Arena* arena) {
+    prb_CoreCountResult result = {.success = false, .cores = 0};
+    prb_TempMemory      temp = prb_beginTempMemory(arena);
+
+#if prb_PLATFORM_WINDOWS
+    prb_windows_GetAffinityResult affinityRes = prb_windows_getAffinity();
+    if (affinityRes.success) {
+        result.success = true;
+        result.cores = affinityRes.setBits;
+    }
+#elif prb_PLATFORM_LINUX
+    prb_linux_GetAffinityResult affinityRes = prb_linux_getAffinity(arena);
+    if (affinityRes.success) {
+        result.success = true;
+        result.cores = affinityRes.setBits;
+    }
+#else
+#error unimplemented
+#endif
+
+    prb_endTempMemory(temp);
+    return result;
+}
+
+prb_PUBLICDEF prb_Status
+prb_allowExecutionOnCores(prb_Arena* arena, int32_t coreCount) {
+    prb_Status     result = prb_Failure;
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+    if (coreCount >= 1) {
+#if prb_PLATFORM_WINDOWS
+        prb_windows_GetAffinityResult affinityRes = prb_windows_getAffinity();
+        if (affinityRes.success) {
+            DWORD_PTR newAffinityMask = affinityRes.affinity;
+            int32_t   coreDelta = coreCount - affinityRes.setBits;
+            for (int32_t bitIndex = 0; bitIndex < (int32_t)sizeof(DWORD_PTR) * 8 && coreDelta != 0; bitIndex++) {
+                DWORD_PTR mask = ((DWORD_PTR)1) << bitIndex;
+                bool      coreIsScheduled = (newAffinityMask & mask) == mask;
+                if (coreIsScheduled) {
+                    if (coreDelta > 0) {
+                        newAffinityMask = newAffinityMask | mask;
+                        coreDelta -= 1;
+                    } else {
+                        newAffinityMask = newAffinityMask & (~mask);
+                        coreDelta += 1;
+                    }
+                }
+            }
+
+            if (coreCount != affinityRes.setBits) {
+                if (SetProcessAffinityMask(GetCurrentProcess(), newAffinityMask)) {
+                    result = prb_Success;
+                }
+            } else {
+                result = prb_Success;
+            }
+        }
+
+#elif prb_PLATFORM_LINUX
+
+        prb_linux_GetAffinityResult affinityRes = prb_linux_getAffinity(arena);
+        if (affinityRes.success) {
+            if (coreCount > affinityRes.setBits) {
+                int32_t coresToSchedule = coreCount - affinityRes.setBits;
+                for (int32_t byteIndex = 0; byteIndex < affinityRes.size && coresToSchedule > 0; byteIndex++) {
+                    uint8_t byte = affinityRes.affinity[byteIndex];
+                    for (int32_t bitIndex = 0; bitIndex < 8 && coresToSchedule > 0; bitIndex++) {
+                        uint8_t mask = 1 << bitIndex;
+                        bool coreIsScheduled = (byte & mask) != 0;
+                        if (!coreIsScheduled) {
+                            byte = byte | mask;
+                            affinityRes.affinity[byteIndex] = byte;
+                            coresToSchedule -= 1;
+                        }
+                    }
+                }
+            } else if (coreCount < affinityRes.setBits) {
+                int32_t coresToUnschedule = affinityRes.setBits - coreCount;
+                for (int32_t byteIndex = 0; byteIndex < affinityRes.size && coresToUnschedule > 0; byteIndex++) {
+                    uint8_t byte = affinityRes.affinity[byteIndex];
+                    for (int32_t bitIndex = 0; bitIndex < 8 && coresToUnschedule > 0; bitIndex++) {
+                        uint8_t mask = 1 << bitIndex;
+                        bool coreIsScheduled = (byte & mask) != 0;
+                        if (coreIsScheduled) {
+                            byte = byte & (~mask);
+                            affinityRes.affinity[byteIndex] = byte;
+                            coresToUnschedule -= 1;
+                        }
+                    }
+                }
+            }
+
+            if (coreCount != affinityRes.setBits) {
+                int setAffinityResult = syscall(SYS_sched_setaffinity, 0, affinityRes.size, affinityRes.affinity);
+                if (setAffinityResult == 0) {
+                    result = prb_Success;
+                }
+            } else {
+                result = prb_Success;
+            }
+        }
+#else
+#error unimplemented
+#endif
+    }
+    prb_endTempMemory(temp);
+    return result;
+}
+
+prb_PUBLICDEF prb_Process
+prb_createProcess(prb_Str cmd, prb_ProcessSpec spec) {
+    prb_Process proc;
+    prb_memset(&proc, 0, sizeof(proc));
+    proc.cmd = cmd;
+    proc.spec = spec;
+    return proc;
+}
+
+prb_PUBLICDEF prb_Status
+prb_launchProcesses(prb_Arena* arena, prb_Process* procs, int32_t procCount, prb_Background mode) {
+    prb_Status     result = prb_Success;
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+
+    for (int32_t procIndex = 0; procIndex < procCount; procIndex++) {
+        prb_Process* proc = procs + procIndex;
+        if (proc->status == prb_ProcessStatus_NotLaunched) {
+            prb_ProcessSpec spec = proc->spec;
+
+#if prb_PLATFORM_WINDOWS
+
+            STARTUPINFOW startupInfo;
+            prb_memset(&startupInfo, 0, sizeof(startupInfo));
+            startupInfo.cb = sizeof(STARTUPINFOW);
+
+            bool    redirectSuccessful = true;
+            BOOL    inheritHandles = spec.redirectStdout || spec.redirectStderr;
+            HANDLE  handlesToClose[2] = {0, 0};
+            int32_t handlesToCloseCount = 0;
+
+            if (inheritHandles) {
+                startupInfo.dwFlags = STARTF_USESTDHANDLES;
+
+                SECURITY_ATTRIBUTES securityAttr = {
+                    .nLength = sizeof(securityAttr),
+                    .lpSecurityDescriptor = NULL,
+                    .bInheritHandle = TRUE,
+                };
+
+                prb_Str stdoutPath = spec.stdoutFilepath;
+                if (stdoutPath.ptr == 0 || stdoutPath.len == 0) {
+                    stdoutPath = prb_STR("NUL");
+                }
+
+                prb_Str stderrPath = spec.stderrFilepath;
+                if (stderrPath.ptr == 0 || stderrPath.len == 0) {
+                    stderrPath = prb_STR("NUL");
+                }
+
+                if (spec.redirectStdout && spec.redirectStderr && prb_streq(stdoutPath, stderrPath)) {
+                    prb_windows_OpenResult openRes = prb_windows_open(arena, stdoutPath, GENERIC_WRITE, FILE_SHARE_WRITE, CREATE_ALWAYS, &securityAttr);
+                    if (openRes.success) {
+                        startupInfo.hStdOutput = openRes.handle;
+                        startupInfo.hStdError = openRes.handle;
+                        handlesToClose[handlesToCloseCount++] = openRes.handle;
+                    } else {
+                        redirectSuccessful = false;
+                    }
+                } else {
+                    if (spec.redirectStdout) {
+                        prb_windows_OpenResult openRes = prb_windows_open(arena, stdoutPath, GENERIC_WRITE, 0, CREATE_ALWAYS, &securityAttr);
+                        if (openRes.success) {
+                            startupInfo.hStdOutput = openRes.handle;
+                            handlesToClose[handlesToCloseCount++] = openRes.handle;
+                        } else {
+                            redirectSuccessful = false;
+                        }
+                    }
+
+                    if (spec.redirectStderr) {
+                        prb_windows_OpenResult openRes = prb_windows_open(arena, stderrPath, GENERIC_WRITE, 0, CREATE_ALWAYS, &securityAttr);
+                        if (openRes.success) {
+                            startupInfo.hStdError = openRes.handle;
+                            handlesToClose[handlesToCloseCount++] = openRes.handle;
+                        } else {
+                            redirectSuccessful = false;
+                        }
+                    }
+                }
+            }
+
+            if (redirectSuccessful) {
+                // NOTE(khvorov) Just replace spaces with null terminators and stick that to the start of the
+                // existing environment and call it a day.
+                LPWCH env = 0;
+                if (spec.addEnv.ptr && spec.addEnv.len > 0) {
+                    prb_windows_WideStr envCopy = prb_windows_getWideStr(arena, spec.addEnv);
+                    for (int32_t envIndex = 0; envIndex < envCopy.len; envIndex++) {
+                        if (envCopy.ptr[envIndex] == ' ') {
+                            envCopy.ptr[envIndex] = '\0';
+                        }
+                    }
+                    LPWCH   existingEnv = GetEnvironmentStringsW();
+                    int32_t existingEnvLen = 0;
+                    for (;;) {
+                        if (existingEnv[existingEnvLen] == '\0' && existingEnv[existingEnvLen + 1] == '\0') {
+                            break;
+                        } else {
+                            existingEnvLen += 1;
+                        }
+                    }
+                    env = (LPWCH)prb_arenaAllocArray(arena, uint16_t, envCopy.len + 1 + existingEnvLen + 2);
+                    prb_memcpy(env, envCopy.ptr, envCopy.len * sizeof(*envCopy.ptr));
+                    prb_memcpy(env + envCopy.len + 1, existingEnv, existingEnvLen * sizeof(*existingEnv));
+                    FreeEnvironmentStringsW(existingEnv);
+                }
+
+                prb_windows_WideStr wcmd = prb_windows_getWideStr(arena, proc->cmd);
+                if (CreateProcessW(0, wcmd.ptr, 0, 0, inheritHandles, CREATE_UNICODE_ENVIRONMENT, env, 0, &startupInfo, &proc->processInfo)) {
+                    proc->status = prb_ProcessStatus_Launched;
+                    if (mode == prb_Background_No) {
+                        prb_windows_waitForProcess(proc);
+                    }
+                }
+            }
+
+            for (int32_t handleIndex = 0; handleIndex < handlesToCloseCount; handleIndex++) {
+                CloseHandle(handlesToClose[handleIndex]);
+            }
+
+#elif prb_PLATFORM_LINUX
+
+            const char* stdoutPath = 0;
+            if (spec.redirectStdout) {
+                if (spec.stdoutFilepath.ptr && spec.stdoutFilepath.len > 0) {
+                    stdoutPath = prb_strGetNullTerminated(arena, spec.stdoutFilepath);
+                } else {
+                    stdoutPath = "/dev/null";
+                }
+            }
+
+            const char* stderrPath = 0;
+            if (spec.redirectStderr) {
+                if (spec.stderrFilepath.ptr && spec.stderrFilepath.len > 0) {
+                    stderrPath = prb_strGetNullTerminated(arena, spec.stderrFilepath);
+                } else {
+                    stderrPath = "/dev/null";
+                }
+            }
+
+            bool fileActionsSucceeded = true;
+            bool fileActionsInited = false;
+            posix_spawn_file_actions_t* fileActionsPtr = 0;
+            posix_spawn_file_actions_t fileActions = {};
+            if (spec.redirectStdout || spec.redirectStderr) {
+                fileActionsPtr = &fileActions;
+                int initResult = posix_spawn_file_actions_init(&fileActions);
+                fileActionsSucceeded = initResult == 0;
+                fileActionsInited = initResult == 0;
+                if (fileActionsSucceeded) {
+                    if (spec.redirectStdout) {
+                        int stdoutRedirectResult = posix_spawn_file_actions_addopen(
+                            &fileActions,
+                            STDOUT_FILENO,
+                            stdoutPath,
+                            O_WRONLY | O_CREAT | O_TRUNC,
+                            S_IRUSR | S_IRGRP | S_IROTH | S_IWUSR
+                        );
+                        fileActionsSucceeded = stdoutRedirectResult == 0;
+                    }
+
+                    if (fileActionsSucceeded && spec.redirectStderr) {
+                        if (spec.redirectStdout && prb_streq(prb_STR(stdoutPath), prb_STR(stderrPath))) {
+                            int dupResult = posix_spawn_file_actions_adddup2(&fileActions, STDOUT_FILENO, STDERR_FILENO);
+                            fileActionsSucceeded = dupResult == 0;
+                        } else {
+                            int stderrRedirectResult = posix_spawn_file_actions_addopen(
+                                &fileActions,
+                                STDERR_FILENO,
+                                stderrPath,
+                                O_WRONLY | O_CREAT | O_TRUNC,
+                                S_IRUSR | S_IRGRP | S_IROTH | S_IWUSR
+                            );
+                            fileActionsSucceeded = stderrRedirectResult == 0;
+                        }
+                    }
+                }
+            }
+
+            if (fileActionsSucceeded) {
+                bool envSucceeded = true;
+                char** env = __environ;
+                bool envAllocated = false;
+                if (proc->spec.addEnv.ptr && proc->spec.addEnv.len > 0) {
+                    envAllocated = true;
+                    env = 0;
+
+                    prb_StrFindSpec equals = {};
+                    equals.pattern = prb_STR("=");
+                    prb_StrFinder equalsFinder = prb_createStrFinder(equals);
+                    prb_StrSplitResult entries = prb_strSplit(arena, proc->spec.addEnv, prb_STR(" "), prb_StrSplitFlag_SkipEmpty);
+                    prb_Str* newVarNames = 0;
+                    for (int32_t entryIndex = 0; entryIndex < entries.count && envSucceeded; entryIndex++) {
+                        prb_Str entry = entries.tokens[entryIndex];
+                        envSucceeded = false;
+                        prb_StrScanner nameScanner = prb_createStrScanner(entry);
+                        if (prb_strScannerMoveWith(&nameScanner, &equalsFinder, prb_StrScannerSide_AfterMatch)) {
+                            if (nameScanner.betweenLastMatches.len > 0) {
+                                char* newEnvEntry = (char*)prb_strGetNullTerminated(arena, entry);
+                                prb_stbds_arrput(env, newEnvEntry);
+                                prb_stbds_arrput(newVarNames, nameScanner.betweenLastMatches);
+                                envSucceeded = true;
+                            }
+                        }
+                    }
+
+                    if (envSucceeded) {
+                        for (int32_t envIndex = 0;; envIndex++) {
+                            char* existingEntry = __environ[envIndex];
+                            if (existingEntry) {
+                                prb_StrScanner nameScanner = prb_createStrScanner(prb_STR(existingEntry));
+                                prb_assert(prb_strScannerMoveWith(&nameScanner, &equalsFinder, prb_StrScannerSide_AfterMatch));
+                                prb_assert(nameScanner.betweenLastMatches.len > 0);
+                                prb_Str existingName = nameScanner.betweenLastMatches;
+                                bool existingInNew = false;
+                                for (int32_t newVarIndex = 0; newVarIndex < prb_stbds_arrlen(newVarNames) && !existingInNew; newVarIndex++) {
+                                    prb_Str newVarName = newVarNames[newVarIndex];
+                                    existingInNew = prb_streq(newVarName, existingName);
+                                }
+                                if (!existingInNew) {
+                                    prb_stbds_arrput(env, existingEntry);
+                                }
+                            } else {
+                                break;
+                            }
+                        }
+
+                        // NOTE(khvorov) Null-terminate the new env array
+                        prb_stbds_arrput(env, 0);
+                    }
+
+                    prb_stbds_arrfree(newVarNames);
+                }
+
+                if (envSucceeded) {
+                    const char** args = prb_getArgArrayFromStr(arena, proc->cmd);
+                    int spawnResult = posix_spawnp(&proc->pid, args[0], fileActionsPtr, 0, (char**)args, env);
+                    if (spawnResult == 0) {
+                        proc->status = prb_ProcessStatus_Launched;
+                        if (mode == prb_Background_No) {
+                            prb_linux_waitForProcess(proc);
+                        }
+                    }
+                    prb_stbds_arrfree(args);
+                }
+
+                if (envAllocated) {
+                    prb_stbds_arrfree(env);
+                }
+            }
+
+            if (fileActionsInited) {
+                posix_spawn_file_actions_destroy(fileActionsPtr);
+            }
+
+#else
+#error unimplemented
+#endif
+
+            prb_ProcessStatus reqStatus = prb_ProcessStatus_CompletedSuccess;
+            if (mode == prb_Background_Yes) {
+                reqStatus = prb_ProcessStatus_Launched;
+            }
+            if (proc->status != reqStatus) {
+                result = prb_Failure;
+            }
+        }
+    }
+
+    prb_endTempMemory(temp);
+    return result;
+}
+
+prb_PUBLICDEF prb_Status
+prb_waitForProcesses(prb_Process* handles, int32_t handleCount) {
+    prb_Status result = prb_Success;
+
+    for (int32_t handleIndex = 0; handleIndex < handleCount; handleIndex++) {
+        prb_Process* handle = handles + handleIndex;
+        prb_assert(handle->status != prb_ProcessStatus_NotLaunched);
+        if (handle->status == prb_ProcessStatus_Launched) {
+#if prb_PLATFORM_WINDOWS
+            prb_windows_waitForProcess(handle);
+#elif prb_PLATFORM_LINUX
+            prb_linux_waitForProcess(handle);
+#else
+#error unimplemented
+#endif
+
+            if (handle->status != prb_ProcessStatus_CompletedSuccess) {
+                result = prb_Failure;
+            }
+        }
+    }
+
+    return result;
+}
+
+prb_PUBLICDEF prb_Status
+prb_killProcesses(prb_Process* handles, int32_t handleCount) {
+    prb_Status result = prb_Success;
+
+    for (int32_t handleIndex = 0; handleIndex < handleCount; handleIndex++) {
+        prb_Process* handle = handles + handleIndex;
+        prb_assert(handle->status != prb_ProcessStatus_NotLaunched);
+        if (handle->status == prb_ProcessStatus_Launched) {
+#if prb_PLATFORM_WINDOWS
+            if (TerminateProcess(handle->processInfo.hProcess, 9)) {
+                handle->status = prb_ProcessStatus_CompletedFailed;
+                CloseHandle(handle->processInfo.hProcess);
+                CloseHandle(handle->processInfo.hThread);
+            }
+#elif prb_PLATFORM_LINUX
+            if (kill(handle->pid, SIGKILL) == 0) {
+                handle->status = prb_ProcessStatus_CompletedFailed;
+            }
+#else
+#error unimplemented
+#endif
+
+            if (handle->status != prb_ProcessStatus_CompletedFailed) {
+                result = prb_Failure;
+            }
+        }
+    }
+
+    return result;
+}
+
+prb_PUBLICDEF void
+prb_sleep(float ms) {
+#if prb_PLATFORM_WINDOWS
+
+    prb_TimeStart timeStart = prb_timeStart();
+    DWORD         msec = (DWORD)(ms);
+    Sleep(msec);
+    float msSpentSleeping = prb_getMsFrom(timeStart);
+
+    float left = ms - msSpentSleeping;
+    float msSpentSpinning = 0.0f;
+    timeStart = prb_timeStart();
+    while (msSpentSpinning < left) {
+        msSpentSpinning = prb_getMsFrom(timeStart);
+    }
+
+#elif prb_PLATFORM_LINUX
+
+    float secf = ms * 0.001f;
+    long int sec = (long int)(secf);
+    long int nsec = (long int)((secf - (float)sec) * 1000.0f * 1000.0f * 1000.0f);
+    struct timespec ts = {.tv_sec = sec, .tv_nsec = nsec};
+    nanosleep(&ts, 0);
+
+#else
+#error unimplemented
+#endif
+}
+
+prb_PUBLICDEF bool
+prb_debuggerPresent(prb_Arena* arena) {
+    bool           result = false;
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+
+#if prb_PLATFORM_WINDOWS
+
+    result = IsDebuggerPresent();
+
+#elif prb_PLATFORM_LINUX
+
+    prb_Bytes     content = prb_linux_readFromProc(arena, prb_STR("self/status"));
+    prb_LineIndex lines = prb_buildLineIndex(arena, prb_strFromBytes(content));
+    for (prb_LineIter iter = prb_createLineIter(&lines); prb_lineIterNext(&iter) == prb_Success;) {
+        prb_Str search = prb_STR("TracerPid:");
+        if (prb_strStartsWith(iter.curLine, search)) {
+            prb_Str number = prb_strTrim(prb_strSlice(iter.curLine, search.len, iter.curLine.len));
+            result = number.len > 1 || number.ptr[0] != '0';
+            break;
+        }
+    }
+
+#else
+#error unimplemented
+#endif
+
+    prb_endTempMemory(temp);
+    return result;
+}
+
+prb_PUBLICDEF prb_Status
+prb_setenv(prb_Arena* arena, prb_Str name, prb_Str value) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+    prb_Status     result = prb_Failure;
+
+#if prb_PLATFORM_WINDOWS
+
+    prb_windows_WideStr wname = prb_windows_getWideStr(arena, name);
+    prb_windows_WideStr wvalue = prb_windows_getWideStr(arena, value);
+    if (SetEnvironmentVariableW(wname.ptr, wvalue.ptr)) {
+        result = prb_Success;
+    }
+
+#elif prb_PLATFORM_LINUX
+    const char* nameNull = prb_strGetNullTerminated(arena, name);
+    const char* valueNull = prb_strGetNullTerminated(arena, value);
+    result = setenv(nameNull, valueNull, 1) == 0 ? prb_Success : prb_Failure;
+#else
+#error unimplemented
+#endif
+
+    prb_endTempMemory(temp);
+    return result;
+}
+
+prb_PUBLICDEF prb_GetenvResult
+prb_getenv(prb_Arena* arena, prb_Str name) {
+    prb_GetenvResult result;
+    prb_memset(&result, 0, sizeof(result));
+
+#if prb_PLATFORM_WINDOWS
+
+    prb_arenaAlignFreePtr(arena, prb_alignof(uint16_t));
+    prb_windows_WideStr wname = prb_windows_getWideStr(arena, name);
+    LPWSTR              wptr = (LPWSTR)prb_arenaFreePtr(arena);
+    DWORD               getEnvResult = GetEnvironmentVariableW(wname.ptr, wptr, (DWORD)prb_min(prb_arenaFreeSize(arena), UINT32_MAX));
+    if (getEnvResult > 0) {
+        prb_arenaChangeUsed(arena, (int32_t)getEnvResult * (int32_t)sizeof(*wptr));
+        prb_arenaAllocAndZero(arena, 2, 1);  // NOTE(khvorov) Null terminator
+        result.str = prb_windows_strFromWideStr(arena, (prb_windows_WideStr) {wptr, (int32_t)getEnvResult});
+        result.found = true;
+    }
+
+#elif prb_PLATFORM_LINUX
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+    const char* nameNull = prb_strGetNullTerminated(arena, name);
+    char* str = getenv(nameNull);
+    if (str) {
+        result.found = true;
+        result.str = prb_STR(str);
+    }
+    prb_endTempMemory(temp);
+
+#else
+#error unimplemented
+#endif
+
+    return result;
+}
+
+prb_PUBLICDEF prb_Status
+prb_unsetenv(prb_Arena* arena, prb_Str name) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+    prb_Status     result = prb_Failure;
+
+#if prb_PLATFORM_WINDOWS
+
+    prb_windows_WideStr wname = prb_windows_getWideStr(arena, name);
+    if (SetEnvironmentVariableW(wname.ptr, NULL)) {
+        result = prb_Success;
+    }
+
+#elif prb_PLATFORM_LINUX
+
+    const char* nameNull = prb_strGetNullTerminated(arena, name);
+    result = unsetenv(nameNull) == 0 ? prb_Success : prb_Failure;
+
+#else
+#error unimplemented
+#endif
+
+    prb_endTempMemory(temp);
+    return result;
+}
+
+// NOTE(khvorov) Meant to be called first thing in main with __FILE__ and the flags the build script uses.
+// Only the source and cbuild.h are checked. The implementation is compiled once into an object next to
+// the executable and reused until cbuild.h changes. If anything was rebuilt the new executable is run
+// in place of this one with the same arguments.
+prb_PUBLICDEF void
+prb_rebuildSelfIfChanged(prb_Arena* arena, prb_Str sourcePath, prb_Str flags) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+    prb_Str        rebuiltEnv = prb_STR("prb_REBUILT_SELF");
+
+    // NOTE(khvorov) Set for the rebuilt executable so that a stamp that failed to write can't cause a loop
+    if (prb_getenv(arena, rebuiltEnv).found) {
+        prb_unsetenv(arena, rebuiltEnv);
+    } else {
+        prb_Str exePath = {};
+
+#if prb_PLATFORM_WINDOWS
+
+        prb_arenaAlignFreePtr(arena, prb_alignof(uint16_t));
+        LPWSTR ptrWide = (LPWSTR)prb_arenaFreePtr(arena);
+        DWORD  lenWide = GetModuleFileNameW(0, ptrWide, (DWORD)prb_min(prb_arenaFreeSize(arena), UINT32_MAX) / sizeof(uint16_t));
+        prb_assert(lenWide > 0);
+        prb_arenaChangeUsed(arena, (int32_t)lenWide * (int32_t)sizeof(uint16_t));
+        prb_arenaAllocAndZero(arena, 2, 1);  // NOTE(khvorov) Null terminator
+        exePath = prb_windows_strFromWideStr(arena, (prb_windows_WideStr) {ptrWide, (int32_t)lenWide});
+        prb_Str linkFlags = prb_STR("-Xlinker /incremental:no");
+
+#elif prb_PLATFORM_LINUX
+
+        char*   exeBuf = (char*)prb_arenaFreePtr(arena);
+        ssize_t exeLen = readlink("/proc/self/exe", exeBuf, (size_t)prb_min(prb_arenaFreeSize(arena) - 1, INT32_MAX));
+        prb_assert(exeLen > 0);
+        prb_arenaChangeUsed(arena, exeLen);
+        prb_arenaAllocAndZero(arena, 1, 1);  // NOTE(khvorov) Null terminator
+        exePath.ptr = exeBuf;
+        exePath.len = (int32_t)exeLen;
+        prb_Str linkFlags = prb_STR("-lpthread");
+
+#else
+#error unimplemented
+#endif
+
+        // NOTE(khvorov) __FILE__ is whatever the compiler was given, the rebuilt executable gets absolute paths
+        prb_Str      source = prb_getAbsolutePath(arena, sourcePath);
+        prb_Str      header = prb_getAbsolutePath(arena, prb_STR(__FILE__));
+        prb_FileHash sourceHash = prb_getFileHash(arena, source);
+        prb_FileHash headerHash = prb_getFileHash(arena, header);
+        if (sourceHash.valid && headerHash.valid) {
+            uint64_t flagsHash = prb_stbds_hash_bytes((void*)flags.ptr, (size_t)flags.len, (size_t)1);
+            uint64_t sourceKey[] = {sourceHash.hash, flagsHash};
+            uint64_t headerKey[] = {headerHash.hash, flagsHash};
+            prb_Str  headerStamp = prb_fmt(arena, "0x%llX", (unsigned long long)prb_stbds_hash_bytes(headerKey, sizeof(headerKey), (size_t)1));
+            prb_Str  stamp = prb_fmt(arena, "0x%llX %.*s", (unsigned long long)prb_stbds_hash_bytes(sourceKey, sizeof(sourceKey), (size_t)1), prb_LIT(headerStamp));
+
+            prb_Str                  stampPath = prb_replaceExt(arena, exePath, prb_STR("rebuild"));
+            prb_ReadEntireFileResult prevStampRead = prb_readEntireFile(arena, stampPath);
+            prb_Str                  prevStamp = prevStampRead.success ? prb_strFromBytes(prevStampRead.content) : prb_STR("");
+            if (!prb_streq(stamp, prevStamp)) {
+                prb_Str    implObj = prb_replaceExt(arena, exePath, prb_STR("cbuild.obj"));
+                prb_Str    newExe = prb_replaceExt(arena, exePath, prb_STR("new"));
+                prb_Status status = prb_Success;
+
+                if (!prb_strEndsWith(prevStamp, headerStamp) || !prb_isFile(arena, implObj)) {
+                    prb_Str     cmd = prb_fmt(arena, "clang %.*s -Dprb_NOT_STATIC -x c -c %.*s -o %.*s", prb_LIT(flags), prb_LIT(header), prb_LIT(implObj));
+                    prb_writelnToStdout(arena, cmd);
+                    prb_Process proc = prb_createProcess(cmd, (prb_ProcessSpec) {});
+                    status = prb_launchProcesses(arena, &proc, 1, prb_Background_No);
+                }
+
+                if (status == prb_Success) {
+                    prb_Str     cmd = prb_fmt(arena, "clang %.*s -Dprb_NO_IMPLEMENTATION %.*s %.*s -o %.*s %.*s", prb_LIT(flags), prb_LIT(source), prb_LIT(implObj), prb_LIT(newExe), prb_LIT(linkFlags));
+                    prb_writelnToStdout(arena, cmd);
+                    prb_Process proc = prb_createProcess(cmd, (prb_ProcessSpec) {});
+                    status = prb_launchProcesses(arena, &proc, 1, prb_Background_No);
+                }
+
+                if (status == prb_Success) {
+#if prb_PLATFORM_WINDOWS
+                    // NOTE(khvorov) A running executable can't be replaced but it can be moved out of the way
+                    prb_windows_WideStr exeWide = prb_windows_getWideStr(arena, exePath);
+                    prb_windows_WideStr oldWide = prb_windows_getWideStr(arena, prb_replaceExt(arena, exePath, prb_STR("old")));
+                    prb_windows_WideStr newWide = prb_windows_getWideStr(arena, newExe);
+                    bool                moved = MoveFileExW(exeWide.ptr, oldWide.ptr, MOVEFILE_REPLACE_EXISTING) && MoveFileExW(newWide.ptr, exeWide.ptr, MOVEFILE_REPLACE_EXISTING);
+#elif prb_PLATFORM_LINUX
+                    bool moved = rename(prb_strGetNullTerminated(arena, newExe), prb_strGetNullTerminated(arena, exePath)) == 0;
+#else
+#error unimplemented
+#endif
+                    status = moved ? prb_Success : prb_Failure;
+                }
+
+                if (status == prb_Failure) {
+                    prb_writelnToStdout(arena, prb_fmt(arena, "%sfailed to rebuild %.*s%s", prb_colorEsc(prb_ColorID_Red).ptr, prb_LIT(exePath), prb_colorEsc(prb_ColorID_Reset).ptr));
+                    prb_terminate(1);
+                }
+
+                prb_writeEntireFile(arena, stampPath, stamp.ptr, stamp.len);
+                prb_setenv(arena, rebuiltEnv, prb_STR("1"));
+
+#if prb_PLATFORM_WINDOWS
+                prb_Process proc = prb_createProcess(prb_getCmdline(arena), (prb_ProcessSpec) {});
+                prb_terminate(prb_launchProcesses(arena, &proc, 1, prb_Background_No) == prb_Success ? 0 : 1);
+#elif prb_PLATFORM_LINUX
+                prb_Str* args = prb_getCmdArgs(arena);
+                char**   argv = prb_arenaAllocArray(arena, char*, prb_stbds_arrlen(args) + 1);
+                argv[0] = (char*)prb_strGetNullTerminated(arena, exePath);
+                for (int32_t argIndex = 1; argIndex < prb_stbds_arrlen(args); argIndex++) {
+                    argv[argIndex] = (char*)prb_strGetNullTerminated(arena, args[argIndex]);
+                }
+                execv(argv[0], argv);
+                // NOTE(khvorov) Only returns on failure
+                prb_terminate(1);
+#else
+#error unimplemented
+#endif
+            }
+        }
+    }
+
+    prb_endTempMemory(temp);
+}
+
+//
+// SECTION Timing (implementation)
+//
+
+prb_PUBLICDEF prb_TimeStart
+prb_timeStart(void) {
+    prb_TimeStart result;
+    prb_memset(&result, 0, sizeof(result));
+#if prb_PLATFORM_WINDOWS
+    LARGE_INTEGER ticks;
+    prb_memset(&ticks, 0, sizeof(ticks));
+    if (QueryPerformanceCounter(&ticks)) {
+        result.valid = true;
+        result.ticks = ticks.QuadPart;
+    }
+#elif prb_PLATFORM_LINUX
+    struct timespec tp = {};
+    if (clock_gettime(CLOCK_MONOTONIC, &tp) == 0) {
+        prb_assert(tp.tv_nsec >= 0 && tp.tv_sec >= 0);
+        result.nsec = (uint64_t)tp.tv_nsec + (uint64_t)tp.tv_sec * 1000 * 1000 * 1000;
+        result.valid = true;
+    }
+#else
+#error unimplemented
+#endif
+    return result;
+}
+
+prb_PUBLICDEF float
+prb_getMsFrom(prb_TimeStart timeStart) {
+    prb_TimeStart now = prb_timeStart();
+    float         result = 0.0f;
+    if (now.valid && timeStart.valid) {
+#if prb_PLATFORM_WINDOWS
+        LARGE_INTEGER ticksPerSecond;
+        prb_memset(&ticksPerSecond, 0, sizeof(ticksPerSecond));
+        if (QueryPerformanceFrequency(&ticksPerSecond)) {
+            LONGLONG ticksDiff = now.ticks - timeStart.ticks;
+            float    secs = (float)ticksDiff / (float)ticksPerSecond.QuadPart;
+            result = secs * 1000.0f;
+        }
+#elif prb_PLATFORM_LINUX
+        uint64_t nsec = now.nsec - timeStart.nsec;
+        result = (float)nsec / 1000.0f / 1000.0f;
+#else
+#error unimplemented
+#endif
+    }
+    return result;
+}
+
+//
+// SECTION Multithreading (implementation)
+//
+
+#if prb_PLATFORM_WINDOWS
+
+static DWORD WINAPI
+prb_windows_threadProc(void* data) {
+    prb_Job* job = (prb_Job*)data;
+    job->proc(&job->arena, job->data);
+    return 0;
+}
+
+#elif prb_PLATFORM_LINUX
+
+static void*
+prb_linux_threadProc(void* data) {
+    prb_Job* job = (prb_Job*)data;
+    job->proc(&job->arena, job->data);
+    return 0;
+}
+
+#endif
+
+prb_PUBLICDEF prb_Job
+prb_createJob(prb_JobProc proc, void* data, prb_Arena* arena, int32_t arenaBytes) {
+    prb_Job job;
+    prb_memset(&job, 0, sizeof(job));
+    job.proc = proc;
+    job.data = data;
+    job.arena = prb_createArenaFromArena(arena, arenaBytes);
+    return job;
+}
+
+prb_PUBLICDEF prb_Status
+prb_launchJobs(prb_Job* jobs, int32_t jobsCount, prb_Background mode) {
+    prb_Status result = prb_Success;
+
+    switch (mode) {
+        case prb_Background_No: {
+            for (int32_t jobIndex = 0; jobIndex < jobsCount && result == prb_Success; jobIndex++) {
+                prb_Job* job = jobs + jobIndex;
+                if (job->status == prb_JobStatus_NotLaunched) {
+                    job->status = prb_JobStatus_Launched;
+                    job->proc(&job->arena, job->data);
+                    job->status = prb_JobStatus_Completed;
+                }
+            }
+        } break;
+
+        case prb_Background_Yes: {
+            for (int32_t jobIndex = 0; jobIndex < jobsCount && result == prb_Success; jobIndex++) {
+                prb_Job* job = jobs + jobIndex;
+                if (job->status == prb_JobStatus_NotLaunched) {
+                    job->status = prb_JobStatus_Launched;
+#if prb_PLATFORM_WINDOWS
+                    job->threadhandle = CreateThread(0, 0, prb_windows_threadProc, job, 0, &job->threadid);
+                    if (job->threadhandle == NULL) {
+                        result = prb_Failure;
+                    }
+#elif prb_PLATFORM_LINUX
+                    if (pthread_create(&job->threadid, 0, prb_linux_threadProc, job) != 0) {
+                        result = prb_Failure;
+                    }
+#else
+#error unimplemented
+#endif
+                }
+            }
+        } break;
+    }
+
+    return result;
+}
+
+prb_PUBLICDEF prb_Status
+prb_waitForJobs(prb_Job* jobs, int32_t jobsCount) {
+    prb_Status result = prb_Success;
+    for (int32_t jobIndex = 0; jobIndex < jobsCount; jobIndex++) {
+        prb_Job* job = jobs + jobIndex;
+        prb_assert(job->status != prb_JobStatus_NotLaunched);
+        if (job->status == prb_JobStatus_Launched) {
+#if prb_PLATFORM_WINDOWS
+
+            if (WaitForSingleObject(job->threadhandle, INFINITE) == WAIT_OBJECT_0) {
+                job->status = prb_JobStatus_Completed;
+            } else {
+                result = prb_Failure;
+            }
+
+#elif prb_PLATFORM_LINUX
+
+            if (pthread_join(job->threadid, 0) == 0) {
+                job->status = prb_JobStatus_Completed;
+            } else {
+                result = prb_Failure;
+            }
+
+#else
+#error unimplemented
+#endif
+        }
+    }
+
+    return result;
+}
+
+//
+// SECTION Remote execution (implementation)
+//
+
+typedef struct prb_remote_Queue {
+    prb_Action*      actions;
+    int32_t*         indices;
+    int32_t          count;
+    volatile int32_t next;
+} prb_remote_Queue;
+
+typedef struct prb_remote_Slot {
+    prb_remote_Queue* localOnly;
+    prb_remote_Queue* remoteEligible;
+    // NOTE(khvorov) Empty for local slots
+    prb_Str workerAddress;
+    prb_Str workerToken;
+} prb_remote_Slot;
+
+static prb_Action*
+prb_remote_queueNext(prb_remote_Queue* queue) {
+    prb_Action* result = 0;
+    if (queue->next < queue->count) {
+        int32_t index = prb_atomicFetchAddI32(&queue->next, 1);
+        if (index < queue->count) {
+            result = queue->actions + queue->indices[index];
+        }
+    }
+    return result;
+}
+
+static void
+prb_remote_runLocally(prb_Arena* arena, prb_Action* action) {
+    prb_TimeStart   start = prb_timeStart();
+    prb_ProcessSpec spec;
+    prb_memset(&spec, 0, sizeof(spec));
+    spec.addEnv = action->addEnv;
+    prb_Process proc = prb_createProcess(action->cmd, spec);
+    prb_launchProcesses(arena, &proc, 1, prb_Background_No);
+    action->status = proc.status == prb_ProcessStatus_CompletedSuccess ? prb_ProcessStatus_CompletedSuccess : prb_ProcessStatus_CompletedFailed;
+    action->durationMs = prb_getMsFrom(start);
+}
+
+#if prb_PLATFORM_LINUX
+
+// NOTE(khvorov) Every message is a header (kind and payload length) followed by the payload.
+// All integers are u64 little-endian, strings are length-prefixed.
+typedef enum prb_remote_MsgKind {
+    prb_remote_MsgKind_Hello = 1,
+    prb_remote_MsgKind_Action,
+    prb_remote_MsgKind_Need,
+    prb_remote_MsgKind_Blob,
+    prb_remote_MsgKind_Result,
+    prb_remote_MsgKind_Shutdown,
+} prb_remote_MsgKind;
+
+typedef struct prb_remote_Reader {
+    prb_Bytes bytes;
+    int32_t   offset;
+    bool      ok;
+} prb_remote_Reader;
+
+typedef struct prb_remote_RecvResult {
+    bool               success;
+    prb_remote_MsgKind kind;
+    prb_remote_Reader  reader;
+} prb_remote_RecvResult;
+
+static void
+prb_remote_encodeU64(uint8_t* dest, uint64_t value) {
+    for (int32_t byteIndex = 0; byteIndex < 8; byteIndex++) {
+        dest[byteIndex] = (uint8_t)(value >> (byteIndex * 8));
+    }
+}
+
+static uint64_t
+prb_remote_decodeU64(const uint8_t* src) {
+    uint64_t result = 0;
+    for (int32_t byteIndex = 0; byteIndex < 8; byteIndex++) {
+        result |= (uint64_t)src[byteIndex] << (byteIndex * 8);
+    }
+    return result;
+}
+
+static void
+prb_remote_putU64(uint8_t** buf, uint64_t value) {
+    uint8_t* dest = prb_stbds_arraddnptr(*buf, 8);
+    prb_remote_encodeU64(dest, value);
+}
+
+static void
+prb_remote_putStr(uint8_t** buf, prb_Str str) {
+    prb_remote_putU64(buf, (uint64_t)str.len);
+    if (str.len > 0) {
+        uint8_t* dest = prb_stbds_arraddnptr(*buf, str.len);
+        prb_memcpy(dest, str.ptr, str.len);
+    }
+}
+
+static uint64_t
+prb_remote_getU64(prb_remote_Reader* reader) {
+    uint64_t result = 0;
+    if (reader->ok && reader->offset + 8 <= reader->bytes.len) {
+        result = prb_remote_decodeU64(reader->bytes.data + reader->offset);
+        reader->offset += 8;
+    } else {
+        reader->ok = false;
+    }
+    return result;
+}
+
+// NOTE(khvorov) Counts come off the wire so they can't be more than the rest of the payload can hold
+static int32_t
+prb_remote_getCount(prb_remote_Reader* reader, int32_t minBytesPerItem) {
+    int32_t  result = 0;
+    uint64_t count = prb_remote_getU64(reader);
+    if (reader->ok && count <= (uint64_t)((reader->bytes.len - reader->offset) / minBytesPerItem)) {
+        result = (int32_t)count;
+    } else {
+        reader->ok = false;
+    }
+    return result;
+}
+
+static prb_Str
+prb_remote_getStr(prb_remote_Reader* reader) {
+    prb_Str  result = {0, 0};
+    uint64_t len = prb_remote_getU64(reader);
+    if (reader->ok && len <= (uint64_t)(reader->bytes.len - reader->offset)) {
+        result.ptr = (const char*)reader->bytes.data + reader->offset;
+        result.len = (int32_t)len;
+        reader->offset += (int32_t)len;
+    } else {
+        reader->ok = false;
+    }
+    return result;
+}
+
+// NOTE(khvorov) Blobs are looked up by digest alone and whatever is in the cache gets used without
+// looking at the content again, so the digest has to be collision resistant
+typedef struct prb_remote_Digest {
+    uint8_t bytes[32];
+} prb_remote_Digest;
+
+static const uint32_t prb_remote_sha256K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static uint32_t
+prb_remote_rotr32(uint32_t value, int32_t bits) {
+    uint32_t result = (value >> bits) | (value << (32 - bits));
+    return result;
+}
+
+static void
+prb_remote_sha256Block(uint32_t* state, const uint8_t* block) {
+    uint32_t w[64];
+    for (int32_t index = 0; index < 16; index++) {
+        const uint8_t* src = block + index * 4;
+        w[index] = ((uint32_t)src[0] << 24) | ((uint32_t)src[1] << 16) | ((uint32_t)src[2] << 8) | (uint32_t)src[3];
+    }
+    for (int32_t index = 16; index < 64; index++) {
+        uint32_t s0 = prb_remote_rotr32(w[index - 15], 7) ^ prb_remote_rotr32(w[index - 15], 18) ^ (w[index - 15] >> 3);
+        uint32_t s1 = prb_remote_rotr32(w[index - 2], 17) ^ prb_remote_rotr32(w[index - 2], 19) ^ (w[index - 2] >> 10);
+        w[index] = w[index - 16] + s0 + w[index - 7] + s1;
+    }
+
+    uint32_t v[8];
+    prb_memcpy(v, state, sizeof(v));
+    for (int32_t index = 0; index < 64; index++) {
+        uint32_t s1 = prb_remote_rotr32(v[4], 6) ^ prb_remote_rotr32(v[4], 11) ^ prb_remote_rotr32(v[4], 25);
+        uint32_t ch = (v[4] & v[5]) ^ (~v[4] & v[6]);
+        uint32_t temp1 = v[7] + s1 + ch + prb_remote_sha256K[index] + w[index];
+        uint32_t s0 = prb_remote_rotr32(v[0], 2) ^ prb_remote_rotr32(v[0], 13) ^ prb_remote_rotr32(v[0], 22);
+        uint32_t maj = (v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]);
+        uint32_t temp2 = s0 + maj;
+        v[7] = v[6];
+        v[6] = v[5];
+        v[5] = v[4];
+        v[4] = v[3] + temp1;
+        v[3] = v[2];
+        v[2] = v[1];
+        v[1] = v[0];
+        v[0] = temp1 + temp2;
+    }
+    for (int32_t index = 0; index < 8; index++) {
+        state[index] += v[index];
+    }
+}
 
-                prb_Str stderrPath = spec.stderrFilepath;
-                if (stderrPath.ptr == 0 || stderrPath.len == 0) {
-                    stderrPath = prb_STR("NUL");
-                }
+static prb_remote_Digest
+prb_remote_sha256(const void* data, intptr_t len) {
+    uint32_t state[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    intptr_t fullBlocksLen = len - len % 64;
+    for (intptr_t offset = 0; offset < fullBlocksLen; offset += 64) {
+        prb_remote_sha256Block(state, (const uint8_t*)data + offset);
+    }
 
-                if (spec.redirectStdout && spec.redirectStderr && prb_streq(stdoutPath, stderrPath)) {
-                    prb_windows_OpenResult openRes = prb_windows_open(arena, stdoutPath, GENERIC_WRITE, FILE_SHARE_WRITE, CREATE_ALWAYS, &securityAttr);
-                    if (openRes.success) {
-                        startupInfo.hStdOutput = openRes.handle;
-                        startupInfo.hStdError = openRes.handle;
-                        handlesToClose[handlesToCloseCount++] = openRes.handle;
-                    } else {
-                        redirectSuccessful = false;
-                    }
-                } else {
-                    if (spec.redirectStdout) {
-                        prb_windows_OpenResult openRes = prb_windows_open(arena, stdoutPath, GENERIC_WRITE, 0, CREATE_ALWAYS, &securityAttr);
-                        if (openRes.success) {
-                            startupInfo.hStdOutput = openRes.handle;
-                            handlesToClose[handlesToCloseCount++] = openRes.handle;
-                        } else {
-                            redirectSuccessful = false;
-                        }
-                    }
+    // NOTE(khvorov) The rest of the data, a 1 bit, zeros and the length in bits take one or two more blocks
+    uint8_t tail[128];
+    prb_memset(tail, 0, sizeof(tail));
+    int32_t restLen = (int32_t)(len - fullBlocksLen);
+    if (restLen > 0) {
+        prb_memcpy(tail, (const uint8_t*)data + fullBlocksLen, (size_t)restLen);
+    }
+    tail[restLen] = 0x80;
+    int32_t  tailLen = restLen + 9 <= 64 ? 64 : 128;
+    uint64_t bitLen = (uint64_t)len * 8;
+    for (int32_t byteIndex = 0; byteIndex < 8; byteIndex++) {
+        tail[tailLen - 1 - byteIndex] = (uint8_t)(bitLen >> (byteIndex * 8));
+    }
+    for (int32_t offset = 0; offset < tailLen; offset += 64) {
+        prb_remote_sha256Block(state, tail + offset);
+    }
 
-                    if (spec.redirectStderr) {
-                        prb_windows_OpenResult openRes = prb_windows_open(arena, stderrPath, GENERIC_WRITE, 0, CREATE_ALWAYS, &securityAttr);
-                        if (openRes.success) {
-                            startupInfo.hStdError = openRes.handle;
-                            handlesToClose[handlesToCloseCount++] = openRes.handle;
-                        } else {
-                            redirectSuccessful = false;
-                        }
-                    }
-                }
-            }
+    prb_remote_Digest result;
+    for (int32_t index = 0; index < 8; index++) {
+        result.bytes[index * 4 + 0] = (uint8_t)(state[index] >> 24);
+        result.bytes[index * 4 + 1] = (uint8_t)(state[index] >> 16);
+        result.bytes[index * 4 + 2] = (uint8_t)(state[index] >> 8);
+        result.bytes[index * 4 + 3] = (uint8_t)state[index];
+    }
+    return result;
+}
 
-            if (redirectSuccessful) {
-                // NOTE(khvorov) Just replace spaces with null terminators and stick that to the start of the
-                // existing environment and call it a day.
-                LPWCH env = 0;
-                if (spec.addEnv.ptr && spec.addEnv.len > 0) {
-                    prb_windows_WideStr envCopy = prb_windows_getWideStr(arena, spec.addEnv);
-                    for (int32_t envIndex = 0; envIndex < envCopy.len; envIndex++) {
-                        if (envCopy.ptr[envIndex] == ' ') {
-                            envCopy.ptr[envIndex] = '\0';
-                        }
-                    }
-                    LPWCH   existingEnv = GetEnvironmentStringsW();
-                    int32_t existingEnvLen = 0;
-                    for (;;) {
-                        if (existingEnv[existingEnvLen] == '\0' && existingEnv[existingEnvLen + 1] == '\0') {
-                            break;
-                        } else {
-                            existingEnvLen += 1;
-                        }
-                    }
-                    env = (LPWCH)prb_arenaAllocArray(arena, uint16_t, envCopy.len + 1 + existingEnvLen + 2);
-                    prb_memcpy(env, envCopy.ptr, envCopy.len * sizeof(*envCopy.ptr));
-                    prb_memcpy(env + envCopy.len + 1, existingEnv, existingEnvLen * sizeof(*existingEnv));
-                    FreeEnvironmentStringsW(existingEnv);
-                }
+static bool
+prb_remote_digestEq(prb_remote_Digest a, prb_remote_Digest b) {
+    bool result = prb_memcmp(a.bytes, b.bytes, sizeof(a.bytes)) == 0;
+    return result;
+}
 
-                prb_windows_WideStr wcmd = prb_windows_getWideStr(arena, proc->cmd);
-                if (CreateProcessW(0, wcmd.ptr, 0, 0, inheritHandles, CREATE_UNICODE_ENVIRONMENT, env, 0, &startupInfo, &proc->processInfo)) {
-                    proc->status = prb_ProcessStatus_Launched;
-                    if (mode == prb_Background_No) {
-                        prb_windows_waitForProcess(proc);
-                    }
-                }
-            }
+static void
+prb_remote_putDigest(uint8_t** buf, prb_remote_Digest digest) {
+    uint8_t* dest = prb_stbds_arraddnptr(*buf, (int32_t)sizeof(digest.bytes));
+    prb_memcpy(dest, digest.bytes, sizeof(digest.bytes));
+}
 
-            for (int32_t handleIndex = 0; handleIndex < handlesToCloseCount; handleIndex++) {
-                CloseHandle(handlesToClose[handleIndex]);
+static prb_remote_Digest
+prb_remote_getDigest(prb_remote_Reader* reader) {
+    prb_remote_Digest result;
+    prb_memset(&result, 0, sizeof(result));
+    if (reader->ok && reader->offset + (int32_t)sizeof(result.bytes) <= reader->bytes.len) {
+        prb_memcpy(result.bytes, reader->bytes.data + reader->offset, sizeof(result.bytes));
+        reader->offset += (int32_t)sizeof(result.bytes);
+    } else {
+        reader->ok = false;
+    }
+    return result;
+}
+
+static prb_Status
+prb_linux_sendAll(int sock, const void* data, intptr_t len) {
+    prb_Status result = prb_Success;
+    intptr_t   sent = 0;
+    while (sent < len && result == prb_Success) {
+        ssize_t sendResult = send(sock, (const uint8_t*)data + sent, len - sent, MSG_NOSIGNAL);
+        if (sendResult > 0) {
+            sent += sendResult;
+        } else if (sendResult == -1 && errno == EINTR) {
+            continue;
+        } else {
+            result = prb_Failure;
+        }
+    }
+    return result;
+}
+
+static prb_Status
+prb_linux_recvAll(int sock, void* data, intptr_t len) {
+    prb_Status result = prb_Success;
+    intptr_t   received = 0;
+    while (received < len && result == prb_Success) {
+        ssize_t recvResult = recv(sock, (uint8_t*)data + received, len - received, 0);
+        if (recvResult > 0) {
+            received += recvResult;
+        } else if (recvResult == -1 && errno == EINTR) {
+            continue;
+        } else {
+            result = prb_Failure;
+        }
+    }
+    return result;
+}
+
+static prb_Status
+prb_remote_sendMsg(int sock, prb_remote_MsgKind kind, uint8_t* payload) {
+    uint8_t header[16];
+    prb_remote_encodeU64(header, (uint64_t)kind);
+    prb_remote_encodeU64(header + 8, (uint64_t)prb_stbds_arrlen(payload));
+    prb_Status result = prb_linux_sendAll(sock, header, sizeof(header));
+    if (result == prb_Success && prb_stbds_arrlen(payload) > 0) {
+        result = prb_linux_sendAll(sock, payload, prb_stbds_arrlen(payload));
+    }
+    return result;
+}
+
+static prb_remote_RecvResult
+prb_remote_recvMsg(prb_Arena* arena, int sock) {
+    prb_remote_RecvResult result;
+    prb_memset(&result, 0, sizeof(result));
+    uint8_t header[16];
+    if (prb_linux_recvAll(sock, header, sizeof(header)) == prb_Success) {
+        uint64_t kind = prb_remote_decodeU64(header);
+        uint64_t len = prb_remote_decodeU64(header + 8);
+        if (len < INT32_MAX && (intptr_t)len < prb_arenaFreeSize(arena)) {
+            uint8_t* payload = (uint8_t*)prb_arenaAllocAndZero(arena, (int32_t)len + 1, 1);
+            if (prb_linux_recvAll(sock, payload, (intptr_t)len) == prb_Success) {
+                result.success = true;
+                result.kind = (prb_remote_MsgKind)kind;
+                result.reader.bytes = (prb_Bytes) {payload, (int32_t)len};
+                result.reader.ok = true;
             }
+        }
+    }
+    return result;
+}
 
-#elif prb_PLATFORM_LINUX
+static prb_Status
+prb_remote_sendToken(int sock, prb_remote_MsgKind kind, prb_Str token) {
+    uint8_t* payload = 0;
+    if (token.len > 0) {
+        uint8_t* dest = prb_stbds_arraddnptr(payload, token.len);
+        prb_memcpy(dest, token.ptr, token.len);
+    }
+    prb_Status result = prb_remote_sendMsg(sock, kind, payload);
+    prb_stbds_arrfree(payload);
+    return result;
+}
 
-            const char* stdoutPath = 0;
-            if (spec.redirectStdout) {
-                if (spec.stdoutFilepath.ptr && spec.stdoutFilepath.len > 0) {
-                    stdoutPath = prb_strGetNullTerminated(arena, spec.stdoutFilepath);
-                } else {
-                    stdoutPath = "/dev/null";
+// NOTE(khvorov) Every connection has to start with a hello or a shutdown carrying the worker's token.
+// Returns 0 for anything else.
+static prb_remote_MsgKind
+prb_remote_recvToken(prb_Arena* arena, int sock, prb_Str token) {
+    prb_remote_MsgKind result = (prb_remote_MsgKind)0;
+    prb_TempMemory     temp = prb_beginTempMemory(arena);
+    uint8_t            header[16];
+    if (prb_linux_recvAll(sock, header, sizeof(header)) == prb_Success) {
+        uint64_t kind = prb_remote_decodeU64(header);
+        uint64_t len = prb_remote_decodeU64(header + 8);
+        bool     kindOk = kind == prb_remote_MsgKind_Hello || kind == prb_remote_MsgKind_Shutdown;
+        if (kindOk && len == (uint64_t)token.len) {
+            uint8_t* received = prb_arenaAllocArray(arena, uint8_t, token.len);
+            if (prb_linux_recvAll(sock, received, token.len) == prb_Success) {
+                // NOTE(khvorov) Look at every byte so the time taken doesn't say how much of the token matched
+                uint8_t diff = 0;
+                for (int32_t byteIndex = 0; byteIndex < token.len; byteIndex++) {
+                    diff |= received[byteIndex] ^ (uint8_t)token.ptr[byteIndex];
+                }
+                if (diff == 0) {
+                    result = (prb_remote_MsgKind)kind;
                 }
             }
+        }
+    }
+    prb_endTempMemory(temp);
+    return result;
+}
 
-            const char* stderrPath = 0;
-            if (spec.redirectStderr) {
-                if (spec.stderrFilepath.ptr && spec.stderrFilepath.len > 0) {
-                    stderrPath = prb_strGetNullTerminated(arena, spec.stderrFilepath);
+typedef struct prb_linux_OpenSocketResult {
+    bool    success;
+    int     sock;
+    prb_Str unixPath;
+} prb_linux_OpenSocketResult;
+
+static prb_linux_OpenSocketResult
+prb_linux_openSocket(prb_Arena* arena, prb_Str address, bool listening) {
+    prb_linux_OpenSocketResult result = {.success = false, .sock = -1, .unixPath = {0, 0}};
+    prb_Str                    unixPrefix = prb_STR("unix:");
+    prb_Str                    tcpPrefix = prb_STR("tcp:");
+
+    if (prb_strStartsWith(address, unixPrefix)) {
+        prb_Str            path = prb_strSlice(address, unixPrefix.len, address.len);
+        struct sockaddr_un addr;
+        prb_memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (path.len > 0 && path.len < (int32_t)sizeof(addr.sun_path)) {
+            result.sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (result.sock != -1) {
+                if (listening) {
+                    // NOTE(khvorov) Bind to a temporary name and rename once listening so that
+                    // anyone who sees the socket file can connect to it straight away
+                    prb_Str tempPath = prb_fmt(arena, "%.*s.%d", prb_LIT(path), (int)getpid());
+                    if (tempPath.len < (int32_t)sizeof(addr.sun_path)) {
+                        prb_memcpy(addr.sun_path, tempPath.ptr, tempPath.len);
+                        unlink(addr.sun_path);
+                        if (bind(result.sock, (struct sockaddr*)&addr, sizeof(addr)) == 0 && listen(result.sock, SOMAXCONN) == 0) {
+                            const char* pathNull = prb_strGetNullTerminated(arena, path);
+                            result.success = rename(addr.sun_path, pathNull) == 0;
+                            result.unixPath = path;
+                        }
+                    }
                 } else {
-                    stderrPath = "/dev/null";
+                    prb_memcpy(addr.sun_path, path.ptr, path.len);
+                    result.success = connect(result.sock, (struct sockaddr*)&addr, sizeof(addr)) == 0;
                 }
             }
-
-            bool fileActionsSucceeded = true;
-            bool fileActionsInited = false;
-            posix_spawn_file_actions_t* fileActionsPtr = 0;
-            posix_spawn_file_actions_t fileActions = {};
-            if (spec.redirectStdout || spec.redirectStderr) {
-                fileActionsPtr = &fileActions;
-                int initResult = posix_spawn_file_actions_init(&fileActions);
-                fileActionsSucceeded = initResult == 0;
-                fileActionsInited = initResult == 0;
-                if (fileActionsSucceeded) {
-                    if (spec.redirectStdout) {
-                        int stdoutRedirectResult = posix_spawn_file_actions_addopen(
-                            &fileActions,
-                            STDOUT_FILENO,
-                            stdoutPath,
-                            O_WRONLY | O_CREAT | O_TRUNC,
-                            S_IRUSR | S_IRGRP | S_IROTH | S_IWUSR
-                        );
-                        fileActionsSucceeded = stdoutRedirectResult == 0;
-                    }
-
-                    if (fileActionsSucceeded && spec.redirectStderr) {
-                        if (spec.redirectStdout && prb_streq(prb_STR(stdoutPath), prb_STR(stderrPath))) {
-                            int dupResult = posix_spawn_file_actions_adddup2(&fileActions, STDOUT_FILENO, STDERR_FILENO);
-                            fileActionsSucceeded = dupResult == 0;
+        }
+    } else if (prb_strStartsWith(address, tcpPrefix)) {
+        prb_Str         hostAndPort = prb_strSlice(address, tcpPrefix.len, address.len);
+        prb_StrFindSpec colon;
+        prb_memset(&colon, 0, sizeof(colon));
+        colon.direction = prb_StrDirection_FromEnd;
+        colon.pattern = prb_STR(":");
+        prb_StrFindResult colonFind = prb_strFind(hostAndPort, colon);
+        if (colonFind.found) {
+            const char*     host = prb_strGetNullTerminated(arena, colonFind.beforeMatch);
+            const char*     port = prb_strGetNullTerminated(arena, colonFind.afterMatch);
+            struct addrinfo hints;
+            prb_memset(&hints, 0, sizeof(hints));
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+            hints.ai_flags = listening ? AI_PASSIVE : 0;
+            struct addrinfo* addrs = 0;
+            if (getaddrinfo(colonFind.beforeMatch.len > 0 ? host : 0, port, &hints, &addrs) == 0) {
+                for (struct addrinfo* addr = addrs; addr && !result.success; addr = addr->ai_next) {
+                    result.sock = socket(addr->ai_family, addr->ai_socktype | SOCK_CLOEXEC, addr->ai_protocol);
+                    if (result.sock != -1) {
+                        int one = 1;
+                        if (listening) {
+                            setsockopt(result.sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+                            result.success = bind(result.sock, addr->ai_addr, addr->ai_addrlen) == 0 && listen(result.sock, SOMAXCONN) == 0;
                         } else {
-                            int stderrRedirectResult = posix_spawn_file_actions_addopen(
-                                &fileActions,
-                                STDERR_FILENO,
-                                stderrPath,
-                                O_WRONLY | O_CREAT | O_TRUNC,
-                                S_IRUSR | S_IRGRP | S_IROTH | S_IWUSR
-                            );
-                            fileActionsSucceeded = stderrRedirectResult == 0;
+                            setsockopt(result.sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                            result.success = connect(result.sock, addr->ai_addr, addr->ai_addrlen) == 0;
+                        }
+                        if (!result.success) {
+                            close(result.sock);
+                            result.sock = -1;
                         }
                     }
                 }
+                freeaddrinfo(addrs);
             }
+        }
+    }
 
-            if (fileActionsSucceeded) {
-                bool envSucceeded = true;
-                char** env = __environ;
-                bool envAllocated = false;
-                if (proc->spec.addEnv.ptr && proc->spec.addEnv.len > 0) {
-                    envAllocated = true;
-                    env = 0;
+    if (!result.success && result.sock != -1) {
+        close(result.sock);
+        result.sock = -1;
+    }
+    return result;
+}
 
-                    prb_StrFindSpec space = {};
-                    space.pattern = prb_STR(" ");
-                    space.alwaysMatchEnd = true;
-                    prb_StrFindSpec equals = {};
-                    equals.pattern = prb_STR("=");
-                    prb_StrScanner scanner = prb_createStrScanner(proc->spec.addEnv);
-                    prb_Str* newVarNames = 0;
-                    while (envSucceeded && prb_strScannerMove(&scanner, space, prb_StrScannerSide_AfterMatch)) {
-                        if (scanner.betweenLastMatches.len > 0) {
-                            envSucceeded = false;
-                            prb_StrScanner nameScanner = prb_createStrScanner(scanner.betweenLastMatches);
-                            if (prb_strScannerMove(&nameScanner, equals, prb_StrScannerSide_AfterMatch)) {
-                                if (nameScanner.betweenLastMatches.len > 0) {
-                                    char* newEnvEntry = (char*)prb_strGetNullTerminated(arena, scanner.betweenLastMatches);
-                                    prb_stbds_arrput(env, newEnvEntry);
-                                    prb_stbds_arrput(newVarNames, nameScanner.betweenLastMatches);
-                                    envSucceeded = true;
-                                }
-                            }
-                        }
-                    }
+// NOTE(khvorov) Empty when path is not inside execRoot
+static prb_Str
+prb_remote_relPath(prb_Str execRoot, prb_Str path) {
+    prb_Str result = {0, 0};
+    if (execRoot.len > 0 && prb_strStartsWith(path, execRoot)) {
+        bool atBoundary = path.len > execRoot.len && (prb_charIsSep(execRoot.ptr[execRoot.len - 1]) || prb_charIsSep(path.ptr[execRoot.len]));
+        if (atBoundary) {
+            result = prb_strSlice(path, execRoot.len, path.len);
+            while (result.len > 0 && prb_charIsSep(result.ptr[0])) {
+                result = prb_strSlice(result, 1, result.len);
+            }
+        }
+    }
+    return result;
+}
 
-                    if (envSucceeded) {
-                        for (int32_t envIndex = 0;; envIndex++) {
-                            char* existingEntry = __environ[envIndex];
-                            if (existingEntry) {
-                                prb_StrScanner nameScanner = prb_createStrScanner(prb_STR(existingEntry));
-                                prb_assert(prb_strScannerMove(&nameScanner, equals, prb_StrScannerSide_AfterMatch));
-                                prb_assert(nameScanner.betweenLastMatches.len > 0);
-                                prb_Str existingName = nameScanner.betweenLastMatches;
-                                bool existingInNew = false;
-                                for (int32_t newVarIndex = 0; newVarIndex < prb_stbds_arrlen(newVarNames) && !existingInNew; newVarIndex++) {
-                                    prb_Str newVarName = newVarNames[newVarIndex];
-                                    existingInNew = prb_streq(newVarName, existingName);
-                                }
-                                if (!existingInNew) {
-                                    prb_stbds_arrput(env, existingEntry);
-                                }
-                            } else {
-                                break;
-                            }
-                        }
+static bool
+prb_remote_canRunRemotely(prb_Action* action) {
+    bool result = action->execRoot.len > 0;
+    for (int32_t inputIndex = 0; inputIndex < action->inputsCount && result; inputIndex++) {
+        result = prb_remote_relPath(action->execRoot, action->inputs[inputIndex]).len > 0;
+    }
+    for (int32_t outputIndex = 0; outputIndex < action->outputsCount && result; outputIndex++) {
+        result = prb_remote_relPath(action->execRoot, action->outputs[outputIndex]).len > 0;
+    }
+    return result;
+}
 
-                        // NOTE(khvorov) Null-terminate the new env array
-                        prb_stbds_arrput(env, 0);
-                    }
+// NOTE(khvorov) Paths from the wire get joined onto the sandbox, they must not be able to leave it
+static bool
+prb_remote_isSandboxPath(prb_Str path) {
+    bool result = path.len > 0 && !prb_charIsSep(path.ptr[0]) && !prb_pathIsAbsolute(path);
+    for (int32_t offset = 0; offset < path.len && result;) {
+        int32_t entryStart = offset;
+        while (offset < path.len && !prb_charIsSep(path.ptr[offset])) {
+            result = result && path.ptr[offset] != '\0';
+            offset += 1;
+        }
+        result = result && !prb_streq(prb_strSlice(path, entryStart, offset), prb_STR(".."));
+        offset += 1;
+    }
+    return result;
+}
+
+static prb_Str
+prb_remote_replaceAll(prb_Arena* arena, prb_Str str, prb_Str pattern, prb_Str replacement) {
+    prb_Str result = str;
+    if (pattern.len > 0) {
+        prb_GrowingStr  gstr = prb_beginStr(arena);
+        prb_StrScanner  scanner = prb_createStrScanner(str);
+        prb_StrFindSpec spec;
+        prb_memset(&spec, 0, sizeof(spec));
+        spec.pattern = pattern;
+        prb_StrFinder finder = prb_createStrFinder(spec);
+        while (prb_strScannerMoveWith(&scanner, &finder, prb_StrScannerSide_AfterMatch)) {
+            prb_addStr(&gstr, scanner.betweenLastMatches);
+            prb_addStr(&gstr, replacement);
+        }
+        prb_addStr(&gstr, scanner.afterMatch);
+        result = prb_endStr(&gstr);
+    }
+    return result;
+}
+
+static prb_Str
+prb_remote_casPath(prb_Arena* arena, prb_Str casDir, prb_remote_Digest digest) {
+    prb_GrowingStr gstr = prb_beginStr(arena);
+    for (int32_t byteIndex = 0; byteIndex < (int32_t)sizeof(digest.bytes); byteIndex++) {
+        prb_addStrSegment(&gstr, "%02x", digest.bytes[byteIndex]);
+    }
+    prb_Str result = prb_pathJoin(arena, casDir, prb_endStr(&gstr));
+    return result;
+}
+
+static bool
+prb_linux_isSingleThreaded(prb_Arena* arena) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+    prb_Str*       threads = prb_getAllDirEntries(arena, prb_STR("/proc/self/task"), prb_Recursive_No);
+    bool           result = prb_stbds_arrlen(threads) == 1;
+    prb_stbds_arrfree(threads);
+    prb_endTempMemory(temp);
+    return result;
+}
+
+// NOTE(khvorov) Called right after a fork so it sticks to raw syscalls and a stack buffer
+static void
+prb_linux_closeFdsExcept(int keep1, int keep2) {
+    int dirFd = open("/proc/self/fd", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd != -1) {
+        uint64_t buf[128];
+        for (;;) {
+            long bytesRead = syscall(SYS_getdents64, dirFd, buf, sizeof(buf));
+            if (bytesRead <= 0) {
+                break;
+            }
+            for (long offset = 0; offset < bytesRead;) {
+                prb_linux_Dirent64* ent = (prb_linux_Dirent64*)((uint8_t*)buf + offset);
+                int                 fd = 0;
+                bool                isNumber = ent->d_name[0] != '\0';
+                for (int32_t charIndex = 0; ent->d_name[charIndex] != '\0' && isNumber; charIndex++) {
+                    char ch = ent->d_name[charIndex];
+                    isNumber = ch >= '0' && ch <= '9';
+                    fd = fd * 10 + (ch - '0');
+                }
+                if (isNumber && fd > STDERR_FILENO && fd != keep1 && fd != keep2 && fd != dirFd) {
+                    close(fd);
+                }
+                offset += ent->d_reclen;
+            }
+        }
+        close(dirFd);
+    }
+}
 
-                    prb_stbds_arrfree(newVarNames);
+// NOTE(khvorov) Runs in a forked process, one per connection.
+// Actions are handled one at a time, the coordinator opens more connections for more parallelism.
+static void
+prb_linux_serveConnection(prb_Arena* arena, int sock, prb_Str workDir, prb_Str casDir) {
+    prb_Str sandboxDir = prb_pathJoin(arena, workDir, prb_fmt(arena, "sandbox-%d", (int)getpid()));
+    prb_Str logPath = prb_fmt(arena, "%.*s.log", prb_LIT(sandboxDir));
+
+    for (bool connected = true; connected;) {
+        prb_TempMemory        temp = prb_beginTempMemory(arena);
+        prb_remote_RecvResult actionMsg = prb_remote_recvMsg(arena, sock);
+        connected = actionMsg.success && actionMsg.kind == prb_remote_MsgKind_Action;
+
+        if (connected) {
+            prb_remote_Reader* reader = &actionMsg.reader;
+            prb_Str            cmd = prb_remote_getStr(reader);
+            prb_Str            addEnv = prb_remote_getStr(reader);
+            prb_Str            execRoot = prb_remote_getStr(reader);
+            int32_t            inputsCount = prb_remote_getCount(reader, 8 + (int32_t)sizeof(prb_remote_Digest));
+            prb_Str*           inputs = prb_arenaAllocArray(arena, prb_Str, inputsCount);
+            prb_remote_Digest* inputDigests = prb_arenaAllocArray(arena, prb_remote_Digest, inputsCount);
+            for (int32_t inputIndex = 0; inputIndex < inputsCount && reader->ok; inputIndex++) {
+                inputs[inputIndex] = prb_remote_getStr(reader);
+                inputDigests[inputIndex] = prb_remote_getDigest(reader);
+                reader->ok = reader->ok && prb_remote_isSandboxPath(inputs[inputIndex]);
+            }
+            int32_t  outputsCount = prb_remote_getCount(reader, 8);
+            prb_Str* outputs = prb_arenaAllocArray(arena, prb_Str, outputsCount);
+            for (int32_t outputIndex = 0; outputIndex < outputsCount && reader->ok; outputIndex++) {
+                outputs[outputIndex] = prb_remote_getStr(reader);
+                reader->ok = reader->ok && prb_remote_isSandboxPath(outputs[outputIndex]);
+            }
+            connected = reader->ok;
+
+            // NOTE(khvorov) Ask only for the blobs we haven't seen before
+            uint8_t* needPayload = 0;
+            if (connected) {
+                prb_remote_Digest* needed = 0;
+                for (int32_t inputIndex = 0; inputIndex < inputsCount; inputIndex++) {
+                    prb_remote_Digest digest = inputDigests[inputIndex];
+                    bool              alreadyNeeded = false;
+                    for (int32_t neededIndex = 0; neededIndex < prb_stbds_arrlen(needed) && !alreadyNeeded; neededIndex++) {
+                        alreadyNeeded = prb_remote_digestEq(needed[neededIndex], digest);
+                    }
+                    if (!alreadyNeeded && !prb_isFile(arena, prb_remote_casPath(arena, casDir, digest))) {
+                        prb_stbds_arrput(needed, digest);
+                    }
                 }
-
-                if (envSucceeded) {
-                    const char** args = prb_getArgArrayFromStr(arena, proc->cmd);
-                    int spawnResult = posix_spawnp(&proc->pid, args[0], fileActionsPtr, 0, (char**)args, env);
-                    if (spawnResult == 0) {
-                        proc->status = prb_ProcessStatus_Launched;
-                        if (mode == prb_Background_No) {
-                            prb_linux_waitForProcess(proc);
+                prb_remote_putU64(&needPayload, (uint64_t)prb_stbds_arrlen(needed));
+                for (int32_t neededIndex = 0; neededIndex < prb_stbds_arrlen(needed); neededIndex++) {
+                    prb_remote_putDigest(&needPayload, needed[neededIndex]);
+                }
+                connected = prb_remote_sendMsg(sock, prb_remote_MsgKind_Need, needPayload) == prb_Success;
+
+                for (int32_t neededIndex = 0; neededIndex < prb_stbds_arrlen(needed) && connected; neededIndex++) {
+                    prb_remote_RecvResult blobMsg = prb_remote_recvMsg(arena, sock);
+                    connected = blobMsg.success && blobMsg.kind == prb_remote_MsgKind_Blob;
+                    if (connected) {
+                        prb_remote_Digest digest = prb_remote_getDigest(&blobMsg.reader);
+                        prb_Str           content = prb_remote_getStr(&blobMsg.reader);
+                        connected = blobMsg.reader.ok && prb_remote_digestEq(digest, needed[neededIndex])
+                            && prb_remote_digestEq(prb_remote_sha256(content.ptr, content.len), digest);
+                        if (connected) {
+                            // NOTE(khvorov) Other connections may be writing the same blob
+                            prb_Str blobPath = prb_remote_casPath(arena, casDir, digest);
+                            prb_Str tempPath = prb_fmt(arena, "%.*s.%d", prb_LIT(blobPath), (int)getpid());
+                            connected = prb_writeEntireFile(arena, tempPath, content.ptr, content.len) == prb_Success
+                                && rename(prb_strGetNullTerminated(arena, tempPath), prb_strGetNullTerminated(arena, blobPath)) == 0;
                         }
                     }
-                    prb_stbds_arrfree(args);
+                }
+                prb_stbds_arrfree(needed);
+            }
+            prb_stbds_arrfree(needPayload);
+
+            uint8_t* resultPayload = 0;
+            if (connected) {
+                bool materialized = prb_clearDir(arena, sandboxDir) == prb_Success;
+                for (int32_t inputIndex = 0; inputIndex < inputsCount && materialized; inputIndex++) {
+                    prb_ReadEntireFileResult blob = prb_readEntireFile(arena, prb_remote_casPath(arena, casDir, inputDigests[inputIndex]));
+                    materialized = blob.success
+                        && prb_writeEntireFile(arena, prb_pathJoin(arena, sandboxDir, inputs[inputIndex]), blob.content.data, blob.content.len) == prb_Success;
+                }
+                for (int32_t outputIndex = 0; outputIndex < outputsCount && materialized; outputIndex++) {
+                    prb_Str outputDir = prb_getParentDir(arena, prb_pathJoin(arena, sandboxDir, outputs[outputIndex]));
+                    materialized = prb_createDirIfNotExists(arena, outputDir) == prb_Success;
                 }
 
-                if (envAllocated) {
-                    prb_stbds_arrfree(env);
+                bool procSucceeded = false;
+                if (materialized) {
+                    prb_ProcessSpec spec;
+                    prb_memset(&spec, 0, sizeof(spec));
+                    spec.redirectStdout = true;
+                    spec.stdoutFilepath = logPath;
+                    spec.redirectStderr = true;
+                    spec.stderrFilepath = logPath;
+                    spec.addEnv = prb_remote_replaceAll(arena, addEnv, execRoot, sandboxDir);
+                    prb_Str     sandboxCmd = prb_remote_replaceAll(arena, cmd, execRoot, sandboxDir);
+                    prb_Process proc = prb_createProcess(sandboxCmd, spec);
+                    procSucceeded = prb_launchProcesses(arena, &proc, 1, prb_Background_No) == prb_Success;
                 }
-            }
 
-            if (fileActionsInited) {
-                posix_spawn_file_actions_destroy(fileActionsPtr);
+                prb_ReadEntireFileResult log = prb_readEntireFile(arena, logPath);
+                prb_remote_putU64(&resultPayload, procSucceeded);
+                prb_remote_putStr(&resultPayload, log.success ? prb_strFromBytes(log.content) : prb_STR(""));
+                prb_remote_putU64(&resultPayload, (uint64_t)outputsCount);
+                for (int32_t outputIndex = 0; outputIndex < outputsCount; outputIndex++) {
+                    prb_ReadEntireFileResult output = prb_readEntireFile(arena, prb_pathJoin(arena, sandboxDir, outputs[outputIndex]));
+                    prb_remote_putU64(&resultPayload, output.success);
+                    prb_remote_putStr(&resultPayload, output.success ? prb_strFromBytes(output.content) : prb_STR(""));
+                }
+                connected = prb_remote_sendMsg(sock, prb_remote_MsgKind_Result, resultPayload) == prb_Success;
             }
+            prb_stbds_arrfree(resultPayload);
+        }
 
-#else
-#error unimplemented
-#endif
+        prb_endTempMemory(temp);
+    }
 
-            prb_ProcessStatus reqStatus = prb_ProcessStatus_CompletedSuccess;
-            if (mode == prb_Background_Yes) {
-                reqStatus = prb_ProcessStatus_Launched;
+    prb_removePathIfExists(arena, sandboxDir);
+    prb_removePathIfExists(arena, logPath);
+}
+
+// NOTE(khvorov) Returns false when the connection is no longer usable and the action should be run locally
+static bool
+prb_remote_execute(prb_Arena* arena, int sock, prb_Action* action) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+    prb_TimeStart  start = prb_timeStart();
+    bool           result = true;
+
+    prb_Bytes*         inputContents = prb_arenaAllocArray(arena, prb_Bytes, action->inputsCount);
+    prb_remote_Digest* inputDigests = prb_arenaAllocArray(arena, prb_remote_Digest, action->inputsCount);
+    bool               inputsRead = true;
+    for (int32_t inputIndex = 0; inputIndex < action->inputsCount && inputsRead; inputIndex++) {
+        prb_ReadEntireFileResult readRes = prb_readEntireFile(arena, action->inputs[inputIndex]);
+        inputsRead = readRes.success;
+        inputContents[inputIndex] = readRes.content;
+        inputDigests[inputIndex] = prb_remote_sha256(readRes.content.data, readRes.content.len);
+    }
+
+    if (!inputsRead) {
+        action->status = prb_ProcessStatus_CompletedFailed;
+    } else {
+        uint8_t* actionPayload = 0;
+        prb_remote_putStr(&actionPayload, action->cmd);
+        prb_remote_putStr(&actionPayload, action->addEnv);
+        prb_remote_putStr(&actionPayload, action->execRoot);
+        prb_remote_putU64(&actionPayload, (uint64_t)action->inputsCount);
+        for (int32_t inputIndex = 0; inputIndex < action->inputsCount; inputIndex++) {
+            prb_remote_putStr(&actionPayload, prb_remote_relPath(action->execRoot, action->inputs[inputIndex]));
+            prb_remote_putDigest(&actionPayload, inputDigests[inputIndex]);
+        }
+        prb_remote_putU64(&actionPayload, (uint64_t)action->outputsCount);
+        for (int32_t outputIndex = 0; outputIndex < action->outputsCount; outputIndex++) {
+            prb_remote_putStr(&actionPayload, prb_remote_relPath(action->execRoot, action->outputs[outputIndex]));
+        }
+        result = prb_remote_sendMsg(sock, prb_remote_MsgKind_Action, actionPayload) == prb_Success;
+        prb_stbds_arrfree(actionPayload);
+
+        if (result) {
+            prb_remote_RecvResult needMsg = prb_remote_recvMsg(arena, sock);
+            result = needMsg.success && needMsg.kind == prb_remote_MsgKind_Need;
+            int32_t neededCount = prb_remote_getCount(&needMsg.reader, (int32_t)sizeof(prb_remote_Digest));
+            for (int32_t neededIndex = 0; neededIndex < neededCount && result; neededIndex++) {
+                prb_remote_Digest digest = prb_remote_getDigest(&needMsg.reader);
+                int32_t           inputIndex = 0;
+                while (inputIndex < action->inputsCount && !prb_remote_digestEq(inputDigests[inputIndex], digest)) {
+                    inputIndex++;
+                }
+                result = needMsg.reader.ok && inputIndex < action->inputsCount;
+                if (result) {
+                    uint8_t* blobPayload = 0;
+                    prb_remote_putDigest(&blobPayload, digest);
+                    prb_remote_putStr(&blobPayload, prb_strFromBytes(inputContents[inputIndex]));
+                    result = prb_remote_sendMsg(sock, prb_remote_MsgKind_Blob, blobPayload) == prb_Success;
+                    prb_stbds_arrfree(blobPayload);
+                }
             }
-            if (proc->status != reqStatus) {
-                result = prb_Failure;
+        }
+
+        if (result) {
+            prb_remote_RecvResult resultMsg = prb_remote_recvMsg(arena, sock);
+            result = resultMsg.success && resultMsg.kind == prb_remote_MsgKind_Result;
+            bool    procSucceeded = prb_remote_getU64(&resultMsg.reader) != 0;
+            prb_Str log = prb_remote_getStr(&resultMsg.reader);
+            int32_t outputsCount = prb_remote_getCount(&resultMsg.reader, 16);
+            result = result && resultMsg.reader.ok && outputsCount == action->outputsCount;
+            bool outputsWritten = true;
+            for (int32_t outputIndex = 0; outputIndex < outputsCount && result; outputIndex++) {
+                bool    present = prb_remote_getU64(&resultMsg.reader) != 0;
+                prb_Str content = prb_remote_getStr(&resultMsg.reader);
+                result = resultMsg.reader.ok;
+                if (result && present) {
+                    outputsWritten = outputsWritten && prb_writeEntireFile(arena, action->outputs[outputIndex], content.ptr, content.len) == prb_Success;
+                }
+            }
+
+            if (result) {
+                if (log.len > 0) {
+                    prb_writeToStdout(log);
+                }
+                action->ranRemotely = true;
+                action->status = procSucceeded && outputsWritten ? prb_ProcessStatus_CompletedSuccess : prb_ProcessStatus_CompletedFailed;
+                action->durationMs = prb_getMsFrom(start);
             }
         }
     }
@@ -3286,114 +9846,239 @@ prb_launchProcesses(prb_Arena* arena, prb_Process* procs, int32_t procCount, prb
     return result;
 }
 
-prb_PUBLICDEF prb_Status
-prb_waitForProcesses(prb_Process* handles, int32_t handleCount) {
-    prb_Status result = prb_Success;
+#endif
 
-    for (int32_t handleIndex = 0; handleIndex < handleCount; handleIndex++) {
-        prb_Process* handle = handles + handleIndex;
-        prb_assert(handle->status != prb_ProcessStatus_NotLaunched);
-        if (handle->status == prb_ProcessStatus_Launched) {
+static void
+prb_remote_slotProc(prb_Arena* arena, void* data) {
+    prb_remote_Slot* slot = (prb_remote_Slot*)data;
+
+    if (slot->workerAddress.len == 0) {
+        for (prb_Action* action = 0;;) {
+            action = prb_remote_queueNext(slot->localOnly);
+            if (!action) {
+                action = prb_remote_queueNext(slot->remoteEligible);
+            }
+            if (!action) {
+                break;
+            }
+            prb_TempMemory temp = prb_beginTempMemory(arena);
+            prb_remote_runLocally(arena, action);
+            prb_endTempMemory(temp);
+        }
+    } else {
 #if prb_PLATFORM_WINDOWS
-            prb_windows_waitForProcess(handle);
+        // NOTE(khvorov) Not implemented on windows, local slots will pick up the actions
 #elif prb_PLATFORM_LINUX
-            prb_linux_waitForProcess(handle);
+        prb_linux_OpenSocketResult connection = prb_linux_openSocket(arena, slot->workerAddress, false);
+        if (connection.success) {
+            if (prb_remote_sendToken(connection.sock, prb_remote_MsgKind_Hello, slot->workerToken) == prb_Success) {
+                for (prb_Action* action = prb_remote_queueNext(slot->remoteEligible); action; action = prb_remote_queueNext(slot->remoteEligible)) {
+                    if (!prb_remote_execute(arena, connection.sock, action)) {
+                        // NOTE(khvorov) Lost the worker (or it didn't accept the token), finish this one here
+                        // and leave the rest to other slots
+                        prb_remote_runLocally(arena, action);
+                        break;
+                    }
+                }
+            }
+            close(connection.sock);
+        }
 #else
 #error unimplemented
 #endif
+    }
+}
 
-            if (handle->status != prb_ProcessStatus_CompletedSuccess) {
-                result = prb_Failure;
-            }
+prb_PUBLICDEF prb_Status
+prb_executeActions(prb_Arena* arena, prb_Action* actions, int32_t actionsCount, prb_ExecSpec spec) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+    prb_Status     result = prb_Success;
+
+    prb_remote_Queue* localOnly = prb_arenaAllocStruct(arena, prb_remote_Queue);
+    prb_remote_Queue* remoteEligible = prb_arenaAllocStruct(arena, prb_remote_Queue);
+    localOnly->actions = actions;
+    localOnly->indices = prb_arenaAllocArray(arena, int32_t, actionsCount);
+    remoteEligible->actions = actions;
+    remoteEligible->indices = prb_arenaAllocArray(arena, int32_t, actionsCount);
+    for (int32_t actionIndex = 0; actionIndex < actionsCount; actionIndex++) {
+        prb_Action* action = actions + actionIndex;
+        if (action->status == prb_ProcessStatus_NotLaunched) {
+            action->status = prb_ProcessStatus_Launched;
+            action->ranRemotely = false;
+            prb_remote_Queue* queue = spec.workersCount > 0 && prb_remote_canRunRemotely(action) ? remoteEligible : localOnly;
+            queue->indices[queue->count++] = actionIndex;
         }
     }
 
-    return result;
-}
+    int32_t localSlots = spec.localSlots;
+    if (localSlots == 0) {
+        prb_CoreCountResult cores = prb_getAllowExecutionCoreCount(arena);
+        localSlots = cores.success ? prb_max(cores.cores, 1) : 1;
+    }
+    localSlots = prb_min(prb_max(localSlots, 0), actionsCount);
+    int32_t slotsPerWorker = prb_max(spec.slotsPerWorker, 1);
+    int32_t slotCount = localSlots + spec.workersCount * slotsPerWorker;
+
+    prb_remote_Slot* slots = prb_arenaAllocArray(arena, prb_remote_Slot, slotCount);
+    prb_Job*         jobs = prb_arenaAllocArray(arena, prb_Job, slotCount);
+    intptr_t         bytesPerSlot = prb_min(prb_arenaFreeSize(arena) / (slotCount + 1), INT32_MAX);
+    for (int32_t slotIndex = 0; slotIndex < slotCount; slotIndex++) {
+        prb_remote_Slot* slot = slots + slotIndex;
+        slot->localOnly = localOnly;
+        slot->remoteEligible = remoteEligible;
+        if (slotIndex >= localSlots) {
+            slot->workerAddress = spec.workers[(slotIndex - localSlots) / slotsPerWorker];
+            slot->workerToken = spec.workerToken;
+        }
+        jobs[slotIndex] = prb_createJob(prb_remote_slotProc, slot, arena, (int32_t)bytesPerSlot);
+    }
 
-prb_PUBLICDEF prb_Status
-prb_killProcesses(prb_Process* handles, int32_t handleCount) {
-    prb_Status result = prb_Success;
+    if (slotCount == 1) {
+        result = prb_launchJobs(jobs, slotCount, prb_Background_No);
+    } else {
+        result = prb_launchJobs(jobs, slotCount, prb_Background_Yes);
+        if (prb_waitForJobs(jobs, slotCount) == prb_Failure) {
+            result = prb_Failure;
+        }
+    }
 
-    for (int32_t handleIndex = 0; handleIndex < handleCount; handleIndex++) {
-        prb_Process* handle = handles + handleIndex;
-        prb_assert(handle->status != prb_ProcessStatus_NotLaunched);
-        if (handle->status == prb_ProcessStatus_Launched) {
-#if prb_PLATFORM_WINDOWS
-            if (TerminateProcess(handle->processInfo.hProcess, 9)) {
-                handle->status = prb_ProcessStatus_CompletedFailed;
-                CloseHandle(handle->processInfo.hProcess);
-                CloseHandle(handle->processInfo.hThread);
-            }
-#elif prb_PLATFORM_LINUX
-            if (kill(handle->pid, SIGKILL) == 0) {
-                handle->status = prb_ProcessStatus_CompletedFailed;
-            }
-#else
-#error unimplemented
-#endif
+    // NOTE(khvorov) Whatever is left had no slot that could take it (no worker answered and there are no local slots).
+    // Run it here rather than leave it undone.
+    for (prb_Action* action = prb_remote_queueNext(localOnly); action; action = prb_remote_queueNext(localOnly)) {
+        prb_remote_runLocally(arena, action);
+    }
+    for (prb_Action* action = prb_remote_queueNext(remoteEligible); action; action = prb_remote_queueNext(remoteEligible)) {
+        prb_remote_runLocally(arena, action);
+    }
 
-            if (handle->status != prb_ProcessStatus_CompletedFailed) {
-                result = prb_Failure;
-            }
+    for (int32_t actionIndex = 0; actionIndex < actionsCount; actionIndex++) {
+        if (actions[actionIndex].status != prb_ProcessStatus_CompletedSuccess) {
+            result = prb_Failure;
         }
     }
 
+    prb_endTempMemory(temp);
     return result;
 }
 
-prb_PUBLICDEF void
-prb_sleep(float ms) {
-#if prb_PLATFORM_WINDOWS
+prb_PUBLICDEF prb_Status
+prb_runWorker(prb_Arena* arena, prb_Str address, prb_Str workDir, prb_Str token) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+    prb_Status     result = prb_Failure;
 
-    prb_TimeStart timeStart = prb_timeStart();
-    DWORD         msec = (DWORD)(ms);
-    Sleep(msec);
-    float msSpentSleeping = prb_getMsFrom(timeStart);
+#if prb_PLATFORM_WINDOWS
 
-    float left = ms - msSpentSleeping;
-    float msSpentSpinning = 0.0f;
-    timeStart = prb_timeStart();
-    while (msSpentSpinning < left) {
-        msSpentSpinning = prb_getMsFrom(timeStart);
-    }
+    // NOTE(khvorov) Not implemented on windows
+    prb_unused(address);
+    prb_unused(workDir);
+    prb_unused(token);
 
 #elif prb_PLATFORM_LINUX
 
-    float secf = ms * 0.001f;
-    long int sec = (long int)(secf);
-    long int nsec = (long int)((secf - (float)sec) * 1000.0f * 1000.0f * 1000.0f);
-    struct timespec ts = {.tv_sec = sec, .tv_nsec = nsec};
-    nanosleep(&ts, 0);
+    // NOTE(khvorov) Whoever connects gets to run commands, so there is no running without a token.
+    // Handlers are forked and go on to use malloc and everything else, which is only safe when no other
+    // thread could be holding a lock at the time of the fork.
+    prb_Str casDir = prb_pathJoin(arena, workDir, prb_STR("cas"));
+    int     shutdownPipe[2] = {-1, -1};
+    if (token.len > 0 && prb_linux_isSingleThreaded(arena) && prb_createDirIfNotExists(arena, casDir) == prb_Success && pipe(shutdownPipe) == 0) {
+        fcntl(shutdownPipe[0], F_SETFD, FD_CLOEXEC);
+        fcntl(shutdownPipe[1], F_SETFD, FD_CLOEXEC);
+        prb_linux_OpenSocketResult listener = prb_linux_openSocket(arena, address, true);
+        if (listener.success) {
+            result = prb_Success;
+            pid_t* handlers = 0;
+            for (bool running = true; running;) {
+                struct pollfd pollFds[2] = {{listener.sock, POLLIN, 0}, {shutdownPipe[0], POLLIN, 0}};
+                int           ready = poll(pollFds, 2, -1);
+
+                // NOTE(khvorov) Reap finished handlers. Only wait on our own children
+                for (int32_t handlerIndex = 0; handlerIndex < prb_stbds_arrlen(handlers);) {
+                    if (waitpid(handlers[handlerIndex], 0, WNOHANG) == handlers[handlerIndex]) {
+                        prb_stbds_arrdelswap(handlers, handlerIndex);
+                    } else {
+                        handlerIndex++;
+                    }
+                }
+
+                if (ready == -1) {
+                    if (errno != EINTR) {
+                        result = prb_Failure;
+                        running = false;
+                    }
+                } else if (pollFds[1].revents != 0) {
+                    // NOTE(khvorov) A handler got a shutdown with the right token
+                    running = false;
+                } else if (pollFds[0].revents != 0) {
+                    int conn = accept(listener.sock, 0, 0);
+                    if (conn != -1) {
+                        // NOTE(khvorov) The handshake happens in the handler so that a peer that never sends
+                        // anything (or sends it slowly) only holds up its own connection
+                        pid_t handler = fork();
+                        if (handler == 0) {
+                            prb_linux_closeFdsExcept(conn, shutdownPipe[1]);
+                            struct timeval timeout = {.tv_sec = 10, .tv_usec = 0};
+                            setsockopt(conn, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+                            prb_remote_MsgKind hello = prb_remote_recvToken(arena, conn, token);
+                            timeout.tv_sec = 0;
+                            setsockopt(conn, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+                            if (hello == prb_remote_MsgKind_Shutdown) {
+                                uint8_t byte = 0;
+                                ssize_t written = write(shutdownPipe[1], &byte, 1);
+                                prb_unused(written);
+                            } else if (hello == prb_remote_MsgKind_Hello) {
+                                prb_linux_serveConnection(arena, conn, workDir, casDir);
+                            }
+                            close(conn);
+                            _exit(0);
+                        } else if (handler == -1) {
+                            result = prb_Failure;
+                            running = false;
+                        } else {
+                            prb_stbds_arrput(handlers, handler);
+                        }
+                        close(conn);
+                    }
+                }
+            }
+
+            close(listener.sock);
+            for (int32_t handlerIndex = 0; handlerIndex < prb_stbds_arrlen(handlers); handlerIndex++) {
+                waitpid(handlers[handlerIndex], 0, 0);
+            }
+            prb_stbds_arrfree(handlers);
+            if (listener.unixPath.len > 0) {
+                unlink(prb_strGetNullTerminated(arena, listener.unixPath));
+            }
+        }
+        close(shutdownPipe[0]);
+        close(shutdownPipe[1]);
+    }
 
 #else
 #error unimplemented
 #endif
+
+    prb_endTempMemory(temp);
+    return result;
 }
 
-prb_PUBLICDEF bool
-prb_debuggerPresent(prb_Arena* arena) {
-    bool           result = false;
+prb_PUBLICDEF prb_Status
+prb_stopWorker(prb_Arena* arena, prb_Str address, prb_Str token) {
     prb_TempMemory temp = prb_beginTempMemory(arena);
+    prb_Status     result = prb_Failure;
 
 #if prb_PLATFORM_WINDOWS
 
-    result = IsDebuggerPresent();
+    // NOTE(khvorov) Not implemented on windows
+    prb_unused(address);
+    prb_unused(token);
 
 #elif prb_PLATFORM_LINUX
 
-    prb_Bytes content = prb_linux_readFromProc(arena, prb_STR("self/status"));
-    prb_Str str = {(const char*)content.data, content.len};
-    prb_StrScanner iter = prb_createStrScanner(str);
-    prb_StrFindSpec lineBreakSpec = {};
-    lineBreakSpec.mode = prb_StrFindMode_LineBreak;
-    while (prb_strScannerMove(&iter, lineBreakSpec, prb_StrScannerSide_AfterMatch)) {
-        prb_Str search = prb_STR("TracerPid:");
-        if (prb_strStartsWith(iter.betweenLastMatches, search)) {
-            prb_Str number = prb_strTrim(prb_strSlice(iter.betweenLastMatches, search.len, iter.betweenLastMatches.len));
-            result = number.len > 1 || number.ptr[0] != '0';
-            break;
-        }
+    prb_linux_OpenSocketResult connection = prb_linux_openSocket(arena, address, false);
+    if (connection.success) {
+        result = prb_remote_sendToken(connection.sock, prb_remote_MsgKind_Shutdown, token);
+        close(connection.sock);
     }
 
 #else
@@ -3404,246 +10089,903 @@ prb_debuggerPresent(prb_Arena* arena) {
     return result;
 }
 
-prb_PUBLICDEF prb_Status
-prb_setenv(prb_Arena* arena, prb_Str name, prb_Str value) {
-    prb_TempMemory temp = prb_beginTempMemory(arena);
-    prb_Status     result = prb_Failure;
-
-#if prb_PLATFORM_WINDOWS
+//
+// SECTION Static libraries (implementation)
+//
 
-    prb_windows_WideStr wname = prb_windows_getWideStr(arena, name);
-    prb_windows_WideStr wvalue = prb_windows_getWideStr(arena, value);
-    if (SetEnvironmentVariableW(wname.ptr, wvalue.ptr)) {
-        result = prb_Success;
-    }
+typedef enum prb_lib_LogColumn {
+    prb_lib_LogColumn_ObjPath,
+    prb_lib_LogColumn_CompileCmd,
+    prb_lib_LogColumn_PreprocessedHash,
+    prb_lib_LogColumn_ExtraInputsHash,
+    prb_lib_LogColumn_SideOutputs,
+    prb_lib_LogColumn_FileHashes,
+    prb_lib_LogColumn_Count,
+} prb_lib_LogColumn;
+
+static const char* prb_lib_logColumnNames[prb_lib_LogColumn_Count] = {"objPath", "compileCmd", "preprocessedHash", "extraInputsHash", "sideOutputs", "fileHashes"};
+
+// NOTE(khvorov) Logs written before a column was added are still usable, the missing value reads as 0/empty
+static const bool prb_lib_logColumnOptional[prb_lib_LogColumn_Count] = {false, false, false, true, true, true};
+
+static const char* prb_lib_rebuildReasonNames[prb_RebuildReason_Count] = {"always runs", "not in log", "output missing", "side output missing", "command changed", "extra inputs changed", "source changed", "objects changed"};
+
+// NOTE(khvorov) Upper bound on columns in a log row, unknown columns are ignored when reading
+#define prb_lib_MAX_LOG_COLUMNS 32
+
+typedef struct prb_lib_CostEntry {
+    prb_Str key;
+    int32_t count;
+    float   durationMs;
+} prb_lib_CostEntry;
+
+typedef struct prb_lib_State {
+    prb_Str*     inputs;
+    prb_Str*     preprocessed;
+    prb_Str*     objs;
+    prb_ObjInfo* objInfos;
+    int32_t      firstAction;
+    int32_t      actionsCount;
+    int32_t      firstRecord;
+    // NOTE(khvorov) Copied into the arena once every phase is done
+    prb_BuildRecord* records;
+    bool             regenLib;
+} prb_lib_State;
 
+static prb_Str
+prb_lib_defaultBuildCmd(prb_Arena* arena, void* data, prb_BuildStep step, prb_Str flags, prb_Str input, prb_Str output) {
+    prb_unused(data);
+    prb_Str result = {};
+    switch (step) {
+        case prb_BuildStep_Preprocess: result = prb_fmt(arena, "clang -E %.*s %.*s -o %.*s", prb_LIT(flags), prb_LIT(input), prb_LIT(output)); break;
+        case prb_BuildStep_Compile: result = prb_fmt(arena, "clang -c %.*s %.*s -o %.*s", prb_LIT(flags), prb_LIT(input), prb_LIT(output)); break;
+        case prb_BuildStep_Archive: {
+#if prb_PLATFORM_WINDOWS
+            result = prb_fmt(arena, "llvm-lib /nologo -out:%.*s %.*s", prb_LIT(output), prb_LIT(input));
 #elif prb_PLATFORM_LINUX
-    const char* nameNull = prb_strGetNullTerminated(arena, name);
-    const char* valueNull = prb_strGetNullTerminated(arena, value);
-    result = setenv(nameNull, valueNull, 1) == 0 ? prb_Success : prb_Failure;
+            result = prb_fmt(arena, "ar rcs %.*s %.*s", prb_LIT(output), prb_LIT(input));
 #else
 #error unimplemented
 #endif
+        } break;
+    }
+    return result;
+}
 
-    prb_endTempMemory(temp);
+static prb_Str
+prb_lib_buildCmd(prb_Arena* arena, prb_StaticLibSpec* spec, prb_BuildStep step, prb_Str flags, prb_Str input, prb_Str output) {
+    prb_BuildCmdProc proc = spec->buildCmd ? spec->buildCmd : prb_lib_defaultBuildCmd;
+    prb_Str          result = proc(arena, spec->buildCmdData, step, flags, input, output);
     return result;
 }
 
-prb_PUBLICDEF prb_GetenvResult
-prb_getenv(prb_Arena* arena, prb_Str name) {
-    prb_GetenvResult result;
-    prb_memset(&result, 0, sizeof(result));
+static void
+prb_lib_addCsvField(prb_GrowingStr* gstr, prb_Str field, bool last) {
+    prb_addChar(gstr, '"');
+    int32_t runStart = 0;
+    for (int32_t index = 0; index <= field.len; index++) {
+        if (index == field.len || field.ptr[index] == '"') {
+            prb_addStr(gstr, prb_strSlice(field, runStart, index));
+            if (index < field.len) {
+                prb_addStr(gstr, prb_STR("\"\""));
+            }
+            runStart = index + 1;
+        }
+    }
+    prb_addStr(gstr, last ? prb_STR("\"\n") : prb_STR("\","));
+}
 
-#if prb_PLATFORM_WINDOWS
+// NOTE(khvorov) Hex digits never need escaping
+static void
+prb_lib_addCsvHexField(prb_GrowingStr* gstr, uint64_t value) {
+    prb_addChar(gstr, '"');
+    prb_addHex(gstr, value);
+    prb_addStr(gstr, prb_STR("\","));
+}
+
+// NOTE(khvorov) Returns the number of fields in the row, 0 at the end of input and -1 if the row is malformed
+static int32_t
+prb_lib_csvNextRow(prb_Arena* arena, prb_Str str, int32_t* offset, prb_Str* fields, int32_t fieldsMax) {
+    int32_t result = 0;
+    int32_t at = *offset;
+    bool    rowDone = at >= str.len;
+    while (!rowDone && result >= 0) {
+        if (str.ptr[at] != '"' || result == fieldsMax) {
+            result = -1;
+        } else {
+            at += 1;
+            prb_GrowingStr field = prb_beginStr(arena);
+            int32_t        runStart = at;
+            bool           fieldDone = false;
+            while (!fieldDone && result >= 0) {
+                if (at >= str.len) {
+                    result = -1;
+                } else if (str.ptr[at] == '"') {
+                    prb_addStr(&field, prb_strSlice(str, runStart, at));
+                    if (at + 1 < str.len && str.ptr[at + 1] == '"') {
+                        prb_addChar(&field, '"');
+                        at += 2;
+                        runStart = at;
+                    } else {
+                        at += 1;
+                        fieldDone = true;
+                    }
+                } else {
+                    at += 1;
+                }
+            }
+            prb_Str fieldStr = prb_endStr(&field);
+
+            if (result >= 0) {
+                fields[result++] = fieldStr;
+                if (at >= str.len) {
+                    rowDone = true;
+                } else if (str.ptr[at] == ',') {
+                    at += 1;
+                } else if (str.ptr[at] == '\n') {
+                    at += 1;
+                    rowDone = true;
+                } else if (str.ptr[at] == '\r' && at + 1 < str.len && str.ptr[at + 1] == '\n') {
+                    at += 2;
+                    rowDone = true;
+                } else {
+                    result = -1;
+                }
+            }
+        }
+    }
+    *offset = at;
+    return result;
+}
 
-    prb_arenaAlignFreePtr(arena, prb_alignof(uint16_t));
-    prb_windows_WideStr wname = prb_windows_getWideStr(arena, name);
-    LPWSTR              wptr = (LPWSTR)prb_arenaFreePtr(arena);
-    DWORD               getEnvResult = GetEnvironmentVariableW(wname.ptr, wptr, (DWORD)prb_min(prb_arenaFreeSize(arena), UINT32_MAX));
-    if (getEnvResult > 0) {
-        prb_arenaChangeUsed(arena, (int32_t)getEnvResult * (int32_t)sizeof(*wptr));
-        prb_arenaAllocAndZero(arena, 2, 1);  // NOTE(khvorov) Null terminator
-        result.str = prb_windows_strFromWideStr(arena, (prb_windows_WideStr) {wptr, (int32_t)getEnvResult});
-        result.found = true;
+static void
+prb_lib_parseLog(prb_Arena* arena, prb_Str str, prb_StaticLib* lib) {
+    lib->prevLogObjs = prb_createStrInterner(arena, prb_ThreadSafe_No);
+    prb_Str header[prb_lib_MAX_LOG_COLUMNS] = {};
+    int32_t offset = 0;
+    int32_t headerCount = prb_lib_csvNextRow(arena, str, &offset, header, prb_arrayCount(header));
+
+    int32_t columnIndices[prb_lib_LogColumn_Count] = {};
+    bool    allColumnsPresent = headerCount > 0;
+    for (int32_t column = 0; column < prb_lib_LogColumn_Count; column++) {
+        columnIndices[column] = -1;
+        for (int32_t headerIndex = 0; headerIndex < headerCount; headerIndex++) {
+            if (prb_streq(header[headerIndex], prb_STR(prb_lib_logColumnNames[column]))) {
+                columnIndices[column] = headerIndex;
+            }
+        }
+        allColumnsPresent = allColumnsPresent && (columnIndices[column] != -1 || prb_lib_logColumnOptional[column]);
     }
 
-#elif prb_PLATFORM_LINUX
+    if (allColumnsPresent) {
+        prb_Str      row[prb_lib_MAX_LOG_COLUMNS] = {};
+        bool         malformed = false;
+        prb_ObjInfo* infos = 0;
+        for (;;) {
+            int32_t rowCount = prb_lib_csvNextRow(arena, str, &offset, row, prb_arrayCount(row));
+            if (rowCount == 0) {
+                break;
+            }
+            if (rowCount != headerCount) {
+                malformed = true;
+                break;
+            }
+            prb_ParsedNumber hash = prb_parseNumber(row[columnIndices[prb_lib_LogColumn_PreprocessedHash]]);
+            prb_ParsedNumber extraHash = {};
+            extraHash.kind = prb_ParsedNumberKind_U64;
+            if (columnIndices[prb_lib_LogColumn_ExtraInputsHash] != -1) {
+                extraHash = prb_parseNumber(row[columnIndices[prb_lib_LogColumn_ExtraInputsHash]]);
+            }
+            if (hash.kind == prb_ParsedNumberKind_U64 && extraHash.kind == prb_ParsedNumberKind_U64) {
+                prb_ObjInfo info = {row[columnIndices[prb_lib_LogColumn_CompileCmd]], hash.parsedU64, extraHash.parsedU64, {}, {}};
+                if (columnIndices[prb_lib_LogColumn_SideOutputs] != -1) {
+                    info.sideOutputs = row[columnIndices[prb_lib_LogColumn_SideOutputs]];
+                }
+                if (columnIndices[prb_lib_LogColumn_FileHashes] != -1) {
+                    info.fileHashes = row[columnIndices[prb_lib_LogColumn_FileHashes]];
+                }
+                // NOTE(khvorov) The last entry for an object wins
+                prb_InternedStr* objPath = prb_internStr(&lib->prevLogObjs, row[columnIndices[prb_lib_LogColumn_ObjPath]]);
+                if (objPath->id == prb_stbds_arrlen(infos)) {
+                    prb_stbds_arrput(infos, info);
+                } else {
+                    infos[objPath->id] = info;
+                }
+            }
+        }
+        if (malformed) {
+            lib->prevLogObjs = prb_createStrInterner(arena, prb_ThreadSafe_No);
+        } else if (prb_stbds_arrlen(infos) > 0) {
+            lib->prevLog = prb_arenaAllocArray(arena, prb_ObjInfo, prb_stbds_arrlen(infos));
+            prb_memcpy(lib->prevLog, infos, prb_stbds_arrlen(infos) * (int32_t)sizeof(prb_ObjInfo));
+        }
+        prb_stbds_arrfree(infos);
+    }
+}
+
+static void
+prb_lib_writeLog(prb_Arena* arena, prb_StaticLib* lib, prb_lib_State* state) {
+    // NOTE(khvorov) The log goes out chunk by chunk, it never needs to be contiguous
     prb_TempMemory temp = prb_beginTempMemory(arena);
-    const char* nameNull = prb_strGetNullTerminated(arena, name);
-    char* str = getenv(nameNull);
-    if (str) {
-        result.found = true;
-        result.str = prb_STR(str);
+    prb_GrowingStr gstr = prb_beginChunkedStr(arena);
+    for (int32_t column = 0; column < prb_lib_LogColumn_Count; column++) {
+        prb_lib_addCsvField(&gstr, prb_STR(prb_lib_logColumnNames[column]), column == prb_lib_LogColumn_Count - 1);
     }
+    for (int32_t objIndex = 0; objIndex < prb_stbds_arrlen(state->objs); objIndex++) {
+        prb_ObjInfo info = state->objInfos[objIndex];
+        prb_lib_addCsvField(&gstr, state->objs[objIndex], false);
+        prb_lib_addCsvField(&gstr, info.compileCmd, false);
+        prb_lib_addCsvHexField(&gstr, info.preprocessedHash);
+        prb_lib_addCsvHexField(&gstr, info.extraInputsHash);
+        prb_lib_addCsvField(&gstr, info.sideOutputs, false);
+        prb_lib_addCsvField(&gstr, info.fileHashes, true);
+    }
+    prb_writeChunksToFile(arena, lib->logPath, gstr.firstChunk);
     prb_endTempMemory(temp);
+}
 
-#else
-#error unimplemented
-#endif
-
+static prb_Status
+prb_lib_gatherSources(prb_Arena* arena, prb_StaticLibSpec* spec, prb_Str** inputs) {
+    prb_Status result = prb_Success;
+    for (int32_t srcIndex = 0; srcIndex < spec->sourcesCount && result == prb_Success; srcIndex++) {
+        prb_Str src = spec->sources[srcIndex];
+        prb_Str path = prb_pathJoin(arena, spec->srcDir, src);
+        prb_Str lastEntry = prb_getLastEntryInPath(path);
+        if (prb_strStartsWith(lastEntry, prb_STR("*."))) {
+            prb_Str  ext = prb_strSlice(lastEntry, 1, lastEntry.len);
+            prb_Str  dir = prb_getParentDir(arena, path);
+            prb_Str* entries = prb_getAllDirEntries(arena, dir, prb_Recursive_No);
+            bool     atleastone = false;
+            for (int32_t entryIndex = 0; entryIndex < prb_stbds_arrlen(entries); entryIndex++) {
+                prb_Str entry = entries[entryIndex];
+                if (prb_strEndsWith(entry, ext) && prb_isFile(arena, entry)) {
+                    prb_stbds_arrput(*inputs, entry);
+                    atleastone = true;
+                }
+            }
+            prb_stbds_arrfree(entries);
+            if (!atleastone) {
+                prb_writelnToStdout(arena, prb_fmt(arena, "%.*s: src pattern no files: %.*s", prb_LIT(spec->name), prb_LIT(src)));
+                result = prb_Failure;
+            }
+        } else if (prb_isFile(arena, path)) {
+            prb_stbds_arrput(*inputs, path);
+        } else {
+            prb_writelnToStdout(arena, prb_fmt(arena, "%.*s: src file not found: %.*s", prb_LIT(spec->name), prb_LIT(src)));
+            result = prb_Failure;
+        }
+    }
     return result;
 }
 
-prb_PUBLICDEF prb_Status
-prb_unsetenv(prb_Arena* arena, prb_Str name) {
-    prb_TempMemory temp = prb_beginTempMemory(arena);
-    prb_Status     result = prb_Failure;
-
-#if prb_PLATFORM_WINDOWS
-
-    prb_windows_WideStr wname = prb_windows_getWideStr(arena, name);
-    if (SetEnvironmentVariableW(wname.ptr, NULL)) {
-        result = prb_Success;
+// NOTE(khvorov) The same library built in several configurations has the same source list,
+// in that case directories only need to be listed once
+static bool
+prb_lib_sameSources(prb_StaticLibSpec* spec1, prb_StaticLibSpec* spec2) {
+    bool result = prb_streq(spec1->srcDir, spec2->srcDir) && spec1->sourcesCount == spec2->sourcesCount;
+    for (int32_t srcIndex = 0; srcIndex < spec1->sourcesCount && result; srcIndex++) {
+        result = prb_streq(spec1->sources[srcIndex], spec2->sources[srcIndex]);
     }
-
-#elif prb_PLATFORM_LINUX
-
-    const char* nameNull = prb_strGetNullTerminated(arena, name);
-    result = unsetenv(nameNull) == 0 ? prb_Success : prb_Failure;
-
-#else
-#error unimplemented
-#endif
-
-    prb_endTempMemory(temp);
     return result;
 }
 
-//
-// SECTION Timing (implementation)
-//
+// NOTE(khvorov) Removes side outputs from a previous compilation that aren't produced anymore
+static void
+prb_lib_removeSideOutputs(prb_Arena* arena, prb_Str prevSideOutputs, prb_Str currentSideOutputs) {
+    prb_StrScanner  scanner = prb_createStrScanner(prevSideOutputs);
+    prb_StrFindSpec space = {};
+    space.pattern = prb_STR(" ");
+    space.alwaysMatchEnd = true;
+    prb_StrFinder spaceFinder = prb_createStrFinder(space);
+    while (prb_strScannerMoveWith(&scanner, &spaceFinder, prb_StrScannerSide_AfterMatch)) {
+        prb_Str prev = scanner.betweenLastMatches;
+        if (prev.len > 0) {
+            bool           stillProduced = false;
+            prb_StrScanner currentScanner = prb_createStrScanner(currentSideOutputs);
+            while (!stillProduced && prb_strScannerMoveWith(&currentScanner, &spaceFinder, prb_StrScannerSide_AfterMatch)) {
+                stillProduced = prb_streq(prev, currentScanner.betweenLastMatches);
+            }
+            if (!stillProduced) {
+                prb_removePathIfExists(arena, prev);
+            }
+        }
+    }
+}
 
-prb_PUBLICDEF prb_TimeStart
-prb_timeStart(void) {
-    prb_TimeStart result;
-    prb_memset(&result, 0, sizeof(result));
-#if prb_PLATFORM_WINDOWS
-    LARGE_INTEGER ticks;
-    prb_memset(&ticks, 0, sizeof(ticks));
-    if (QueryPerformanceCounter(&ticks)) {
-        result.valid = true;
-        result.ticks = ticks.QuadPart;
+// NOTE(khvorov) Linemarkers look like `# 12 "path" 2` (gcc/clang) or `#line 12 "path"` (msvc)
+static bool
+prb_lib_parseLinemarker(prb_Str line, prb_Str* path) {
+    int32_t at = 1;
+    if (prb_strStartsWith(prb_strSlice(line, at, line.len), prb_STR("line"))) {
+        at += 4;
     }
-#elif prb_PLATFORM_LINUX
-    struct timespec tp = {};
-    if (clock_gettime(CLOCK_MONOTONIC, &tp) == 0) {
-        prb_assert(tp.tv_nsec >= 0 && tp.tv_sec >= 0);
-        result.nsec = (uint64_t)tp.tv_nsec + (uint64_t)tp.tv_sec * 1000 * 1000 * 1000;
-        result.valid = true;
+    bool result = at < line.len && line.ptr[at] == ' ';
+    while (at < line.len && line.ptr[at] == ' ') {
+        at += 1;
+    }
+    int32_t digitsStart = at;
+    while (at < line.len && line.ptr[at] >= '0' && line.ptr[at] <= '9') {
+        at += 1;
+    }
+    result = result && at > digitsStart && at + 1 < line.len && line.ptr[at] == ' ' && line.ptr[at + 1] == '"';
+    if (result) {
+        int32_t pathStart = at + 2;
+        int32_t pathEnd = pathStart;
+        while (pathEnd < line.len && line.ptr[pathEnd] != '"') {
+            pathEnd += 1;
+        }
+        result = pathEnd < line.len;
+        *path = prb_strSlice(line, pathStart, pathEnd);
     }
-#else
-#error unimplemented
-#endif
     return result;
 }
 
-prb_PUBLICDEF float
-prb_getMsFrom(prb_TimeStart timeStart) {
-    prb_TimeStart now = prb_timeStart();
-    float         result = 0.0f;
-    if (now.valid && timeStart.valid) {
-#if prb_PLATFORM_WINDOWS
-        LARGE_INTEGER ticksPerSecond;
-        prb_memset(&ticksPerSecond, 0, sizeof(ticksPerSecond));
-        if (QueryPerformanceFrequency(&ticksPerSecond)) {
-            LONGLONG ticksDiff = now.ticks - timeStart.ticks;
-            float    secs = (float)ticksDiff / (float)ticksPerSecond.QuadPart;
-            result = secs * 1000.0f;
+// NOTE(khvorov) Hashes the text between linemarkers separately for every file so that when a TU
+// changes we can tell which header did it. Keys are heap copies so the content can go away after.
+// NOTE(khvorov) One line per file that contributed to the preprocessed output, the hash of every segment
+// that came from it and the path. Paths are slices of the preprocessed content.
+static prb_Str
+prb_lib_fileHashes(prb_Arena* arena, prb_Str preprocessed) {
+    prb_StrMap hashes = prb_createStrMap(arena, 0);
+    prb_Str    currentFile = prb_STR("");
+    int32_t    segmentStart = 0;
+    for (int32_t lineStart = 0; lineStart <= preprocessed.len;) {
+        int32_t lineEnd = lineStart;
+        while (lineEnd < preprocessed.len && preprocessed.ptr[lineEnd] != '\n') {
+            lineEnd += 1;
         }
-#elif prb_PLATFORM_LINUX
-        uint64_t nsec = now.nsec - timeStart.nsec;
-        result = (float)nsec / 1000.0f / 1000.0f;
-#else
-#error unimplemented
-#endif
+        prb_Str line = prb_strSlice(preprocessed, lineStart, lineEnd);
+        prb_Str markerPath = {};
+        bool    isMarker = line.len > 0 && line.ptr[0] == '#' && prb_lib_parseLinemarker(line, &markerPath);
+        if (isMarker || lineEnd == preprocessed.len) {
+            int32_t segmentEnd = isMarker ? lineStart : lineEnd;
+            if (segmentEnd > segmentStart) {
+                prb_StrMapEntry* entry = prb_strMapAdd(&hashes, currentFile);
+                uint64_t         pair[] = {entry->value, prb_stbds_hash_bytes((void*)(preprocessed.ptr + segmentStart), (size_t)(segmentEnd - segmentStart), (size_t)1)};
+                entry->value = prb_stbds_hash_bytes(pair, sizeof(pair), (size_t)1);
+            }
+            if (isMarker) {
+                currentFile = markerPath;
+                segmentStart = prb_min(lineEnd + 1, preprocessed.len);
+            }
+        }
+        lineStart = lineEnd + 1;
+    }
+
+    prb_GrowingStr gstr = prb_beginStr(arena);
+    for (int32_t entryIndex = 0; entryIndex < hashes.count; entryIndex++) {
+        prb_addHex(&gstr, hashes.entries[entryIndex].value);
+        prb_addChar(&gstr, ' ');
+        prb_addStr(&gstr, hashes.entries[entryIndex].key);
+        prb_addChar(&gstr, '\n');
     }
+    prb_Str result = prb_endStr(&gstr);
     return result;
 }
 
-//
-// SECTION Multithreading (implementation)
-//
+// NOTE(khvorov) Compares two fileHashes strings from prb_ObjInfo
+static prb_Str
+prb_lib_changedFiles(prb_Arena* arena, prb_Str prevFileHashes, prb_Str fileHashes) {
+    prb_StrMap      prev = prb_createStrMap(arena, 0);
+    prb_StrFindSpec newline = {};
+    newline.pattern = prb_STR("\n");
+    newline.alwaysMatchEnd = true;
+    prb_StrFindSpec space = {};
+    space.pattern = prb_STR(" ");
+    prb_StrFinder newlineFinder = prb_createStrFinder(newline);
+    prb_StrFinder spaceFinder = prb_createStrFinder(space);
+
+    prb_StrScanner prevScanner = prb_createStrScanner(prevFileHashes);
+    while (prb_strScannerMoveWith(&prevScanner, &newlineFinder, prb_StrScannerSide_AfterMatch)) {
+        prb_StrFindResult split = prb_strFinderFind(&spaceFinder, prevScanner.betweenLastMatches);
+        if (split.found) {
+            prb_ParsedNumber hash = prb_parseNumber(split.beforeMatch);
+            if (hash.kind == prb_ParsedNumberKind_U64) {
+                prb_strMapAdd(&prev, split.afterMatch)->value = hash.parsedU64;
+            }
+        }
+    }
 
-#if prb_PLATFORM_WINDOWS
+    prb_Str*       changes = 0;
+    bool*          prevSeen = prb_arenaAllocArray(arena, bool, prev.count);
+    prb_StrScanner scanner = prb_createStrScanner(fileHashes);
+    while (prb_strScannerMoveWith(&scanner, &newlineFinder, prb_StrScannerSide_AfterMatch)) {
+        prb_StrFindResult split = prb_strFinderFind(&spaceFinder, scanner.betweenLastMatches);
+        if (split.found) {
+            prb_ParsedNumber hash = prb_parseNumber(split.beforeMatch);
+            prb_Str          path = split.afterMatch;
+            prb_StrMapEntry* prevEntry = prb_strMapFind(&prev, path);
+            if (!prevEntry) {
+                prb_stbds_arrput(changes, prb_fmt(arena, "new %.*s", prb_LIT(path)));
+            } else {
+                if (hash.kind != prb_ParsedNumberKind_U64 || prevEntry->value != hash.parsedU64) {
+                    prb_stbds_arrput(changes, prb_fmt(arena, "changed %.*s", prb_LIT(path)));
+                }
+                prevSeen[prevEntry - prev.entries] = true;
+            }
+        }
+    }
+    for (int32_t prevIndex = 0; prevIndex < prev.count; prevIndex++) {
+        if (!prevSeen[prevIndex]) {
+            prb_stbds_arrput(changes, prb_fmt(arena, "gone %.*s", prb_LIT(prev.entries[prevIndex].key)));
+        }
+    }
 
-static DWORD WINAPI
-prb_windows_threadProc(void* data) {
-    prb_Job* job = (prb_Job*)data;
-    job->proc(&job->arena, job->data);
-    return 0;
+    prb_Str result = prb_stringsJoin(arena, changes, prb_stbds_arrlen(changes), prb_STR("\n"));
+    prb_stbds_arrfree(changes);
+    return result;
 }
 
-#elif prb_PLATFORM_LINUX
+// NOTE(khvorov) Arguments are compared as a set, so reordering doesn't count as a change
+static prb_Str
+prb_lib_changedArgs(prb_Arena* arena, prb_Str prevCmd, prb_Str cmd) {
+    prb_StrMap      prev = prb_createStrMap(arena, 0);
+    prb_StrFindSpec space = {};
+    space.pattern = prb_STR(" ");
+    space.alwaysMatchEnd = true;
+    prb_StrFinder spaceFinder = prb_createStrFinder(space);
+
+    prb_StrScanner prevScanner = prb_createStrScanner(prevCmd);
+    while (prb_strScannerMoveWith(&prevScanner, &spaceFinder, prb_StrScannerSide_AfterMatch)) {
+        if (prevScanner.betweenLastMatches.len > 0) {
+            prb_strMapAdd(&prev, prevScanner.betweenLastMatches);
+        }
+    }
 
-static void*
-prb_linux_threadProc(void* data) {
-    prb_Job* job = (prb_Job*)data;
-    job->proc(&job->arena, job->data);
-    return 0;
+    prb_Str*       changes = 0;
+    prb_StrScanner scanner = prb_createStrScanner(cmd);
+    while (prb_strScannerMoveWith(&scanner, &spaceFinder, prb_StrScannerSide_AfterMatch)) {
+        prb_Str arg = scanner.betweenLastMatches;
+        if (arg.len > 0) {
+            prb_StrMapEntry* prevEntry = prb_strMapFind(&prev, arg);
+            if (!prevEntry) {
+                prb_stbds_arrput(changes, prb_fmt(arena, "added arg %.*s", prb_LIT(arg)));
+            } else {
+                prevEntry->value = true;
+            }
+        }
+    }
+    for (int32_t prevIndex = 0; prevIndex < prev.count; prevIndex++) {
+        if (!prev.entries[prevIndex].value) {
+            prb_stbds_arrput(changes, prb_fmt(arena, "removed arg %.*s", prb_LIT(prev.entries[prevIndex].key)));
+        }
+    }
+
+    prb_Str result = prb_stringsJoin(arena, changes, prb_stbds_arrlen(changes), prb_STR("\n"));
+    prb_stbds_arrfree(changes);
+    return result;
 }
 
-#endif
+static void
+prb_lib_collectStatus(prb_StaticLib* libs, int32_t libsCount, prb_lib_State* states, prb_Action* actions) {
+    for (int32_t libIndex = 0; libIndex < libsCount; libIndex++) {
+        prb_StaticLib* lib = libs + libIndex;
+        prb_lib_State* state = states + libIndex;
+        if (lib->status == prb_ProcessStatus_Launched) {
+            for (int32_t actionIndex = 0; actionIndex < state->actionsCount; actionIndex++) {
+                prb_Action* action = actions + state->firstAction + actionIndex;
+                state->records[state->firstRecord + actionIndex].durationMs = action->durationMs;
+                if (action->status != prb_ProcessStatus_CompletedSuccess) {
+                    lib->status = prb_ProcessStatus_CompletedFailed;
+                }
+            }
+        }
+        state->firstAction = 0;
+        state->actionsCount = 0;
+    }
+}
 
-prb_PUBLICDEF prb_Job
-prb_createJob(prb_JobProc proc, void* data, prb_Arena* arena, int32_t arenaBytes) {
-    prb_Job job;
-    prb_memset(&job, 0, sizeof(job));
-    job.proc = proc;
-    job.data = data;
-    job.arena = prb_createArenaFromArena(arena, arenaBytes);
-    return job;
+static void
+prb_lib_addRecord(prb_lib_State* state, prb_BuildStep step, prb_RebuildReason reason, prb_Str output, prb_Str causes) {
+    prb_BuildRecord record = {};
+    record.step = step;
+    record.reason = reason;
+    record.output = output;
+    record.causes = causes;
+    prb_stbds_arrput(state->records, record);
+}
+
+prb_PUBLICDEF prb_StaticLib
+prb_createStaticLib(prb_Arena* arena, prb_StaticLibSpec spec) {
+    prb_assert(spec.objDir.len > 0 && spec.libFile.len > 0);
+    prb_StaticLib result = {};
+    result.spec = spec;
+    result.logPath = prb_pathJoin(arena, prb_getParentDir(arena, spec.objDir), prb_fmt(arena, "%.*s-log.csv", prb_LIT(prb_getLastEntryInPath(spec.objDir))));
+    prb_ReadEntireFileResult prevLogRead = prb_readEntireFile(arena, result.logPath);
+    if (prevLogRead.success) {
+        prb_lib_parseLog(arena, prb_strFromBytes(prevLogRead.content), &result);
+    }
+    return result;
 }
 
 prb_PUBLICDEF prb_Status
-prb_launchJobs(prb_Job* jobs, int32_t jobsCount, prb_Background mode) {
-    prb_Status result = prb_Success;
+prb_compileStaticLibs(prb_Arena* arena, prb_StaticLib* libs, int32_t libsCount, prb_ExecSpec spec) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+    prb_Status     result = prb_Success;
+    prb_lib_State* states = prb_arenaAllocArray(arena, prb_lib_State, libsCount);
+    bool           remote = spec.workersCount > 0;
+
+    // NOTE(khvorov) Preprocess. The hash of the output is what decides if a TU needs to be recompiled.
+    // All libraries go through the same executeActions call so that they share the slots.
+    prb_Action* actions = 0;
+    for (int32_t libIndex = 0; libIndex < libsCount; libIndex++) {
+        prb_StaticLib* lib = libs + libIndex;
+        prb_lib_State* state = states + libIndex;
+        prb_assert(lib->status == prb_ProcessStatus_NotLaunched);
+        lib->status = prb_ProcessStatus_Launched;
+
+        prb_Status gatherStatus = prb_Failure;
+        for (int32_t prevLibIndex = 0; prevLibIndex < libIndex && gatherStatus == prb_Failure; prevLibIndex++) {
+            prb_lib_State* prevState = states + prevLibIndex;
+            if (libs[prevLibIndex].status == prb_ProcessStatus_Launched && prb_lib_sameSources(&lib->spec, &libs[prevLibIndex].spec)) {
+                for (int32_t inputIndex = 0; inputIndex < prb_stbds_arrlen(prevState->inputs); inputIndex++) {
+                    prb_stbds_arrput(state->inputs, prevState->inputs[inputIndex]);
+                }
+                gatherStatus = prb_Success;
+            }
+        }
+        if (gatherStatus == prb_Failure) {
+            gatherStatus = prb_lib_gatherSources(arena, &lib->spec, &state->inputs);
+        }
 
-    switch (mode) {
-        case prb_Background_No: {
-            for (int32_t jobIndex = 0; jobIndex < jobsCount && result == prb_Success; jobIndex++) {
-                prb_Job* job = jobs + jobIndex;
-                if (job->status == prb_JobStatus_NotLaunched) {
-                    job->status = prb_JobStatus_Launched;
-                    job->proc(&job->arena, job->data);
-                    job->status = prb_JobStatus_Completed;
+        if (prb_createDirIfNotExists(arena, lib->spec.objDir) == prb_Failure || gatherStatus == prb_Failure) {
+            lib->status = prb_ProcessStatus_CompletedFailed;
+        } else {
+            prb_Str preprocessExt = lib->spec.cpp ? prb_STR("ii") : prb_STR("i");
+            state->firstAction = prb_stbds_arrlen(actions);
+            state->actionsCount = prb_stbds_arrlen(state->inputs);
+            state->firstRecord = prb_stbds_arrlen(state->records);
+            for (int32_t inputIndex = 0; inputIndex < prb_stbds_arrlen(state->inputs); inputIndex++) {
+                prb_Str input = state->inputs[inputIndex];
+                prb_Str output = prb_pathJoin(arena, lib->spec.objDir, prb_replaceExt(arena, prb_getLastEntryInPath(input), preprocessExt));
+                prb_stbds_arrput(state->preprocessed, output);
+                prb_Action action = {};
+                action.cmd = prb_lib_buildCmd(arena, &lib->spec, prb_BuildStep_Preprocess, lib->spec.flags, input, output);
+                prb_stbds_arrput(actions, action);
+                prb_lib_addRecord(state, prb_BuildStep_Preprocess, prb_RebuildReason_AlwaysRuns, output, prb_STR(""));
+            }
+        }
+    }
+    prb_executeActions(arena, actions, prb_stbds_arrlen(actions), spec);
+    prb_lib_collectStatus(libs, libsCount, states, actions);
+    prb_stbds_arrfree(actions);
+
+    // NOTE(khvorov) Compile whatever changed. Workers don't have the headers so they get the preprocessed files.
+    for (int32_t libIndex = 0; libIndex < libsCount; libIndex++) {
+        prb_StaticLib* lib = libs + libIndex;
+        prb_lib_State* state = states + libIndex;
+        if (lib->status == prb_ProcessStatus_Launched) {
+            // NOTE(khvorov) Objects on disk get the first ids so that they can be marked as used in an array
+            prb_StrInterner existingObjs = prb_createStrInterner(arena, prb_ThreadSafe_No);
+            prb_Str*        entries = prb_getAllDirEntries(arena, lib->spec.objDir, prb_Recursive_No);
+            for (int32_t entryIndex = 0; entryIndex < prb_stbds_arrlen(entries); entryIndex++) {
+                prb_Str entry = entries[entryIndex];
+                if (prb_strEndsWith(entry, prb_STR(".obj"))) {
+                    prb_internStr(&existingObjs, entry);
+                }
+            }
+            prb_stbds_arrfree(entries);
+            bool* existingObjUsed = prb_arenaAllocArray(arena, bool, existingObjs.count);
+
+            // NOTE(khvorov) Combined hash of all extra inputs
+            uint64_t extraInputsHash = 0;
+            for (int32_t extraIndex = 0; extraIndex < lib->spec.extraInputsCount; extraIndex++) {
+                prb_FileHash extraHash = prb_getFileHash(arena, lib->spec.extraInputs[extraIndex]);
+                if (extraHash.valid) {
+                    uint64_t hashes[] = {extraInputsHash, extraHash.hash};
+                    extraInputsHash = prb_stbds_hash_bytes(hashes, sizeof(hashes), (size_t)1);
+                } else {
+                    prb_writelnToStdout(arena, prb_fmt(arena, "%.*s: extra input not found: %.*s", prb_LIT(lib->spec.name), prb_LIT(lib->spec.extraInputs[extraIndex])));
+                    lib->status = prb_ProcessStatus_CompletedFailed;
                 }
             }
-        } break;
 
-        case prb_Background_Yes: {
-            for (int32_t jobIndex = 0; jobIndex < jobsCount && result == prb_Success; jobIndex++) {
-                prb_Job* job = jobs + jobIndex;
-                if (job->status == prb_JobStatus_NotLaunched) {
-                    job->status = prb_JobStatus_Launched;
-#if prb_PLATFORM_WINDOWS
-                    job->threadhandle = CreateThread(0, 0, prb_windows_threadProc, job, 0, &job->threadid);
-                    if (job->threadhandle == NULL) {
-                        result = prb_Failure;
+            state->firstAction = prb_stbds_arrlen(actions);
+            state->firstRecord = prb_stbds_arrlen(state->records);
+            for (int32_t inputIndex = 0; inputIndex < prb_stbds_arrlen(state->inputs) && lib->status == prb_ProcessStatus_Launched; inputIndex++) {
+                prb_Str objPath = prb_pathJoin(arena, lib->spec.objDir, prb_replaceExt(arena, prb_getLastEntryInPath(state->inputs[inputIndex]), prb_STR("obj")));
+                prb_stbds_arrput(state->objs, objPath);
+                prb_InternedStr* existingObj = prb_findInternedStr(&existingObjs, objPath);
+                if (existingObj) {
+                    existingObjUsed[existingObj->id] = true;
+                }
+
+                prb_Str* sideOutputs = prb_arenaAllocArray(arena, prb_Str, lib->spec.sideOutputExtsCount);
+                bool     sideOutputsPresent = true;
+                for (int32_t extIndex = 0; extIndex < lib->spec.sideOutputExtsCount; extIndex++) {
+                    sideOutputs[extIndex] = prb_replaceExt(arena, objPath, lib->spec.sideOutputExts[extIndex]);
+                    sideOutputsPresent = sideOutputsPresent && prb_isFile(arena, sideOutputs[extIndex]);
+                }
+                prb_Str sideOutputsStr = prb_stringsJoin(arena, sideOutputs, lib->spec.sideOutputExtsCount, prb_STR(" "));
+
+                // NOTE(khvorov) Compiling the not preprocessed input locally gives more useful warnings.
+                // Only the source input command is logged and compared so that turning workers
+                // on or off doesn't recompile everything
+                prb_Str compileCmd = prb_lib_buildCmd(arena, &lib->spec, prb_BuildStep_Compile, lib->spec.flags, state->inputs[inputIndex], objPath);
+                prb_Str runCmd = remote ? prb_lib_buildCmd(arena, &lib->spec, prb_BuildStep_Compile, lib->spec.flags, state->preprocessed[inputIndex], objPath) : compileCmd;
+
+                // NOTE(khvorov) The preprocessed content is only needed for hashing
+                // and the file hashes are moved out of temp memory through the heap
+                prb_FileHash preprocessedHash = {};
+                char*        fileHashesHeap = 0;
+                {
+                    prb_TempMemory           tempContent = prb_beginTempMemory(arena);
+                    prb_ReadEntireFileResult preprocessedRead = prb_readEntireFile(arena, state->preprocessed[inputIndex]);
+                    if (preprocessedRead.success) {
+                        preprocessedHash.valid = true;
+                        preprocessedHash.hash = prb_stbds_hash_bytes(preprocessedRead.content.data, (size_t)preprocessedRead.content.len, (size_t)1);
+                        prb_Str tempFileHashes = prb_lib_fileHashes(arena, prb_strFromBytes(preprocessedRead.content));
+                        if (tempFileHashes.len > 0) {
+                            char* dest = prb_stbds_arraddnptr(fileHashesHeap, tempFileHashes.len);
+                            prb_memcpy(dest, tempFileHashes.ptr, tempFileHashes.len);
+                        }
                     }
-#elif prb_PLATFORM_LINUX
-                    if (pthread_create(&job->threadid, 0, prb_linux_threadProc, job) != 0) {
-                        result = prb_Failure;
+                    prb_endTempMemory(tempContent);
+                }
+                prb_Str fileHashes = prb_fmt(arena, "%.*s", (int)prb_stbds_arrlen(fileHashesHeap), fileHashesHeap ? fileHashesHeap : "");
+                prb_stbds_arrfree(fileHashesHeap);
+
+                if (!preprocessedHash.valid) {
+                    lib->status = prb_ProcessStatus_CompletedFailed;
+                } else {
+                    prb_RebuildReason reason = prb_RebuildReason_NotInLog;
+                    prb_Str           causes = {};
+                    bool              shouldRecompile = true;
+                    prb_InternedStr*  logEntry = prb_findInternedStr(&lib->prevLogObjs, objPath);
+                    if (logEntry) {
+                        prb_ObjInfo info = lib->prevLog[logEntry->id];
+                        if (!prb_isFile(arena, objPath)) {
+                            reason = prb_RebuildReason_OutputMissing;
+                        } else if (!sideOutputsPresent) {
+                            reason = prb_RebuildReason_SideOutputMissing;
+                        } else if (!prb_streq(compileCmd, info.compileCmd)) {
+                            reason = prb_RebuildReason_CmdChanged;
+                            causes = prb_lib_changedArgs(arena, info.compileCmd, compileCmd);
+                        } else if (extraInputsHash != info.extraInputsHash) {
+                            reason = prb_RebuildReason_ExtraInputsChanged;
+                        } else if (preprocessedHash.hash != info.preprocessedHash) {
+                            reason = prb_RebuildReason_SourceChanged;
+                            causes = prb_lib_changedFiles(arena, info.fileHashes, fileHashes);
+                        } else {
+                            shouldRecompile = false;
+                        }
+                        prb_lib_removeSideOutputs(arena, info.sideOutputs, sideOutputsStr);
                     }
-#else
-#error unimplemented
-#endif
+
+                    if (shouldRecompile) {
+                        prb_writelnToStdout(arena, runCmd);
+                        prb_Action action = {};
+                        action.cmd = runCmd;
+                        if (remote) {
+                            action.execRoot = lib->spec.objDir;
+                            action.inputs = state->preprocessed + inputIndex;
+                            action.inputsCount = 1;
+                            action.outputs = prb_arenaAllocArray(arena, prb_Str, 1 + lib->spec.sideOutputExtsCount);
+                            action.outputs[0] = objPath;
+                            prb_memcpy(action.outputs + 1, sideOutputs, lib->spec.sideOutputExtsCount * (int32_t)sizeof(prb_Str));
+                            action.outputsCount = 1 + lib->spec.sideOutputExtsCount;
+                        }
+                        prb_stbds_arrput(actions, action);
+                        prb_lib_addRecord(state, prb_BuildStep_Compile, reason, objPath, causes);
+                        state->regenLib = true;
+                    }
+
+                    prb_ObjInfo info = {compileCmd, preprocessedHash.hash, extraInputsHash, sideOutputsStr, fileHashes};
+                    prb_stbds_arrput(state->objInfos, info);
                 }
             }
-        } break;
+            state->actionsCount = prb_stbds_arrlen(actions) - state->firstAction;
+
+            // NOTE(khvorov) Remove all objs that don't correspond to any inputs
+            for (int32_t slot = 0; slot < existingObjs.slotsCount; slot++) {
+                prb_InternedStr* existingObj = existingObjs.slots[slot];
+                if (existingObj && !existingObjUsed[existingObj->id]) {
+                    prb_Str     obj = existingObj->str;
+                    const char* siblingExts[] = {"obj", "i", "ii", "pdb"};
+                    for (int32_t extIndex = 0; extIndex < prb_arrayCount(siblingExts); extIndex++) {
+                        prb_removePathIfExists(arena, prb_replaceExt(arena, obj, prb_STR(siblingExts[extIndex])));
+                    }
+                    prb_InternedStr* logEntry = prb_findInternedStr(&lib->prevLogObjs, obj);
+                    if (logEntry) {
+                        prb_lib_removeSideOutputs(arena, lib->prevLog[logEntry->id].sideOutputs, prb_STR(""));
+                    }
+                    state->regenLib = true;
+                }
+            }
+
+            if (state->actionsCount == 0) {
+                prb_writelnToStdout(arena, prb_fmt(arena, "skip compile %.*s", prb_LIT(lib->spec.name)));
+            }
+        }
+    }
+    prb_executeActions(arena, actions, prb_stbds_arrlen(actions), spec);
+    prb_lib_collectStatus(libs, libsCount, states, actions);
+    prb_stbds_arrfree(actions);
+
+    // NOTE(khvorov) Archive
+    for (int32_t libIndex = 0; libIndex < libsCount; libIndex++) {
+        prb_StaticLib* lib = libs + libIndex;
+        prb_lib_State* state = states + libIndex;
+        if (lib->status == prb_ProcessStatus_Launched) {
+            bool libMissing = !prb_isFile(arena, lib->spec.libFile);
+            if (libMissing || state->regenLib) {
+                prb_Str objsStr = prb_stringsJoin(arena, state->objs, prb_stbds_arrlen(state->objs), prb_STR(" "));
+                prb_Str libCmd = prb_lib_buildCmd(arena, &lib->spec, prb_BuildStep_Archive, prb_STR(""), objsStr, lib->spec.libFile);
+                prb_writelnToStdout(arena, libCmd);
+                prb_removePathIfExists(arena, lib->spec.libFile);
+                state->firstAction = prb_stbds_arrlen(actions);
+                state->actionsCount = 1;
+                state->firstRecord = prb_stbds_arrlen(state->records);
+                prb_Action action = {};
+                action.cmd = libCmd;
+                prb_stbds_arrput(actions, action);
+                prb_lib_addRecord(state, prb_BuildStep_Archive, libMissing ? prb_RebuildReason_OutputMissing : prb_RebuildReason_ObjsChanged, lib->spec.libFile, prb_STR(""));
+            } else {
+                prb_writelnToStdout(arena, prb_fmt(arena, "skip lib %.*s", prb_LIT(lib->spec.name)));
+            }
+        }
+    }
+    prb_executeActions(arena, actions, prb_stbds_arrlen(actions), spec);
+    prb_lib_collectStatus(libs, libsCount, states, actions);
+
+    for (int32_t libIndex = 0; libIndex < libsCount; libIndex++) {
+        prb_StaticLib* lib = libs + libIndex;
+        prb_lib_State* state = states + libIndex;
+        if (lib->status == prb_ProcessStatus_Launched) {
+            lib->status = prb_ProcessStatus_CompletedSuccess;
+            prb_lib_writeLog(arena, lib, state);
+        } else {
+            result = prb_Failure;
+        }
+        prb_stbds_arrfree(state->inputs);
+        prb_stbds_arrfree(state->preprocessed);
+        prb_stbds_arrfree(state->objs);
+        prb_stbds_arrfree(state->objInfos);
+    }
+    prb_stbds_arrfree(actions);
+
+    // NOTE(khvorov) Records and their strings were made in temp memory, move them out of it
+    prb_BuildRecord* allRecords = 0;
+    char*            recordStrs = 0;
+    for (int32_t libIndex = 0; libIndex < libsCount; libIndex++) {
+        prb_StaticLib* lib = libs + libIndex;
+        prb_lib_State* state = states + libIndex;
+        lib->recordsCount = prb_stbds_arrlen(state->records);
+        for (int32_t recordIndex = 0; recordIndex < lib->recordsCount; recordIndex++) {
+            prb_BuildRecord* record = state->records + recordIndex;
+            prb_stbds_arrput(allRecords, *record);
+            if (record->output.len + record->causes.len > 0) {
+                prb_stbds_arraddnptr(recordStrs, record->output.len + record->causes.len);
+                char* dest = recordStrs + prb_stbds_arrlen(recordStrs) - record->output.len - record->causes.len;
+                if (record->output.len > 0) {
+                    prb_memcpy(dest, record->output.ptr, record->output.len);
+                }
+                if (record->causes.len > 0) {
+                    prb_memcpy(dest + record->output.len, record->causes.ptr, record->causes.len);
+                }
+            }
+        }
+        prb_stbds_arrfree(state->records);
+    }
+    prb_endTempMemory(temp);
+
+    char* persistentStrs = (char*)prb_arenaAllocAndZero(arena, (int32_t)prb_stbds_arrlen(recordStrs), 1);
+    if (prb_stbds_arrlen(recordStrs) > 0) {
+        prb_memcpy(persistentStrs, recordStrs, (int32_t)prb_stbds_arrlen(recordStrs));
+    }
+    prb_BuildRecord* srcRecord = allRecords;
+    for (int32_t libIndex = 0; libIndex < libsCount; libIndex++) {
+        prb_StaticLib* lib = libs + libIndex;
+        lib->records = prb_arenaAllocArray(arena, prb_BuildRecord, lib->recordsCount);
+        for (int32_t recordIndex = 0; recordIndex < lib->recordsCount; recordIndex++) {
+            prb_BuildRecord* record = lib->records + recordIndex;
+            *record = *srcRecord++;
+            record->output.ptr = persistentStrs;
+            persistentStrs += record->output.len;
+            record->causes.ptr = persistentStrs;
+            persistentStrs += record->causes.len;
+        }
     }
+    prb_stbds_arrfree(allRecords);
+    prb_stbds_arrfree(recordStrs);
 
     return result;
 }
 
-prb_PUBLICDEF prb_Status
-prb_waitForJobs(prb_Job* jobs, int32_t jobsCount) {
-    prb_Status result = prb_Success;
-    for (int32_t jobIndex = 0; jobIndex < jobsCount; jobIndex++) {
-        prb_Job* job = jobs + jobIndex;
-        prb_assert(job->status != prb_JobStatus_NotLaunched);
-        if (job->status == prb_JobStatus_Launched) {
-#if prb_PLATFORM_WINDOWS
+// NOTE(khvorov) Durations aren't negative and those order the same way as their bits. Inverted so the biggest comes first.
+static uint64_t
+prb_lib_descendingKey(float durationMs) {
+    uint32_t bits = 0;
+    prb_memcpy(&bits, &durationMs, sizeof(bits));
+    uint64_t result = (uint64_t)(uint32_t)~bits;
+    return result;
+}
 
-            if (WaitForSingleObject(job->threadhandle, INFINITE) == WAIT_OBJECT_0) {
-                job->status = prb_JobStatus_Completed;
-            } else {
-                result = prb_Failure;
+prb_PUBLICDEF prb_Str
+prb_explainStaticLibs(prb_Arena* arena, prb_StaticLib* libs, int32_t libsCount, int32_t maxLines) {
+    int32_t            totalCount = 0;
+    float              totalMs = 0;
+    int32_t            reasonCounts[prb_RebuildReason_Count] = {};
+    float              reasonMs[prb_RebuildReason_Count] = {};
+    prb_StrMap         causeIndices = prb_createStrMap(arena, 0);
+    prb_lib_CostEntry* causeCosts = 0;
+    prb_BuildRecord**  slowest = 0;
+    prb_StrFindSpec    newline = {};
+    newline.pattern = prb_STR("\n");
+    newline.alwaysMatchEnd = true;
+    prb_StrFinder newlineFinder = prb_createStrFinder(newline);
+    for (int32_t libIndex = 0; libIndex < libsCount; libIndex++) {
+        prb_StaticLib* lib = libs + libIndex;
+        for (int32_t recordIndex = 0; recordIndex < lib->recordsCount; recordIndex++) {
+            prb_BuildRecord* record = lib->records + recordIndex;
+            totalCount += 1;
+            totalMs += record->durationMs;
+            reasonCounts[record->reason] += 1;
+            reasonMs[record->reason] += record->durationMs;
+
+            // NOTE(khvorov) Preprocessing is the fixed cost of every build so it's not interesting to rank
+            if (record->step != prb_BuildStep_Preprocess) {
+                prb_stbds_arrput(slowest, record);
+                prb_Str causes = record->causes.len > 0 ? record->causes : prb_STR(prb_lib_rebuildReasonNames[record->reason]);
+                prb_StrScanner scanner = prb_createStrScanner(causes);
+                while (prb_strScannerMoveWith(&scanner, &newlineFinder, prb_StrScannerSide_AfterMatch)) {
+                    if (scanner.betweenLastMatches.len > 0) {
+                        // NOTE(khvorov) Costs are in the same order as map entries
+                        int32_t causeIndex = (int32_t)(prb_strMapAdd(&causeIndices, scanner.betweenLastMatches) - causeIndices.entries);
+                        if (causeIndex == prb_stbds_arrlen(causeCosts)) {
+                            prb_lib_CostEntry entry = {};
+                            entry.key = scanner.betweenLastMatches;
+                            prb_stbds_arrput(causeCosts, entry);
+                        }
+                        causeCosts[causeIndex].count += 1;
+                        causeCosts[causeIndex].durationMs += record->durationMs;
+                    }
+                }
             }
+        }
+    }
 
-#elif prb_PLATFORM_LINUX
-
-            if (pthread_join(job->threadid, 0) == 0) {
-                job->status = prb_JobStatus_Completed;
-            } else {
-                result = prb_Failure;
-            }
+    // NOTE(khvorov) Most expensive first, ties stay in the order they were added
+    int32_t   causesCount = causeIndices.count;
+    uint64_t* causeKeys = prb_arenaAllocArray(arena, uint64_t, causesCount);
+    uint64_t* causeOrder = prb_arenaAllocArray(arena, uint64_t, causesCount);
+    for (int32_t causeIndex = 0; causeIndex < causesCount; causeIndex++) {
+        causeKeys[causeIndex] = prb_lib_descendingKey(causeCosts[causeIndex].durationMs);
+        causeOrder[causeIndex] = (uint64_t)causeIndex;
+    }
+    prb_sortU64(arena, causeKeys, causeOrder, causesCount);
+    int32_t   slowestCount = (int32_t)prb_stbds_arrlen(slowest);
+    uint64_t* slowestKeys = prb_arenaAllocArray(arena, uint64_t, slowestCount);
+    uint64_t* slowestOrder = prb_arenaAllocArray(arena, uint64_t, slowestCount);
+    for (int32_t recordIndex = 0; recordIndex < slowestCount; recordIndex++) {
+        slowestKeys[recordIndex] = prb_lib_descendingKey(slowest[recordIndex]->durationMs);
+        slowestOrder[recordIndex] = (uint64_t)recordIndex;
+    }
+    prb_sortU64(arena, slowestKeys, slowestOrder, slowestCount);
 
-#else
-#error unimplemented
-#endif
+    const char*    stepNames[] = {"preprocess", "compile", "archive"};
+    prb_GrowingStr gstr = prb_beginStr(arena);
+    prb_addStrSegment(&gstr, "%d actions took %.2fms\n", totalCount, totalMs);
+    prb_addStrSegment(&gstr, "by reason:\n");
+    for (int32_t reason = 0; reason < prb_RebuildReason_Count; reason++) {
+        if (reasonCounts[reason] > 0) {
+            prb_addStrSegment(&gstr, "  %10.2fms %5d %s\n", reasonMs[reason], reasonCounts[reason], prb_lib_rebuildReasonNames[reason]);
         }
     }
+    prb_addStrSegment(&gstr, "by cause:\n");
+    for (int32_t causeIndex = 0; causeIndex < causesCount && causeIndex < maxLines; causeIndex++) {
+        prb_lib_CostEntry entry = causeCosts[causeOrder[causeIndex]];
+        prb_addStrSegment(&gstr, "  %10.2fms %5d %.*s\n", entry.durationMs, entry.count, prb_LIT(entry.key));
+    }
+    prb_addStrSegment(&gstr, "slowest:\n");
+    for (int32_t recordIndex = 0; recordIndex < slowestCount && recordIndex < maxLines; recordIndex++) {
+        prb_BuildRecord* record = slowest[slowestOrder[recordIndex]];
+        prb_addStrSegment(&gstr, "  %10.2fms %s %.*s (%s)\n", record->durationMs, stepNames[record->step], prb_LIT(record->output), prb_lib_rebuildReasonNames[record->reason]);
+    }
+    prb_Str result = prb_endStr(&gstr);
 
+    prb_stbds_arrfree(causeCosts);
+    prb_stbds_arrfree(slowest);
     return result;
 }
 
@@ -11,49 +11,35 @@ typedef enum Compiler {
     Compiler_Msvc,
 } Compiler;
 
-typedef struct ObjInfo {
-    prb_Str  compileCmd;
-    uint64_t preprocessedHash;
-} ObjInfo;
-
-typedef struct CompileLogEntry {
-    char*   key;
-    ObjInfo value;
-} CompileLogEntry;
+typedef enum Pgo {
+    Pgo_None,
+    Pgo_Generate,
+    Pgo_Use,
+} Pgo;
 
 typedef struct ProjectInfo {
-    prb_Str        rootDir;
-    prb_Str        compileOutDir;
-    Compiler       compiler;
-    bool           release;
-    prb_Background tuCompilationMode;
+    prb_Str      rootDir;
+    prb_Str      compileOutDir;
+    Compiler     compiler;
+    bool         release;
+    bool         lto;
+    prb_Str      ltoCacheDir;
+    Pgo          pgo;
+    prb_Str      pgoDir;
+    prb_Str*     profileFiles;
+    bool         splitDwarf;
+    prb_Str      debugCompression;
+    bool         dwp;
+    bool         explain;
+    prb_ExecSpec exec;
 } ProjectInfo;
 
-typedef enum LogColumn {
-    LogColumn_ObjPath,
-    LogColumn_CompileCmd,
-    LogColumn_PreprocessedHash,
-    LogColumn_Count,
-} LogColumn;
-
 typedef struct StaticLibInfo {
-    ProjectInfo*      project;
-    prb_Str           name;
     prb_Str           downloadDir;
     prb_Str           includeDir;
     prb_Str           includeFlag;
-    prb_Str           objDir;
-    prb_Str           libFile;
-    prb_Str           compileFlags;
-    prb_Str*          sourcesRelToDownload;
-    i32               sourcesCount;
     bool              notDownloaded;
-    bool              cpp;
-    prb_ProcessStatus compileStatus;
-    CompileLogEntry*  prevCompileLog;
-    CompileLogEntry*  thisCompileLog;
-    prb_Str           logPath;
-    prb_Str           logColumnNames[LogColumn_Count];
+    prb_StaticLibSpec spec;
 } StaticLibInfo;
 
 typedef enum Lang {
@@ -61,137 +47,14 @@ typedef enum Lang {
     Lang_Cpp,
 } Lang;
 
-typedef struct GetStrInQuotesResult {
-    bool    success;
-    prb_Str inquotes;
-    prb_Str past;
-} GetStrInQuotesResult;
-
-function GetStrInQuotesResult
-getStrInQuotes(prb_Str str) {
-    GetStrInQuotesResult result = {};
-    prb_StrFindSpec      quoteFindSpec = {.pattern = prb_STR("\"")};
-    prb_StrScanner       scanner = prb_createStrScanner(str);
-    if (prb_strScannerMove(&scanner, quoteFindSpec, prb_StrScannerSide_AfterMatch)) {
-        if (prb_strScannerMove(&scanner, quoteFindSpec, prb_StrScannerSide_AfterMatch)) {
-            result.success = true;
-            result.inquotes = scanner.betweenLastMatches;
-            result.past = scanner.afterMatch;
-        }
-    }
-    return result;
-}
-
-typedef struct String3 {
-    bool    success;
-    prb_Str strings[3];
-} String3;
-
-function String3
-get3StrInQuotes(prb_Str str) {
-    String3 result = {.success = true};
-    for (i32 index = 0; index < prb_arrayCount(result.strings) && result.success; index++) {
-        GetStrInQuotesResult get1 = getStrInQuotes(str);
-        if (get1.success) {
-            result.strings[index] = get1.inquotes;
-            str = get1.past;
-        } else {
-            result.success = false;
-        }
-    }
-    return result;
-}
-
-typedef struct ParseLogResult {
-    CompileLogEntry* log;
-    bool             success;
-} ParseLogResult;
-
-function ParseLogResult
-parseLog(prb_Arena* arena, prb_Str str, prb_Str* columnNames) {
-    prb_unused(str);
-    ParseLogResult  result = {};
-    prb_StrScanner  lineIter = prb_createStrScanner(str);
-    prb_StrFindSpec lineBreakSpec = {.mode = prb_StrFindMode_LineBreak};
-    if (prb_strScannerMove(&lineIter, lineBreakSpec, prb_StrScannerSide_AfterMatch) == prb_Success) {
-        String3 headers = get3StrInQuotes(lineIter.betweenLastMatches);
-        if (headers.success) {
-            bool expectedHeaders = prb_streq(headers.strings[LogColumn_ObjPath], columnNames[LogColumn_ObjPath])
-                && prb_streq(headers.strings[LogColumn_CompileCmd], columnNames[LogColumn_CompileCmd])
-                && prb_streq(headers.strings[LogColumn_PreprocessedHash], columnNames[LogColumn_PreprocessedHash]);
-            if (expectedHeaders) {
-                result.success = true;
-                while (prb_strScannerMove(&lineIter, lineBreakSpec, prb_StrScannerSide_AfterMatch) && result.success) {
-                    String3 row = get3StrInQuotes(lineIter.betweenLastMatches);
-                    if (row.success) {
-                        prb_ParsedNumber hashResult = prb_parseNumber(row.strings[LogColumn_PreprocessedHash]);
-                        if (hashResult.kind == prb_ParsedNumberKind_U64) {
-                            ObjInfo info = {row.strings[LogColumn_CompileCmd], hashResult.parsedU64};
-                            shput(result.log, prb_strGetNullTerminated(arena, row.strings[LogColumn_ObjPath]), info);
-                        }
-                    } else {
-                        result.success = false;
-                    }
-                }
-            }
-        }
-    }
-    return result;
-}
-
-function StaticLibInfo
-getStaticLibInfo(
-    prb_Arena*   arena,
-    ProjectInfo* project,
-    prb_Str      name,
-    Lang         lang,
-    prb_Str      includeDirRelToDownload,
-    prb_Str      compileFlags,
-    prb_Str*     sourcesRelToDownload,
-    i32          sourcesCount
-) {
-    StaticLibInfo result = {
-        .project = project,
-        .name = name,
-        .cpp = lang == Lang_Cpp,
-        .downloadDir = prb_pathJoin(arena, project->rootDir, name),
-        .objDir = prb_pathJoin(arena, project->compileOutDir, name),
-        .sourcesRelToDownload = sourcesRelToDownload,
-        .sourcesCount = sourcesCount,
-    };
-    result.includeDir = prb_pathJoin(arena, result.downloadDir, includeDirRelToDownload);
-    result.includeFlag = prb_fmt(arena, "-I%.*s", prb_LIT(result.includeDir));
-    result.compileFlags = prb_fmt(arena, "%.*s %.*s", prb_LIT(compileFlags), prb_LIT(result.includeFlag));
-
-#if prb_PLATFORM_WINDOWS
-    prb_Str libFilename = prb_fmt(arena, "%.*s.lib", prb_LIT(name));
-#elif prb_PLATFORM_LINUX
-    prb_Str libFilename = prb_fmt(arena, "%.*s.a", prb_LIT(name));
-#else
-#error unimplemented
-#endif
-
-    result.libFile = prb_pathJoin(arena, project->compileOutDir, libFilename);
-    result.notDownloaded = !prb_isDir(arena, result.downloadDir) || prb_dirIsEmpty(arena, result.downloadDir);
-
-    // NOTE(khvorov) Log file from previous compilation
-    result.logColumnNames[LogColumn_ObjPath] = prb_STR("objPath");
-    result.logColumnNames[LogColumn_CompileCmd] = prb_STR("compileCmd");
-    result.logColumnNames[LogColumn_PreprocessedHash] = prb_STR("preprocessedHash");
-    result.logPath = prb_pathJoin(arena, project->compileOutDir, prb_fmt(arena, "%.*s-log.csv", prb_LIT(name)));
-    {
-        prb_ReadEntireFileResult prevLogRead = prb_readEntireFile(arena, result.logPath);
-        if (prevLogRead.success) {
-            prb_Str        prevLog = (prb_Str) {(const char*)prevLogRead.content.data, prevLogRead.content.len};
-            ParseLogResult prevLogParsed = parseLog(arena, prevLog, result.logColumnNames);
-            if (prevLogParsed.success) {
-                result.prevCompileLog = prevLogParsed.log;
-            }
-        }
-    }
-
-    return result;
-}
+typedef struct Deps {
+    prb_Str       fribidiHeaderFlags;
+    StaticLibInfo fribidi;
+    StaticLibInfo icu;
+    StaticLibInfo freetype;
+    StaticLibInfo harfbuzz;
+    StaticLibInfo sdl;
+} Deps;
 
 function prb_Process
 gitClone(prb_Arena* arena, StaticLibInfo lib, prb_Str downloadUrl) {
@@ -221,6 +84,48 @@ execCmd(prb_Arena* arena, prb_Str cmd) {
     return status;
 }
 
+// NOTE(khvorov) LTO needs tools that don't always come with the compiler (lld and llvm-ar for clang,
+// gcc-ar for gcc), without them release builds use the regular non-LTO commands
+function bool
+ltoToolsPresent(prb_Arena* arena, ProjectInfo* project) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+    prb_Str*       probes = 0;
+    switch (project->compiler) {
+        case Compiler_Msvc: break;
+#if prb_PLATFORM_WINDOWS
+        case Compiler_Gcc: break;
+        case Compiler_Clang: arrput(probes, prb_STR("lld-link --version")); break;
+#elif prb_PLATFORM_LINUX
+        case Compiler_Gcc: arrput(probes, prb_STR("gcc-ar --version")); break;
+        case Compiler_Clang: {
+            arrput(probes, prb_STR("ld.lld --version"));
+            arrput(probes, prb_STR("llvm-ar --version"));
+        } break;
+#else
+#error unimplemented
+#endif
+    }
+
+    bool            result = true;
+    prb_Str         probeOutput = prb_pathJoin(arena, project->compileOutDir, prb_STR("lto-probe.txt"));
+    prb_ProcessSpec spec = {};
+    spec.redirectStdout = true;
+    spec.stdoutFilepath = probeOutput;
+    spec.redirectStderr = true;
+    spec.stderrFilepath = probeOutput;
+    for (i32 probeIndex = 0; probeIndex < arrlen(probes) && result; probeIndex++) {
+        prb_Process proc = prb_createProcess(probes[probeIndex], spec);
+        if (prb_launchProcesses(arena, &proc, 1, prb_Background_No) == prb_Failure) {
+            prb_writelnToStdout(arena, prb_fmt(arena, "%.*s failed, building without LTO", prb_LIT(probes[probeIndex])));
+            result = false;
+        }
+    }
+    prb_removePathIfExists(arena, probeOutput);
+    arrfree(probes);
+    prb_endTempMemory(temp);
+    return result;
+}
+
 function prb_Status
 gitReset(prb_Arena* arena, StaticLibInfo lib, prb_Str commit) {
     prb_TempMemory temp = prb_beginTempMemory(arena);
@@ -245,7 +150,9 @@ function prb_Str
 constructCompileCmd(prb_Arena* arena, ProjectInfo* project, prb_Str flags, prb_Str inputPath, prb_Str outputPath, prb_Str linkFlags) {
     prb_Str pdbPath = prb_replaceExt(arena, outputPath, prb_STR("pdb"));
     prb_unused(pdbPath);  // NOTE(khvorov) MSVC only
-    prb_Str outputDir = prb_getParentDir(arena, outputPath);
+    prb_Str            outputDir = prb_getParentDir(arena, outputPath);
+    prb_Str            profdataPath = prb_pathJoin(arena, project->pgoDir, prb_STR("example.profdata"));
+    prb_StrSplitResult linkFlagsSplit = prb_strSplit(arena, linkFlags, prb_STR(" "), prb_StrSplitFlag_SkipEmpty);
 
     prb_GrowingStr cmd = prb_beginStr(arena);
 
@@ -255,6 +162,9 @@ constructCompileCmd(prb_Arena* arena, ProjectInfo* project, prb_Str flags, prb_S
         case Compiler_Msvc: prb_addStrSegment(&cmd, "cl /nologo /diagnostics:column /FC /utf-8"); break;
     }
 
+    bool inIsPreprocessed = fileIsPreprocessed(inputPath);
+    bool outIsPreprocess = fileIsPreprocessed(outputPath);
+
     if (project->release) {
         switch (project->compiler) {
             case Compiler_Gcc:
@@ -267,10 +177,42 @@ constructCompileCmd(prb_Arena* arena, ProjectInfo* project, prb_Str flags, prb_S
             case Compiler_Clang: prb_addStrSegment(&cmd, " -g"); break;
             case Compiler_Msvc: prb_addStrSegment(&cmd, " /Zi"); break;
         }
+
+        // NOTE(khvorov) Split DWARF leaves a skeleton in the object and puts the rest in a .dwo next to it,
+        // so archives and the linker don't have to move most of the debug info around
+        if (project->splitDwarf && !outIsPreprocess) {
+            prb_addStrSegment(&cmd, " -gsplit-dwarf");
+        }
+        if (project->debugCompression.len > 0 && !outIsPreprocess) {
+            prb_addStrSegment(&cmd, " -gz=%.*s", prb_LIT(project->debugCompression));
+        }
+    }
+
+    // NOTE(khvorov) With LTO objects contain IR and codegen happens at link time across all the libraries
+    if (project->lto && !outIsPreprocess) {
+        switch (project->compiler) {
+            case Compiler_Gcc: prb_addStrSegment(&cmd, " -flto=auto"); break;
+            case Compiler_Clang: prb_addStrSegment(&cmd, " -flto=thin"); break;
+            case Compiler_Msvc: prb_addStrSegment(&cmd, " /GL"); break;
+        }
+    }
+
+    // NOTE(khvorov) Gcc names its profiles after the objects so both PGO steps need to use the same object paths
+    if (project->pgo == Pgo_Generate && !outIsPreprocess) {
+        switch (project->compiler) {
+            case Compiler_Gcc: prb_addStrSegment(&cmd, " -fprofile-generate=%.*s", prb_LIT(project->pgoDir)); break;
+            case Compiler_Clang: prb_addStrSegment(&cmd, " -fprofile-instr-generate=%.*s/%%p.profraw", prb_LIT(project->pgoDir)); break;
+            case Compiler_Msvc: prb_assert(!"pgo not supported for msvc"); break;
+        }
+    } else if (project->pgo == Pgo_Use && !outIsPreprocess) {
+        // NOTE(khvorov) Code that changed since training just gets less optimization, it's not an error
+        switch (project->compiler) {
+            case Compiler_Gcc: prb_addStrSegment(&cmd, " -fprofile-use=%.*s -fprofile-partial-training -Wno-missing-profile -Wno-error=coverage-mismatch", prb_LIT(project->pgoDir)); break;
+            case Compiler_Clang: prb_addStrSegment(&cmd, " -fprofile-instr-use=%.*s -Wno-profile-instr-out-of-date -Wno-profile-instr-unprofiled", prb_LIT(profdataPath)); break;
+            case Compiler_Msvc: prb_assert(!"pgo not supported for msvc"); break;
+        }
     }
 
-    bool inIsPreprocessed = fileIsPreprocessed(inputPath);
-    bool outIsPreprocess = fileIsPreprocessed(outputPath);
     if (outIsPreprocess) {
         prb_assert(!inIsPreprocessed);
         switch (project->compiler) {
@@ -328,6 +270,20 @@ constructCompileCmd(prb_Arena* arena, ProjectInfo* project, prb_Str flags, prb_S
     }
 #endif
 
+    // NOTE(khvorov) The ThinLTO cache keeps codegen results for modules whose IR (and imports) didn't change
+    // so relinking after a small change doesn't redo the whole program
+    if (project->lto && !isObj && !outIsPreprocess) {
+        switch (project->compiler) {
+            case Compiler_Gcc: break;
+#if prb_PLATFORM_WINDOWS
+            case Compiler_Clang: prb_addStrSegment(&cmd, " -Xlinker /lldltocache:%.*s", prb_LIT(project->ltoCacheDir)); break;
+#elif prb_PLATFORM_LINUX
+            case Compiler_Clang: prb_addStrSegment(&cmd, " -fuse-ld=lld -Wl,--thinlto-cache-dir=%.*s", prb_LIT(project->ltoCacheDir)); break;
+#endif
+            case Compiler_Msvc: prb_addStrSegment(&cmd, " /LTCG"); break;
+        }
+    }
+
     if (linkFlags.ptr && linkFlags.len > 0) {
         prb_Str prefix = prb_STR("");
 #if prb_PLATFORM_WINDOWS
@@ -335,12 +291,8 @@ constructCompileCmd(prb_Arena* arena, ProjectInfo* project, prb_Str flags, prb_S
             prefix = prb_STR("-Xlinker ");
         }
 #endif
-        prb_StrScanner  scanner = prb_createStrScanner(linkFlags);
-        prb_StrFindSpec space = {.pattern = prb_STR(" "), .alwaysMatchEnd = true};
-        while (prb_strScannerMove(&scanner, space, prb_StrScannerSide_AfterMatch)) {
-            if (scanner.betweenLastMatches.len > 0) {
-                prb_addStrSegment(&cmd, " %.*s%.*s", prb_LIT(prefix), prb_LIT(scanner.betweenLastMatches));
-            }
+        for (i32 flagIndex = 0; flagIndex < linkFlagsSplit.count; flagIndex++) {
+            prb_addStrSegment(&cmd, " %.*s%.*s", prb_LIT(prefix), prb_LIT(linkFlagsSplit.tokens[flagIndex]));
         }
     }
 
@@ -348,240 +300,90 @@ constructCompileCmd(prb_Arena* arena, ProjectInfo* project, prb_Str flags, prb_S
     return cmdStr;
 }
 
-typedef struct StringFound {
-    char* key;
-    bool  value;
-} StringFound;
-
 function prb_Str
-strMallocCopy(prb_Str str) {
-    prb_Str copy = {};
-    copy.len = str.len;
-    copy.ptr = (const char*)prb_malloc(str.len + 1);
-    prb_memcpy((char*)copy.ptr, str.ptr, str.len);
-    ((char*)copy.ptr)[copy.len] = '\0';
-    return copy;
-}
-
-function void
-addLogRow(prb_GrowingStr* gstr, prb_Str* strings) {
-    for (i32 colIndex = 0; colIndex < LogColumn_Count; colIndex++) {
-        prb_addStrSegment(gstr, "\"%.*s\"", prb_LIT(strings[colIndex]));
-        if (colIndex == LogColumn_Count - 1) {
-            prb_addStrSegment(gstr, "\n");
-        } else {
-            prb_addStrSegment(gstr, ",");
-        }
-    }
-}
-
-function void
-writeLog(prb_Arena* arena, CompileLogEntry* log, prb_Str path, prb_Str* columnNames) {
-    prb_TempMemory temp = prb_beginTempMemory(arena);
-    prb_Arena      numberFmtArena = prb_createArenaFromArena(arena, 100);
-    prb_GrowingStr gstr = prb_beginStr(arena);
-    addLogRow(&gstr, columnNames);
-    for (i32 entryIndex = 0; entryIndex < shlen(log); entryIndex++) {
-        CompileLogEntry entry = log[entryIndex];
-        prb_TempMemory  tempNumber = prb_beginTempMemory(&numberFmtArena);
-
-        prb_Str strings[] = {
-            [LogColumn_ObjPath] = prb_STR(entry.key),
-            [LogColumn_CompileCmd] = entry.value.compileCmd,
-            [LogColumn_PreprocessedHash] = prb_fmt(&numberFmtArena, "0x%llX", (unsigned long long)entry.value.preprocessedHash),
-        };
-        addLogRow(&gstr, strings);
-        prb_endTempMemory(tempNumber);
-    }
-    prb_Str str = prb_endStr(&gstr);
-    prb_assert(prb_writeEntireFile(arena, path, str.ptr, str.len) == prb_Success);
-    prb_endTempMemory(temp);
-}
-
-function void
-compileStaticLib(prb_Arena* arena, void* staticLibInfo) {
-    prb_TimeStart  compileStart = prb_timeStart();
-    StaticLibInfo* lib = (StaticLibInfo*)staticLibInfo;
-    prb_TempMemory temp = prb_beginTempMemory(arena);
-    prb_assert(lib->compileStatus == prb_ProcessStatus_NotLaunched);
-    lib->compileStatus = prb_ProcessStatus_Launched;
-
-    prb_assert(prb_createDirIfNotExists(arena, lib->objDir) == prb_Success);
-
-    prb_Str* inputPaths = 0;
-    for (i32 srcIndex = 0; srcIndex < lib->sourcesCount; srcIndex++) {
-        prb_Str srcRelToDownload = lib->sourcesRelToDownload[srcIndex];
-        if (prb_strEndsWith(srcRelToDownload, prb_STR("/*.c"))) {
-            prb_Str relevantDir = prb_pathJoin(arena, lib->downloadDir, srcRelToDownload);
-            relevantDir.len -= 4;
-            prb_Str* entries = prb_getAllDirEntries(arena, relevantDir, prb_Recursive_No);
-            bool     atleastone = false;
-            for (i32 entryIndex = 0; entryIndex < arrlen(entries); entryIndex++) {
-                prb_Str entry = entries[entryIndex];
-                if (prb_strEndsWith(entry, prb_STR(".c"))) {
-                    arrput(inputPaths, entry);
-                    atleastone = true;
-                }
-            }
-            if (!atleastone) {
-                prb_writeToStdout(prb_fmt(arena, "src pattern no files: %.*s\n", prb_LIT(srcRelToDownload)));
-                prb_assert(!"src pattern corresponds to no files");
-            }
-        } else {
-            prb_Str path = prb_pathJoin(arena, lib->downloadDir, srcRelToDownload);
-            if (!prb_isFile(arena, path)) {
-                prb_writeToStdout(prb_fmt(arena, "src file not found: %.*s\n", prb_LIT(srcRelToDownload)));
-                prb_assert(!"src file not found");
+buildCmd(prb_Arena* arena, void* data, prb_BuildStep step, prb_Str flags, prb_Str input, prb_Str output) {
+    ProjectInfo* project = (ProjectInfo*)data;
+    prb_Str      result = {};
+    switch (step) {
+        case prb_BuildStep_Preprocess:
+        case prb_BuildStep_Compile: result = constructCompileCmd(arena, project, flags, input, output, prb_STR("")); break;
+        case prb_BuildStep_Archive: {
+#if prb_PLATFORM_WINDOWS
+            prb_Str libProg = prb_STR("lib");
+            if (project->compiler == Compiler_Clang) {
+                libProg = prb_STR("llvm-lib");
+            } else if (project->lto) {
+                libProg = prb_STR("lib /LTCG");
             }
-            arrput(inputPaths, path);
-        }
-    }
-    prb_assert(arrlen(inputPaths) > 0);
-
-    StringFound* existingObjs = 0;
-    {
-        prb_Str* entries = prb_getAllDirEntries(arena, lib->objDir, prb_Recursive_No);
-        for (i32 entryIndex = 0; entryIndex < arrlen(entries); entryIndex++) {
-            prb_Str entry = entries[entryIndex];
-            if (prb_strEndsWith(entry, prb_STR(".obj"))) {
-                shput(existingObjs, entry.ptr, false);
+            result = prb_fmt(arena, "%.*s /nologo -out:%.*s %.*s", prb_LIT(libProg), prb_LIT(output), prb_LIT(input));
+#elif prb_PLATFORM_LINUX
+            // NOTE(khvorov) Plain ar can't build a symbol index for IR objects
+            prb_Str arProg = prb_STR("ar");
+            if (project->lto) {
+                arProg = project->compiler == Compiler_Clang ? prb_STR("llvm-ar") : prb_STR("gcc-ar");
             }
-        }
-    }
-
-    // NOTE(khvorov) Preprocess
-    prb_Str      preprocessExt = lib->cpp ? prb_STR("ii") : prb_STR("i");
-    prb_Str*     outputPreprocess = 0;
-    prb_Process* processesPreprocess = 0;
-    for (i32 inputPathIndex = 0; inputPathIndex < arrlen(inputPaths); inputPathIndex++) {
-        prb_Str inputFilepath = inputPaths[inputPathIndex];
-        prb_Str inputFilename = prb_getLastEntryInPath(inputFilepath);
-
-        prb_Str outputPreprocessFilename = prb_replaceExt(arena, inputFilename, preprocessExt);
-        prb_Str outputPreprocessFilepath = prb_pathJoin(arena, lib->objDir, outputPreprocessFilename);
-        arrput(outputPreprocess, outputPreprocessFilepath);
-
-        prb_Str     cmd = constructCompileCmd(arena, lib->project, lib->compileFlags, inputFilepath, outputPreprocessFilepath, prb_STR(""));
-        prb_Process proc = prb_createProcess(cmd, (prb_ProcessSpec) {});
-        arrput(processesPreprocess, proc);
+            result = prb_fmt(arena, "%.*s rcs %.*s %.*s", prb_LIT(arProg), prb_LIT(output), prb_LIT(input));
+#else
+#error unimplemented
+#endif
+        } break;
     }
+    return result;
+}
 
-    prb_assert(prb_launchProcesses(arena, processesPreprocess, arrlen(processesPreprocess), lib->project->tuCompilationMode));
-    prb_Status preprocessStatus = prb_waitForProcesses(processesPreprocess, arrlen(processesPreprocess));
-    arrfree(processesPreprocess);
-
-    // NOTE(khvorov) Compile
-    if (preprocessStatus == prb_Success) {
-        prb_Str*     outputObjs = 0;
-        prb_Process* processesCompile = 0;
-        for (i32 inputPathIndex = 0; inputPathIndex < arrlen(inputPaths); inputPathIndex++) {
-            prb_Str inputNotPreprocessedFilepath = inputPaths[inputPathIndex];
-            prb_Str inputNotPreprocessedFilename = prb_getLastEntryInPath(inputNotPreprocessedFilepath);
-
-            prb_Str outputObjFilename = prb_replaceExt(arena, inputNotPreprocessedFilename, prb_STR("obj"));
-            prb_Str outputObjFilepath = prb_pathJoin(arena, lib->objDir, outputObjFilename);
-            arrput(outputObjs, outputObjFilepath);
-            if (shgeti(existingObjs, (char*)outputObjFilepath.ptr) != -1) {
-                shput(existingObjs, (char*)outputObjFilepath.ptr, true);
-            }
-
-            // NOTE(khvorov) Using not preprocessed input.
-            // I found that giving the compiler preprocessed file generates less useful warnings.
-            prb_Str compileCmd = constructCompileCmd(arena, lib->project, lib->compileFlags, inputNotPreprocessedFilepath, outputObjFilepath, prb_STR(""));
-
-            // NOTE(khvorov) Figure out if we should recompile this file
-            bool         shouldRecompile = true;
-            prb_FileHash preprocessedHash = prb_getFileHash(arena, outputPreprocess[inputPathIndex]);
-            prb_assert(preprocessedHash.valid);
-            if (lib->prevCompileLog != 0 && prb_isFile(arena, outputObjFilepath)) {
-                int32_t logEntryIndex = shgeti(lib->prevCompileLog, outputObjFilepath.ptr);
-                if (logEntryIndex != -1) {
-                    ObjInfo info = lib->prevCompileLog[logEntryIndex].value;
-                    if (preprocessedHash.hash == info.preprocessedHash) {
-                        if (prb_streq(compileCmd, info.compileCmd)) {
-                            shouldRecompile = false;
-                        }
-                    }
-                }
-            }
-
-            if (shouldRecompile) {
-                prb_writelnToStdout(arena, compileCmd);
-                prb_Process process = prb_createProcess(compileCmd, (prb_ProcessSpec) {});
-                arrput(processesCompile, process);
-            }
-
-            // NOTE(khvorov) Update compile log
-            {
-                prb_Str outputObjFilepathCopy = strMallocCopy(outputObjFilepath);
-                prb_Str compileCmdCopy = strMallocCopy(compileCmd);
-                ObjInfo thisObjInfo = {compileCmdCopy, preprocessedHash.hash};
-                shput(lib->thisCompileLog, outputObjFilepathCopy.ptr, thisObjInfo);
-            }
-        }
-
-        // NOTE(khvorov) Remove all objs that don't correspond to any inputs
-        bool shouldRegenLib = false;
-        for (i32 existingObjIndex = 0; existingObjIndex < shlen(existingObjs); existingObjIndex++) {
-            StringFound existingObj = existingObjs[existingObjIndex];
-            if (!existingObj.value) {
-                prb_assert(prb_removePathIfExists(arena, prb_STR(existingObj.key)) == prb_Success);
-                prb_assert(prb_removePathIfExists(arena, prb_replaceExt(arena, prb_STR(existingObj.key), prb_STR("i"))) == prb_Success);
-                prb_assert(prb_removePathIfExists(arena, prb_replaceExt(arena, prb_STR(existingObj.key), prb_STR("ii"))) == prb_Success);
-                prb_assert(prb_removePathIfExists(arena, prb_replaceExt(arena, prb_STR(existingObj.key), prb_STR("pdb"))) == prb_Success);
-                shouldRegenLib = true;
-            }
-        }
-
-        if (arrlen(processesCompile) == 0) {
-            prb_writelnToStdout(arena, prb_fmt(arena, "skip compile %.*s", prb_LIT(lib->name)));
-        } else {
-            shouldRegenLib = true;
-        }
-
-        prb_assert(prb_launchProcesses(arena, processesCompile, arrlen(processesCompile), lib->project->tuCompilationMode));
-        prb_Status compileStatus = prb_waitForProcesses(processesCompile, arrlen(processesCompile));
-        arrfree(processesCompile);
+function StaticLibInfo
+getStaticLibInfo(
+    prb_Arena*   arena,
+    ProjectInfo* project,
+    prb_Str      name,
+    Lang         lang,
+    prb_Str      includeDirRelToDownload,
+    prb_Str      compileFlags,
+    prb_Str*     sourcesRelToDownload,
+    i32          sourcesCount
+) {
+    StaticLibInfo result = {};
+    result.downloadDir = prb_pathJoin(arena, project->rootDir, name);
+    result.includeDir = prb_pathJoin(arena, result.downloadDir, includeDirRelToDownload);
+    result.includeFlag = prb_fmt(arena, "-I%.*s", prb_LIT(result.includeDir));
+    result.notDownloaded = !prb_isDir(arena, result.downloadDir) || prb_dirIsEmpty(arena, result.downloadDir);
 
-        if (compileStatus == prb_Success) {
-            prb_Status libStatus = prb_Success;
-            if (!prb_isFile(arena, lib->libFile) || shouldRegenLib) {
-                prb_Str objsPathsString = prb_stringsJoin(arena, outputObjs, arrlen(outputObjs), prb_STR(" "));
 #if prb_PLATFORM_WINDOWS
-                prb_Str libProg = prb_STR("lib");
-                if (lib->project->compiler == Compiler_Clang) {
-                    libProg = prb_STR("llvm-lib");
-                }
-                prb_Str libCmd = prb_fmt(arena, "%.*s /nologo -out:%.*s %.*s", prb_LIT(libProg), prb_LIT(lib->libFile), prb_LIT(objsPathsString));
+    prb_Str libFilename = prb_fmt(arena, "%.*s.lib", prb_LIT(name));
 #elif prb_PLATFORM_LINUX
-                prb_Str libCmd = prb_fmt(arena, "ar rcs %.*s %.*s", prb_LIT(lib->libFile), prb_LIT(objsPathsString));
+    prb_Str libFilename = prb_fmt(arena, "%.*s.a", prb_LIT(name));
+#else
+#error unimplemented
 #endif
-                prb_assert(prb_removePathIfExists(arena, lib->libFile) == prb_Success);
-                libStatus = execCmd(arena, libCmd);
-            } else {
-                prb_Str msg = prb_fmt(arena, "skip lib %.*s", prb_LIT(lib->name));
-                prb_writelnToStdout(arena, msg);
-            }
 
-            if (libStatus == prb_Success) {
-                lib->compileStatus = prb_ProcessStatus_CompletedSuccess;
-            }
-        }
-
-        arrfree(outputObjs);
+    prb_Str* sideOutputExts = 0;
+    if (project->splitDwarf) {
+        sideOutputExts = prb_arenaAllocArray(arena, prb_Str, 1);
+        sideOutputExts[0] = prb_STR("dwo");
     }
 
-    if (lib->compileStatus != prb_ProcessStatus_CompletedSuccess) {
-        lib->compileStatus = prb_ProcessStatus_CompletedFailed;
-    } else {
-        writeLog(arena, lib->thisCompileLog, lib->logPath, lib->logColumnNames);
-    }
-    arrfree(inputPaths);
-    shfree(existingObjs);
-    arrfree(outputPreprocess);
+    // NOTE(khvorov) The source lists are on the caller's stack
+    prb_Str* sources = prb_arenaAllocArray(arena, prb_Str, sourcesCount);
+    prb_memcpy(sources, sourcesRelToDownload, sourcesCount * (i32)sizeof(prb_Str));
 
-    prb_writelnToStdout(arena, prb_fmt(arena, "%.*s compile step: %.2fms", prb_LIT(lib->name), prb_getMsFrom(compileStart)));
-    prb_endTempMemory(temp);
+    result.spec = (prb_StaticLibSpec) {
+        .name = name,
+        .srcDir = result.downloadDir,
+        .sources = sources,
+        .sourcesCount = sourcesCount,
+        .flags = prb_fmt(arena, "%.*s %.*s", prb_LIT(compileFlags), prb_LIT(result.includeFlag)),
+        .objDir = prb_pathJoin(arena, project->compileOutDir, name),
+        .libFile = prb_pathJoin(arena, project->compileOutDir, libFilename),
+        .sideOutputExts = sideOutputExts,
+        .sideOutputExtsCount = project->splitDwarf ? 1 : 0,
+        .extraInputs = project->profileFiles,
+        .extraInputsCount = arrlen(project->profileFiles),
+        .cpp = lang == Lang_Cpp,
+        .buildCmd = buildCmd,
+        .buildCmdData = project,
+    };
+
+    return result;
 }
 
 function void
@@ -614,43 +416,8 @@ textfileReplace(prb_Arena* arena, prb_Str path, prb_Str pattern, prb_Str replace
     prb_assert(prb_writeEntireFile(arena, path, newContent.ptr, newContent.len) == prb_Success);
 }
 
-int
-main() {
-    prb_TimeStart scriptStartTime = prb_timeStart();
-    prb_Arena     arena_ = prb_createArenaFromVmem(1 * prb_GIGABYTE);
-    prb_Arena*    arena = &arena_;
-    ProjectInfo   project_ = {};
-    ProjectInfo*  project = &project_;
-
-    prb_Str* cmdArgs = prb_getCmdArgs(arena);
-    prb_assert(arrlen(cmdArgs) == 3 || arrlen(cmdArgs) == 4);
-    prb_Str compilerStr = cmdArgs[1];
-    prb_Str buildTypeStr = cmdArgs[2];
-    bool    runningOnCi = arrlen(cmdArgs) == 4 && prb_streq(cmdArgs[3], prb_STR("ci"));
-    prb_assert(prb_streq(buildTypeStr, prb_STR("debug")) || prb_streq(buildTypeStr, prb_STR("release")));
-
-    project->rootDir = prb_getParentDir(arena, prb_STR(__FILE__));
-    project->release = prb_streq(buildTypeStr, prb_STR("release"));
-    project->compileOutDir = prb_pathJoin(arena, project->rootDir, prb_fmt(arena, "build-%.*s-%.*s", prb_LIT(compilerStr), prb_LIT(buildTypeStr)));
-    prb_assert(prb_createDirIfNotExists(arena, project->compileOutDir) == prb_Success);
-
-#if prb_PLATFORM_WINDOWS
-    prb_assert(prb_streq(compilerStr, prb_STR("msvc")) || prb_streq(compilerStr, prb_STR("clang")));
-    project->compiler = prb_streq(compilerStr, prb_STR("msvc")) ? Compiler_Msvc : Compiler_Clang;
-#elif prb_PLATFORM_LINUX
-    prb_assert(prb_streq(compilerStr, prb_STR("gcc")) || prb_streq(compilerStr, prb_STR("clang")));
-    project->compiler = prb_streq(compilerStr, prb_STR("gcc")) ? Compiler_Gcc : Compiler_Clang;
-#else
-#error unimlemented
-#endif
-
-    project->tuCompilationMode = prb_Background_Yes;
-
-    // NOTE(khvorov) MSVC runs out of memory on CI (lol wtf microsoft)
-    if (runningOnCi && project->compiler == Compiler_Msvc) {
-        project->tuCompilationMode = prb_Background_No;
-    }
-
+function Deps
+getDeps(prb_Arena* arena, ProjectInfo* project) {
     //
     // SECTION Setup
     //
@@ -904,7 +671,7 @@ main() {
     );
 
     // NOTE(khvorov) Freetype and harfbuzz depend on each other
-    freetype.compileFlags = prb_fmt(arena, "%.*s %.*s", prb_LIT(freetype.compileFlags), prb_LIT(harfbuzz.includeFlag));
+    freetype.spec.flags = prb_fmt(arena, "%.*s %.*s", prb_LIT(freetype.spec.flags), prb_LIT(harfbuzz.includeFlag));
 
     // NOTE(khvorov) SDL
 
@@ -993,6 +760,38 @@ main() {
         prb_arrayCount(sdlCompileSources)
     );
 
+    Deps result = {};
+    result.fribidiHeaderFlags = fribidiHeaderFlags;
+    result.fribidi = fribidi;
+    result.icu = icu;
+    result.freetype = freetype;
+    result.harfbuzz = harfbuzz;
+    result.sdl = sdl;
+    return result;
+}
+
+// NOTE(khvorov) Download directories are shared between all configurations so this runs once for all of them.
+// The generated fribidi tables are plain data so it doesn't matter which configuration's compiler makes them
+function void
+prepareDeps(prb_Arena* arena, ProjectInfo* projects, Deps* allDeps, i32 projectsCount) {
+    for (i32 projectIndex = 1; projectIndex < projectsCount; projectIndex++) {
+        Deps* other = allDeps + projectIndex;
+        prb_assert(prb_streq(other->fribidi.downloadDir, allDeps->fribidi.downloadDir));
+        prb_assert(prb_streq(other->icu.downloadDir, allDeps->icu.downloadDir));
+        prb_assert(prb_streq(other->freetype.downloadDir, allDeps->freetype.downloadDir));
+        prb_assert(prb_streq(other->harfbuzz.downloadDir, allDeps->harfbuzz.downloadDir));
+        prb_assert(prb_streq(other->sdl.downloadDir, allDeps->sdl.downloadDir));
+    }
+
+    ProjectInfo*  project = projects;
+    Deps*         deps = allDeps;
+    prb_Str       fribidiHeaderFlags = deps->fribidiHeaderFlags;
+    StaticLibInfo fribidi = deps->fribidi;
+    StaticLibInfo icu = deps->icu;
+    StaticLibInfo freetype = deps->freetype;
+    StaticLibInfo harfbuzz = deps->harfbuzz;
+    StaticLibInfo sdl = deps->sdl;
+
     //
     // SECTION Download
     //
@@ -1161,6 +960,41 @@ main() {
             prb_STR("#include \"SDL_config_minimal.h\"")
         );
     }
+}
+
+function void
+runMainActions(prb_Arena* arena, prb_Action* actions, prb_ExecSpec exec) {
+    for (i32 actionIndex = 0; actionIndex < arrlen(actions); actionIndex++) {
+        prb_writelnToStdout(arena, actions[actionIndex].cmd);
+    }
+    prb_assert(prb_executeActions(arena, actions, arrlen(actions), exec) == prb_Success);
+}
+
+// NOTE(khvorov) Everything shares one exec spec so take the most restrictive local slot limit,
+// otherwise the MSVC one on CI would be lost as soon as it's not the first configuration
+function prb_ExecSpec
+getSharedExec(ProjectInfo* projects, i32 projectsCount) {
+    prb_ExecSpec result = projects[0].exec;
+    for (i32 projectIndex = 1; projectIndex < projectsCount; projectIndex++) {
+        i32 localSlots = projects[projectIndex].exec.localSlots;
+        if (localSlots != 0 && (result.localSlots == 0 || localSlots < result.localSlots)) {
+            result.localSlots = localSlots;
+        }
+    }
+    return result;
+}
+
+// NOTE(khvorov) Builds every configuration in one go. Downloading and patching happens once and
+// the TUs of all configurations share the same slots.
+function prb_Str*
+buildProjects(prb_Arena* arena, ProjectInfo* projects, i32 projectsCount) {
+    Deps* allDeps = prb_arenaAllocArray(arena, Deps, projectsCount);
+    for (i32 projectIndex = 0; projectIndex < projectsCount; projectIndex++) {
+        allDeps[projectIndex] = getDeps(arena, projects + projectIndex);
+    }
+
+    prepareDeps(arena, projects, allDeps, projectsCount);
+    prb_ExecSpec exec = getSharedExec(projects, projectsCount);
 
     //
     // SECTION Compile
@@ -1169,30 +1003,38 @@ main() {
     prb_TimeStart compileStart = prb_timeStart();
 
     // NOTE(khvorov) Force clean
-    // prb_assert(prb_clearDir(arena, fribidi.objDir) == prb_Success);
-    // prb_assert(prb_clearDir(arena, icu.objDir) == prb_Success);
-    // prb_assert(prb_clearDir(arena, freetype.objDir) == prb_Success);
-    // prb_assert(prb_clearDir(arena, harfbuzz.objDir) == prb_Success);
-    // prb_assert(prb_clearDir(arena, sdl.objDir) == prb_Success);
+    // for (i32 projectIndex = 0; projectIndex < projectsCount; projectIndex++) {
+    //     prb_assert(prb_clearDir(arena, projects[projectIndex].compileOutDir) == prb_Success);
+    // }
 
     if (true) {
-        prb_Job* jobs = 0;
-        arrput(jobs, prb_createJob(compileStaticLib, &fribidi, arena, 50 * prb_MEGABYTE));
-        arrput(jobs, prb_createJob(compileStaticLib, &icu, arena, 50 * prb_MEGABYTE));
-        arrput(jobs, prb_createJob(compileStaticLib, &freetype, arena, 50 * prb_MEGABYTE));
-        arrput(jobs, prb_createJob(compileStaticLib, &harfbuzz, arena, 50 * prb_MEGABYTE));
-        arrput(jobs, prb_createJob(compileStaticLib, &sdl, arena, 50 * prb_MEGABYTE));
-
-        // NOTE(khvorov) Multithreading here doesn't really make it faster presumably because each job is
-        // paralellised already anyway
-        prb_assert(prb_launchJobs(jobs, arrlen(jobs), project->tuCompilationMode));
-        prb_assert(prb_waitForJobs(jobs, arrlen(jobs)));
-
-        prb_assert(fribidi.compileStatus == prb_ProcessStatus_CompletedSuccess);
-        prb_assert(icu.compileStatus == prb_ProcessStatus_CompletedSuccess);
-        prb_assert(freetype.compileStatus == prb_ProcessStatus_CompletedSuccess);
-        prb_assert(harfbuzz.compileStatus == prb_ProcessStatus_CompletedSuccess);
-        prb_assert(sdl.compileStatus == prb_ProcessStatus_CompletedSuccess);
+        prb_StaticLib* libs = 0;
+        i32*           firstLibs = prb_arenaAllocArray(arena, i32, projectsCount + 1);
+        for (i32 projectIndex = 0; projectIndex < projectsCount; projectIndex++) {
+            Deps* deps = allDeps + projectIndex;
+            firstLibs[projectIndex] = (i32)arrlen(libs);
+            arrput(libs, prb_createStaticLib(arena, deps->fribidi.spec));
+            arrput(libs, prb_createStaticLib(arena, deps->icu.spec));
+            arrput(libs, prb_createStaticLib(arena, deps->freetype.spec));
+            arrput(libs, prb_createStaticLib(arena, deps->harfbuzz.spec));
+            arrput(libs, prb_createStaticLib(arena, deps->sdl.spec));
+        }
+        firstLibs[projectsCount] = (i32)arrlen(libs);
+
+        // NOTE(khvorov) All the libraries share the same slots so one with a lot of TUs doesn't hold the others up
+        prb_assert(prb_compileStaticLibs(arena, libs, arrlen(libs), exec));
+
+        // NOTE(khvorov) Why everything that was rebuilt was rebuilt and what it cost, per configuration
+        for (i32 projectIndex = 0; projectIndex < projectsCount; projectIndex++) {
+            ProjectInfo* project = projects + projectIndex;
+            if (project->explain) {
+                prb_writelnToStdout(arena, project->compileOutDir);
+                i32 firstLib = firstLibs[projectIndex];
+                prb_writeToStdout(prb_explainStaticLibs(arena, libs + firstLib, firstLibs[projectIndex + 1] - firstLib, 20));
+            }
+        }
+
+        arrfree(libs);
 
         prb_writelnToStdout(arena, prb_fmt(arena, "total deps compile: %.2fms", prb_getMsFrom(compileStart)));
     }
@@ -1201,52 +1043,300 @@ main() {
     // SECTION Main program
     //
 
-    prb_Str mainWarningFlags = prb_STR("-Wall -Wextra -Werror");
-    if (project->compiler == Compiler_Msvc) {
-        mainWarningFlags = prb_STR("/Wall /WX");
+    prb_Str*    mainOutPaths = 0;
+    prb_Action* compileActions = 0;
+    prb_Action* linkActions = 0;
+    prb_Action* dwpActions = 0;
+    for (i32 projectIndex = 0; projectIndex < projectsCount; projectIndex++) {
+        ProjectInfo* project = projects + projectIndex;
+        Deps*        deps = allDeps + projectIndex;
+
+        prb_Str mainWarningFlags = prb_STR("-Wall -Wextra -Werror");
+        if (project->compiler == Compiler_Msvc) {
+            mainWarningFlags = prb_STR("/Wall /WX");
+        }
+
+        prb_Str mainFlags[] = {
+            deps->freetype.includeFlag,
+            deps->sdl.includeFlag,
+            deps->harfbuzz.includeFlag,
+            deps->icu.includeFlag,
+            deps->fribidi.includeFlag,
+            deps->fribidiHeaderFlags,
+            mainWarningFlags,
+        };
+
+        prb_Str mainNotPreprocessedName = prb_STR("example.c");
+        prb_Str mainNotPreprocessedPath = prb_pathJoin(arena, project->rootDir, mainNotPreprocessedName);
+        prb_Str mainPreprocessedName = prb_replaceExt(arena, mainNotPreprocessedName, prb_STR("i"));
+        prb_Str mainPreprocessedPath = prb_pathJoin(arena, project->compileOutDir, mainPreprocessedName);
+        prb_Str mainObjPath = prb_replaceExt(arena, mainPreprocessedPath, prb_STR("obj"));
+
+        prb_Str mainFlagsStr = prb_stringsJoin(arena, mainFlags, prb_arrayCount(mainFlags), prb_STR(" "));
+
+        prb_Action mainPreprocess = {};
+        mainPreprocess.cmd = constructCompileCmd(arena, project, mainFlagsStr, mainNotPreprocessedPath, mainPreprocessedPath, prb_STR(""));
+        arrput(compileActions, mainPreprocess);
+
+        prb_Action mainObj = {};
+        mainObj.cmd = constructCompileCmd(arena, project, mainFlagsStr, mainNotPreprocessedPath, mainObjPath, prb_STR(""));
+        arrput(compileActions, mainObj);
+
+        prb_Str mainObjs[] = {mainObjPath, deps->freetype.spec.libFile, deps->sdl.spec.libFile, deps->harfbuzz.spec.libFile, deps->icu.spec.libFile, deps->fribidi.spec.libFile};
+        prb_Str mainObjsStr = prb_stringsJoin(arena, mainObjs, prb_arrayCount(mainObjs), prb_STR(" "));
+
+        prb_Str mainOutPath = prb_replaceExt(arena, mainPreprocessedPath, prb_STR("exe"));
+        arrput(mainOutPaths, mainOutPath);
+
+#if prb_PLATFORM_WINDOWS
+        prb_Str mainLinkFlags = prb_STR("-subsystem:windows User32.lib Shell32.lib Advapi32.lib Ole32.lib Winmm.lib Gdi32.lib Imm32.lib OleAut32.lib Version.lib");
+#elif prb_PLATFORM_LINUX
+        prb_Str mainLinkFlags = prb_STR("-lX11 -lm -lstdc++ -ldl -lfontconfig");
+#endif
+
+        prb_Action mainExe = {};
+        mainExe.cmd = constructCompileCmd(arena, project, mainFlagsStr, mainObjsStr, mainOutPath, mainLinkFlags);
+        arrput(linkActions, mainExe);
+
+        // NOTE(khvorov) Packs all the .dwo files into one so the executable can be debugged without the build directory
+        if (project->dwp) {
+            prb_Str    dwpProg = project->compiler == Compiler_Clang ? prb_STR("llvm-dwp") : prb_STR("dwp");
+            prb_Str    dwpPath = prb_replaceExt(arena, mainOutPath, prb_STR("dwp"));
+            prb_Action mainDwp = {};
+            mainDwp.cmd = prb_fmt(arena, "%.*s -e %.*s -o %.*s", prb_LIT(dwpProg), prb_LIT(mainOutPath), prb_LIT(dwpPath));
+            arrput(dwpActions, mainDwp);
+        }
     }
 
-    prb_Str mainFlags[] = {
-        freetype.includeFlag,
-        sdl.includeFlag,
-        harfbuzz.includeFlag,
-        icu.includeFlag,
-        fribidi.includeFlag,
-        fribidiHeaderFlags,
-        mainWarningFlags,
-    };
+    runMainActions(arena, compileActions, exec);
+    runMainActions(arena, linkActions, exec);
+    runMainActions(arena, dwpActions, exec);
+    arrfree(compileActions);
+    arrfree(linkActions);
+    arrfree(dwpActions);
 
-    prb_Str mainNotPreprocessedName = prb_STR("example.c");
-    prb_Str mainNotPreprocessedPath = prb_pathJoin(arena, project->rootDir, mainNotPreprocessedName);
-    prb_Str mainPreprocessedName = prb_replaceExt(arena, mainNotPreprocessedName, prb_STR("i"));
-    prb_Str mainPreprocessedPath = prb_pathJoin(arena, project->compileOutDir, mainPreprocessedName);
-    prb_Str mainObjPath = prb_replaceExt(arena, mainPreprocessedPath, prb_STR("obj"));
+    return mainOutPaths;
+}
 
-    prb_Str mainFlagsStr = prb_stringsJoin(arena, mainFlags, prb_arrayCount(mainFlags), prb_STR(" "));
+function prb_Str
+buildProject(prb_Arena* arena, ProjectInfo* project) {
+    prb_Str* mainOutPaths = buildProjects(arena, project, 1);
+    prb_Str  result = mainOutPaths[0];
+    arrfree(mainOutPaths);
+    return result;
+}
 
-    prb_Str mainCmdPreprocess = constructCompileCmd(arena, project, mainFlagsStr, mainNotPreprocessedPath, mainPreprocessedPath, prb_STR(""));
-    prb_writelnToStdout(arena, mainCmdPreprocess);
-    prb_Process mainHandlePre = prb_createProcess(mainCmdPreprocess, (prb_ProcessSpec) {});
-    prb_assert(prb_launchProcesses(arena, &mainHandlePre, 1, prb_Background_Yes));
+function prb_Str*
+getProfileFiles(prb_Arena* arena, ProjectInfo* project) {
+    prb_Str* result = 0;
+    switch (project->compiler) {
+        case Compiler_Gcc: {
+            prb_Str* entries = prb_getAllDirEntries(arena, project->pgoDir, prb_Recursive_No);
+            for (i32 entryIndex = 0; entryIndex < arrlen(entries); entryIndex++) {
+                if (prb_strEndsWith(entries[entryIndex], prb_STR(".gcda"))) {
+                    arrput(result, entries[entryIndex]);
+                }
+            }
+            arrfree(entries);
+            // NOTE(khvorov) Directory order changes between machines, the profile files go into the command line
+            prb_sortStrs(arena, result, arrlen(result));
+        } break;
+        case Compiler_Clang: arrput(result, prb_pathJoin(arena, project->pgoDir, prb_STR("example.profdata"))); break;
+        case Compiler_Msvc: break;
+    }
+    return result;
+}
 
-    prb_Str mainCmdObj = constructCompileCmd(arena, project, mainFlagsStr, mainNotPreprocessedPath, mainObjPath, prb_STR(""));
-    prb_assert(execCmd(arena, mainCmdObj));
+function void
+trainProfile(prb_Arena* arena, ProjectInfo* project, prb_Str instrumentedExe) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+
+    // NOTE(khvorov) The dummy video driver renders into memory so training doesn't need a display
+    prb_Str cmd = prb_fmt(arena, "%.*s frames=500", prb_LIT(instrumentedExe));
+    prb_writelnToStdout(arena, cmd);
+    prb_ProcessSpec spec = {};
+    spec.addEnv = prb_STR("SDL_VIDEODRIVER=dummy");
+    prb_Process proc = prb_createProcess(cmd, spec);
+    prb_assert(prb_launchProcesses(arena, &proc, 1, prb_Background_No));
+
+    if (project->compiler == Compiler_Clang) {
+        prb_Str* entries = prb_getAllDirEntries(arena, project->pgoDir, prb_Recursive_No);
+        prb_Str* raws = 0;
+        for (i32 entryIndex = 0; entryIndex < arrlen(entries); entryIndex++) {
+            if (prb_strEndsWith(entries[entryIndex], prb_STR(".profraw"))) {
+                arrput(raws, entries[entryIndex]);
+            }
+        }
+        prb_assert(arrlen(raws) > 0);
+        prb_sortStrs(arena, raws, arrlen(raws));
+        prb_Str rawsStr = prb_stringsJoin(arena, raws, arrlen(raws), prb_STR(" "));
+        prb_Str profdataPath = prb_pathJoin(arena, project->pgoDir, prb_STR("example.profdata"));
+        prb_assert(execCmd(arena, prb_fmt(arena, "llvm-profdata merge -o %.*s %.*s", prb_LIT(profdataPath), prb_LIT(rawsStr))));
+        arrfree(raws);
+        arrfree(entries);
+    }
 
-    prb_Str mainObjs[] = {mainObjPath, freetype.libFile, sdl.libFile, harfbuzz.libFile, icu.libFile, fribidi.libFile};
-    prb_Str mainObjsStr = prb_stringsJoin(arena, mainObjs, prb_arrayCount(mainObjs), prb_STR(" "));
+    prb_endTempMemory(temp);
+}
 
-    prb_Str mainOutPath = prb_replaceExt(arena, mainPreprocessedPath, prb_STR("exe"));
+typedef struct Options {
+    bool     runningOnCi;
+    bool     noLto;
+    Pgo      pgo;
+    bool     splitDwarf;
+    prb_Str  debugCompression;
+    bool     dwp;
+    bool     explain;
+    prb_Str* workers;
+} Options;
+
+function ProjectInfo
+createProject(prb_Arena* arena, prb_Str compilerStr, prb_Str buildTypeStr, Options* opts) {
+    prb_assert(prb_streq(buildTypeStr, prb_STR("debug")) || prb_streq(buildTypeStr, prb_STR("release")));
 
+    ProjectInfo  project_ = {};
+    ProjectInfo* project = &project_;
+    project->rootDir = prb_getParentDir(arena, prb_STR(__FILE__));
+    project->release = prb_streq(buildTypeStr, prb_STR("release"));
+    project->compileOutDir = prb_pathJoin(arena, project->rootDir, prb_fmt(arena, "build-%.*s-%.*s", prb_LIT(compilerStr), prb_LIT(buildTypeStr)));
+    prb_assert(prb_createDirIfNotExists(arena, project->compileOutDir) == prb_Success);
 #if prb_PLATFORM_WINDOWS
-    prb_Str mainLinkFlags = prb_STR("-subsystem:windows User32.lib Shell32.lib Advapi32.lib Ole32.lib Winmm.lib Gdi32.lib Imm32.lib OleAut32.lib Version.lib");
+    prb_assert(prb_streq(compilerStr, prb_STR("msvc")) || prb_streq(compilerStr, prb_STR("clang")));
+    project->compiler = prb_streq(compilerStr, prb_STR("msvc")) ? Compiler_Msvc : Compiler_Clang;
 #elif prb_PLATFORM_LINUX
-    prb_Str mainLinkFlags = prb_STR("-lX11 -lm -lstdc++ -ldl -lfontconfig");
+    prb_assert(prb_streq(compilerStr, prb_STR("gcc")) || prb_streq(compilerStr, prb_STR("clang")));
+    project->compiler = prb_streq(compilerStr, prb_STR("gcc")) ? Compiler_Gcc : Compiler_Clang;
+#else
+#error unimlemented
+#endif
+
+    project->lto = project->release && !opts->noLto && ltoToolsPresent(arena, project);
+    project->ltoCacheDir = prb_pathJoin(arena, project->compileOutDir, prb_STR("lto-cache"));
+
+    // NOTE(khvorov) These are DWARF things so only make sense for debug builds on linux
+    if (opts->splitDwarf || opts->debugCompression.len > 0) {
+        prb_assert(!project->release && project->compiler != Compiler_Msvc);
+        prb_assert(prb_PLATFORM_LINUX);
+    }
+    project->splitDwarf = opts->splitDwarf;
+    project->debugCompression = opts->debugCompression;
+    project->dwp = opts->dwp;
+    project->explain = opts->explain;
+
+    // NOTE(khvorov) MSVC runs out of memory on CI (lol wtf microsoft)
+    if (opts->runningOnCi && project->compiler == Compiler_Msvc) {
+        project->exec.localSlots = 1;
+    }
+
+    project->exec.workers = opts->workers;
+    project->exec.workersCount = arrlen(opts->workers);
+    if (project->exec.workersCount > 0) {
+        // NOTE(khvorov) Same token the workers were started with, see worker.c
+        prb_GetenvResult token = prb_getenv(arena, prb_STR("PRB_WORKER_TOKEN"));
+        prb_assert(token.found && token.str.len > 0);
+        project->exec.workerToken = token.str;
+    }
+
+    project->pgoDir = prb_pathJoin(arena, project->compileOutDir, prb_STR("pgo"));
+    if (opts->pgo != Pgo_None) {
+        prb_assert(project->release && project->compiler != Compiler_Msvc);
+        // NOTE(khvorov) Workers wouldn't have the profile
+        prb_assert(project->exec.workersCount == 0);
+    }
+
+    return project_;
+}
+
+int
+main() {
+    prb_TimeStart scriptStartTime = prb_timeStart();
+    prb_Arena     arena_ = prb_createArenaFromVmem(1 * prb_GIGABYTE);
+    prb_Arena*    arena = &arena_;
+    prb_rebuildSelfIfChanged(arena, prb_STR(__FILE__), prb_STR("-g -Wall -Wextra -Werror -Wfatal-errors"));
+
+    // NOTE(khvorov) Either "<compiler> <debug/release>" or "matrix" which builds every supported
+    // compiler/build type combination in one process
+    prb_Str* cmdArgs = prb_getCmdArgs(arena);
+    prb_assert(arrlen(cmdArgs) >= 2);
+    bool matrix = prb_streq(cmdArgs[1], prb_STR("matrix"));
+    i32  firstOptionalArg = matrix ? 2 : 3;
+    prb_assert(arrlen(cmdArgs) >= firstOptionalArg);
+
+    // NOTE(khvorov) Optional args are "ci", "nolto", "pgo", "pgouse", "splitdwarf", "gz=<zlib/zstd>", "dwp",
+    // "explain" and any number of "worker=<address>"
+    Options opts = {};
+    for (i32 argIndex = firstOptionalArg; argIndex < arrlen(cmdArgs); argIndex++) {
+        prb_Str arg = cmdArgs[argIndex];
+        prb_Str workerPrefix = prb_STR("worker=");
+        if (prb_streq(arg, prb_STR("ci"))) {
+            opts.runningOnCi = true;
+        } else if (prb_streq(arg, prb_STR("nolto"))) {
+            opts.noLto = true;
+        } else if (prb_streq(arg, prb_STR("pgo"))) {
+            opts.pgo = Pgo_Generate;
+        } else if (prb_streq(arg, prb_STR("pgouse"))) {
+            opts.pgo = Pgo_Use;
+        } else if (prb_streq(arg, prb_STR("splitdwarf"))) {
+            opts.splitDwarf = true;
+        } else if (prb_streq(arg, prb_STR("gz=zlib")) || prb_streq(arg, prb_STR("gz=zstd"))) {
+            opts.debugCompression = prb_strSlice(arg, 3, arg.len);
+        } else if (prb_streq(arg, prb_STR("dwp"))) {
+            opts.dwp = true;
+            opts.splitDwarf = true;
+        } else if (prb_streq(arg, prb_STR("explain"))) {
+            opts.explain = true;
+        } else if (prb_strStartsWith(arg, workerPrefix)) {
+            arrput(opts.workers, prb_strSlice(arg, workerPrefix.len, arg.len));
+        } else {
+            prb_writelnToStdout(arena, prb_fmt(arena, "unrecognized argument: %.*s", prb_LIT(arg)));
+            prb_assert(!"unrecognized argument");
+        }
+    }
+
+    if (matrix) {
+        // NOTE(khvorov) PGO and the DWARF modes are per-configuration things
+        prb_assert(opts.pgo == Pgo_None && !opts.splitDwarf && opts.debugCompression.len == 0);
+
+        prb_Str compilerStrs[] = {
+            prb_STR("clang"),
+#if prb_PLATFORM_WINDOWS
+            prb_STR("msvc"),
+#elif prb_PLATFORM_LINUX
+            prb_STR("gcc"),
+#else
+#error unimplemented
 #endif
+        };
+        prb_Str buildTypeStrs[] = {prb_STR("debug"), prb_STR("release")};
+
+        ProjectInfo* projects = 0;
+        for (i32 compilerIndex = 0; compilerIndex < prb_arrayCount(compilerStrs); compilerIndex++) {
+            for (i32 buildTypeIndex = 0; buildTypeIndex < prb_arrayCount(buildTypeStrs); buildTypeIndex++) {
+                arrput(projects, createProject(arena, compilerStrs[compilerIndex], buildTypeStrs[buildTypeIndex], &opts));
+            }
+        }
 
-    prb_Str mainCmdExe = constructCompileCmd(arena, project, mainFlagsStr, mainObjsStr, mainOutPath, mainLinkFlags);
-    prb_assert(execCmd(arena, mainCmdExe));
+        // NOTE(khvorov) Projects are referenced by the lib specs so the array can't move after this
+        buildProjects(arena, projects, arrlen(projects));
+    } else {
+        ProjectInfo  project_ = createProject(arena, cmdArgs[1], cmdArgs[2], &opts);
+        ProjectInfo* project = &project_;
+
+        // NOTE(khvorov) PGO builds instrumented, runs the example headless to collect a profile, then builds again
+        // using it. "pgouse" skips straight to the last step with whatever profile is already there.
+        if (opts.pgo == Pgo_Generate) {
+            prb_assert(prb_clearDir(arena, project->pgoDir) == prb_Success);
+            project->pgo = Pgo_Generate;
+            prb_Str instrumentedExe = buildProject(arena, project);
+            trainProfile(arena, project, instrumentedExe);
+        }
+        if (opts.pgo != Pgo_None) {
+            project->pgo = Pgo_Use;
+            project->profileFiles = getProfileFiles(arena, project);
+        }
 
-    prb_assert(prb_waitForProcesses(&mainHandlePre, 1) == prb_Success);
+        buildProject(arena, project);
+    }
 
     prb_writelnToStdout(arena, prb_fmt(arena, "total: %.2fms", prb_getMsFrom(scriptStartTime)));
     return 0;
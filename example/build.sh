@@ -1,3 +1,4 @@
 SCRIPT_DIR=$(dirname "$0")
 RUN_BIN=$SCRIPT_DIR/build.bin
-clang -g -Wall -Wextra -Werror -Wfatal-errors $SCRIPT_DIR/build.c -o $RUN_BIN -lpthread && $RUN_BIN $@
+# NOTE(khvorov) The binary rebuilds itself when build.c or cbuild.h change
+([ -f $RUN_BIN ] || clang -g -Wall -Wextra -Werror -Wfatal-errors $SCRIPT_DIR/build.c -o $RUN_BIN -lpthread) && $RUN_BIN $@
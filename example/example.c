@@ -1051,8 +1051,12 @@ processEvent(SDL_Window* window, SDL_Event* event, bool* running) {
 
 int
 main(int argc, char* argv[]) {
-    UNUSED(argc);
-    UNUSED(argv);
+    // NOTE(khvorov) "frames=N" renders N frames without waiting for input, prints the average timings and exits.
+    // The build program uses it with SDL_VIDEODRIVER=dummy to train PGO profiles.
+    i32 framesToRender = -1;
+    if (argc > 1 && SDL_strncmp(argv[1], "frames=", 7) == 0) {
+        framesToRender = SDL_atoi(argv[1] + 7);
+    }
 
     SDL_SetMemoryFunctions(sdlCustomMalloc, sdlCustomCalloc, sdlCustomRealloc, sdlCustomFree);
     int initResult = SDL_Init(SDL_INIT_VIDEO);
@@ -1073,15 +1077,20 @@ main(int argc, char* argv[]) {
 
             u64  prevFrameTicks = 0;
             u64  prevFrameUnicodeDrawTicks = 0;
+            u64  totalFrameTicks = 0;
+            u64  totalUnicodeDrawTicks = 0;
+            i32  framesRendered = 0;
             f32  ticksPerMS = (f32)SDL_GetPerformanceFrequency() / 1000.0f;
-            bool running = true;
+            bool running = framesToRender != 0;
             while (running) {
                 u64 frameStart = SDL_GetPerformanceCounter();
                 assert(virtualArena.tempCount == 0);
 
                 SDL_Event event = {0};
-                assert(SDL_WaitEvent(&event) == 1);
-                processEvent(sdlWindow, &event, &running);
+                if (framesToRender < 0) {
+                    assert(SDL_WaitEvent(&event) == 1);
+                    processEvent(sdlWindow, &event, &running);
+                }
                 while (SDL_PollEvent(&event)) {
                     processEvent(sdlWindow, &event, &running);
                 }
@@ -1186,6 +1195,19 @@ main(int argc, char* argv[]) {
                 renderEnd(&renderer);
                 prevFrameTicks = SDL_GetPerformanceCounter() - frameStart;
                 prevFrameUnicodeDrawTicks = unicodeDrawTicks;
+
+                totalFrameTicks += prevFrameTicks;
+                totalUnicodeDrawTicks += unicodeDrawTicks;
+                framesRendered += 1;
+                if (framesToRender > 0 && framesRendered >= framesToRender) {
+                    running = false;
+                }
+            }
+
+            if (framesRendered > 0 && framesToRender > 0) {
+                f32 avgUnicodeDrawMs = (f32)totalUnicodeDrawTicks / ticksPerMS / (f32)framesRendered;
+                f32 avgFrameMs = (f32)totalFrameTicks / ticksPerMS / (f32)framesRendered;
+                SDL_Log("%d frames, avg unicode draw: %.3fms, avg frame total: %.3fms\n", framesRendered, (double)avgUnicodeDrawMs, (double)avgFrameMs);
             }
         }
     } else {
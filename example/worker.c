@@ -0,0 +1,33 @@
+#include "../cbuild.h"
+
+// NOTE(khvorov) Runs a worker that build.c can send compile actions to like this
+// PRB_WORKER_TOKEN=<secret> ./example/worker.sh unix:/tmp/prb-worker.sock
+// PRB_WORKER_TOKEN=<secret> ./example/build.sh clang debug worker=unix:/tmp/prb-worker.sock
+// The worker runs whatever command a peer with the token sends it and nothing on the connection is
+// encrypted (the token included), so keep it to trusted networks. Only listen on a unix socket
+// or on loopback (tcp:127.0.0.1:7000) and reach other machines through something like an ssh tunnel.
+// Stop it with ctrl-c or by sending it a shutdown message with prb_stopWorker.
+// prb_runWorker forks a handler per connection so it refuses to run in a process with other threads.
+
+int
+main() {
+    prb_Arena  arena_ = prb_createArenaFromVmem(1 * prb_GIGABYTE);
+    prb_Arena* arena = &arena_;
+    prb_rebuildSelfIfChanged(arena, prb_STR(__FILE__), prb_STR("-g -Wall -Wextra -Werror -Wfatal-errors"));
+
+    prb_Str* cmdArgs = prb_getCmdArgs(arena);
+    prb_assert(arrlen(cmdArgs) == 2 || arrlen(cmdArgs) == 3);
+    prb_Str address = cmdArgs[1];
+    prb_Str workDir = arrlen(cmdArgs) == 3 ? cmdArgs[2] : prb_pathJoin(arena, prb_getParentDir(arena, prb_STR(__FILE__)), prb_STR("worker"));
+
+    prb_GetenvResult token = prb_getenv(arena, prb_STR("PRB_WORKER_TOKEN"));
+    if (!token.found || token.str.len == 0) {
+        prb_writelnToStdout(arena, prb_STR("set PRB_WORKER_TOKEN to a secret shared with the build"));
+        return 1;
+    }
+
+    prb_writelnToStdout(arena, prb_fmt(arena, "worker listening on %.*s, work dir %.*s", prb_LIT(address), prb_LIT(workDir)));
+    prb_Status status = prb_runWorker(arena, address, workDir, token.str);
+    prb_assert(status == prb_Success);
+    return 0;
+}
@@ -0,0 +1,4 @@
+SCRIPT_DIR=$(dirname "$0")
+RUN_BIN=$SCRIPT_DIR/worker.bin
+# NOTE(khvorov) The binary rebuilds itself when worker.c or cbuild.h change
+([ -f $RUN_BIN ] || clang -g -Wall -Wextra -Werror -Wfatal-errors $SCRIPT_DIR/worker.c -o $RUN_BIN -lpthread) && $RUN_BIN $@
@@ -0,0 +1,1220 @@
+#include "../cbuild.h"
+
+#define function static
+
+typedef int32_t  i32;
+typedef uint64_t u64;
+
+// NOTE(khvorov) Run with ./tests/run.sh bench [name]
+// Each benchmark compares the current implementation to a reference on inputs that look like
+// what build programs actually search through: preprocessed sources and compiler output.
+
+typedef struct Inputs {
+    prb_Str preprocessed;
+    prb_Str compilerOutput;
+} Inputs;
+
+function prb_Str
+repeatUntil(prb_Arena* arena, prb_Str str, i32 minLen) {
+    prb_GrowingStr gstr = prb_beginStr(arena);
+    while (gstr.str.len < minLen) {
+        prb_addStrSegment(&gstr, "%.*s", prb_LIT(str));
+    }
+    prb_Str result = prb_endStr(&gstr);
+    return result;
+}
+
+function Inputs
+getInputs(prb_Arena* arena) {
+    Inputs  result = {};
+    prb_Str testsDir = prb_getParentDir(arena, prb_STR(__FILE__));
+    prb_Str header = prb_pathJoin(arena, prb_getParentDir(arena, testsDir), prb_STR("cbuild.h"));
+    i32     minLen = 8 * prb_MEGABYTE;
+
+    {
+        prb_Str         outPath = prb_pathJoin(arena, testsDir, prb_STR("bench-preprocessed.log"));
+        prb_ProcessSpec spec = {};
+        spec.redirectStdout = true;
+        spec.stdoutFilepath = outPath;
+        prb_Process proc = prb_createProcess(prb_fmt(arena, "clang -E -x c %.*s", prb_LIT(header)), spec);
+        prb_assert(prb_launchProcesses(arena, &proc, 1, prb_Background_No));
+        prb_ReadEntireFileResult readRes = prb_readEntireFile(arena, outPath);
+        prb_assert(readRes.success);
+        prb_assert(prb_removePathIfExists(arena, outPath));
+        result.preprocessed = repeatUntil(arena, prb_strFromBytes(readRes.content), minLen);
+    }
+
+    {
+        prb_GrowingStr gstr = prb_beginStr(arena);
+        for (i32 lineIndex = 0; gstr.str.len < minLen; lineIndex++) {
+            i32 line = (lineIndex * 7919) % 5000 + 1;
+            i32 col = lineIndex % 80 + 1;
+            prb_addStrSegment(
+                &gstr,
+                "/home/user/project/src/module%d/file%d.c:%d:%d: warning: unused variable 'value%d' [-Wunused-variable]\n"
+                "%5d |     int value%d = compute(input, %d);\n"
+                "      |         ^~~~~~~~\n",
+                lineIndex % 13,
+                lineIndex % 101,
+                line,
+                col,
+                lineIndex,
+                line,
+                lineIndex,
+                col
+            );
+            if (lineIndex % 1000 == 999) {
+                prb_addStrSegment(&gstr, "/home/user/project/src/main.c:%d:1: error: expected ';' before '}' token\n", line);
+            }
+        }
+        result.compilerOutput = prb_endStr(&gstr);
+    }
+
+    return result;
+}
+
+// NOTE(khvorov) Every measurement is repeated and the fastest run is reported
+#define globalRuns 5
+
+function float
+bestMs(i32 runIndex, float best, float ms) {
+    float result = runIndex == 0 ? ms : prb_min(best, ms);
+    return result;
+}
+
+function void
+report(prb_Arena* arena, const char* name, float ms, i32 bytes, i32 matches) {
+    float mbPerS = (float)bytes / (float)(prb_MEGABYTE) / (ms / 1000.0f);
+    prb_writelnToStdout(arena, prb_fmt(arena, "%-50s %9.2fms %9.1fMB/s %8d matches", name, ms, mbPerS, matches));
+}
+
+//
+// SECTION Strings
+//
+
+// NOTE(khvorov) What prb_strFind used for exact patterns before it had vector kernels,
+// single bytes went through the utf8 AnyChar path
+function i32
+findRaita(const uint8_t* str, i32 strLen, prb_Str pattern) {
+    i32 shifts[256];
+    prb_lib_buildRaitaShifts((const uint8_t*)pattern.ptr, pattern.len, prb_StrDirection_FromStart, shifts);
+    i32 result = prb_lib_findExactRaita(str, strLen, (const uint8_t*)pattern.ptr, pattern.len, prb_StrDirection_FromStart, shifts);
+    return result;
+}
+
+function i32
+countReference(prb_Str str, prb_Str pattern) {
+    i32 result = 0;
+    if (pattern.len == 1) {
+        prb_StrFindSpec spec = {};
+        spec.mode = prb_StrFindMode_AnyChar;
+        spec.pattern = pattern;
+        for (prb_StrFindResult find = prb_strFind(str, spec); find.found; find = prb_strFind(find.afterMatch, spec)) {
+            result += 1;
+        }
+    } else {
+        i32 off = 0;
+        for (;;) {
+            i32 found = findRaita((const uint8_t*)str.ptr + off, str.len - off, pattern);
+            if (found == -1) {
+                break;
+            }
+            result += 1;
+            off += found + pattern.len;
+        }
+    }
+    return result;
+}
+
+function i32
+countStrFind(prb_Str str, prb_Str pattern) {
+    i32             result = 0;
+    prb_StrFindSpec spec = {};
+    spec.pattern = pattern;
+    for (prb_StrFindResult find = prb_strFind(str, spec); find.found; find = prb_strFind(find.afterMatch, spec)) {
+        result += 1;
+    }
+    return result;
+}
+
+function void
+bench_strFind(prb_Arena* arena, Inputs* inputs) {
+    prb_Str texts[] = {inputs->preprocessed, inputs->compilerOutput};
+    prb_Str textNames[] = {prb_STR("preprocessed"), prb_STR("compiler output")};
+    prb_Str patterns[] = {
+        prb_STR("#"),
+        prb_STR("\n#"),
+        prb_STR("error:"),
+        prb_STR("prb_StrFindSpec"),
+        prb_STR("[-Wunused-variable]"),
+        prb_STR("this pattern is long enough to go to the raita path and it is not in either text"),
+    };
+
+    for (i32 textIndex = 0; textIndex < prb_arrayCount(texts); textIndex++) {
+        prb_Str text = texts[textIndex];
+        for (i32 patIndex = 0; patIndex < prb_arrayCount(patterns); patIndex++) {
+            prb_Str pattern = patterns[patIndex];
+
+            i32   refMatches = 0;
+            i32   matches = 0;
+            float refMs = 0;
+            float ms = 0;
+            for (i32 runIndex = 0; runIndex < globalRuns; runIndex++) {
+                prb_TimeStart refStart = prb_timeStart();
+                refMatches = countReference(text, pattern);
+                refMs = bestMs(runIndex, refMs, prb_getMsFrom(refStart));
+
+                prb_TimeStart start = prb_timeStart();
+                matches = countStrFind(text, pattern);
+                ms = bestMs(runIndex, ms, prb_getMsFrom(start));
+                prb_assert(matches == refMatches);
+            }
+
+            prb_Str ptrn = pattern.len > 20 ? prb_fmt(arena, "%.17s...", pattern.ptr) : pattern;
+            if (prb_streq(pattern, prb_STR("\n#"))) {
+                ptrn = prb_STR("\\n#");
+            }
+            report(arena, prb_fmt(arena, "reference %.*s '%.*s'", prb_LIT(textNames[textIndex]), prb_LIT(ptrn)).ptr, refMs, text.len, refMatches);
+            report(arena, prb_fmt(arena, "strFind %.*s '%.*s'", prb_LIT(textNames[textIndex]), prb_LIT(ptrn)).ptr, ms, text.len, matches);
+        }
+    }
+
+    // NOTE(khvorov) Many one-off searches in short strings, like looking for a separator in each line
+    {
+        prb_Str line = prb_STR("/home/user/project/src/main.c:12:1: error: expected ';'");
+        prb_Str pattern = prb_STR(": error: ");
+        i32     iterations = 1000000;
+        u64     checksum = 0;
+
+        prb_TimeStart refStart = prb_timeStart();
+        for (i32 iteration = 0; iteration < iterations; iteration++) {
+            checksum += (u64)findRaita((const uint8_t*)line.ptr, line.len - (iteration & 1), pattern);
+        }
+        float refMs = prb_getMsFrom(refStart);
+
+        prb_StrFindSpec spec = {};
+        spec.pattern = pattern;
+        prb_TimeStart start = prb_timeStart();
+        for (i32 iteration = 0; iteration < iterations; iteration++) {
+            prb_Str str = {line.ptr, line.len - (iteration & 1)};
+            checksum -= (u64)prb_strFind(str, spec).beforeMatch.len;
+        }
+        float ms = prb_getMsFrom(start);
+        prb_assert(checksum == 0);
+
+        report(arena, "reference short line", refMs, line.len * iterations, iterations);
+        report(arena, "strFind short line", ms, line.len * iterations, iterations);
+    }
+}
+
+// NOTE(khvorov) Tokenizing loops that used to prepare the same spec on every call
+function void
+bench_strFinder(prb_Arena* arena, Inputs* inputs) {
+    prb_Str text = inputs->compilerOutput;
+
+    prb_StrFindSpec anySpace = {};
+    anySpace.mode = prb_StrFindMode_AnyChar;
+    anySpace.pattern = prb_STR(" \t");
+    anySpace.alwaysMatchEnd = true;
+
+    prb_StrFindSpec newline = {};
+    newline.pattern = prb_STR("\n");
+    newline.alwaysMatchEnd = true;
+
+    prb_StrFindSpec longPattern = {};
+    longPattern.pattern = prb_STR("a pattern that is long enough to need a shift table and does not appear in the text");
+
+    {
+        i32   refTokens = 0;
+        i32   tokens = 0;
+        float refMs = 0;
+        float ms = 0;
+        for (i32 runIndex = 0; runIndex < globalRuns; runIndex++) {
+            prb_TimeStart  refStart = prb_timeStart();
+            prb_StrScanner refScanner = prb_createStrScanner(text);
+            for (refTokens = 0; prb_strScannerMove(&refScanner, anySpace, prb_StrScannerSide_AfterMatch); refTokens++) {}
+            refMs = bestMs(runIndex, refMs, prb_getMsFrom(refStart));
+
+            prb_TimeStart  start = prb_timeStart();
+            prb_StrFinder  finder = prb_createStrFinder(anySpace);
+            prb_StrScanner scanner = prb_createStrScanner(text);
+            for (tokens = 0; prb_strScannerMoveWith(&scanner, &finder, prb_StrScannerSide_AfterMatch); tokens++) {}
+            ms = bestMs(runIndex, ms, prb_getMsFrom(start));
+            prb_assert(tokens == refTokens);
+        }
+        report(arena, "scannerMove split on ' \\t'", refMs, text.len, refTokens);
+        report(arena, "scannerMoveWith split on ' \\t'", ms, text.len, tokens);
+    }
+
+    {
+        i32   refLines = 0;
+        i32   lines = 0;
+        float refMs = 0;
+        float ms = 0;
+        for (i32 runIndex = 0; runIndex < globalRuns; runIndex++) {
+            prb_TimeStart  refStart = prb_timeStart();
+            prb_StrScanner refScanner = prb_createStrScanner(text);
+            for (refLines = 0; prb_strScannerMove(&refScanner, newline, prb_StrScannerSide_AfterMatch); refLines++) {
+                prb_assert(!prb_strFind(refScanner.betweenLastMatches, longPattern).found);
+            }
+            refMs = bestMs(runIndex, refMs, prb_getMsFrom(refStart));
+
+            prb_TimeStart  start = prb_timeStart();
+            prb_StrFinder  newlineFinder = prb_createStrFinder(newline);
+            prb_StrFinder  longFinder = prb_createStrFinder(longPattern);
+            prb_StrScanner scanner = prb_createStrScanner(text);
+            for (lines = 0; prb_strScannerMoveWith(&scanner, &newlineFinder, prb_StrScannerSide_AfterMatch); lines++) {
+                prb_assert(!prb_strFinderFind(&longFinder, scanner.betweenLastMatches).found);
+            }
+            ms = bestMs(runIndex, ms, prb_getMsFrom(start));
+            prb_assert(lines == refLines);
+        }
+        report(arena, "strFind long pattern in every line", refMs, text.len, refLines);
+        report(arena, "strFinderFind long pattern in every line", ms, text.len, lines);
+    }
+}
+
+// NOTE(khvorov) What prb_strFinderFind did for AnyChar patterns before it had vector kernels:
+// a bitmap lookup per byte for ascii patterns, every pattern character compared for the rest
+function prb_StrFindResult
+findAnyCharReference(prb_StrFinder* finder, prb_Str str) {
+    prb_StrFindResult result = {};
+    i32               off = -1;
+    i32               len = 1;
+    if (finder->patternIsAscii) {
+        off = prb_lib_findByteSetScalar((const uint8_t*)str.ptr, 0, str.len, finder->byteSet, prb_StrDirection_FromStart);
+    } else {
+        for (prb_Utf8CharIter iter = prb_createUtf8CharIter(str, prb_StrDirection_FromStart); prb_utf8CharIterNext(&iter) == prb_Success && off == -1;) {
+            if (iter.curIsValid) {
+                for (prb_Utf8CharIter patIter = prb_createUtf8CharIter(finder->spec.pattern, prb_StrDirection_FromStart); prb_utf8CharIterNext(&patIter) == prb_Success;) {
+                    if (patIter.curIsValid && patIter.curUtf32Char == iter.curUtf32Char) {
+                        off = iter.curByteOffset;
+                        len = iter.curUtf8Bytes;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    if (off != -1) {
+        result.found = true;
+        result.beforeMatch = prb_strSlice(str, 0, off);
+        result.match = prb_strSlice(str, off, off + len);
+        result.afterMatch = prb_strSlice(str, off + len, str.len);
+    }
+    return result;
+}
+
+function void
+bench_anyChar(prb_Arena* arena, Inputs* inputs) {
+    prb_Str text = inputs->preprocessed;
+    prb_Str patterns[] = {
+        prb_STR("@$`"),
+        prb_STR("{}"),
+        prb_STR(" \t=/\\"),
+        prb_STR("!\"#$%&'()*+,-./:;<=>?@[\\]^_`{|}~"),
+        prb_STR("@→"),
+        prb_STR("{}→←"),
+    };
+
+    for (i32 patIndex = 0; patIndex < prb_arrayCount(patterns); patIndex++) {
+        prb_Str         pattern = patterns[patIndex];
+        prb_StrFindSpec spec = {};
+        spec.mode = prb_StrFindMode_AnyChar;
+        spec.pattern = pattern;
+
+        i32   refCount = 0;
+        i32   count = 0;
+        float refMs = 0;
+        float ms = 0;
+        for (i32 runIndex = 0; runIndex < globalRuns; runIndex++) {
+            prb_StrFinder finder = prb_createStrFinder(spec);
+
+            prb_TimeStart refStart = prb_timeStart();
+            refCount = 0;
+            for (prb_StrFindResult find = findAnyCharReference(&finder, text); find.found; find = findAnyCharReference(&finder, find.afterMatch)) {
+                refCount += 1;
+            }
+            refMs = bestMs(runIndex, refMs, prb_getMsFrom(refStart));
+
+            prb_TimeStart start = prb_timeStart();
+            count = 0;
+            for (prb_StrFindResult find = prb_strFinderFind(&finder, text); find.found; find = prb_strFinderFind(&finder, find.afterMatch)) {
+                count += 1;
+            }
+            ms = bestMs(runIndex, ms, prb_getMsFrom(start));
+            prb_assert(count == refCount);
+        }
+
+        prb_Str shown = pattern.len > 12 ? prb_fmt(arena, "%d chars", pattern.len) : pattern;
+        report(arena, prb_fmt(arena, "reference any of '%.*s'", prb_LIT(shown)).ptr, refMs, text.len, refCount);
+        report(arena, prb_fmt(arena, "strFinderFind any of '%.*s'", prb_LIT(shown)).ptr, ms, text.len, count);
+    }
+}
+
+function void
+bench_lines(prb_Arena* arena, Inputs* inputs) {
+    prb_Str text = inputs->compilerOutput;
+
+    prb_StrFindSpec lineBreak = {};
+    lineBreak.mode = prb_StrFindMode_LineBreak;
+
+    i32   scannerLines = 0;
+    i32   refLines = 0;
+    i32   lines = 0;
+    float scannerMs = 0;
+    float refMs = 0;
+    float ms = 0;
+    for (i32 runIndex = 0; runIndex < globalRuns; runIndex++) {
+        prb_TimeStart  scannerStart = prb_timeStart();
+        prb_StrScanner scanner = prb_createStrScanner(text);
+        for (scannerLines = 0; prb_strScannerMove(&scanner, lineBreak, prb_StrScannerSide_AfterMatch); scannerLines++) {}
+        scannerMs = bestMs(runIndex, scannerMs, prb_getMsFrom(scannerStart));
+
+        // NOTE(khvorov) The same index with a byte at a time loop
+        prb_TempMemory     refTemp = prb_beginTempMemory(arena);
+        prb_TimeStart      refStart = prb_timeStart();
+        prb_lib_LineStarts refStarts = {};
+        refStarts.str = (const uint8_t*)text.ptr;
+        refStarts.strLen = text.len;
+        refStarts.starts = prb_arenaAllocArray(arena, i32, text.len + 1);
+        refStarts.cap = text.len + 1;
+        refStarts.starts[refStarts.count++] = 0;
+        prb_lib_addLineBreaksScalar(&refStarts, 0);
+        refLines = refStarts.count;
+        refMs = bestMs(runIndex, refMs, prb_getMsFrom(refStart));
+        prb_endTempMemory(refTemp);
+
+        prb_TempMemory temp = prb_beginTempMemory(arena);
+        prb_TimeStart  start = prb_timeStart();
+        prb_LineIndex  index = prb_buildLineIndex(arena, text);
+        lines = 0;
+        for (prb_LineIter iter = prb_createLineIter(&index); prb_lineIterNext(&iter);) {
+            lines += 1;
+        }
+        ms = bestMs(runIndex, ms, prb_getMsFrom(start));
+        prb_endTempMemory(temp);
+
+        prb_assert(scannerLines == refLines && lines == refLines);
+    }
+    report(arena, "strScannerMove every line", scannerMs, text.len, scannerLines);
+    report(arena, "scalar line index", refMs, text.len, refLines);
+    report(arena, "buildLineIndex and iterate", ms, text.len, lines);
+}
+
+function void
+bench_split(prb_Arena* arena, Inputs* inputs) {
+    // NOTE(khvorov) Whitespace-separated tokens the way args and flag lists are split, on a much bigger input
+    prb_Str text = inputs->compilerOutput;
+
+    prb_StrFindSpec spec = {};
+    spec.mode = prb_StrFindMode_AnyChar;
+    spec.pattern = prb_STR(" \n");
+    spec.alwaysMatchEnd = true;
+    prb_StrFinder finder = prb_createStrFinder(spec);
+
+    i32   scannerTokens = 0;
+    i32   tokens = 0;
+    float scannerMs = 0;
+    float ms = 0;
+    for (i32 runIndex = 0; runIndex < globalRuns; runIndex++) {
+        prb_TimeStart  scannerStart = prb_timeStart();
+        prb_StrScanner scanner = prb_createStrScanner(text);
+        scannerTokens = 0;
+        while (prb_strScannerMoveWith(&scanner, &finder, prb_StrScannerSide_AfterMatch)) {
+            scannerTokens += scanner.betweenLastMatches.len > 0;
+        }
+        scannerMs = bestMs(runIndex, scannerMs, prb_getMsFrom(scannerStart));
+
+        prb_TempMemory     temp = prb_beginTempMemory(arena);
+        prb_TimeStart      start = prb_timeStart();
+        prb_StrSplitResult split = prb_strSplit(arena, text, prb_STR(" \n"), prb_StrSplitFlag_SkipEmpty);
+        tokens = split.count;
+        ms = bestMs(runIndex, ms, prb_getMsFrom(start));
+        prb_endTempMemory(temp);
+
+        prb_assert(scannerTokens == tokens);
+    }
+    report(arena, "strScannerMoveWith every token", scannerMs, text.len, scannerTokens);
+    report(arena, "strSplit", ms, text.len, tokens);
+}
+
+function void
+bench_utf8(prb_Arena* arena, Inputs* inputs) {
+    prb_Str mixed = repeatUntil(arena, prb_STR("// 太阳 означает солнце, 😐 is a face\nint sun = 1;\n"), 8 * prb_MEGABYTE);
+    prb_Str texts[] = {inputs->preprocessed, mixed};
+    const char* textNames[] = {"source", "mixed"};
+
+    for (i32 textIndex = 0; textIndex < prb_arrayCount(texts); textIndex++) {
+        prb_Str text = texts[textIndex];
+
+        i32   refChars = 0;
+        i32   chars = 0;
+        float refMs = 0;
+        float validateMs = 0;
+        float ms = 0;
+        for (i32 runIndex = 0; runIndex < globalRuns; runIndex++) {
+            prb_TempMemory temp = prb_beginTempMemory(arena);
+
+            // NOTE(khvorov) What converting looked like before, one character per iterator step
+            prb_TimeStart refStart = prb_timeStart();
+            uint32_t*     refOut = prb_arenaAllocArray(arena, uint32_t, text.len);
+            refChars = 0;
+            for (prb_Utf8CharIter iter = prb_createUtf8CharIter(text, prb_StrDirection_FromStart); prb_utf8CharIterNext(&iter);) {
+                prb_assert(iter.curIsValid);
+                refOut[refChars++] = iter.curUtf32Char;
+            }
+            refMs = bestMs(runIndex, refMs, prb_getMsFrom(refStart));
+
+            prb_TimeStart validateStart = prb_timeStart();
+            prb_assert(prb_utf8Validate(text).valid);
+            validateMs = bestMs(runIndex, validateMs, prb_getMsFrom(validateStart));
+
+            prb_TimeStart   start = prb_timeStart();
+            prb_Utf32Result utf32 = prb_utf8ToUtf32(arena, text);
+            ms = bestMs(runIndex, ms, prb_getMsFrom(start));
+            chars = utf32.str.len;
+            prb_assert(utf32.valid && chars == refChars && prb_memeq(utf32.str.ptr, refOut, chars * (i32)sizeof(uint32_t)));
+
+            prb_endTempMemory(temp);
+        }
+        report(arena, prb_fmt(arena, "utf8CharIter %s", textNames[textIndex]).ptr, refMs, text.len, refChars);
+        report(arena, prb_fmt(arena, "utf8Validate %s", textNames[textIndex]).ptr, validateMs, text.len, chars);
+        report(arena, prb_fmt(arena, "utf8ToUtf32 %s", textNames[textIndex]).ptr, ms, text.len, chars);
+    }
+}
+
+function void
+bench_numbers(prb_Arena* arena) {
+    prb_Rng rng = prb_createRng(42);
+
+    // NOTE(khvorov) Columns like the ones in the static library log and in generated tables
+    prb_GrowingStr intsGstr = prb_beginStr(arena);
+    for (i32 index = 0; index < 1000000; index++) {
+        u64 value = ((u64)prb_randomU32(&rng) << 32) | prb_randomU32(&rng);
+        prb_addStrSegment(&intsGstr, "%llu,", (unsigned long long)(value >> prb_randomU32Bound(&rng, 64)));
+    }
+    prb_Str ints = prb_endStr(&intsGstr);
+
+    prb_GrowingStr floatsGstr = prb_beginStr(arena);
+    for (i32 index = 0; index < 1000000; index++) {
+        double value = (double)prb_randomU32(&rng) / (double)(prb_randomU32(&rng) | 1) * 1000.0;
+        prb_addStrSegment(&floatsGstr, index % 2 ? "%.17g," : "%.6f,", value);
+    }
+    prb_Str floats = prb_endStr(&floatsGstr);
+
+    prb_Str     texts[] = {ints, floats};
+    const char* textNames[] = {"integers", "floats"};
+    for (i32 textIndex = 0; textIndex < prb_arrayCount(texts); textIndex++) {
+        prb_Str text = texts[textIndex];
+        i32     refCount = 0;
+        i32     count = 0;
+        float   refMs = 0;
+        float   ms = 0;
+        for (i32 runIndex = 0; runIndex < globalRuns; runIndex++) {
+            // NOTE(khvorov) The C library parsing the same fields, the text ends with a delimiter
+            prb_TimeStart refStart = prb_timeStart();
+            double        refSum = 0;
+            refCount = 0;
+            for (char* at = (char*)text.ptr; at < text.ptr + text.len; at++) {
+                if (textIndex == 0) {
+                    refSum += (double)strtoull(at, &at, 10);
+                } else {
+                    refSum += strtod(at, &at);
+                }
+                refCount += 1;
+            }
+            refMs = bestMs(runIndex, refMs, prb_getMsFrom(refStart));
+
+            prb_TempMemory         temp = prb_beginTempMemory(arena);
+            prb_TimeStart          start = prb_timeStart();
+            prb_ParseNumbersResult parsed = prb_parseNumbers(arena, text, prb_STR(","));
+            ms = bestMs(runIndex, ms, prb_getMsFrom(start));
+            count = parsed.count;
+            prb_assert(parsed.success && count == refCount);
+            double sum = 0;
+            for (i32 index = 0; index < count; index++) {
+                sum += textIndex == 0 ? (double)parsed.numbers[index].parsedU64 : parsed.numbers[index].parsedF64;
+            }
+            prb_assert(sum == refSum);
+            prb_endTempMemory(temp);
+        }
+        report(arena, prb_fmt(arena, "libc %s", textNames[textIndex]).ptr, refMs, text.len, refCount);
+        report(arena, prb_fmt(arena, "parseNumbers %s", textNames[textIndex]).ptr, ms, text.len, count);
+    }
+}
+
+function void
+bench_appenders(prb_Arena* arena) {
+    // NOTE(khvorov) Pieces of a compile command and of a log row
+    prb_Str flags[] = {prb_STR("-Wall"), prb_STR("-Wextra"), prb_STR("-Isrc/include/some/deeper/directory"), prb_STR("-DSOME_DEFINE=1")};
+    prb_Rng rng = prb_createRng(42);
+    u64*    hashes = prb_arenaAllocArray(arena, u64, 100000);
+    for (i32 index = 0; index < 100000; index++) {
+        hashes[index] = ((u64)prb_randomU32(&rng) << 32) | prb_randomU32(&rng);
+    }
+
+    prb_Str fmtStr = {};
+    prb_Str str = {};
+    float   fmtMs = 0;
+    float   ms = 0;
+    for (i32 runIndex = 0; runIndex < globalRuns; runIndex++) {
+        prb_TempMemory temp = prb_beginTempMemory(arena);
+
+        prb_TimeStart  fmtStart = prb_timeStart();
+        prb_GrowingStr fmtGstr = prb_beginStr(arena);
+        for (i32 index = 0; index < 100000; index++) {
+            prb_Str flag = flags[index % prb_arrayCount(flags)];
+            prb_addStrSegment(&fmtGstr, " %.*s", prb_LIT(flag));
+            prb_addStrSegment(&fmtGstr, ",0x%llX,%d", (unsigned long long)hashes[index], index);
+        }
+        fmtStr = prb_endStr(&fmtGstr);
+        fmtMs = bestMs(runIndex, fmtMs, prb_getMsFrom(fmtStart));
+
+        prb_TimeStart  start = prb_timeStart();
+        prb_GrowingStr gstr = prb_beginStr(arena);
+        for (i32 index = 0; index < 100000; index++) {
+            prb_addChar(&gstr, ' ');
+            prb_addStr(&gstr, flags[index % prb_arrayCount(flags)]);
+            prb_addChar(&gstr, ',');
+            prb_addHex(&gstr, hashes[index]);
+            prb_addChar(&gstr, ',');
+            prb_addI64(&gstr, index, 10, 0);
+        }
+        str = prb_endStr(&gstr);
+        ms = bestMs(runIndex, ms, prb_getMsFrom(start));
+
+        prb_assert(prb_streq(str, fmtStr));
+        prb_endTempMemory(temp);
+    }
+    report(arena, "addStrSegment", fmtMs, fmtStr.len, 100000);
+    report(arena, "typed appenders", ms, str.len, 100000);
+}
+
+function void
+bench_embed(prb_Arena* arena) {
+    i32      dataLen = 20 * prb_MEGABYTE;
+    uint8_t* data = prb_arenaAllocArray(arena, uint8_t, dataLen);
+    prb_Rng  rng = prb_createRng(42);
+    for (i32 index = 0; index < dataLen; index++) {
+        data[index] = (uint8_t)prb_randomU32(&rng);
+    }
+
+    float fmtMs = 0;
+    float arrayMs = 0;
+    float stringMs = 0;
+    i32   arrayLen = 0;
+    i32   stringLen = 0;
+    for (i32 runIndex = 0; runIndex < globalRuns; runIndex++) {
+        prb_TempMemory temp = prb_beginTempMemory(arena);
+
+        // NOTE(khvorov) What prb_binaryToCArray used to do
+        prb_TimeStart  fmtStart = prb_timeStart();
+        prb_GrowingStr gstr = prb_beginStr(arena);
+        prb_addStrSegment(&gstr, "unsigned char data[] = {\n    ");
+        for (i32 byteIndex = 0; byteIndex < dataLen; byteIndex++) {
+            prb_addStrSegment(&gstr, "0x%x", data[byteIndex]);
+            if (byteIndex != dataLen - 1) {
+                prb_addStrSegment(&gstr, ",");
+                prb_addStrSegment(&gstr, (byteIndex + 1) % 10 == 0 ? "\n    " : " ");
+            } else {
+                prb_addStrSegment(&gstr, "\n");
+            }
+        }
+        prb_addStrSegment(&gstr, "};");
+        prb_Str fmtArray = prb_endStr(&gstr);
+        fmtMs = bestMs(runIndex, fmtMs, prb_getMsFrom(fmtStart));
+
+        prb_TimeStart arrayStart = prb_timeStart();
+        prb_Str       array = prb_binaryToCArray(arena, prb_STR("data"), data, dataLen);
+        arrayMs = bestMs(runIndex, arrayMs, prb_getMsFrom(arrayStart));
+        arrayLen = array.len;
+        prb_assert(prb_streq(array, fmtArray));
+
+        prb_TimeStart stringStart = prb_timeStart();
+        prb_Str       string = prb_binaryToCString(arena, prb_STR("data"), data, dataLen);
+        stringMs = bestMs(runIndex, stringMs, prb_getMsFrom(stringStart));
+        stringLen = string.len;
+
+        prb_endTempMemory(temp);
+    }
+    report(arena, "formatted C array", fmtMs, dataLen, arrayLen);
+    report(arena, "binaryToCArray", arrayMs, dataLen, arrayLen);
+    report(arena, "binaryToCString", stringMs, dataLen, stringLen);
+}
+
+typedef struct PathEntry {
+    char* key;
+    i32   value;
+} PathEntry;
+
+function void
+bench_intern(prb_Arena* arena) {
+    // NOTE(khvorov) Object paths looked up the way the static library pipeline does
+    i32      pathCount = 100000;
+    prb_Str* paths = prb_arenaAllocArray(arena, prb_Str, pathCount);
+    for (i32 index = 0; index < pathCount; index++) {
+        paths[index] = prb_fmt(arena, "build/debug/objects/some_library/source_file_%d.obj", index);
+    }
+
+    float shMs = 0;
+    float ms = 0;
+    i32   shFound = 0;
+    i32   found = 0;
+    for (i32 runIndex = 0; runIndex < globalRuns; runIndex++) {
+        prb_TempMemory temp = prb_beginTempMemory(arena);
+
+        PathEntry* map = 0;
+        sh_new_arena(map);
+        for (i32 index = 0; index < pathCount; index++) {
+            shput(map, (char*)paths[index].ptr, index);
+        }
+        prb_TimeStart shStart = prb_timeStart();
+        shFound = 0;
+        for (i32 lookup = 0; lookup < 10; lookup++) {
+            for (i32 index = 0; index < pathCount; index++) {
+                shFound += shgeti(map, (char*)paths[index].ptr) != -1;
+            }
+        }
+        shMs = bestMs(runIndex, shMs, prb_getMsFrom(shStart));
+        shfree(map);
+
+        prb_StrInterner interner = prb_createStrInterner(arena, prb_ThreadSafe_No);
+        for (i32 index = 0; index < pathCount; index++) {
+            prb_internStr(&interner, paths[index]);
+        }
+        prb_TimeStart start = prb_timeStart();
+        found = 0;
+        for (i32 lookup = 0; lookup < 10; lookup++) {
+            for (i32 index = 0; index < pathCount; index++) {
+                found += prb_findInternedStr(&interner, paths[index]) != 0;
+            }
+        }
+        ms = bestMs(runIndex, ms, prb_getMsFrom(start));
+
+        prb_assert(shFound == pathCount * 10 && found == pathCount * 10);
+        prb_endTempMemory(temp);
+    }
+    report(arena, "stb_ds string map lookups", shMs, 0, shFound);
+    report(arena, "interner lookups", ms, 0, found);
+}
+
+function void
+bench_strMap(prb_Arena* arena) {
+    // NOTE(khvorov) Keys are slices of a bigger string the way log and command line entries are,
+    // stb_ds needs them copied out and null-terminated
+    i32      pathCount = 100000;
+    prb_Str  joined = {};
+    prb_Str* paths = prb_arenaAllocArray(arena, prb_Str, pathCount);
+    {
+        prb_GrowingStr gstr = prb_beginStr(arena);
+        i32*           starts = 0;
+        for (i32 index = 0; index < pathCount; index++) {
+            arrput(starts, gstr.str.len);
+            prb_addStrSegment(&gstr, "build/debug/objects/some_library/source_file_%d.obj\n", index);
+        }
+        joined = prb_endStr(&gstr);
+        for (i32 index = 0; index < pathCount; index++) {
+            i32 end = index + 1 < pathCount ? starts[index + 1] - 1 : joined.len - 1;
+            paths[index] = prb_strSlice(joined, starts[index], end);
+        }
+        arrfree(starts);
+    }
+
+    float shMs = 0;
+    float ms = 0;
+    i32   shFound = 0;
+    i32   found = 0;
+    for (i32 runIndex = 0; runIndex < globalRuns; runIndex++) {
+        prb_TempMemory temp = prb_beginTempMemory(arena);
+
+        PathEntry* map = 0;
+        sh_new_arena(map);
+        for (i32 index = 0; index < pathCount; index++) {
+            shput(map, (char*)prb_strGetNullTerminated(arena, paths[index]), index);
+        }
+        prb_TimeStart shStart = prb_timeStart();
+        shFound = 0;
+        for (i32 lookup = 0; lookup < 10; lookup++) {
+            for (i32 index = 0; index < pathCount; index++) {
+                shFound += shgeti(map, (char*)prb_strGetNullTerminated(arena, paths[index])) != -1;
+            }
+        }
+        shMs = bestMs(runIndex, shMs, prb_getMsFrom(shStart));
+        shfree(map);
+
+        prb_StrMap strMap = prb_createStrMap(arena, 0);
+        for (i32 index = 0; index < pathCount; index++) {
+            prb_strMapAdd(&strMap, paths[index])->value = (u64)index;
+        }
+        prb_TimeStart start = prb_timeStart();
+        found = 0;
+        for (i32 lookup = 0; lookup < 10; lookup++) {
+            for (i32 index = 0; index < pathCount; index++) {
+                found += prb_strMapFind(&strMap, paths[index]) != 0;
+            }
+        }
+        ms = bestMs(runIndex, ms, prb_getMsFrom(start));
+
+        prb_assert(shFound == pathCount * 10 && found == pathCount * 10);
+        prb_endTempMemory(temp);
+    }
+    report(arena, "stb_ds string map lookups", shMs, 0, shFound);
+    report(arena, "strMap lookups", ms, 0, found);
+}
+
+typedef struct SharedMapJob {
+    prb_StrInterner*  interner;
+    prb_SharedStrMap* map;
+    prb_Str*          paths;
+    i32               pathCount;
+    i32               first;
+    i32               lookups;
+    i32               found;
+} SharedMapJob;
+
+// NOTE(khvorov) Memoization the way parallel jobs would share a cache: look up, add on a miss
+function void
+sharedMapJob(prb_Arena* arena, void* data) {
+    prb_unused(arena);
+    SharedMapJob* job = (SharedMapJob*)data;
+    job->found = 0;
+    for (i32 lookup = 0; lookup < job->lookups; lookup++) {
+        prb_Str path = job->paths[(job->first + lookup) % job->pathCount];
+        if (job->interner) {
+            job->found += prb_internStr(job->interner, path)->str.len == path.len;
+        } else {
+            prb_StrMapEntry* entry = prb_sharedStrMapFind(job->map, path);
+            if (!entry) {
+                entry = prb_sharedStrMapAdd(job->map, path, 1);
+            }
+            job->found += entry->key.len == path.len;
+        }
+    }
+}
+
+function void
+bench_sharedStrMap(prb_Arena* arena) {
+    i32      pathCount = 100000;
+    i32      totalLookups = 4000000;
+    prb_Str* paths = prb_arenaAllocArray(arena, prb_Str, pathCount);
+    for (i32 index = 0; index < pathCount; index++) {
+        paths[index] = prb_fmt(arena, "build/debug/objects/some_library/source_file_%d.obj", index);
+    }
+    prb_CoreCountResult cores = prb_getCoreCount(arena);
+    prb_assert(cores.success);
+
+    for (i32 threadCount = 1; threadCount <= prb_max(cores.cores, 1); threadCount *= 2) {
+        float lockedMs = 0;
+        float ms = 0;
+        i32   found = 0;
+        for (i32 runIndex = 0; runIndex < globalRuns; runIndex++) {
+            for (i32 shared = 0; shared < 2; shared++) {
+                prb_TempMemory   temp = prb_beginTempMemory(arena);
+                prb_Arena        mapArena = prb_createArenaFromArena(arena, 64 * prb_MEGABYTE);
+                prb_StrInterner  interner = prb_createStrInterner(&mapArena, prb_ThreadSafe_Yes);
+                prb_SharedStrMap map = prb_createSharedStrMap(&mapArena);
+                prb_Job*         jobs = prb_arenaAllocArray(arena, prb_Job, threadCount);
+                SharedMapJob*    jobData = prb_arenaAllocArray(arena, SharedMapJob, threadCount);
+                for (i32 jobIndex = 0; jobIndex < threadCount; jobIndex++) {
+                    jobData[jobIndex].interner = shared ? 0 : &interner;
+                    jobData[jobIndex].map = &map;
+                    jobData[jobIndex].paths = paths;
+                    jobData[jobIndex].pathCount = pathCount;
+                    jobData[jobIndex].first = jobIndex * (pathCount / threadCount);
+                    jobData[jobIndex].lookups = totalLookups / threadCount;
+                    jobs[jobIndex] = prb_createJob(sharedMapJob, jobData + jobIndex, arena, 0);
+                }
+
+                prb_TimeStart start = prb_timeStart();
+                prb_assert(prb_launchJobs(jobs, threadCount, prb_Background_Yes));
+                prb_assert(prb_waitForJobs(jobs, threadCount));
+                float jobsMs = prb_getMsFrom(start);
+
+                found = 0;
+                for (i32 jobIndex = 0; jobIndex < threadCount; jobIndex++) {
+                    found += jobData[jobIndex].found;
+                }
+                prb_assert(found == totalLookups / threadCount * threadCount);
+                if (shared) {
+                    ms = bestMs(runIndex, ms, jobsMs);
+                } else {
+                    lockedMs = bestMs(runIndex, lockedMs, jobsMs);
+                }
+                prb_endTempMemory(temp);
+            }
+        }
+        report(arena, prb_fmt(arena, "interner with one lock, %d threads", threadCount).ptr, lockedMs, 0, found);
+        report(arena, prb_fmt(arena, "sharedStrMap, %d threads", threadCount).ptr, ms, 0, found);
+    }
+}
+
+function int
+compareU64(const void* left, const void* right) {
+    u64 key1 = *(const u64*)left;
+    u64 key2 = *(const u64*)right;
+    int result = key1 < key2 ? -1 : key1 > key2;
+    return result;
+}
+
+function int
+compareStrs(const void* left, const void* right) {
+    prb_Str str1 = *(const prb_Str*)left;
+    prb_Str str2 = *(const prb_Str*)right;
+    int     result = prb_memcmp(str1.ptr, str2.ptr, (size_t)prb_min(str1.len, str2.len));
+    if (result == 0) {
+        result = str1.len < str2.len ? -1 : str1.len > str2.len;
+    }
+    return result;
+}
+
+function void
+bench_sort(prb_Arena* arena) {
+    prb_Rng rng = prb_createRng(1);
+
+    // NOTE(khvorov) Hashes and sizes, the kind of keys logs are ordered by
+    {
+        i32  count = 1000000;
+        u64* keys = prb_arenaAllocArray(arena, u64, count);
+        for (i32 index = 0; index < count; index++) {
+            keys[index] = ((u64)prb_randomU32(&rng) << 32) | prb_randomU32(&rng);
+        }
+        float qsortMs = 0;
+        float ms = 0;
+        for (i32 runIndex = 0; runIndex < globalRuns; runIndex++) {
+            prb_TempMemory temp = prb_beginTempMemory(arena);
+            u64*           qsorted = prb_arenaAllocArray(arena, u64, count);
+            u64*           sorted = prb_arenaAllocArray(arena, u64, count);
+            prb_memcpy(qsorted, keys, (size_t)count * sizeof(u64));
+            prb_memcpy(sorted, keys, (size_t)count * sizeof(u64));
+
+            prb_TimeStart qsortStart = prb_timeStart();
+            qsort(qsorted, (size_t)count, sizeof(u64), compareU64);
+            qsortMs = bestMs(runIndex, qsortMs, prb_getMsFrom(qsortStart));
+
+            prb_TimeStart start = prb_timeStart();
+            prb_sortU64(arena, sorted, 0, count);
+            ms = bestMs(runIndex, ms, prb_getMsFrom(start));
+
+            prb_assert(prb_memeq(qsorted, sorted, count * (i32)sizeof(u64)));
+            prb_endTempMemory(temp);
+        }
+        report(arena, "qsort u64", qsortMs, count * (i32)sizeof(u64), count);
+        report(arena, "sortU64", ms, count * (i32)sizeof(u64), count);
+    }
+
+    // NOTE(khvorov) A big tree listed in directory order, paths share long prefixes
+    {
+        i32      count = 200000;
+        prb_Str* paths = prb_arenaAllocArray(arena, prb_Str, count);
+        for (i32 index = 0; index < count; index++) {
+            paths[index] = prb_fmt(arena, "project/src/module_%d/sub_%d/file_%d.c", prb_randomU32Bound(&rng, 50), prb_randomU32Bound(&rng, 20), prb_randomU32(&rng));
+        }
+        float qsortMs = 0;
+        float ms = 0;
+        for (i32 runIndex = 0; runIndex < globalRuns; runIndex++) {
+            prb_TempMemory temp = prb_beginTempMemory(arena);
+            prb_Str*       qsorted = prb_arenaAllocArray(arena, prb_Str, count);
+            prb_Str*       sorted = prb_arenaAllocArray(arena, prb_Str, count);
+            prb_memcpy(qsorted, paths, (size_t)count * sizeof(prb_Str));
+            prb_memcpy(sorted, paths, (size_t)count * sizeof(prb_Str));
+
+            prb_TimeStart qsortStart = prb_timeStart();
+            qsort(qsorted, (size_t)count, sizeof(prb_Str), compareStrs);
+            qsortMs = bestMs(runIndex, qsortMs, prb_getMsFrom(qsortStart));
+
+            prb_TimeStart start = prb_timeStart();
+            prb_sortStrs(arena, sorted, count);
+            ms = bestMs(runIndex, ms, prb_getMsFrom(start));
+
+            for (i32 index = 0; index < count; index++) {
+                prb_assert(prb_streq(qsorted[index], sorted[index]));
+            }
+            prb_endTempMemory(temp);
+        }
+        report(arena, "qsort paths", qsortMs, 0, count);
+        report(arena, "sortStrs", ms, 0, count);
+    }
+}
+
+function void
+reportMemory(prb_Arena* arena, const char* name, intptr_t bytes) {
+    prb_writelnToStdout(arena, prb_fmt(arena, "%-50s %9.2fMB", name, (double)bytes / (double)(prb_MEGABYTE)));
+}
+
+function intptr_t
+pathTrieBytes(prb_PathTrie* trie) {
+    intptr_t result = arrlen(trie->nodes) * (intptr_t)sizeof(*trie->nodes) + arrlen(trie->names);
+    return result;
+}
+
+function void
+bench_pathTrie(prb_Arena* arena) {
+    // NOTE(khvorov) A directory on disk, the arena keeps every listing and joined path for prb_getAllDirEntries
+    {
+        prb_Str dir = prb_pathJoin(arena, prb_getParentDir(arena, prb_STR(__FILE__)), prb_STR("bench-pathtrie"));
+        prb_assert(prb_clearDir(arena, dir));
+        for (i32 moduleIndex = 0; moduleIndex < 20; moduleIndex++) {
+            for (i32 subIndex = 0; subIndex < 10; subIndex++) {
+                prb_Str subdir = prb_fmt(arena, "%.*s/source/module_%d/sub_%d", prb_LIT(dir), moduleIndex, subIndex);
+                prb_assert(prb_createDirIfNotExists(arena, subdir));
+                for (i32 fileIndex = 0; fileIndex < 50; fileIndex++) {
+                    prb_Str file = prb_fmt(arena, "%.*s/file_%d.cpp", prb_LIT(subdir), fileIndex);
+                    prb_assert(prb_writeEntireFile(arena, file, 0, 0));
+                }
+            }
+        }
+
+        float    entriesMs = 0;
+        float    trieMs = 0;
+        intptr_t entriesBytes = 0;
+        intptr_t trieBytes = 0;
+        i32      count = 0;
+        for (i32 runIndex = 0; runIndex < globalRuns; runIndex++) {
+            prb_TempMemory temp = prb_beginTempMemory(arena);
+            prb_TimeStart  entriesStart = prb_timeStart();
+            prb_Str*       entries = prb_getAllDirEntries(arena, dir, prb_Recursive_Yes);
+            entriesMs = bestMs(runIndex, entriesMs, prb_getMsFrom(entriesStart));
+            entriesBytes = arena->used - temp.usedAtBegin + arrlen(entries) * (intptr_t)sizeof(prb_Str);
+            count = (i32)arrlen(entries);
+            arrfree(entries);
+            prb_endTempMemory(temp);
+
+            temp = prb_beginTempMemory(arena);
+            prb_TimeStart trieStart = prb_timeStart();
+            prb_PathTrie  trie = prb_getAllDirEntriesTrie(arena, dir, prb_Recursive_Yes);
+            trieMs = bestMs(runIndex, trieMs, prb_getMsFrom(trieStart));
+            trieBytes = arena->used - temp.usedAtBegin + pathTrieBytes(&trie);
+            prb_assert(arrlen(trie.nodes) == count + 2);
+            arrfree(trie.nodes);
+            arrfree(trie.names);
+            prb_endTempMemory(temp);
+        }
+        report(arena, "getAllDirEntries", entriesMs, 0, count);
+        report(arena, "getAllDirEntriesTrie", trieMs, 0, count);
+        reportMemory(arena, "getAllDirEntries memory", entriesBytes);
+        reportMemory(arena, "getAllDirEntriesTrie memory", trieBytes);
+
+        prb_assert(prb_removePathIfExists(arena, dir));
+    }
+
+    // NOTE(khvorov) A deep tree about the size of a big vendored dependency
+    {
+        prb_Rng  rng = prb_createRng(1);
+        i32      count = 400000;
+        prb_Str* paths = prb_arenaAllocArray(arena, prb_Str, count);
+        intptr_t pathsBytes = count * (intptr_t)sizeof(prb_Str);
+        for (i32 index = 0; index < count; index++) {
+            paths[index] = prb_fmt(
+                arena,
+                "third_party/icu4c/source/%s/module_%d/sub_%d/file_%d.cpp",
+                index % 4 == 0 ? "common" : "i18n",
+                prb_randomU32Bound(&rng, 100),
+                prb_randomU32Bound(&rng, 20),
+                index
+            );
+            pathsBytes += paths[index].len;
+        }
+        prb_Str prefix = prb_STR("third_party/icu4c/source/common");
+
+        float        createMs = 0;
+        float        scanMs = 0;
+        float        findMs = 0;
+        float        toBytesMs = 0;
+        float        parseMs = 0;
+        i32          underPrefix = 0;
+        prb_PathTrie trie = {};
+        prb_Bytes    bytes = {};
+        for (i32 runIndex = 0; runIndex < globalRuns; runIndex++) {
+            arrfree(trie.nodes);
+            arrfree(trie.names);
+            prb_TimeStart createStart = prb_timeStart();
+            trie = prb_createPathTrie(arena, paths, count);
+            createMs = bestMs(runIndex, createMs, prb_getMsFrom(createStart));
+
+            prb_Str       prefixDir = prb_fmt(arena, "%.*s/", prb_LIT(prefix));
+            prb_TimeStart scanStart = prb_timeStart();
+            i32           scanned = 0;
+            for (i32 index = 0; index < count; index++) {
+                scanned += prb_strStartsWith(paths[index], prefixDir);
+            }
+            scanMs = bestMs(runIndex, scanMs, prb_getMsFrom(scanStart));
+
+            prb_TimeStart findStart = prb_timeStart();
+            i32           node = prb_pathTrieFind(&trie, prefix);
+            i32           files = 0;
+            for (i32 child = node + 1; child < node + trie.nodes[node].subtreeCount; child++) {
+                files += trie.nodes[child].subtreeCount == 1;
+            }
+            findMs = bestMs(runIndex, findMs, prb_getMsFrom(findStart));
+            prb_assert(files == scanned);
+            underPrefix = files;
+
+            prb_TempMemory temp = prb_beginTempMemory(arena);
+            prb_TimeStart  toBytesStart = prb_timeStart();
+            bytes = prb_pathTrieToBytes(arena, &trie);
+            toBytesMs = bestMs(runIndex, toBytesMs, prb_getMsFrom(toBytesStart));
+
+            prb_TimeStart           parseStart = prb_timeStart();
+            prb_PathTrieParseResult parsed = prb_parsePathTrie(bytes);
+            parseMs = bestMs(runIndex, parseMs, prb_getMsFrom(parseStart));
+            prb_assert(parsed.success && arrlen(parsed.trie.nodes) == arrlen(trie.nodes));
+            arrfree(parsed.trie.nodes);
+            arrfree(parsed.trie.names);
+            prb_endTempMemory(temp);
+        }
+        report(arena, "createPathTrie", createMs, 0, count);
+        report(arena, "prefix scan over paths", scanMs, 0, underPrefix);
+        report(arena, "pathTrieFind + subtree", findMs, 0, underPrefix);
+        report(arena, "pathTrieToBytes", toBytesMs, bytes.len, count);
+        report(arena, "parsePathTrie", parseMs, bytes.len, count);
+        reportMemory(arena, "paths memory", pathsBytes);
+        reportMemory(arena, "path trie memory", pathTrieBytes(&trie));
+        reportMemory(arena, "path trie serialized", bytes.len);
+        arrfree(trie.nodes);
+        arrfree(trie.names);
+    }
+}
+
+function void
+benchMultiFindSet(prb_Arena* arena, prb_Str str, prb_Str* patterns, i32 patternsCount, const char* refName, const char* name) {
+    float refMs = 0;
+    float ms = 0;
+    i32   refMatches = 0;
+    i32   matches = 0;
+    for (i32 runIndex = 0; runIndex < globalRuns; runIndex++) {
+        prb_TempMemory temp = prb_beginTempMemory(arena);
+
+        prb_TimeStart refStart = prb_timeStart();
+        refMatches = 0;
+        for (i32 patIndex = 0; patIndex < patternsCount; patIndex++) {
+            refMatches += countStrFind(str, patterns[patIndex]);
+        }
+        refMs = bestMs(runIndex, refMs, prb_getMsFrom(refStart));
+
+        prb_TimeStart       start = prb_timeStart();
+        prb_MultiFinder     finder = prb_createMultiFinder(arena, patterns, patternsCount);
+        prb_MultiFindResult result = prb_multiFinderFindAll(arena, &finder, str);
+        ms = bestMs(runIndex, ms, prb_getMsFrom(start));
+        matches = result.count;
+
+        prb_assert(refMatches == matches);
+        prb_endTempMemory(temp);
+    }
+    report(arena, refName, refMs, str.len, refMatches);
+    report(arena, name, ms, str.len, matches);
+}
+
+function void
+bench_multiFind(prb_Arena* arena, Inputs* inputs) {
+    // NOTE(khvorov) Diagnostic kinds are a handful of patterns, file names are enough to need the automaton
+    prb_Str kinds[] = {prb_STR("error:"), prb_STR("warning:"), prb_STR("note:")};
+    benchMultiFindSet(arena, inputs->compilerOutput, kinds, prb_arrayCount(kinds), "strFind per diagnostic kind", "multiFinder diagnostic kinds");
+
+    i32      fileCount = 200;
+    prb_Str* files = prb_arenaAllocArray(arena, prb_Str, fileCount);
+    for (i32 index = 0; index < fileCount; index++) {
+        files[index] = prb_fmt(arena, "/file%d.c:", index);
+    }
+    benchMultiFindSet(arena, inputs->compilerOutput, files, fileCount, "strFind per file name", "multiFinder file names");
+}
+
+function void
+bench_regex(prb_Arena* arena) {
+    // NOTE(khvorov) Directory walk filtering by extension, on a million paths
+    i32         pathCount = 1000000;
+    const char* exts[] = {"c", "h", "cpp", "obj", "gcda", "txt", "exe", "cc"};
+    prb_Str*    paths = prb_arenaAllocArray(arena, prb_Str, pathCount);
+    for (i32 index = 0; index < pathCount; index++) {
+        paths[index] = prb_fmt(arena, "project/src/module_%d/sub/file_%d.%s", index % 97, index, exts[index % prb_arrayCount(exts)]);
+    }
+
+    prb_Regex* regex = prb_compileRegex(arena, prb_STR("\\.(c|h|cpp|cc)$"), 0).regex;
+
+    float refMs = 0;
+    float ms = 0;
+    i32   refMatches = 0;
+    i32   matches = 0;
+    for (i32 runIndex = 0; runIndex < globalRuns; runIndex++) {
+        prb_TimeStart refStart = prb_timeStart();
+        refMatches = 0;
+        for (i32 index = 0; index < pathCount; index++) {
+            prb_Str path = paths[index];
+            refMatches += prb_strEndsWith(path, prb_STR(".c"))
+                || prb_strEndsWith(path, prb_STR(".h"))
+                || prb_strEndsWith(path, prb_STR(".cpp"))
+                || prb_strEndsWith(path, prb_STR(".cc"));
+        }
+        refMs = bestMs(runIndex, refMs, prb_getMsFrom(refStart));
+
+        prb_TimeStart start = prb_timeStart();
+        matches = 0;
+        for (i32 index = 0; index < pathCount; index++) {
+            matches += prb_regexFind(regex, paths[index]).found;
+        }
+        ms = bestMs(runIndex, ms, prb_getMsFrom(start));
+
+        prb_assert(refMatches == matches);
+    }
+    report(arena, "strEndsWith per extension", refMs, 0, refMatches);
+    report(arena, "regexFind", ms, 0, matches);
+}
+
+int
+main() {
+    prb_Arena  arena_ = prb_createArenaFromVmem(1 * prb_GIGABYTE);
+    prb_Arena* arena = &arena_;
+
+    prb_Str* args = prb_getCmdArgs(arena);
+    prb_Str  only = arrlen(args) >= 2 ? args[1] : prb_STR("");
+    Inputs   inputs = getInputs(arena);
+
+    if (only.len == 0 || prb_streq(only, prb_STR("strFind"))) {
+        bench_strFind(arena, &inputs);
+    }
+    if (only.len == 0 || prb_streq(only, prb_STR("strFinder"))) {
+        bench_strFinder(arena, &inputs);
+    }
+    if (only.len == 0 || prb_streq(only, prb_STR("anyChar"))) {
+        bench_anyChar(arena, &inputs);
+    }
+    if (only.len == 0 || prb_streq(only, prb_STR("lines"))) {
+        bench_lines(arena, &inputs);
+    }
+    if (only.len == 0 || prb_streq(only, prb_STR("split"))) {
+        bench_split(arena, &inputs);
+    }
+    if (only.len == 0 || prb_streq(only, prb_STR("utf8"))) {
+        bench_utf8(arena, &inputs);
+    }
+    if (only.len == 0 || prb_streq(only, prb_STR("numbers"))) {
+        bench_numbers(arena);
+    }
+    if (only.len == 0 || prb_streq(only, prb_STR("appenders"))) {
+        bench_appenders(arena);
+    }
+    if (only.len == 0 || prb_streq(only, prb_STR("intern"))) {
+        bench_intern(arena);
+    }
+    if (only.len == 0 || prb_streq(only, prb_STR("strMap"))) {
+        bench_strMap(arena);
+    }
+    if (only.len == 0 || prb_streq(only, prb_STR("sharedStrMap"))) {
+        bench_sharedStrMap(arena);
+    }
+    if (only.len == 0 || prb_streq(only, prb_STR("sort"))) {
+        bench_sort(arena);
+    }
+    if (only.len == 0 || prb_streq(only, prb_STR("pathTrie"))) {
+        bench_pathTrie(arena);
+    }
+    if (only.len == 0 || prb_streq(only, prb_STR("embed"))) {
+        bench_embed(arena);
+    }
+    if (only.len == 0 || prb_streq(only, prb_STR("multiFind"))) {
+        bench_multiFind(arena, &inputs);
+    }
+    if (only.len == 0 || prb_streq(only, prb_STR("regex"))) {
+        bench_regex(arena);
+    }
+}
@@ -6,8 +6,11 @@ set SHELL_BAT=%SCRIPT_DIR%\shell.bat
 if exist %SHELL_BAT% call %SHELL_BAT%
 
 set RUN_BIN=%SCRIPT_DIR%\run.exe
+rem The binary rebuilds itself when run.c or cbuild.h change
+if exist %RUN_BIN% goto run
 clang -g -Wall -Wextra -Werror -Wfatal-errors %SCRIPT_DIR%\run.c -o %RUN_BIN% -Xlinker /incremental:no
 if %ERRORLEVEL% NEQ 0 (
   EXIT /B
 )
+:run
 %RUN_BIN% %*
\ No newline at end of file
@@ -240,10 +240,12 @@ main() {
     prb_TimeStart scriptStart = prb_timeStart();
     prb_Arena     arena_ = prb_createArenaFromVmem(1 * prb_GIGABYTE);
     prb_Arena*    arena = &arena_;
+    prb_rebuildSelfIfChanged(arena, prb_STR(__FILE__), prb_STR("-g -Wall -Wextra -Werror -Wfatal-errors"));
 
     prb_Str* args = prb_getCmdArgs(arena);
     bool     runAllTests = arrlen(args) >= 2 && prb_streq(args[1], prb_STR("all"));
     bool     runningOnCi = arrlen(args) >= 2 && prb_streq(args[1], prb_STR("ci"));
+    bool     runBench = arrlen(args) >= 2 && prb_streq(args[1], prb_STR("bench"));
 
     globalTestsDir = prb_getParentDir(arena, prb_STR(__FILE__));
     prb_Str rootDir = prb_getParentDir(arena, globalTestsDir);
@@ -257,29 +259,27 @@ main() {
 
     // NOTE(khvorov) Remove artifacts
     {
-        prb_Str* entries = prb_getAllDirEntries(arena, globalTestsDir, prb_Recursive_No);
+        prb_Regex* keep = prb_compileRegex(arena, prb_STR("run\\.(exe|pdb)$"), 0).regex;
+        prb_Regex* artifact = prb_compileRegex(arena, prb_STR("\\.(gcda|gcno|exe|pdb|obj|exp|lib|log|supp)$|^coverage"), 0).regex;
+        prb_Str*   entries = prb_getAllDirEntries(arena, globalTestsDir, prb_Recursive_No);
         for (i32 entryIndex = 0; entryIndex < arrlen(entries); entryIndex++) {
             prb_Str entry = entries[entryIndex];
-            prb_Str entryName = prb_getLastEntryInPath(entry);
-            if (!prb_strEndsWith(entry, prb_STR("run.exe")) && !prb_strEndsWith(entry, prb_STR("run.pdb"))) {
-                bool remove = prb_strEndsWith(entry, prb_STR(".gcda"))
-                    || prb_strEndsWith(entry, prb_STR(".gcno"))
-                    || prb_strEndsWith(entry, prb_STR(".exe"))
-                    || prb_strEndsWith(entry, prb_STR(".pdb"))
-                    || prb_strEndsWith(entry, prb_STR(".obj"))
-                    || prb_strEndsWith(entry, prb_STR(".exp"))
-                    || prb_strEndsWith(entry, prb_STR(".lib"))
-                    || prb_strEndsWith(entry, prb_STR(".log"))
-                    || prb_strEndsWith(entry, prb_STR(".supp"))
-                    || prb_strStartsWith(entryName, prb_STR("coverage"));
-                if (remove) {
-                    prb_assert(prb_removePathIfExists(arena, entry));
-                }
+            if (!prb_regexFind(keep, entry).found && prb_regexFind(artifact, prb_getLastEntryInPath(entry)).found) {
+                prb_assert(prb_removePathIfExists(arena, entry));
             }
         }
     }
 
-    if (!runAllTests && !runningOnCi) {
+    if (runBench) {
+        // NOTE(khvorov) Optionally followed by the name of the one benchmark to run
+        CompileSpec spec = {};
+        spec.flags = prb_STR("-O2");
+        spec.input = prb_pathJoin(arena, globalTestsDir, prb_STR("bench.c"));
+        spec.output = prb_replaceExt(arena, spec.input, prb_STR("exe"));
+        prb_assert(execCmd(arena, constructCompileCmd(arena, spec)));
+        prb_Str only = arrlen(args) >= 3 ? args[2] : prb_STR("");
+        prb_assert(execCmd(arena, prb_fmt(arena, "%.*s %.*s", prb_LIT(spec.output), prb_LIT(only))));
+    } else if (!runAllTests && !runningOnCi) {
         // NOTE(khvorov) Fast path to avoid waiting for the full suite
         TestJobSpec spec = {};
         spec.doNotRedirect = true;
@@ -485,26 +485,23 @@ main() {
 
             prb_Str buildModeArgs[] = {prb_STR("debug"), prb_STR("release")};
 
-            for (i32 compArgIndex = 0; compArgIndex < prb_arrayCount(compilerArgs); compArgIndex++) {
-                prb_Str compilerArg = compilerArgs[compArgIndex];
-                for (i32 buildModeArgIndex = 0; buildModeArgIndex < prb_arrayCount(buildModeArgs); buildModeArgIndex++) {
-                    prb_Str buildModeArg = buildModeArgs[buildModeArgIndex];
-
-                    // NOTE(khvorov) Remove fribidi to make sure we can generate the tables with any compiler/mode settings
-                    prb_Str fribidiDir = prb_pathJoin(arena, exampleDir, prb_STR("fribidi"));
-                    prb_assert(prb_removePathIfExists(arena, fribidiDir));
-
-                    prb_Str cmd = prb_fmt(arena, "%.*s %.*s %.*s", prb_LIT(spec.output), prb_LIT(compilerArg), prb_LIT(buildModeArg));
-                    if (runningOnCi) {
-                        cmd = prb_fmt(arena, "%.*s ci", prb_LIT(cmd));
-                    }
-                    prb_assert(execCmd(arena, cmd));
-                    // NOTE(khvorov) Compile again to make sure incremental compilation code executes
-                    prb_assert(execCmd(arena, cmd));
+            // NOTE(khvorov) Every compiler/mode combination is built by one process so that downloading,
+            // source discovery and the compile slots are shared
+            {
+                // NOTE(khvorov) Remove fribidi to make sure we can generate the tables
+                prb_Str fribidiDir = prb_pathJoin(arena, exampleDir, prb_STR("fribidi"));
+                prb_assert(prb_removePathIfExists(arena, fribidiDir));
 
-                    // NOTE(khvorov) Make sure the path is what I expect it to be
-                    prb_assert(prb_isDir(arena, fribidiDir));
+                prb_Str cmd = prb_fmt(arena, "%.*s matrix", prb_LIT(spec.output));
+                if (runningOnCi) {
+                    cmd = prb_fmt(arena, "%.*s ci", prb_LIT(cmd));
                 }
+                prb_assert(execCmd(arena, cmd));
+                // NOTE(khvorov) Compile again to make sure incremental compilation code executes
+                prb_assert(execCmd(arena, cmd));
+
+                // NOTE(khvorov) Make sure the path is what I expect it to be
+                prb_assert(prb_isDir(arena, fribidiDir));
             }
 
             // NOTE(khvorov) Check that the build scripts work
@@ -549,6 +546,7 @@ main() {
         // NOTE(khvorov) Print sanitizer output
         {
             prb_Str* entries = prb_getAllDirEntries(arena, globalTestsDir, prb_Recursive_Yes);
+            prb_sortStrs(arena, entries, arrlen(entries));
             for (i32 entryIndex = 0; entryIndex < arrlen(entries); entryIndex++) {
                 prb_Str entry = entries[entryIndex];
                 if (prb_strEndsWith(entry, prb_STR(".log"))) {
@@ -1,3 +1,4 @@
 SCRIPT_DIR=$(dirname "$0")
 RUN_BIN=$SCRIPT_DIR/run.bin
-clang -g -Wall -Wextra -Werror -Wfatal-errors $SCRIPT_DIR/run.c -o $RUN_BIN -lpthread && $RUN_BIN $@
\ No newline at end of file
+# NOTE(khvorov) The binary rebuilds itself when run.c or cbuild.h change
+([ -f $RUN_BIN ] || clang -g -Wall -Wextra -Werror -Wfatal-errors $SCRIPT_DIR/run.c -o $RUN_BIN -lpthread) && $RUN_BIN $@
\ No newline at end of file
@@ -7,6 +7,12 @@
 
 #include "../cbuild.h"
 
+#if prb_PLATFORM_LINUX
+#include <regex.h>
+#include <sys/prctl.h>
+#include <signal.h>
+#endif
+
 #define function static
 #define global_variable static
 
@@ -47,9 +53,44 @@ testNameToPrbName(prb_Arena* arena, prb_Str testName, prb_Str** prbNames) {
     } else if (prb_streq(testName, prb_STR("test_utf8CharIter"))) {
         arrput(*prbNames, prb_STR("prb_createUtf8CharIter"));
         arrput(*prbNames, prb_STR("prb_utf8CharIterNext"));
+    } else if (prb_streq(testName, prb_STR("test_utf32"))) {
+        arrput(*prbNames, prb_STR("prb_utf8ToUtf32"));
+        arrput(*prbNames, prb_STR("prb_utf32ToUtf8"));
+    } else if (prb_streq(testName, prb_STR("test_utf16"))) {
+        arrput(*prbNames, prb_STR("prb_utf8ToUtf16"));
+        arrput(*prbNames, prb_STR("prb_utf16ToUtf8"));
     } else if (prb_streq(testName, prb_STR("test_strScanner"))) {
         arrput(*prbNames, prb_STR("prb_createStrScanner"));
         arrput(*prbNames, prb_STR("prb_strScannerMove"));
+        arrput(*prbNames, prb_STR("prb_strScannerMoveWith"));
+    } else if (prb_streq(testName, prb_STR("test_lineIndex"))) {
+        arrput(*prbNames, prb_STR("prb_buildLineIndex"));
+        arrput(*prbNames, prb_STR("prb_createLineIter"));
+        arrput(*prbNames, prb_STR("prb_lineIterNext"));
+    } else if (prb_streq(testName, prb_STR("test_strFinder"))) {
+        arrput(*prbNames, prb_STR("prb_createStrFinder"));
+        arrput(*prbNames, prb_STR("prb_strFinderFind"));
+    } else if (prb_streq(testName, prb_STR("test_strInterner"))) {
+        arrput(*prbNames, prb_STR("prb_createStrInterner"));
+        arrput(*prbNames, prb_STR("prb_internStr"));
+        arrput(*prbNames, prb_STR("prb_findInternedStr"));
+    } else if (prb_streq(testName, prb_STR("test_strMap"))) {
+        arrput(*prbNames, prb_STR("prb_createStrMap"));
+        arrput(*prbNames, prb_STR("prb_strMapAdd"));
+        arrput(*prbNames, prb_STR("prb_strMapAddHashed"));
+        arrput(*prbNames, prb_STR("prb_strMapFind"));
+        arrput(*prbNames, prb_STR("prb_strMapFindHashed"));
+    } else if (prb_streq(testName, prb_STR("test_sharedStrMap"))) {
+        arrput(*prbNames, prb_STR("prb_createSharedStrMap"));
+        arrput(*prbNames, prb_STR("prb_sharedStrMapAdd"));
+        arrput(*prbNames, prb_STR("prb_sharedStrMapFind"));
+    } else if (prb_streq(testName, prb_STR("test_multiFinder"))) {
+        arrput(*prbNames, prb_STR("prb_createMultiFinder"));
+        arrput(*prbNames, prb_STR("prb_multiFinderFindAll"));
+    } else if (prb_streq(testName, prb_STR("test_regex"))) {
+        arrput(*prbNames, prb_STR("prb_compileRegex"));
+        arrput(*prbNames, prb_STR("prb_regexMatch"));
+        arrput(*prbNames, prb_STR("prb_regexFind"));
     } else if (prb_streq(testName, prb_STR("test_pathEntryIter"))) {
         arrput(*prbNames, prb_STR("prb_createPathEntryIter"));
         arrput(*prbNames, prb_STR("prb_pathEntryIterNext"));
@@ -73,9 +114,24 @@ testNameToPrbName(prb_Arena* arena, prb_Str testName, prb_Str** prbNames) {
     } else if (prb_streq(testName, prb_STR("test_getAllDirEntries"))) {
         arrput(*prbNames, prb_STR("prb_getAllDirEntriesCustomBuffer"));
         arrput(*prbNames, prb_STR("prb_getAllDirEntries"));
+    } else if (prb_streq(testName, prb_STR("test_pathTrie"))) {
+        arrput(*prbNames, prb_STR("prb_getAllDirEntriesTrie"));
+        arrput(*prbNames, prb_STR("prb_createPathTrie"));
+        arrput(*prbNames, prb_STR("prb_pathTrieGetName"));
+        arrput(*prbNames, prb_STR("prb_pathTrieGetPath"));
+        arrput(*prbNames, prb_STR("prb_pathTrieFind"));
+        arrput(*prbNames, prb_STR("prb_pathTrieToBytes"));
+        arrput(*prbNames, prb_STR("prb_parsePathTrie"));
     } else if (prb_streq(testName, prb_STR("test_growingStr"))) {
         arrput(*prbNames, prb_STR("prb_beginStr"));
+        arrput(*prbNames, prb_STR("prb_beginChunkedStr"));
         arrput(*prbNames, prb_STR("prb_addStrSegment"));
+        arrput(*prbNames, prb_STR("prb_addStr"));
+        arrput(*prbNames, prb_STR("prb_addChar"));
+        arrput(*prbNames, prb_STR("prb_addU64"));
+        arrput(*prbNames, prb_STR("prb_addI64"));
+        arrput(*prbNames, prb_STR("prb_addHex"));
+        arrput(*prbNames, prb_STR("prb_addF64"));
         arrput(*prbNames, prb_STR("prb_endStr"));
     } else if (prb_streq(testName, prb_STR("test_executionOnCores"))) {
         arrput(*prbNames, prb_STR("prb_getCoreCount"));
@@ -84,6 +140,14 @@ testNameToPrbName(prb_Arena* arena, prb_Str testName, prb_Str** prbNames) {
     } else if (prb_streq(testName, prb_STR("test_fmt"))) {
         arrput(*prbNames, prb_STR("prb_vfmtCustomBuffer"));
         arrput(*prbNames, prb_STR("prb_fmt"));
+    } else if (prb_streq(testName, prb_STR("test_remoteExecution"))) {
+        arrput(*prbNames, prb_STR("prb_executeActions"));
+        arrput(*prbNames, prb_STR("prb_runWorker"));
+        arrput(*prbNames, prb_STR("prb_stopWorker"));
+    } else if (prb_streq(testName, prb_STR("test_staticLibs"))) {
+        arrput(*prbNames, prb_STR("prb_createStaticLib"));
+        arrput(*prbNames, prb_STR("prb_compileStaticLibs"));
+        arrput(*prbNames, prb_STR("prb_explainStaticLibs"));
     } else if (prb_streq(testName, prb_STR("test_timer"))) {
         arrput(*prbNames, prb_STR("prb_timeStart"));
         arrput(*prbNames, prb_STR("prb_getMsFrom"));
@@ -1059,6 +1123,108 @@ test_getAllDirEntries(prb_Arena* arena) {
     prb_endTempMemory(temp);
 }
 
+function void
+test_pathTrie(prb_Arena* arena) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+
+    {
+        prb_Str paths[] = {
+            prb_STR("a/b/x"),
+            prb_STR("a/b.c"),
+            prb_STR("a/b"),
+            prb_STR("a//b/y/"),
+            prb_STR("a/b/x"),
+            prb_STR("/abs/file"),
+            prb_STR("c"),
+        };
+        prb_PathTrie trie = prb_createPathTrie(arena, paths, prb_arrayCount(paths));
+
+        const char* expected[] = {"", "/", "/abs", "/abs/file", "a", "a/b", "a/b/x", "a/b/y", "a/b.c", "c"};
+        prb_assert(arrlen(trie.nodes) == prb_arrayCount(expected));
+        for (i32 node = 0; node < arrlen(trie.nodes); node++) {
+            prb_assert(prb_streq(prb_pathTrieGetPath(arena, &trie, node), prb_STR(expected[node])));
+        }
+        prb_assert(prb_streq(prb_pathTrieGetName(&trie, 3), prb_STR("file")));
+        prb_assert(trie.nodes[0].subtreeCount == prb_arrayCount(expected));
+
+        i32 ab = prb_pathTrieFind(&trie, prb_STR("a/b"));
+        prb_assert(ab == 5 && trie.nodes[ab].subtreeCount == 3);
+        prb_assert(prb_pathTrieFind(&trie, prb_STR("a//b/")) == ab);
+        prb_assert(prb_pathTrieFind(&trie, prb_STR("/abs/file")) == 3);
+        prb_assert(prb_pathTrieFind(&trie, prb_STR("a/b.c")) == 8);
+        prb_assert(prb_pathTrieFind(&trie, prb_STR("")) == 0);
+        prb_assert(prb_pathTrieFind(&trie, prb_STR("a/bb")) == -1);
+        prb_assert(prb_pathTrieFind(&trie, prb_STR("abs")) == -1);
+
+        prb_Bytes               bytes = prb_pathTrieToBytes(arena, &trie);
+        prb_PathTrieParseResult parsed = prb_parsePathTrie(bytes);
+        prb_assert(parsed.success);
+        prb_assert(arrlen(parsed.trie.nodes) == arrlen(trie.nodes) && arrlen(parsed.trie.names) == arrlen(trie.names));
+        prb_assert(prb_memeq(parsed.trie.nodes, trie.nodes, (i32)(arrlen(trie.nodes) * sizeof(*trie.nodes))));
+        prb_assert(prb_memeq(parsed.trie.names, trie.names, (i32)arrlen(trie.names)));
+        arrfree(parsed.trie.nodes);
+        arrfree(parsed.trie.names);
+
+        for (i32 len = 0; len < bytes.len; len++) {
+            prb_Bytes truncated = {bytes.data, len};
+            prb_assert(!prb_parsePathTrie(truncated).success);
+        }
+        // NOTE(khvorov) Subtree of the root's first child claims more nodes than there are
+        bytes.data[5] = 100;
+        prb_assert(!prb_parsePathTrie(bytes).success);
+
+        arrfree(trie.nodes);
+        arrfree(trie.names);
+    }
+
+    {
+        prb_PathTrie trie = prb_createPathTrie(arena, 0, 0);
+        prb_assert(arrlen(trie.nodes) == 1 && trie.nodes[0].subtreeCount == 1);
+        prb_PathTrieParseResult parsed = prb_parsePathTrie(prb_pathTrieToBytes(arena, &trie));
+        prb_assert(parsed.success && arrlen(parsed.trie.nodes) == 1);
+        arrfree(parsed.trie.nodes);
+        arrfree(trie.nodes);
+    }
+
+    // NOTE(khvorov) Same entries as prb_getAllDirEntries
+    prb_Str dir = getTempPath(arena, __FUNCTION__);
+    prb_assert(prb_clearDir(arena, dir) == prb_Success);
+    const char* files[] = {"f1.c", "nested/fn1.c", "nested/nestednested/fnn1.c", "nested/nestednested/fnn2.c", "other/fo1.c"};
+    for (i32 fileIndex = 0; fileIndex < prb_arrayCount(files); fileIndex++) {
+        prb_Str file = prb_pathJoin(arena, dir, prb_STR(files[fileIndex]));
+        prb_assert(prb_createDirIfNotExists(arena, prb_getParentDir(arena, file)) == prb_Success);
+        prb_assert(prb_writeEntireFile(arena, file, file.ptr, file.len) == prb_Success);
+    }
+    prb_assert(prb_createDirIfNotExists(arena, prb_pathJoin(arena, dir, prb_STR("emptynested"))) == prb_Success);
+
+    prb_Str       dirTrailingSlash = prb_fmt(arena, "%.*s/", prb_LIT(dir));
+    prb_Str       allDirs[] = {dir, dirTrailingSlash};
+    prb_Recursive modes[] = {prb_Recursive_Yes, prb_Recursive_No};
+    for (i32 allDirsIndex = 0; allDirsIndex < prb_arrayCount(allDirs); allDirsIndex++) {
+        for (i32 modesIndex = 0; modesIndex < prb_arrayCount(modes); modesIndex++) {
+            prb_Str*     entries = prb_getAllDirEntries(arena, allDirs[allDirsIndex], modes[modesIndex]);
+            prb_PathTrie trie = prb_getAllDirEntriesTrie(arena, allDirs[allDirsIndex], modes[modesIndex]);
+            prb_assert(arrlen(trie.nodes) == arrlen(entries) + 2);
+            prb_assert(prb_streq(prb_pathTrieGetPath(arena, &trie, 1), dir));
+            for (i32 node = 2; node < arrlen(trie.nodes); node++) {
+                prb_Str path = prb_pathTrieGetPath(arena, &trie, node);
+                prb_assert(strIn(path, entries, arrlen(entries)));
+                prb_assert(prb_pathTrieFind(&trie, path) == node);
+            }
+            if (modes[modesIndex] == prb_Recursive_Yes) {
+                i32 nested = prb_pathTrieFind(&trie, prb_pathJoin(arena, dir, prb_STR("nested")));
+                prb_assert(nested != -1 && trie.nodes[nested].subtreeCount == 5);
+            }
+            arrfree(entries);
+            arrfree(trie.nodes);
+            arrfree(trie.names);
+        }
+    }
+
+    prb_assert(prb_removePathIfExists(arena, dir) == prb_Success);
+    prb_endTempMemory(temp);
+}
+
 function void
 test_getLastModified(prb_Arena* arena) {
     prb_TempMemory temp = prb_beginTempMemory(arena);
@@ -1165,6 +1331,39 @@ test_writeEntireFile(prb_Arena* arena) {
     prb_endTempMemory(temp);
 }
 
+function void
+test_writeChunksToFile(prb_Arena* arena) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+    prb_Str        dir = getTempPath(arena, __FUNCTION__);
+    prb_assert(prb_removePathIfExists(arena, dir) == prb_Success);
+    prb_Str filepath = prb_pathJoin(arena, dir, prb_STR("filename.txt"));
+
+    // NOTE(khvorov) More chunks than go into one write
+    prb_GrowingStr gstr = prb_beginChunkedStr(arena);
+    for (i32 index = 0; index < 5000; index++) {
+        prb_addStrSegment(&gstr, "%04d%2996s", index, "\n");
+        prb_arenaAllocAndZero(arena, 1, 1);
+    }
+    i32 chunkCount = 0;
+    for (prb_StrChunk* chunk = gstr.firstChunk; chunk; chunk = chunk->next) {
+        chunkCount += 1;
+    }
+    prb_assert(chunkCount > 64);
+    prb_assert(prb_writeChunksToFile(arena, filepath, gstr.firstChunk));
+    prb_Str                  str = prb_endStr(&gstr);
+    prb_ReadEntireFileResult readRes = prb_readEntireFile(arena, filepath);
+    prb_assert(readRes.success && str.len == 5000 * 3000);
+    prb_assert(prb_streq(prb_strFromBytes(readRes.content), str));
+
+    gstr = prb_beginChunkedStr(arena);
+    prb_assert(prb_writeChunksToFile(arena, filepath, gstr.firstChunk));
+    readRes = prb_readEntireFile(arena, filepath);
+    prb_assert(readRes.success && readRes.content.len == 0);
+
+    prb_assert(prb_removePathIfExists(arena, dir) == prb_Success);
+    prb_endTempMemory(temp);
+}
+
 function void
 test_getFileHash(prb_Arena* arena) {
     prb_TempMemory temp = prb_beginTempMemory(arena);
@@ -1518,6 +1717,180 @@ test_strFind(prb_Arena* arena) {
         prb_assert(prb_streq(find.beforeMatch, line));
     }
 
+    // NOTE(khvorov) Matches on both sides of vector block boundaries with near misses everywhere else
+    {
+        char buf[200];
+        char patBuf[100];
+        i32  patLens[] = {1, 2, 3, 7, 16, 17, 31, 33, 64, 65, 100};
+        for (i32 patLenIndex = 0; patLenIndex < prb_arrayCount(patLens); patLenIndex++) {
+            i32 patLen = patLens[patLenIndex];
+            for (i32 patIndex = 0; patIndex < patLen; patIndex++) {
+                patBuf[patIndex] = patIndex == 0 || patIndex == patLen - 1 ? 'x' : 'y';
+            }
+            if (patLen <= 2) {
+                patBuf[patLen - 1] = 'y';
+            }
+            prb_Str pattern = {patBuf, patLen};
+
+            for (i32 strLen = patLen; strLen <= (i32)sizeof(buf); strLen += 13) {
+                for (i32 matchOff = 0; matchOff + patLen <= strLen; matchOff += 3) {
+                    prb_memset(buf, 'x', sizeof(buf));
+                    prb_memcpy(buf + matchOff, patBuf, (size_t)patLen);
+                    if (matchOff + 2 * patLen + 5 <= strLen) {
+                        prb_memcpy(buf + strLen - patLen, patBuf, (size_t)patLen);
+                    }
+                    prb_Str str = {buf, strLen};
+
+                    i32 firstExpected = -1;
+                    i32 lastExpected = -1;
+                    for (i32 off = 0; off + patLen <= strLen; off++) {
+                        if (prb_memeq(buf + off, patBuf, patLen)) {
+                            firstExpected = firstExpected == -1 ? off : firstExpected;
+                            lastExpected = off;
+                        }
+                    }
+                    prb_assert(firstExpected != -1);
+
+                    prb_StrFindSpec spec = {};
+                    spec.pattern = pattern;
+                    prb_StrFindResult find = prb_strFind(str, spec);
+                    prb_assert(find.found && find.beforeMatch.len == firstExpected && prb_streq(find.match, pattern));
+
+                    spec.direction = prb_StrDirection_FromEnd;
+                    find = prb_strFind(str, spec);
+                    prb_assert(find.found && find.beforeMatch.len == lastExpected && prb_streq(find.match, pattern));
+
+                    buf[matchOff + patLen / 2] = 'z';
+                    buf[strLen - patLen + patLen / 2] = 'z';
+                    prb_assert(!prb_strFind(str, spec).found);
+                }
+            }
+        }
+    }
+
+    prb_endTempMemory(temp);
+}
+
+function void
+test_strFinder(prb_Arena* arena) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+
+    // NOTE(khvorov) Same results as one-off searches while reusing the finder across strings
+    {
+        prb_Str pattern = prb_STR("a pattern long enough for the finder to build the shift table the first time it's needed");
+        prb_Str strs[] = {
+            prb_STR("short"),
+            prb_fmt(arena, "%s%.*s%s", "before ", prb_LIT(pattern), " after"),
+            prb_fmt(arena, "%.*s%.*s", prb_LIT(pattern), prb_LIT(pattern)),
+            prb_fmt(arena, "%0300d", 0),
+        };
+        prb_StrDirection directions[] = {prb_StrDirection_FromStart, prb_StrDirection_FromEnd};
+        for (i32 dirIndex = 0; dirIndex < prb_arrayCount(directions); dirIndex++) {
+            prb_StrFindSpec spec = {};
+            spec.direction = directions[dirIndex];
+            spec.pattern = pattern;
+            prb_StrFinder finder = prb_createStrFinder(spec);
+            prb_assert(!finder.raitaShiftsReady);
+            for (i32 strIndex = 0; strIndex < prb_arrayCount(strs); strIndex++) {
+                prb_StrFindResult expected = prb_strFind(strs[strIndex], spec);
+                prb_StrFindResult find = prb_strFinderFind(&finder, strs[strIndex]);
+                prb_assert(find.found == expected.found);
+                prb_assert(find.beforeMatch.len == expected.beforeMatch.len && find.match.len == expected.match.len);
+            }
+            prb_assert(finder.raitaShiftsReady);
+        }
+    }
+
+    {
+        prb_StrFindSpec spec = {};
+        spec.mode = prb_StrFindMode_AnyChar;
+        spec.pattern = prb_STR(" =\t");
+        prb_StrFinder finder = prb_createStrFinder(spec);
+        prb_assert(finder.patternIsAscii);
+
+        prb_StrFindResult find = prb_strFinderFind(&finder, prb_STR("太阳name=value\tx"));
+        prb_assert(find.found);
+        prb_assert(prb_streq(find.beforeMatch, prb_STR("太阳name")));
+        prb_assert(prb_streq(find.match, prb_STR("=")));
+
+        finder.spec.direction = prb_StrDirection_FromEnd;
+        find = prb_strFinderFind(&finder, prb_STR("太阳name=value\tx"));
+        prb_assert(find.found);
+        prb_assert(prb_streq(find.match, prb_STR("\t")));
+        prb_assert(prb_streq(find.afterMatch, prb_STR("x")));
+
+        prb_assert(!prb_strFinderFind(&finder, prb_STR("太阳")).found);
+    }
+
+    {
+        prb_StrFindSpec spec = {};
+        spec.mode = prb_StrFindMode_AnyChar;
+        spec.pattern = prb_STR("阳x");
+        prb_StrFinder finder = prb_createStrFinder(spec);
+        prb_assert(!finder.patternIsAscii);
+        prb_StrFindResult find = prb_strFinderFind(&finder, prb_STR("太阳"));
+        prb_assert(find.found);
+        prb_assert(prb_streq(find.beforeMatch, prb_STR("太")));
+        prb_assert(prb_streq(find.match, prb_STR("阳")));
+
+        finder.spec.direction = prb_StrDirection_FromEnd;
+        find = prb_strFinderFind(&finder, prb_STR("x太阳yx太"));
+        prb_assert(find.found);
+        prb_assert(prb_streq(find.beforeMatch, prb_STR("x太阳y")));
+        prb_assert(prb_streq(find.afterMatch, prb_STR("太")));
+    }
+
+    // NOTE(khvorov) Every position across vector blocks and the leftover tail, checked against a plain loop
+    {
+        prb_Str          sets[] = {prb_STR("\n"), prb_STR(" \t"), prb_STR("!\"#$%&'()*+,-./:;<=>?@[\\]^_`{|}~"), prb_STR("\x7f\x01")};
+        prb_StrDirection directions[] = {prb_StrDirection_FromStart, prb_StrDirection_FromEnd};
+        char             buf[100];
+        for (i32 setIndex = 0; setIndex < prb_arrayCount(sets); setIndex++) {
+            for (i32 dirIndex = 0; dirIndex < prb_arrayCount(directions); dirIndex++) {
+                prb_StrFindSpec spec = {};
+                spec.mode = prb_StrFindMode_AnyChar;
+                spec.direction = directions[dirIndex];
+                spec.pattern = sets[setIndex];
+                prb_StrFinder finder = prb_createStrFinder(spec);
+                for (i32 len = 0; len <= prb_arrayCount(buf); len++) {
+                    for (i32 matchAt = -1; matchAt < len; matchAt++) {
+                        for (i32 bufIndex = 0; bufIndex < len; bufIndex++) {
+                            buf[bufIndex] = (char)(bufIndex % 2 == 0 ? 'a' : 0xC0 + bufIndex % 16);
+                        }
+                        if (matchAt >= 0) {
+                            buf[matchAt] = sets[setIndex].ptr[matchAt % sets[setIndex].len];
+                        }
+                        prb_Str           str = {buf, len};
+                        prb_StrFindResult find = prb_strFinderFind(&finder, str);
+                        prb_assert(find.found == (matchAt >= 0));
+                        if (find.found) {
+                            prb_assert(find.beforeMatch.len == matchAt);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // NOTE(khvorov) More non-ascii characters than the codepoint set holds
+    {
+        prb_GrowingStr gstr = prb_beginStr(arena);
+        for (i32 ch = 0x400; ch < 0x400 + 100; ch++) {
+            prb_addStrSegment(&gstr, "%c%c", 0xC0 | (ch >> 6), 0x80 | (ch & 0x3F));
+        }
+        prb_Str pattern = prb_endStr(&gstr);
+
+        prb_StrFindSpec spec = {};
+        spec.mode = prb_StrFindMode_AnyChar;
+        spec.pattern = pattern;
+        prb_StrFinder finder = prb_createStrFinder(spec);
+        prb_assert(finder.codepointCount == -1);
+        prb_StrFindResult find = prb_strFinderFind(&finder, prb_STR("太阳\xD1\x80"));
+        prb_assert(find.found);
+        prb_assert(prb_streq(find.beforeMatch, prb_STR("太阳")));
+        prb_assert(!prb_strFinderFind(&finder, prb_STR("太阳")).found);
+    }
+
     prb_endTempMemory(temp);
 }
 
@@ -1546,6 +1919,91 @@ test_stringsJoin(prb_Arena* arena) {
     prb_endTempMemory(temp);
 }
 
+function void
+assertSplit(prb_Arena* arena, prb_Str str, prb_Str delimSet, u32 flags, prb_Str* expected, i32 expectedCount) {
+    prb_TempMemory     temp = prb_beginTempMemory(arena);
+    prb_StrSplitResult split = prb_strSplit(arena, str, delimSet, flags);
+    prb_assert(split.count == expectedCount);
+    for (i32 tokenIndex = 0; tokenIndex < expectedCount; tokenIndex++) {
+        prb_assert(prb_streq(split.tokens[tokenIndex], expected[tokenIndex]));
+    }
+    prb_endTempMemory(temp);
+}
+
+function void
+test_strSplit(prb_Arena* arena) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+
+    {
+        prb_Str expected[] = {prb_STR("a"), prb_STR(""), prb_STR("b"), prb_STR("c"), prb_STR("")};
+        assertSplit(arena, prb_STR("a,,b;c,"), prb_STR(",;"), 0, expected, prb_arrayCount(expected));
+        prb_Str nonEmpty[] = {prb_STR("a"), prb_STR("b"), prb_STR("c")};
+        assertSplit(arena, prb_STR("a,,b;c,"), prb_STR(",;"), prb_StrSplitFlag_SkipEmpty, nonEmpty, prb_arrayCount(nonEmpty));
+        prb_Str whole[] = {prb_STR("a,,b;c,")};
+        assertSplit(arena, whole[0], prb_STR(""), prb_StrSplitFlag_SkipEmpty, whole, 1);
+    }
+
+    {
+        prb_Str empty[] = {prb_STR("")};
+        assertSplit(arena, prb_STR(""), prb_STR(" "), 0, empty, 1);
+        assertSplit(arena, prb_STR(""), prb_STR(" "), prb_StrSplitFlag_SkipEmpty, empty, 0);
+        assertSplit(arena, prb_STR("   "), prb_STR(" "), prb_StrSplitFlag_SkipEmpty, empty, 0);
+    }
+
+    {
+        prb_Str expected[] = {prb_STR("clang"), prb_STR("-DNAME=\"a b\""), prb_STR("\"file name.c\"")};
+        prb_Str cmd = prb_STR("  clang -DNAME=\"a b\"   \"file name.c\" ");
+        assertSplit(arena, cmd, prb_STR(" "), prb_StrSplitFlag_SkipEmpty | prb_StrSplitFlag_RespectQuotes, expected, prb_arrayCount(expected));
+        prb_Str unquoted[] = {prb_STR("clang"), prb_STR("-DNAME=\"a"), prb_STR("b\""), prb_STR("\"file"), prb_STR("name.c\"")};
+        assertSplit(arena, cmd, prb_STR(" "), prb_StrSplitFlag_SkipEmpty, unquoted, prb_arrayCount(unquoted));
+    }
+
+    // NOTE(khvorov) Long random strings cover quotes that are opened in one chunk and closed in another
+    {
+        prb_Rng     rng = prb_createRng(1);
+        const char* alphabet = "ab \t\"";
+        for (i32 round = 0; round < 200; round++) {
+            i32   strLen = (i32)prb_randomU32Bound(&rng, 400);
+            char* buf = prb_arenaAllocArray(arena, char, strLen);
+            for (i32 byteIndex = 0; byteIndex < strLen; byteIndex++) {
+                buf[byteIndex] = alphabet[prb_randomU32Bound(&rng, 5 - (round % 2))];
+            }
+            prb_Str str = {buf, strLen};
+            u32     flags = round % 4 < 2 ? (u32)prb_StrSplitFlag_SkipEmpty : 0;
+            flags |= round % 2 == 0 ? (u32)prb_StrSplitFlag_RespectQuotes : 0;
+
+            prb_Str* expected = 0;
+            i32      tokenStart = 0;
+            bool     inQuotes = false;
+            for (i32 byteIndex = 0; byteIndex <= strLen; byteIndex++) {
+                if (byteIndex == strLen || (!inQuotes && (buf[byteIndex] == ' ' || buf[byteIndex] == '\t'))) {
+                    if (byteIndex > tokenStart || !(flags & prb_StrSplitFlag_SkipEmpty)) {
+                        arrput(expected, prb_strSlice(str, tokenStart, byteIndex));
+                    }
+                    tokenStart = byteIndex + 1;
+                } else if (buf[byteIndex] == '"' && (flags & prb_StrSplitFlag_RespectQuotes)) {
+                    inQuotes = !inQuotes;
+                }
+            }
+            assertSplit(arena, str, prb_STR(" \t"), flags, expected, (i32)arrlen(expected));
+            arrfree(expected);
+        }
+    }
+
+    // NOTE(khvorov) The arena only needs room for the tokens, not for one per byte
+    {
+        i32   strLen = 100000;
+        char* buf = prb_arenaAllocArray(arena, char, strLen);
+        prb_memset(buf, 'a', (usize)strLen);
+        buf[strLen / 2] = ' ';
+        prb_Arena          small = prb_createArenaFromArena(arena, 3 * (i32)sizeof(prb_Str));
+        prb_StrSplitResult split = prb_strSplit(&small, (prb_Str) {buf, strLen}, prb_STR(" "), 0);
+        prb_assert(split.count == 2 && split.tokens[0].len == strLen / 2 && split.tokens[1].len == strLen / 2 - 1);
+    }
+
+    prb_endTempMemory(temp);
+}
+
 function void
 test_growingStr(prb_Arena* arena) {
     prb_GrowingStr gstr = prb_beginStr(arena);
@@ -1553,6 +2011,124 @@ test_growingStr(prb_Arena* arena) {
     prb_addStrSegment(&gstr, "123");
     prb_Str str = prb_endStr(&gstr);
     prb_assert(prb_streq(str, prb_STR("test123")));
+
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+
+    gstr = prb_beginStr(arena);
+    prb_addStr(&gstr, prb_STR("ab"));
+    prb_addChar(&gstr, ',');
+    prb_addU64(&gstr, 0, 10, 0);
+    prb_addChar(&gstr, ',');
+    prb_addU64(&gstr, 42, 10, 5);
+    prb_addChar(&gstr, ',');
+    prb_addU64(&gstr, UINT64_MAX, 10, 0);
+    prb_addChar(&gstr, ',');
+    prb_addU64(&gstr, 5, 2, 0);
+    prb_addChar(&gstr, ',');
+    prb_addU64(&gstr, 80, 3, 0);
+    prb_addChar(&gstr, ',');
+    prb_addI64(&gstr, INT64_MIN, 10, 0);
+    prb_addChar(&gstr, ',');
+    prb_addI64(&gstr, -255, 16, 4);
+    prb_addChar(&gstr, ',');
+    prb_addHex(&gstr, 0xDEADBEEF);
+    prb_addChar(&gstr, ',');
+    prb_addF64(&gstr, -1.5, 2);
+    prb_addChar(&gstr, ',');
+    prb_addF64(&gstr, 2.0, 0);
+    str = prb_endStr(&gstr);
+    prb_assert(prb_streq(str, prb_STR("ab,0,00042,18446744073709551615,101,2222,-9223372036854775808,-00FF,0xDEADBEEF,-1.50,2")));
+    prb_assert(str.ptr[str.len] == '\0');
+
+    // NOTE(khvorov) Padding longer than any number
+    gstr = prb_beginStr(arena);
+    prb_addU64(&gstr, 7, 10, 70);
+    str = prb_endStr(&gstr);
+    prb_assert(str.len == 70 && str.ptr[69] == '7');
+    for (i32 charIndex = 0; charIndex < 69; charIndex++) {
+        prb_assert(str.ptr[charIndex] == '0');
+    }
+
+    // NOTE(khvorov) Has to agree with the format interpreter, including the values it hands over to it
+    prb_Rng rng = prb_createRng(1);
+    for (i32 iter = 0; iter < 100000; iter++) {
+        u64 bits = ((u64)prb_randomU32(&rng) << 32) | prb_randomU32(&rng);
+        u64 value = bits >> prb_randomU32Bound(&rng, 64);
+        i32 minDigits = (i32)prb_randomU32Bound(&rng, 25);
+        i32 decimals = (i32)prb_randomU32Bound(&rng, 12);
+        double real = (double)(int64_t)value / (double)((u64)1 << prb_randomU32Bound(&rng, 40));
+        real = iter % 3 == 0 ? real : iter % 3 == 1 ? prb_randomF3201(&rng) * 1000.0 : (double)prb_randomU32Bound(&rng, 2000) / 8.0 - 125.0;
+
+        gstr = prb_beginStr(arena);
+        prb_addU64(&gstr, value, 10, minDigits);
+        prb_addChar(&gstr, ' ');
+        prb_addI64(&gstr, (int64_t)value, 10, 0);
+        prb_addChar(&gstr, ' ');
+        prb_addU64(&gstr, value, 16, 0);
+        prb_addChar(&gstr, ' ');
+        prb_addU64(&gstr, value, 8, 0);
+        prb_addChar(&gstr, ' ');
+        prb_addF64(&gstr, real, decimals);
+        str = prb_endStr(&gstr);
+        prb_Str expected = prb_fmt(arena, "%0*llu %lld %llX %llo %.*f", minDigits, (unsigned long long)value, (long long)value, (unsigned long long)value, (unsigned long long)value, decimals, real);
+        prb_assert(prb_streq(str, expected));
+    }
+
+    // NOTE(khvorov) Chunked strings let the arena be used in the middle of building
+    {
+        prb_GrowingStr chunked = prb_beginChunkedStr(arena);
+        prb_GrowingStr contiguousGstr = prb_beginStr(arena);
+        for (i32 index = 0; index < 10000; index++) {
+            prb_addI64(&contiguousGstr, index, 10, 0);
+            prb_addStrSegment(&contiguousGstr, "%*s|", index % 300, "");
+        }
+        prb_Str contiguous = prb_endStr(&contiguousGstr);
+
+        i32* allocated = 0;
+        for (i32 index = 0; index < 10000; index++) {
+            prb_addI64(&chunked, index, 10, 0);
+            prb_addStrSegment(&chunked, "%*s|", index % 300, "");
+            if (index % 100 == 0) {
+                allocated = prb_arenaAllocArray(arena, i32, 1);
+                *allocated = index;
+            }
+        }
+        prb_assert(chunked.firstChunk != chunked.lastChunk && chunked.str.len == contiguous.len);
+        i32 chunksLen = 0;
+        for (prb_StrChunk* chunk = chunked.firstChunk; chunk; chunk = chunk->next) {
+            prb_assert(prb_streq(chunk->str, prb_strSlice(contiguous, chunksLen, chunksLen + chunk->str.len)));
+            chunksLen += chunk->str.len;
+        }
+        prb_assert(chunksLen == contiguous.len);
+        str = prb_endStr(&chunked);
+        prb_assert(prb_streq(str, contiguous) && str.ptr[str.len] == '\0' && *allocated == 9900);
+
+        chunked = prb_beginChunkedStr(arena);
+        str = prb_endStr(&chunked);
+        prb_assert(str.len == 0 && str.ptr[0] == '\0');
+
+        // NOTE(khvorov) Empty appends before there is a chunk
+        chunked = prb_beginChunkedStr(arena);
+        prb_addStr(&chunked, prb_STR(""));
+        prb_addStr(&chunked, (prb_Str) {0, 0});
+        prb_addStrSegment(&chunked, "%s", "");
+        prb_addStrSegment(&chunked, "%s", "after");
+        str = prb_endStr(&chunked);
+        prb_assert(prb_streq(str, prb_STR("after")) && str.ptr[str.len] == '\0');
+
+        chunked = prb_beginChunkedStr(arena);
+        prb_addStr(&chunked, prb_STR(""));
+        str = prb_endStr(&chunked);
+        prb_assert(str.len == 0 && str.ptr[0] == '\0');
+
+        chunked = prb_beginChunkedStr(arena);
+        prb_addStr(&chunked, prb_STR("short"));
+        prb_Str chunkPtr = chunked.firstChunk->str;
+        str = prb_endStr(&chunked);
+        prb_assert(prb_streq(str, prb_STR("short")) && str.ptr == chunkPtr.ptr && str.ptr[str.len] == '\0');
+    }
+
+    prb_endTempMemory(temp);
 }
 
 function void
@@ -2001,6 +2577,153 @@ test_utf8CharIter(prb_Arena* arena) {
     }
 }
 
+// NOTE(khvorov) Independent of the header's decoder: the well-formed byte sequences table from the unicode standard
+function i32
+utf8ValidPrefixLen(const u8* str, i32 len) {
+    i32 at = 0;
+    for (;;) {
+        i32 seqLen = 0;
+        if (at < len) {
+            u8 b0 = str[at];
+            u8 b1 = at + 1 < len ? str[at + 1] : 0;
+            u8 lo = 0x80;
+            u8 hi = 0xBF;
+            if (b0 < 0x80) {
+                seqLen = 1;
+            } else if (b0 >= 0xC2 && b0 <= 0xDF) {
+                seqLen = 2;
+            } else if (b0 >= 0xE0 && b0 <= 0xEF) {
+                seqLen = 3;
+                lo = b0 == 0xE0 ? 0xA0 : 0x80;
+                hi = b0 == 0xED ? 0x9F : 0xBF;
+            } else if (b0 >= 0xF0 && b0 <= 0xF4) {
+                seqLen = 4;
+                lo = b0 == 0xF0 ? 0x90 : 0x80;
+                hi = b0 == 0xF4 ? 0x8F : 0xBF;
+            }
+            if (seqLen > 1 && (at + seqLen > len || b1 < lo || b1 > hi)) {
+                seqLen = 0;
+            }
+            for (i32 contIndex = 2; contIndex < seqLen; contIndex++) {
+                if ((str[at + contIndex] & 0xC0) != 0x80) {
+                    seqLen = 0;
+                }
+            }
+        }
+        if (seqLen == 0) {
+            break;
+        }
+        at += seqLen;
+    }
+    return at;
+}
+
+function void
+test_utf8Validate(prb_Arena* arena) {
+    prb_unused(arena);
+
+    prb_assert(prb_utf8Validate(prb_STR("")).valid);
+    prb_assert(prb_utf8Validate(prb_STR("abc太阳😐")).valid);
+    {
+        prb_Utf8ValidateResult res = prb_utf8Validate(prb_STR("abc\xC0\x80"));
+        prb_assert(!res.valid && res.errorOffset == 3);
+        res = prb_utf8Validate(prb_STR("太\xED\xA0\x80"));
+        prb_assert(!res.valid && res.errorOffset == 3);
+        res = prb_utf8Validate(prb_STR("😐\xF4\x90\x80\x80"));
+        prb_assert(!res.valid && res.errorOffset == 4);
+        res = prb_utf8Validate(prb_STR("a\xE5\xA4"));
+        prb_assert(!res.valid && res.errorOffset == 1);
+    }
+
+    // NOTE(khvorov) Every sequence at every offset across vector blocks, in ascii and in multibyte text
+    {
+        const char* seqs[] = {
+            "\xC2\x80", "\xDF\xBF", "\xE0\xA0\x80", "\xED\x9F\xBF", "\xEE\x80\x80", "\xF0\x90\x80\x80", "\xF4\x8F\xBF\xBF",
+            "\x80", "\xBF\x80", "\xC0\x80", "\xC1\xBF", "\xC2", "\xC2\x41", "\xE0\x80\x80", "\xE0\x9F\xBF", "\xED\xA0\x80",
+            "\xED\xBF\xBF", "\xE1\x80", "\xE1\x80\x41", "\xF0\x80\x80\x80", "\xF0\x8F\xBF\xBF", "\xF4\x90\x80\x80",
+            "\xF5\x80\x80\x80", "\xF8\x88\x80\x80\x80", "\xFF", "\xF1\x80\x80", "\xF1\x80\x80\xC0",
+        };
+        const char* fillers[] = {"a", "\xD0\xB6", "\xE5\xA4\xAA", "\xF0\x9F\x98\x90"};
+        u8          buf[128];
+        for (i32 fillerIndex = 0; fillerIndex < prb_arrayCount(fillers); fillerIndex++) {
+            for (i32 seqIndex = 0; seqIndex < prb_arrayCount(seqs); seqIndex++) {
+                for (i32 seqAt = 0; seqAt < 80; seqAt++) {
+                    i32 len = 0;
+                    while (len < seqAt) {
+                        for (const char* ch = fillers[fillerIndex]; *ch && len < seqAt; ch++) {
+                            buf[len++] = (u8)*ch;
+                        }
+                    }
+                    for (const char* ch = seqs[seqIndex]; *ch; ch++) {
+                        buf[len++] = (u8)*ch;
+                    }
+                    for (i32 padIndex = 0; padIndex < seqIndex % 7; padIndex++) {
+                        buf[len++] = 'z';
+                    }
+                    prb_Str                str = {(const char*)buf, len};
+                    i32                    expected = utf8ValidPrefixLen(buf, len);
+                    prb_Utf8ValidateResult res = prb_utf8Validate(str);
+                    prb_assert(res.valid == (expected == len));
+                    prb_assert(res.errorOffset == expected);
+                }
+            }
+        }
+    }
+}
+
+function void
+test_utf32(prb_Arena* arena) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+
+    prb_Str         text = prb_fmt(arena, "%s", "line with ascii long enough to fill a vector, then 太阳 and 😐 and more ascii after them");
+    prb_Utf32Result utf32 = prb_utf8ToUtf32(arena, text);
+    prb_assert(utf32.valid && utf32.errorOffset == text.len);
+    i32 charIndex = 0;
+    for (prb_Utf8CharIter iter = prb_createUtf8CharIter(text, prb_StrDirection_FromStart); prb_utf8CharIterNext(&iter);) {
+        prb_assert(iter.curIsValid && utf32.str.ptr[charIndex++] == iter.curUtf32Char);
+    }
+    prb_assert(charIndex == utf32.str.len && utf32.str.ptr[utf32.str.len] == 0);
+
+    prb_Utf8Result utf8 = prb_utf32ToUtf8(arena, utf32.str);
+    prb_assert(utf8.valid && prb_streq(utf8.str, text));
+
+    utf32 = prb_utf8ToUtf32(arena, prb_STR("太\xE5\xA4"));
+    prb_assert(!utf32.valid && utf32.errorOffset == 3);
+    prb_assert(utf32.str.len == 1 && utf32.str.ptr[0] == 0x592A);
+
+    u32 bad[] = {'a', 0xD800, 'b'};
+    utf8 = prb_utf32ToUtf8(arena, (prb_Utf32Str) {bad, 3});
+    prb_assert(!utf8.valid && utf8.errorOffset == 1 && prb_streq(utf8.str, prb_STR("a")));
+    bad[1] = 0x110000;
+    prb_assert(!prb_utf32ToUtf8(arena, (prb_Utf32Str) {bad, 3}).valid);
+
+    prb_endTempMemory(temp);
+}
+
+function void
+test_utf16(prb_Arena* arena) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+
+    prb_Str         text = prb_fmt(arena, "%s", "line with ascii long enough to fill a vector, then 太阳 and 😐 and more ascii after them");
+    prb_Utf16Result utf16 = prb_utf8ToUtf16(arena, text);
+    prb_assert(utf16.valid && utf16.errorOffset == text.len);
+    prb_assert(utf16.str.ptr[0] == 'l' && utf16.str.ptr[51] == 0x592A && utf16.str.ptr[52] == 0x9633);
+    prb_assert(utf16.str.ptr[58] == 0xD83D && utf16.str.ptr[59] == 0xDE10);
+    prb_assert(utf16.str.ptr[utf16.str.len] == 0);
+
+    prb_Utf8Result utf8 = prb_utf16ToUtf8(arena, utf16.str);
+    prb_assert(utf8.valid && prb_streq(utf8.str, text));
+
+    uint16_t lone[] = {'a', 'b', 0xDC00, 'c'};
+    utf8 = prb_utf16ToUtf8(arena, (prb_Utf16Str) {lone, 4});
+    prb_assert(!utf8.valid && utf8.errorOffset == 2 && prb_streq(utf8.str, prb_STR("ab")));
+    lone[2] = 0xD800;
+    utf8 = prb_utf16ToUtf8(arena, (prb_Utf16Str) {lone, 3});
+    prb_assert(!utf8.valid && utf8.errorOffset == 2);
+
+    prb_endTempMemory(temp);
+}
+
 function void
 test_strScanner(prb_Arena* arena) {
     prb_unused(arena);
@@ -2114,6 +2837,92 @@ test_strScanner(prb_Arena* arena) {
 
         prb_assert(prb_strScannerMove(&iter, lineBreakSpec, prb_StrScannerSide_AfterMatch) == prb_Failure);
     }
+
+    {
+        prb_StrScanner  iter = prb_createStrScanner(prb_STR("-g  -Wall -Werror"));
+        prb_StrFindSpec space = {};
+        space.pattern = prb_STR(" ");
+        space.alwaysMatchEnd = true;
+        prb_StrFinder finder = prb_createStrFinder(space);
+
+        prb_Str args[] = {prb_STR("-g"), prb_STR(""), prb_STR("-Wall"), prb_STR("-Werror")};
+        for (i32 argIndex = 0; argIndex < prb_arrayCount(args); argIndex++) {
+            prb_assert(prb_strScannerMoveWith(&iter, &finder, prb_StrScannerSide_AfterMatch));
+            prb_assert(prb_streq(iter.betweenLastMatches, args[argIndex]));
+        }
+        prb_assert(!prb_strScannerMoveWith(&iter, &finder, prb_StrScannerSide_AfterMatch));
+    }
+}
+
+function void
+test_lineIndex(prb_Arena* arena) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+
+    {
+        prb_LineIndex index = prb_buildLineIndex(arena, prb_STR("line1\r\nline2\nline3\rline4\n\nline6\r\rline8\r\n\r\nline10\r\n\nline12\r\r\nline14"));
+        prb_assert(index.lineCount == 14);
+        prb_LineIter iter = prb_createLineIter(&index);
+        prb_assert(prb_lineIterNext(&iter) == prb_Success);
+        prb_assert(prb_streq(iter.curLine, prb_STR("line1")));
+        prb_assert(prb_streq(iter.curLineBreak, prb_STR("\r\n")));
+        prb_assert(prb_lineIterNext(&iter) == prb_Success);
+        prb_assert(prb_streq(iter.curLine, prb_STR("line2")));
+        prb_assert(prb_lineIterNext(&iter) == prb_Success);
+        prb_assert(prb_streq(iter.curLine, prb_STR("line3")));
+        prb_assert(prb_streq(iter.curLineBreak, prb_STR("\r")));
+        while (iter.curLineIndex < 11) {
+            prb_assert(prb_lineIterNext(&iter) == prb_Success);
+        }
+        prb_assert(prb_streq(iter.curLine, prb_STR("line12")));
+        prb_assert(prb_streq(iter.curLineBreak, prb_STR("\r")));
+        prb_assert(prb_lineIterNext(&iter) == prb_Success);
+        prb_assert(iter.curLine.len == 0);
+        prb_assert(prb_streq(iter.curLineBreak, prb_STR("\r\n")));
+        prb_assert(prb_lineIterNext(&iter) == prb_Success);
+        prb_assert(prb_streq(iter.curLine, prb_STR("line14")));
+        prb_assert(iter.curLineBreak.len == 0);
+        prb_assert(prb_lineIterNext(&iter) == prb_Failure);
+    }
+
+    {
+        prb_LineIndex index = prb_buildLineIndex(arena, prb_STR(""));
+        prb_assert(index.lineCount == 0);
+        prb_LineIter iter = prb_createLineIter(&index);
+        prb_assert(prb_lineIterNext(&iter) == prb_Failure);
+
+        index = prb_buildLineIndex(arena, prb_STR("one line\n"));
+        prb_assert(index.lineCount == 1);
+        prb_assert(index.lineStarts[1] == 9);
+    }
+
+    // NOTE(khvorov) Line breaks everywhere across vector blocks, split \r\n included, checked against the scanner
+    {
+        char breakChars[] = {'a', '\n', '\r'};
+        char buf[80];
+        for (i32 seed = 0; seed < 200; seed++) {
+            i32 len = seed % prb_arrayCount(buf);
+            for (i32 bufIndex = 0; bufIndex < len; bufIndex++) {
+                u32 mixed = (u32)(seed * 2654435761u + (u32)bufIndex * 40503u);
+                buf[bufIndex] = breakChars[(mixed >> 13) % 3 == 0 ? (mixed >> 7) % 3 : 0];
+            }
+            prb_Str str = {buf, len};
+
+            prb_LineIndex   index = prb_buildLineIndex(arena, str);
+            prb_LineIter    iter = prb_createLineIter(&index);
+            prb_StrScanner  scanner = prb_createStrScanner(str);
+            prb_StrFindSpec lineBreakSpec = {};
+            lineBreakSpec.mode = prb_StrFindMode_LineBreak;
+            while (prb_strScannerMove(&scanner, lineBreakSpec, prb_StrScannerSide_AfterMatch)) {
+                prb_assert(prb_lineIterNext(&iter) == prb_Success);
+                prb_assert(iter.curLine.ptr == scanner.betweenLastMatches.ptr && iter.curLine.len == scanner.betweenLastMatches.len);
+                prb_assert(prb_streq(iter.curLineBreak, scanner.match));
+            }
+            prb_assert(prb_lineIterNext(&iter) == prb_Failure);
+            prb_assert(iter.curLineIndex + 1 == index.lineCount);
+        }
+    }
+
+    prb_endTempMemory(temp);
 }
 
 function void
@@ -2136,6 +2945,42 @@ test_parseUint(prb_Arena* arena) {
 
     parseResult = prb_parseUint(prb_STR(""), 16);
     prb_assert(!parseResult.success);
+
+    // NOTE(khvorov) 8 digits at a time with leftovers, leading zeros and the 64-bit limit
+    parseResult = prb_parseUint(prb_STR("1234567890123"), 10);
+    prb_assert(parseResult.success && parseResult.number == 1234567890123);
+    parseResult = prb_parseUint(prb_STR("12345678/0123"), 10);
+    prb_assert(!parseResult.success);
+    parseResult = prb_parseUint(prb_STR("0000000000000000000000018446744073709551615"), 10);
+    prb_assert(parseResult.success && parseResult.number == UINT64_MAX);
+    prb_assert(!prb_parseUint(prb_STR("18446744073709551616"), 10).success);
+    prb_assert(!prb_parseUint(prb_STR("99999999999999999999"), 10).success);
+    prb_assert(!prb_parseUint(prb_STR("1844674407370955161a"), 10).success);
+    parseResult = prb_parseUint(prb_STR("00FFFFFFFFFFFFFFFF"), 16);
+    prb_assert(parseResult.success && parseResult.number == UINT64_MAX);
+    prb_assert(!prb_parseUint(prb_STR("1FFFFFFFFFFFFFFFF"), 16).success);
+    prb_assert(!prb_parseUint(prb_STR("12g"), 16).success);
+
+    // NOTE(khvorov) Failures don't leave a partial number behind
+    parseResult = prb_parseUint(prb_STR("0xFF"), 16);
+    prb_assert(!parseResult.success && parseResult.number == 0);
+    parseResult = prb_parseUint(prb_STR("zz"), 16);
+    prb_assert(!parseResult.success && parseResult.number == 0);
+    parseResult = prb_parseUint(prb_STR("1FFFFFFFFFFFFFFFF"), 16);
+    prb_assert(!parseResult.success && parseResult.number == 0);
+    parseResult = prb_parseUint(prb_STR("18446744073709551616"), 10);
+    prb_assert(!parseResult.success && parseResult.number == 0);
+    parseResult = prb_parseUint(prb_STR("12345678/0123"), 10);
+    prb_assert(!parseResult.success && parseResult.number == 0);
+
+    for (u64 value = 1, digits = 1; digits <= 19; value = value * 10 + (digits % 10), digits++) {
+        prb_Str str = prb_fmt(arena, "%llu", (unsigned long long)value);
+        parseResult = prb_parseUint(str, 10);
+        prb_assert(parseResult.success && parseResult.number == value);
+        str = prb_fmt(arena, "%llx", (unsigned long long)value);
+        parseResult = prb_parseUint(str, 16);
+        prb_assert(parseResult.success && parseResult.number == value);
+    }
 }
 
 function void
@@ -2211,6 +3056,113 @@ test_parseNumber(prb_Arena* arena) {
     prb_assert(prb_parseNumber(prb_STR("a.1")).kind == prb_ParsedNumberKind_None);
     prb_assert(prb_parseNumber(prb_STR("1.1 ")).kind == prb_ParsedNumberKind_None);
     prb_assert(prb_parseNumber(prb_STR("")).kind == prb_ParsedNumberKind_None);
+    prb_assert(prb_parseNumber(prb_STR("1.2.3")).kind == prb_ParsedNumberKind_None);
+    prb_assert(prb_parseNumber(prb_STR("1e")).kind == prb_ParsedNumberKind_None);
+    prb_assert(prb_parseNumber(prb_STR("e5")).kind == prb_ParsedNumberKind_None);
+    prb_assert(prb_parseNumber(prb_STR(".e5")).kind == prb_ParsedNumberKind_None);
+    prb_assert(prb_parseNumber(prb_STR("1e+")).kind == prb_ParsedNumberKind_None);
+
+    number = prb_parseNumber(prb_STR("-1.5e3"));
+    prb_assert(number.kind == prb_ParsedNumberKind_F64 && number.parsedF64 == -1500.0);
+    number = prb_parseNumber(prb_STR("1E-2"));
+    prb_assert(number.kind == prb_ParsedNumberKind_F64 && number.parsedF64 == 0.01);
+    number = prb_parseNumber(prb_STR("1e400"));
+    prb_assert(number.kind == prb_ParsedNumberKind_F64 && number.parsedF64 > 1e308);
+    number = prb_parseNumber(prb_STR("1e-400"));
+    prb_assert(number.kind == prb_ParsedNumberKind_F64 && number.parsedF64 == 0);
+
+    // NOTE(khvorov) Has to round exactly like strtod: random digits and exponents, halfway cases,
+    // subnormals and mantissas too long for 64 bits
+    {
+        const char* cases[] = {
+            "9007199254740993.0",
+            "2.2250738585072011e-308",
+            "2.2250738585072014e-308",
+            "4.9406564584124654e-324",
+            "2.4703282292062327e-324",
+            "2.4703282292062328e-324",
+            "1.7976931348623157e308",
+            "1.7976931348623158e308",
+            "1.7976931348623159e308",
+            "0.1000000000000000055511151231257827021181583404541015625",
+            "7.2057594037927933e16",
+            "123456789012345678901234567890.5",
+            "0.000000000000000000000000000001",
+            "8.988465674311578540726371186585217839905e307",
+        };
+        for (i32 caseIndex = 0; caseIndex < prb_arrayCount(cases); caseIndex++) {
+            prb_Str str = prb_STR(cases[caseIndex]);
+            number = prb_parseNumber(str);
+            prb_assert(number.kind == prb_ParsedNumberKind_F64 && number.parsedF64 == strtod(cases[caseIndex], 0));
+        }
+
+        prb_Rng rng = prb_createRng(1234);
+        for (i32 iter = 0; iter < 100000; iter++) {
+            prb_GrowingStr gstr = prb_beginStr(arena);
+            i32            intDigits = (i32)prb_randomU32Bound(&rng, 22);
+            i32            fracDigits = (i32)prb_randomU32Bound(&rng, 22);
+            for (i32 digitIndex = 0; digitIndex < intDigits; digitIndex++) {
+                prb_addStrSegment(&gstr, "%c", '0' + (char)prb_randomU32Bound(&rng, 10));
+            }
+            prb_addStrSegment(&gstr, ".");
+            for (i32 digitIndex = 0; digitIndex < fracDigits || intDigits + digitIndex == 0; digitIndex++) {
+                prb_addStrSegment(&gstr, "%c", '0' + (char)prb_randomU32Bound(&rng, 10));
+            }
+            if (prb_randomU32Bound(&rng, 2)) {
+                prb_addStrSegment(&gstr, "e%d", (i32)prb_randomU32Bound(&rng, 700) - 350);
+            }
+            prb_Str str = prb_endStr(&gstr);
+            number = prb_parseNumber(str);
+            prb_assert(number.kind == prb_ParsedNumberKind_F64);
+            prb_assert(number.parsedF64 == strtod(str.ptr, 0));
+        }
+
+        // NOTE(khvorov) Every double printed the shortest way that round trips has to come back unchanged
+        for (i32 iter = 0; iter < 100000; iter++) {
+            u64 bits = ((u64)prb_randomU32(&rng) << 32) | prb_randomU32(&rng);
+            bits &= ~((u64)1 << 63);
+            double value = 0;
+            prb_memcpy(&value, &bits, sizeof(value));
+            if (value <= 1.7976931348623157e308) {
+                prb_Str str = prb_fmt(arena, "%.17g", value);
+                number = prb_parseNumber(str);
+                prb_assert(number.kind == prb_ParsedNumberKind_F64 || number.kind == prb_ParsedNumberKind_U64);
+                if (number.kind == prb_ParsedNumberKind_F64) {
+                    prb_assert(number.parsedF64 == value);
+                }
+            }
+        }
+    }
+}
+
+function void
+test_parseNumbers(prb_Arena* arena) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+
+    prb_ParseNumbersResult res = prb_parseNumbers(arena, prb_STR("1, 2.5,,-3\n0x10  4e2\n"), prb_STR(", \n"));
+    prb_assert(res.success && res.errorOffset == 21 && res.count == 5);
+    prb_assert(res.numbers[0].kind == prb_ParsedNumberKind_U64 && res.numbers[0].parsedU64 == 1);
+    prb_assert(res.numbers[1].kind == prb_ParsedNumberKind_F64 && res.numbers[1].parsedF64 == 2.5);
+    prb_assert(res.numbers[2].kind == prb_ParsedNumberKind_I64 && res.numbers[2].parsedI64 == -3);
+    prb_assert(res.numbers[3].kind == prb_ParsedNumberKind_U64 && res.numbers[3].parsedU64 == 16);
+    prb_assert(res.numbers[4].kind == prb_ParsedNumberKind_F64 && res.numbers[4].parsedF64 == 400);
+
+    res = prb_parseNumbers(arena, prb_STR("1,2,x3,4"), prb_STR(","));
+    prb_assert(!res.success && res.errorOffset == 4 && res.count == 2);
+
+    res = prb_parseNumbers(arena, prb_STR(""), prb_STR(","));
+    prb_assert(res.success && res.count == 0);
+
+    res = prb_parseNumbers(arena, prb_STR("18446744073709551615,99999999999999999999,12x"), prb_STR(","));
+    prb_assert(!res.success && res.errorOffset == 21 && res.count == 1 && res.numbers[0].parsedU64 == UINT64_MAX);
+
+    res = prb_parseNumbers(arena, prb_STR("1234567890123456789,0.5"), prb_STR(","));
+    prb_assert(res.success && res.count == 2 && res.numbers[0].parsedU64 == 1234567890123456789ULL && res.numbers[1].parsedF64 == 0.5);
+
+    res = prb_parseNumbers(arena, prb_STR("1020304"), prb_STR("0"));
+    prb_assert(res.success && res.count == 4 && res.numbers[0].parsedU64 == 1 && res.numbers[3].parsedU64 == 4);
+
+    prb_endTempMemory(temp);
 }
 
 function void
@@ -2219,14 +3171,704 @@ test_binaryToCArray(prb_Arena* arena) {
     u8      bytes[] = {0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0x8, 0x9, 0xa, 0xb, 0xc};
     prb_Str carr = prb_binaryToCArray(arena, prb_STR("testarr"), bytes, prb_arrayCount(bytes));
     prb_assert(prb_streq(carr, prb_STR("unsigned char testarr[] = {\n    0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0x8, 0x9, 0xa,\n    0xb, 0xc\n};")));
+
+    // NOTE(khvorov) Same output as formatting every byte
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+    prb_Rng        rng = prb_createRng(1);
+    u8             random[1000] = {};
+    for (i32 index = 0; index < prb_arrayCount(random); index++) {
+        random[index] = (u8)prb_randomU32(&rng);
+    }
+    i32 lens[] = {0, 1, 9, 10, 11, 20, 21, 999, 1000};
+    for (i32 lenIndex = 0; lenIndex < prb_arrayCount(lens); lenIndex++) {
+        i32            len = lens[lenIndex];
+        prb_GrowingStr gstr = prb_beginStr(arena);
+        prb_addStrSegment(&gstr, "unsigned char arr[] = {\n    ");
+        for (i32 byteIndex = 0; byteIndex < len; byteIndex++) {
+            prb_addStrSegment(&gstr, "0x%x", random[byteIndex]);
+            if (byteIndex != len - 1) {
+                prb_addStrSegment(&gstr, (byteIndex + 1) % 10 == 0 ? ",\n    " : ", ");
+            } else {
+                prb_addStrSegment(&gstr, "\n");
+            }
+        }
+        prb_addStrSegment(&gstr, "};");
+        prb_Str expected = prb_endStr(&gstr);
+        prb_assert(prb_streq(prb_binaryToCArray(arena, prb_STR("arr"), random, len), expected));
+    }
+    prb_endTempMemory(temp);
 }
 
-//
-// SECTION Processes
-//
+function prb_Status
+compileAndRun(prb_Arena* arena, prb_Str dir, prb_Str* sources, i32 sourcesCount) {
+    prb_Str         exe = prb_pathJoin(arena, dir, prb_STR("prog.exe"));
+    prb_Str         cmd = prb_fmt(arena, "clang %.*s -o %.*s", prb_LIT(prb_stringsJoin(arena, sources, sourcesCount, prb_STR(" "))), prb_LIT(exe));
+    prb_ProcessSpec spec = {};
+    prb_Process     compile = prb_createProcess(cmd, spec);
+    prb_Status      result = prb_launchProcesses(arena, &compile, 1, prb_Background_No);
+    if (result == prb_Success) {
+        prb_Process run = prb_createProcess(exe, spec);
+        result = prb_launchProcesses(arena, &run, 1, prb_Background_No);
+    }
+    return result;
+}
 
 function void
-test_terminate(prb_Arena* arena) {
+test_binaryToCString(prb_Arena* arena) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+    prb_Str        dir = getTempPath(arena, __FUNCTION__);
+    prb_assert(prb_clearDir(arena, dir));
+
+    u8 tiny[] = {'a', '"', '\\', '?', '?', '=', 0, '1', 0x7F, 0xFF};
+    prb_assert(prb_streq(prb_binaryToCString(arena, prb_STR("s"), tiny, prb_arrayCount(tiny)), prb_STR("unsigned char s[] =\n    \"a\\042\\134\\077\\077=\\0001\\177\\377\";")));
+    prb_assert(prb_streq(prb_binaryToCString(arena, prb_STR("s"), tiny, 0), prb_STR("unsigned char s[] =\n    \"\";")));
+
+    // NOTE(khvorov) The compiler has to see the same bytes as in the array form
+    u8 bytes[1000] = {};
+    for (i32 index = 0; index < prb_arrayCount(bytes); index++) {
+        bytes[index] = (u8)(index * 37);
+    }
+    prb_Str prog = prb_fmt(
+        arena,
+        "#include <string.h>\n%.*s\n%.*s\nint main() {return sizeof(str) == sizeof(arr) + 1 && memcmp(str, arr, sizeof(arr)) == 0 ? 0 : 1;}\n",
+        prb_LIT(prb_binaryToCArray(arena, prb_STR("arr"), bytes, prb_arrayCount(bytes))),
+        prb_LIT(prb_binaryToCString(arena, prb_STR("str"), bytes, prb_arrayCount(bytes)))
+    );
+    prb_Str progPath = prb_pathJoin(arena, dir, prb_STR("prog.c"));
+    prb_assert(prb_writeEntireFile(arena, progPath, prog.ptr, prog.len));
+    prb_assert(compileAndRun(arena, dir, &progPath, 1));
+
+    prb_assert(prb_removePathIfExists(arena, dir));
+    prb_endTempMemory(temp);
+}
+
+function void
+test_embedFile(prb_Arena* arena) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+    prb_Str        dir = getTempPath(arena, __FUNCTION__);
+    prb_assert(prb_clearDir(arena, dir));
+
+    u8 bytes[1000] = {};
+    for (i32 index = 0; index < prb_arrayCount(bytes); index++) {
+        bytes[index] = (u8)(index * 37);
+    }
+    prb_Str dataPath = prb_pathJoin(arena, dir, prb_STR("data.bin"));
+    prb_assert(prb_writeEntireFile(arena, dataPath, bytes, prb_arrayCount(bytes)));
+    prb_Str missingPath = prb_pathJoin(arena, dir, prb_STR("missing.bin"));
+
+    prb_EmbedKind kinds[] = {prb_EmbedKind_CArray, prb_EmbedKind_CString, prb_EmbedKind_CEmbedDirective, prb_EmbedKind_AsmIncbin};
+    for (i32 kindIndex = 0; kindIndex < prb_arrayCount(kinds); kindIndex++) {
+        prb_assert(!prb_embedFile(arena, prb_STR("data"), missingPath, kinds[kindIndex]).success);
+    }
+
+    prb_EmbedFileResult carr = prb_embedFile(arena, prb_STR("data"), dataPath, prb_EmbedKind_CArray);
+    prb_assert(carr.success && prb_streq(carr.str, prb_binaryToCArray(arena, prb_STR("data"), bytes, prb_arrayCount(bytes))));
+    prb_EmbedFileResult cstr = prb_embedFile(arena, prb_STR("data"), dataPath, prb_EmbedKind_CString);
+    prb_assert(cstr.success && prb_streq(cstr.str, prb_binaryToCString(arena, prb_STR("data"), bytes, prb_arrayCount(bytes))));
+
+    prb_EmbedFileResult embed = prb_embedFile(arena, prb_STR("data"), dataPath, prb_EmbedKind_CEmbedDirective);
+    prb_assert(embed.success && prb_strStartsWith(embed.str, prb_STR("unsigned char data[] = {\n#embed \"")));
+    prb_assert(prb_strEndsWith(embed.str, prb_STR("/data.bin\"\n};\n")));
+
+    // NOTE(khvorov) The assembled bytes have to match the array form
+    prb_EmbedFileResult incbin = prb_embedFile(arena, prb_STR("data"), dataPath, prb_EmbedKind_AsmIncbin);
+    prb_assert(incbin.success);
+    prb_Str asmPath = prb_pathJoin(arena, dir, prb_STR("data.S"));
+    prb_assert(prb_writeEntireFile(arena, asmPath, incbin.str.ptr, incbin.str.len));
+    prb_Str prog = prb_fmt(
+        arena,
+        "#include <string.h>\n#include <stdint.h>\n%.*s\nextern const unsigned char data[];\nextern const uint64_t data_size;\n"
+        "int main() {return data_size == sizeof(arr) && memcmp(data, arr, sizeof(arr)) == 0 ? 0 : 1;}\n",
+        prb_LIT(prb_binaryToCArray(arena, prb_STR("arr"), bytes, prb_arrayCount(bytes)))
+    );
+    prb_Str progPath = prb_pathJoin(arena, dir, prb_STR("prog.c"));
+    prb_assert(prb_writeEntireFile(arena, progPath, prog.ptr, prog.len));
+    prb_Str sources[] = {progPath, asmPath};
+    prb_assert(compileAndRun(arena, dir, sources, prb_arrayCount(sources)));
+
+    prb_assert(prb_removePathIfExists(arena, dir));
+    prb_endTempMemory(temp);
+}
+
+function void
+test_hashBytes(prb_Arena* arena) {
+    prb_unused(arena);
+
+    // NOTE(khvorov) Every length through the tail cases and a few blocks, a flipped bit anywhere changes the hash
+    u8 bytes[100] = {};
+    for (i32 index = 0; index < prb_arrayCount(bytes); index++) {
+        bytes[index] = (u8)(index * 7);
+    }
+    for (i32 len = 0; len <= prb_arrayCount(bytes); len++) {
+        u64 hash = prb_hashBytes(bytes, len, 0);
+        prb_assert(hash == prb_hashBytes(bytes, len, 0));
+        prb_assert(hash != prb_hashBytes(bytes, len, 1));
+        if (len < prb_arrayCount(bytes)) {
+            prb_assert(hash != prb_hashBytes(bytes, len + 1, 0));
+        }
+        for (i32 index = 0; index < len; index++) {
+            bytes[index] ^= 0x10;
+            prb_assert(hash != prb_hashBytes(bytes, len, 0));
+            bytes[index] ^= 0x10;
+        }
+    }
+
+    // NOTE(khvorov) Lengths are part of the hash
+    u8 zeros[16] = {};
+    for (i32 len = 0; len < prb_arrayCount(zeros); len++) {
+        prb_assert(prb_hashBytes(zeros, len, 0) != prb_hashBytes(zeros, len + 1, 0));
+    }
+}
+
+function void
+test_hashStr(prb_Arena* arena) {
+    prb_unused(arena);
+    prb_Str str = prb_STR("src/file.c");
+    prb_assert(prb_hashStr(str) == prb_hashBytes(str.ptr, str.len, 0));
+    prb_assert(prb_hashStr(str) != prb_hashStr(prb_STR("src/file.h")));
+}
+
+typedef struct InternJob {
+    prb_StrInterner*  interner;
+    i32               first;
+    prb_InternedStr** results;
+} InternJob;
+
+function void
+internJob(prb_Arena* arena, void* data) {
+    InternJob* job = (InternJob*)data;
+    for (i32 index = 0; index < 2000; index++) {
+        prb_TempMemory temp = prb_beginTempMemory(arena);
+        job->results[index] = prb_internStr(job->interner, prb_fmt(arena, "path/%d.c", (job->first + index) % 3000));
+        prb_endTempMemory(temp);
+    }
+}
+
+function void
+test_strInterner(prb_Arena* arena) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+
+    prb_StrInterner  interner = prb_createStrInterner(arena, prb_ThreadSafe_No);
+    prb_InternedStr* first = prb_internStr(&interner, prb_STR("a.obj"));
+    prb_assert(prb_streq(first->str, prb_STR("a.obj")) && first->str.ptr[first->str.len] == '\0');
+    prb_assert(first->id == 0 && first->hash == prb_hashStr(prb_STR("a.obj")));
+    prb_assert(prb_findInternedStr(&interner, prb_STR("b.obj")) == 0);
+
+    // NOTE(khvorov) Handles survive the table growing and the same contents give the same handle
+    for (i32 index = 0; index < 1000; index++) {
+        prb_InternedStr* interned = prb_internStr(&interner, prb_fmt(arena, "%d", index));
+        prb_assert(interned->id == index + 1);
+    }
+    prb_assert(interner.count == 1001);
+    prb_assert(prb_internStr(&interner, prb_STR("a.obj")) == first);
+    prb_assert(prb_findInternedStr(&interner, prb_STR("a.obj")) == first);
+    for (i32 index = 0; index < 1000; index++) {
+        prb_InternedStr* found = prb_findInternedStr(&interner, prb_fmt(arena, "%d", index));
+        prb_assert(found && found->id == index + 1 && found == prb_internStr(&interner, found->str));
+    }
+    prb_assert(interner.count == 1001);
+
+    prb_InternedStr* empty = prb_internStr(&interner, prb_STR(""));
+    prb_assert(empty->str.len == 0 && empty->id == 1001);
+
+    prb_StrInterner zeroed = {};
+    prb_assert(prb_findInternedStr(&zeroed, prb_STR("a.obj")) == 0);
+
+    // NOTE(khvorov) Threads interning overlapping strings agree on the handles
+    {
+        prb_Arena        sharedArena = prb_createArenaFromArena(arena, 10 * prb_MEGABYTE);
+        prb_StrInterner  shared = prb_createStrInterner(&sharedArena, prb_ThreadSafe_Yes);
+        i32              jobCount = 8;
+        prb_Job*         jobs = prb_arenaAllocArray(arena, prb_Job, jobCount);
+        InternJob*       jobData = prb_arenaAllocArray(arena, InternJob, jobCount);
+        for (i32 jobIndex = 0; jobIndex < jobCount; jobIndex++) {
+            jobData[jobIndex].interner = &shared;
+            jobData[jobIndex].first = jobIndex * 500;
+            jobData[jobIndex].results = prb_arenaAllocArray(arena, prb_InternedStr*, 2000);
+            jobs[jobIndex] = prb_createJob(internJob, jobData + jobIndex, arena, 10 * prb_KILOBYTE);
+        }
+        prb_assert(prb_launchJobs(jobs, jobCount, prb_Background_Yes));
+        prb_assert(prb_waitForJobs(jobs, jobCount));
+
+        prb_assert(shared.count == 3000);
+        for (i32 jobIndex = 0; jobIndex < jobCount; jobIndex++) {
+            for (i32 index = 0; index < 2000; index++) {
+                prb_InternedStr* interned = jobData[jobIndex].results[index];
+                prb_assert(prb_streq(interned->str, prb_fmt(arena, "path/%d.c", (jobData[jobIndex].first + index) % 3000)));
+                prb_assert(prb_findInternedStr(&shared, interned->str) == interned);
+            }
+        }
+    }
+
+    prb_endTempMemory(temp);
+}
+
+function void
+test_strMap(prb_Arena* arena) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+
+    prb_StrMap       map = prb_createStrMap(arena, 0);
+    prb_StrMapEntry* first = prb_strMapAdd(&map, prb_STR("a.c"));
+    prb_assert(first->value == 0 && first->hash == prb_hashStr(prb_STR("a.c")) && map.count == 1);
+    first->value = 5;
+    prb_assert(prb_strMapFind(&map, prb_STR("a.c"))->value == 5);
+    prb_assert(prb_strMapAdd(&map, prb_STR("a.c"))->value == 5 && map.count == 1);
+    prb_assert(prb_strMapFind(&map, prb_STR("b.c")) == 0);
+    prb_Str withNull = {"a.c", 4};
+    prb_assert(prb_strMapFind(&map, withNull) == 0);
+
+    // NOTE(khvorov) Keys only need to be equal, not the same pointer or null-terminated
+    prb_Str joined = prb_STR("a.cb.c");
+    prb_assert(prb_strMapFind(&map, prb_strSlice(joined, 0, 3))->value == 5);
+    prb_strMapAdd(&map, prb_strSlice(joined, 3, 6))->value = 6;
+    prb_assert(prb_strMapFind(&map, prb_STR("b.c"))->value == 6);
+
+    // NOTE(khvorov) Enough keys to grow many times, entries stay in the order they were added
+    i32      keyCount = 5000;
+    prb_Str* keys = prb_arenaAllocArray(arena, prb_Str, keyCount);
+    for (i32 index = 0; index < keyCount; index++) {
+        keys[index] = prb_fmt(arena, "dir/%d.obj", index);
+        prb_StrMapEntry* entry = prb_strMapAddHashed(&map, keys[index], prb_hashStr(keys[index]));
+        prb_assert(entry->value == 0);
+        entry->value = (u64)index + 100;
+    }
+    prb_assert(map.count == keyCount + 2);
+    for (i32 index = 0; index < keyCount; index++) {
+        prb_StrMapEntry* entry = prb_strMapFindHashed(&map, keys[index], prb_hashStr(keys[index]));
+        prb_assert(entry == map.entries + index + 2 && entry->value == (u64)index + 100);
+        prb_assert(prb_strMapFind(&map, prb_fmt(arena, "dir/%d.obj", index)) == entry);
+        prb_assert(prb_strMapFind(&map, prb_fmt(arena, "dir/%d.ob", index)) == 0);
+    }
+    prb_assert(prb_streq(map.entries[0].key, prb_STR("a.c")) && prb_streq(map.entries[1].key, prb_STR("b.c")));
+
+    prb_StrMap presized = prb_createStrMap(arena, 1000);
+    i32        slotsCount = presized.slotsCount;
+    for (i32 index = 0; index < 1000; index++) {
+        prb_strMapAdd(&presized, keys[index]);
+    }
+    prb_assert(presized.slotsCount == slotsCount && presized.count == 1000);
+    prb_assert(prb_strMapAdd(&presized, prb_STR(""))->key.len == 0 && prb_strMapFind(&presized, prb_STR("")) != 0);
+
+    prb_StrMap zeroed = {};
+    prb_assert(prb_strMapFind(&zeroed, prb_STR("a.c")) == 0);
+
+    prb_endTempMemory(temp);
+}
+
+typedef struct SharedStrMapJob {
+    prb_SharedStrMap* map;
+    i32               first;
+    prb_StrMapEntry** results;
+} SharedStrMapJob;
+
+// NOTE(khvorov) Reads race with adds of the same keys from other jobs, whatever is found has to be complete
+function void
+sharedStrMapJob(prb_Arena* arena, void* data) {
+    SharedStrMapJob* job = (SharedStrMapJob*)data;
+    for (i32 index = 0; index < 4000; index++) {
+        prb_TempMemory   temp = prb_beginTempMemory(arena);
+        i32              keyIndex = (job->first + index) % 6000;
+        prb_Str          key = prb_fmt(arena, "path/%d.c", keyIndex);
+        prb_StrMapEntry* found = prb_sharedStrMapFind(job->map, key);
+        prb_assert(!found || (prb_streq(found->key, key) && found->value == (u64)keyIndex));
+        job->results[index] = prb_sharedStrMapAdd(job->map, key, (u64)keyIndex);
+        prb_assert(!found || job->results[index] == found);
+        prb_endTempMemory(temp);
+    }
+}
+
+function void
+test_sharedStrMap(prb_Arena* arena) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+
+    {
+        prb_SharedStrMap map = prb_createSharedStrMap(arena);
+        prb_assert(prb_getOffsetForAlignment(map.shards, 64) == 0 && sizeof(prb_SharedStrMapShard) == 64);
+        prb_assert(prb_sharedStrMapFind(&map, prb_STR("a.c")) == 0);
+        prb_StrMapEntry* first = prb_sharedStrMapAdd(&map, prb_STR("a.c"), 5);
+        prb_assert(prb_streq(first->key, prb_STR("a.c")) && first->key.ptr[first->key.len] == '\0' && first->value == 5);
+        prb_assert(prb_sharedStrMapAdd(&map, prb_STR("a.c"), 6) == first && first->value == 5);
+        prb_assert(prb_sharedStrMapFind(&map, prb_STR("a.c")) == first);
+        for (i32 index = 0; index < 3000; index++) {
+            prb_sharedStrMapAdd(&map, prb_fmt(arena, "%d", index), (u64)index);
+        }
+        for (i32 index = 0; index < 3000; index++) {
+            prb_StrMapEntry* entry = prb_sharedStrMapFind(&map, prb_fmt(arena, "%d", index));
+            prb_assert(entry && entry->value == (u64)index);
+        }
+        prb_assert(prb_sharedStrMapFind(&map, prb_STR("a.c")) == first);
+        prb_assert(prb_sharedStrMapFind(&map, prb_STR("3000")) == 0);
+    }
+
+    // NOTE(khvorov) Jobs add overlapping keys, every key ends up with one entry that all of them agree on
+    {
+        prb_Arena        sharedArena = prb_createArenaFromArena(arena, 10 * prb_MEGABYTE);
+        prb_SharedStrMap shared = prb_createSharedStrMap(&sharedArena);
+        i32              jobCount = 8;
+        prb_Job*         jobs = prb_arenaAllocArray(arena, prb_Job, jobCount);
+        SharedStrMapJob* jobData = prb_arenaAllocArray(arena, SharedStrMapJob, jobCount);
+        for (i32 jobIndex = 0; jobIndex < jobCount; jobIndex++) {
+            jobData[jobIndex].map = &shared;
+            jobData[jobIndex].first = jobIndex * 750;
+            jobData[jobIndex].results = prb_arenaAllocArray(arena, prb_StrMapEntry*, 4000);
+            jobs[jobIndex] = prb_createJob(sharedStrMapJob, jobData + jobIndex, arena, 10 * prb_KILOBYTE);
+        }
+        prb_assert(prb_launchJobs(jobs, jobCount, prb_Background_Yes));
+        prb_assert(prb_waitForJobs(jobs, jobCount));
+
+        i32 count = 0;
+        for (i32 shardIndex = 0; shardIndex < prb_SHARED_STR_MAP_SHARDS; shardIndex++) {
+            count += shared.shards[shardIndex].count;
+        }
+        prb_assert(count == 6000);
+        for (i32 jobIndex = 0; jobIndex < jobCount; jobIndex++) {
+            for (i32 index = 0; index < 4000; index++) {
+                prb_StrMapEntry* entry = jobData[jobIndex].results[index];
+                i32              keyIndex = (jobData[jobIndex].first + index) % 6000;
+                prb_assert(entry->value == (u64)keyIndex && prb_streq(entry->key, prb_fmt(arena, "path/%d.c", keyIndex)));
+                prb_assert(prb_sharedStrMapFind(&shared, entry->key) == entry);
+            }
+        }
+    }
+
+    prb_endTempMemory(temp);
+}
+
+function void
+assertMultiFindMatchesNaive(prb_Arena* arena, prb_MultiFinder* finder, prb_Str str) {
+    prb_TempMemory      temp = prb_beginTempMemory(arena);
+    prb_MultiFindResult result = prb_multiFinderFindAll(arena, finder, str);
+    i32                 matchIndex = 0;
+    for (i32 offset = 0; offset < str.len; offset++) {
+        for (i32 patIndex = 0; patIndex < finder->patternsCount; patIndex++) {
+            if (prb_strStartsWith(prb_strSlice(str, offset, str.len), finder->patterns[patIndex])) {
+                prb_assert(matchIndex < result.count);
+                prb_MultiFindMatch match = result.matches[matchIndex++];
+                prb_assert(match.patternIndex == patIndex && match.offset == offset);
+            }
+        }
+    }
+    prb_assert(matchIndex == result.count);
+    prb_endTempMemory(temp);
+}
+
+function void
+test_multiFinder(prb_Arena* arena) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+
+    {
+        prb_Str             patterns[] = {prb_STR("he"), prb_STR("she"), prb_STR("his"), prb_STR("hers")};
+        prb_MultiFinder     finder = prb_createMultiFinder(arena, patterns, prb_arrayCount(patterns));
+        prb_MultiFindResult result = prb_multiFinderFindAll(arena, &finder, prb_STR("ushers"));
+        prb_assert(result.count == 3);
+        prb_assert(result.matches[0].patternIndex == 1 && result.matches[0].offset == 1);
+        prb_assert(result.matches[1].patternIndex == 0 && result.matches[1].offset == 2);
+        prb_assert(result.matches[2].patternIndex == 3 && result.matches[2].offset == 2);
+        prb_assert(prb_multiFinderFindAll(arena, &finder, prb_STR("")).count == 0);
+        prb_assert(prb_multiFinderFindAll(arena, &finder, prb_STR("nothing to see")).count == 0);
+    }
+
+    // NOTE(khvorov) Overlapping matches and patterns that are the same string all get reported
+    {
+        prb_Str             patterns[] = {prb_STR("aa"), prb_STR("a"), prb_STR("aa")};
+        prb_MultiFinder     finder = prb_createMultiFinder(arena, patterns, prb_arrayCount(patterns));
+        prb_MultiFindResult result = prb_multiFinderFindAll(arena, &finder, prb_STR("aaa"));
+        prb_assert(result.count == 7);
+        prb_assert(result.matches[0].patternIndex == 0 && result.matches[0].offset == 0);
+        prb_assert(result.matches[1].patternIndex == 1 && result.matches[1].offset == 0);
+        prb_assert(result.matches[2].patternIndex == 2 && result.matches[2].offset == 0);
+        prb_assert(result.matches[6].patternIndex == 1 && result.matches[6].offset == 2);
+    }
+
+    // NOTE(khvorov) Random sets from a small alphabet with a two-byte character in it. Small sets are checked
+    // with the prefilter and with the automaton on its own.
+    {
+        prb_Rng rng = prb_createRng(1);
+        prb_Str alphabet[] = {prb_STR("a"), prb_STR("b"), prb_STR("c"), prb_STR("\xC3\xA9")};
+        for (i32 round = 0; round < 200; round++) {
+            i32      patternsCount = 1 + (i32)prb_randomU32Bound(&rng, round % 2 == 0 ? 12 : 100);
+            prb_Str* patterns = prb_arenaAllocArray(arena, prb_Str, patternsCount);
+            for (i32 patIndex = 0; patIndex < patternsCount; patIndex++) {
+                prb_GrowingStr gstr = prb_beginStr(arena);
+                i32            charCount = 1 + (i32)prb_randomU32Bound(&rng, 6);
+                for (i32 charIndex = 0; charIndex < charCount; charIndex++) {
+                    prb_addStr(&gstr, alphabet[prb_randomU32Bound(&rng, prb_arrayCount(alphabet) - (round % 3 == 0))]);
+                }
+                patterns[patIndex] = prb_endStr(&gstr);
+            }
+
+            prb_GrowingStr gstr = prb_beginStr(arena);
+            i32            charCount = (i32)prb_randomU32Bound(&rng, 300);
+            for (i32 charIndex = 0; charIndex < charCount; charIndex++) {
+                prb_addStr(&gstr, alphabet[prb_randomU32Bound(&rng, prb_arrayCount(alphabet))]);
+            }
+            prb_Str str = prb_endStr(&gstr);
+
+            prb_MultiFinder finder = prb_createMultiFinder(arena, patterns, patternsCount);
+            assertMultiFindMatchesNaive(arena, &finder, str);
+            finder.teddy = false;
+            assertMultiFindMatchesNaive(arena, &finder, str);
+        }
+    }
+
+    prb_endTempMemory(temp);
+}
+
+function void
+addRandomRegex(prb_Rng* rng, prb_GrowingStr* gstr, i32 depth) {
+    i32 pieceCount = 1 + (i32)prb_randomU32Bound(rng, 3);
+    for (i32 pieceIndex = 0; pieceIndex < pieceCount; pieceIndex++) {
+        u32 atom = prb_randomU32Bound(rng, depth > 0 ? 7 : 6);
+        switch (atom) {
+            case 0:
+            case 1: prb_addChar(gstr, 'a'); break;
+            case 2: prb_addChar(gstr, 'b'); break;
+            case 3: prb_addChar(gstr, '.'); break;
+            case 4: prb_addStr(gstr, prb_STR("[ac]")); break;
+            case 5: prb_addStr(gstr, prb_STR("[^a]")); break;
+            case 6: {
+                prb_addChar(gstr, '(');
+                addRandomRegex(rng, gstr, depth - 1);
+                if (prb_randomU32Bound(rng, 2) == 0) {
+                    prb_addChar(gstr, '|');
+                    addRandomRegex(rng, gstr, depth - 1);
+                }
+                prb_addChar(gstr, ')');
+            } break;
+        }
+        const char* quantifiers[] = {"", "", "", "*", "+", "?", "{1,2}", "{2}"};
+        const char* quantifier = quantifiers[prb_randomU32Bound(rng, prb_arrayCount(quantifiers))];
+        prb_addStr(gstr, prb_STR(quantifier));
+    }
+}
+
+function void
+test_regex(prb_Arena* arena) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+
+    {
+        prb_CompileRegexResult compiled = prb_compileRegex(arena, prb_STR("\\.(gcda|gcno|exe|pdb|obj)$|^coverage"), 0);
+        prb_assert(compiled.success);
+        prb_Regex* regex = compiled.regex;
+        prb_assert(prb_regexFind(regex, prb_STR("tests/run.gcno")).found);
+        prb_assert(prb_regexFind(regex, prb_STR("coverage.txt")).found);
+        prb_assert(!prb_regexFind(regex, prb_STR("tests/coverage.txt")).found);
+        prb_assert(!prb_regexFind(regex, prb_STR("tests/run.exe.c")).found);
+        prb_assert(!prb_regexMatch(regex, prb_STR("tests/run.gcno")));
+        prb_assert(prb_regexMatch(regex, prb_STR(".obj")));
+    }
+
+    // NOTE(khvorov) Leftmost and then longest, not the first to end
+    {
+        prb_Regex*        regex = prb_compileRegex(arena, prb_STR("abcd|c|x+"), 0).regex;
+        prb_StrFindResult find = prb_regexFind(regex, prb_STR("zabcd xxx"));
+        prb_assert(find.found && prb_streq(find.beforeMatch, prb_STR("z")) && prb_streq(find.match, prb_STR("abcd")));
+        find = prb_regexFind(regex, find.afterMatch);
+        prb_assert(find.found && prb_streq(find.beforeMatch, prb_STR(" ")) && prb_streq(find.match, prb_STR("xxx")) && find.afterMatch.len == 0);
+    }
+
+    {
+        prb_Regex* regex = prb_compileRegex(arena, prb_STR("(?:[0-9]+\\.){2}\\d+\\s\\w*[^\\d\\s]?"), 0).regex;
+        prb_assert(prb_regexMatch(regex, prb_STR("1.22.333 abc_9Z")));
+        prb_assert(prb_regexMatch(regex, prb_STR("1.22.333\t")));
+        prb_assert(!prb_regexMatch(regex, prb_STR("1.22.333 abc 9")));
+        prb_assert(!prb_regexMatch(regex, prb_STR("1.22 abc")));
+    }
+
+    {
+        prb_Regex* regex = prb_compileRegex(arena, prb_STR("a*"), 0).regex;
+        prb_assert(prb_regexMatch(regex, prb_STR("")));
+        prb_StrFindResult find = prb_regexFind(regex, prb_STR("baa"));
+        prb_assert(find.found && find.beforeMatch.len == 0 && find.match.len == 0);
+        prb_assert(prb_regexMatch(prb_compileRegex(arena, prb_STR("\\x41[]x]\\*"), 0).regex, prb_STR("A]*")));
+    }
+
+    {
+        const char* invalid[] = {"(", "a)", "*a", "a{2,1}", "[a", "\\q", "a{1001}", "\\x4"};
+        i32         errorOffsets[] = {1, 1, 0, 5, 2, 1, 6, 2};
+        for (i32 patIndex = 0; patIndex < prb_arrayCount(invalid); patIndex++) {
+            prb_CompileRegexResult compiled = prb_compileRegex(arena, prb_STR(invalid[patIndex]), 0);
+            prb_assert(!compiled.success && compiled.errorOffset == errorOffsets[patIndex]);
+        }
+    }
+
+    // NOTE(khvorov) The caches come out of the arena so the caller decides what they cost
+    {
+        intptr_t usedBefore = arena->used;
+        prb_assert(prb_compileRegex(arena, prb_STR("a+b"), 0).success);
+        prb_assert(arena->used - usedBefore < 128 * prb_KILOBYTE);
+        usedBefore = arena->used;
+        prb_assert(prb_compileRegex(arena, prb_STR("a+b"), 3 * prb_MEGABYTE).success);
+        prb_assert(arena->used - usedBefore >= 3 * prb_MEGABYTE);
+    }
+
+    // NOTE(khvorov) A cache this small gets reset all the time and the answers have to stay the same
+    {
+        prb_Regex* regex = prb_compileRegex(arena, prb_STR("(a|b)*a(a|b){12}"), 0).regex;
+        prb_Rng    rng = prb_createRng(3);
+        for (i32 round = 0; round < 100; round++) {
+            char buf[200];
+            for (i32 byteIndex = 0; byteIndex < prb_arrayCount(buf); byteIndex++) {
+                buf[byteIndex] = prb_randomU32Bound(&rng, 2) == 0 ? 'a' : 'b';
+            }
+            prb_Str str = {buf, prb_arrayCount(buf)};
+            prb_assert(prb_regexMatch(regex, str) == (buf[prb_arrayCount(buf) - 13] == 'a'));
+        }
+        prb_assert(regex->matchDfa.flushCount > 0);
+    }
+
+#if prb_PLATFORM_LINUX
+    // NOTE(khvorov) POSIX extended regexes are leftmost-longest too
+    {
+        prb_Rng rng = prb_createRng(1);
+        for (i32 round = 0; round < 300; round++) {
+            prb_GrowingStr gstr = prb_beginStr(arena);
+            if (prb_randomU32Bound(&rng, 4) == 0) {
+                prb_addChar(&gstr, '^');
+            }
+            addRandomRegex(&rng, &gstr, 2);
+            if (prb_randomU32Bound(&rng, 4) == 0) {
+                prb_addChar(&gstr, '$');
+            }
+            prb_Str pattern = prb_endStr(&gstr);
+
+            prb_CompileRegexResult compiled = prb_compileRegex(arena, pattern, 0);
+            prb_assert(compiled.success);
+            regex_t posix;
+            prb_assert(regcomp(&posix, pattern.ptr, REG_EXTENDED) == 0);
+
+            for (i32 strIndex = 0; strIndex < 20; strIndex++) {
+                char buf[41];
+                i32  strLen = (i32)prb_randomU32Bound(&rng, prb_arrayCount(buf));
+                for (i32 byteIndex = 0; byteIndex < strLen; byteIndex++) {
+                    buf[byteIndex] = "abc"[prb_randomU32Bound(&rng, 3)];
+                }
+                buf[strLen] = '\0';
+                prb_Str str = {buf, strLen};
+
+                regmatch_t        posixMatch;
+                bool              posixFound = regexec(&posix, buf, 1, &posixMatch, 0) == 0;
+                prb_StrFindResult find = prb_regexFind(compiled.regex, str);
+                prb_assert(find.found == posixFound);
+                if (find.found) {
+                    prb_assert(find.beforeMatch.len == posixMatch.rm_so && find.beforeMatch.len + find.match.len == posixMatch.rm_eo);
+                }
+                bool posixWhole = posixFound && posixMatch.rm_so == 0 && posixMatch.rm_eo == strLen;
+                prb_assert(prb_regexMatch(compiled.regex, str) == posixWhole);
+            }
+            regfree(&posix);
+        }
+    }
+#endif
+
+    prb_endTempMemory(temp);
+}
+
+function void
+test_sortU64(prb_Arena* arena) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+
+    {
+        u64 keys[] = {5, 0xFF00000000000000ULL, 3, 5, 0, 0x100};
+        u64 values[] = {0, 1, 2, 3, 4, 5};
+        prb_sortU64(arena, keys, values, prb_arrayCount(keys));
+        u64 sortedKeys[] = {0, 3, 5, 5, 0x100, 0xFF00000000000000ULL};
+        u64 sortedValues[] = {4, 2, 0, 3, 5, 1};
+        prb_assert(prb_memeq(keys, sortedKeys, sizeof(keys)) && prb_memeq(values, sortedValues, sizeof(values)));
+    }
+
+    // NOTE(khvorov) Equal keys keep their order, the values say where they were
+    prb_Rng rng = prb_createRng(1);
+    i32     counts[] = {0, 1, 1000, 100000};
+    u64     keyMasks[] = {0xFF, 0xFFFF0000, 0xFFFFFFFFFFFFFFFFULL};
+    for (i32 countIndex = 0; countIndex < prb_arrayCount(counts); countIndex++) {
+        for (i32 maskIndex = 0; maskIndex < prb_arrayCount(keyMasks); maskIndex++) {
+            i32  count = counts[countIndex];
+            u64* keys = prb_arenaAllocArray(arena, u64, count);
+            u64* values = prb_arenaAllocArray(arena, u64, count);
+            u64* keysOnly = prb_arenaAllocArray(arena, u64, count);
+            for (i32 index = 0; index < count; index++) {
+                keys[index] = (((u64)prb_randomU32(&rng) << 32) | prb_randomU32(&rng)) & keyMasks[maskIndex];
+                values[index] = (u64)index;
+                keysOnly[index] = keys[index];
+            }
+            u64* original = prb_arenaAllocArray(arena, u64, count);
+            prb_memcpy(original, keys, (usize)count * sizeof(u64));
+
+            prb_sortU64(arena, keys, values, count);
+            prb_sortU64(arena, keysOnly, 0, count);
+            for (i32 index = 0; index < count; index++) {
+                prb_assert(keys[index] == original[values[index]] && keysOnly[index] == keys[index]);
+                if (index > 0) {
+                    prb_assert(keys[index - 1] < keys[index] || (keys[index - 1] == keys[index] && values[index - 1] < values[index]));
+                }
+            }
+        }
+    }
+
+    prb_endTempMemory(temp);
+}
+
+function int
+compareStrs(const void* left, const void* right) {
+    prb_Str str1 = *(const prb_Str*)left;
+    prb_Str str2 = *(const prb_Str*)right;
+    int     result = prb_memcmp(str1.ptr, str2.ptr, (usize)prb_min(str1.len, str2.len));
+    if (result == 0) {
+        result = str1.len < str2.len ? -1 : str1.len > str2.len;
+    }
+    return result;
+}
+
+function void
+test_sortStrs(prb_Arena* arena) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+
+    {
+        prb_Str strs[] = {prb_STR("b"), prb_STR(""), prb_STR("ab"), prb_STR("a"), prb_STR("\xFF"), prb_STR("ab"), prb_STR("B")};
+        prb_sortStrs(arena, strs, prb_arrayCount(strs));
+        const char* sorted[] = {"", "B", "a", "ab", "ab", "b", "\xFF"};
+        for (i32 index = 0; index < prb_arrayCount(strs); index++) {
+            prb_assert(prb_streq(strs[index], prb_STR(sorted[index])));
+        }
+    }
+
+    // NOTE(khvorov) Shared prefixes, duplicates and strings that are prefixes of others, checked against qsort
+    prb_Rng rng = prb_createRng(2);
+    i32     counts[] = {0, 1, 31, 32, 1000, 50000};
+    for (i32 countIndex = 0; countIndex < prb_arrayCount(counts); countIndex++) {
+        i32      count = counts[countIndex];
+        prb_Str* strs = prb_arenaAllocArray(arena, prb_Str, count);
+        for (i32 index = 0; index < count; index++) {
+            prb_GrowingStr gstr = prb_beginStr(arena);
+            if (prb_randomU32Bound(&rng, 2) == 0) {
+                prb_addStr(&gstr, prb_STR("build/objects/library/"));
+            }
+            i32 len = (i32)prb_randomU32Bound(&rng, 8);
+            for (i32 byteIndex = 0; byteIndex < len; byteIndex++) {
+                prb_addChar(&gstr, "ab/\x80"[prb_randomU32Bound(&rng, 4)]);
+            }
+            strs[index] = prb_endStr(&gstr);
+        }
+        prb_Str* expected = prb_arenaAllocArray(arena, prb_Str, count);
+        prb_memcpy(expected, strs, (usize)count * sizeof(prb_Str));
+        qsort(expected, (usize)count, sizeof(prb_Str), compareStrs);
+
+        prb_sortStrs(arena, strs, count);
+        for (i32 index = 0; index < count; index++) {
+            prb_assert(prb_streq(strs[index], expected[index]));
+        }
+    }
+
+    prb_endTempMemory(temp);
+}
+
+//
+// SECTION Processes
+//
+
+function void
+test_terminate(prb_Arena* arena) {
     prb_TempMemory temp = prb_beginTempMemory(arena);
     prb_Str        dir = getTempPath(arena, __FUNCTION__);
     prb_assert(prb_clearDir(arena, dir));
@@ -2744,6 +4386,73 @@ test_env(prb_Arena* arena) {
     prb_endTempMemory(temp);
 }
 
+function void
+test_rebuildSelfIfChanged(prb_Arena* arena) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+    prb_Str        dir = getTempPath(arena, __FUNCTION__);
+    prb_assert(prb_clearDir(arena, dir));
+
+    prb_Str programSrc = prb_pathJoin(arena, dir, prb_STR("program.c"));
+    prb_Str programExe = prb_pathJoin(arena, dir, prb_STR("program.exe"));
+    prb_Str outPath = prb_pathJoin(arena, dir, prb_STR("out.txt"));
+    prb_Str programFmt = prb_STR(
+        "#include \"../../cbuild.h\"\n"
+        "int main() {\n"
+        "prb_Arena arena = prb_createArenaFromVmem(1 * prb_MEGABYTE);\n"
+        "prb_rebuildSelfIfChanged(&arena, prb_STR(__FILE__), prb_STR(\"-g\"));\n"
+        "return %d;\n"
+        "}"
+    );
+
+    {
+        prb_Str program = prb_fmt(arena, (const char*)programFmt.ptr, 1);
+        prb_assert(prb_writeEntireFile(arena, programSrc, program.ptr, program.len));
+        prb_Str     cmd = prb_fmt(arena, "clang %.*s -o %.*s", prb_LIT(programSrc), prb_LIT(programExe));
+        prb_Process proc = prb_createProcess(cmd, (prb_ProcessSpec) {});
+        prb_assert(prb_launchProcesses(arena, &proc, 1, prb_Background_No));
+    }
+
+    prb_ProcessSpec spec = {};
+    spec.redirectStdout = true;
+    spec.stdoutFilepath = outPath;
+    prb_StrFindSpec implCmd = {};
+    implCmd.pattern = prb_STR("-Dprb_NOT_STATIC");
+    prb_StrFindSpec programCmd = {};
+    programCmd.pattern = prb_STR("-Dprb_NO_IMPLEMENTATION");
+
+    // NOTE(khvorov) No stamp yet so both the implementation and the program are rebuilt
+    {
+        prb_Process proc = prb_createProcess(programExe, spec);
+        prb_assert(prb_launchProcesses(arena, &proc, 1, prb_Background_No) == prb_Failure);
+        prb_Str out = prb_strFromBytes(prb_readEntireFile(arena, outPath).content);
+        prb_assert(prb_strFind(out, implCmd).found);
+        prb_assert(prb_strFind(out, programCmd).found);
+        prb_assert(prb_isFile(arena, prb_replaceExt(arena, programExe, prb_STR("rebuild"))));
+        prb_assert(prb_isFile(arena, prb_replaceExt(arena, programExe, prb_STR("cbuild.obj"))));
+    }
+
+    // NOTE(khvorov) Nothing changed
+    {
+        prb_Process proc = prb_createProcess(programExe, spec);
+        prb_assert(prb_launchProcesses(arena, &proc, 1, prb_Background_No) == prb_Failure);
+        prb_assert(prb_readEntireFile(arena, outPath).content.len == 0);
+    }
+
+    // NOTE(khvorov) Source changed, implementation is reused
+    {
+        prb_Str program = prb_fmt(arena, (const char*)programFmt.ptr, 0);
+        prb_assert(prb_writeEntireFile(arena, programSrc, program.ptr, program.len));
+        prb_Process proc = prb_createProcess(programExe, spec);
+        prb_assert(prb_launchProcesses(arena, &proc, 1, prb_Background_No) == prb_Success);
+        prb_Str out = prb_strFromBytes(prb_readEntireFile(arena, outPath).content);
+        prb_assert(!prb_strFind(out, implCmd).found);
+        prb_assert(prb_strFind(out, programCmd).found);
+    }
+
+    prb_assert(prb_removePathIfExists(arena, dir));
+    prb_endTempMemory(temp);
+}
+
 //
 // SECTION Timing
 //
@@ -2804,6 +4513,675 @@ test_jobs(prb_Arena* arena) {
     prb_endTempMemory(temp);
 }
 
+//
+// SECTION Remote execution
+//
+
+typedef struct WorkerJobSpec {
+    prb_Str    address;
+    prb_Str    workDir;
+    prb_Str    token;
+    prb_Status status;
+} WorkerJobSpec;
+
+function void
+workerJob(prb_Arena* arena, void* data) {
+    WorkerJobSpec* spec = (WorkerJobSpec*)data;
+    spec->status = prb_runWorker(arena, spec->address, spec->workDir, spec->token);
+}
+
+#if prb_PLATFORM_LINUX
+// NOTE(khvorov) Sends an action the coordinator would never send, returns true if the worker went on to ask for blobs
+function bool
+workerAcceptsAction(prb_Arena* arena, WorkerJobSpec* workerSpec, uint8_t* actionPayload) {
+    prb_linux_OpenSocketResult connection = prb_linux_openSocket(arena, workerSpec->address, false);
+    prb_assert(connection.success);
+    prb_assert(prb_remote_sendToken(connection.sock, prb_remote_MsgKind_Hello, workerSpec->token));
+    prb_assert(prb_remote_sendMsg(connection.sock, prb_remote_MsgKind_Action, actionPayload));
+    prb_remote_RecvResult reply = prb_remote_recvMsg(arena, connection.sock);
+    close(connection.sock);
+    arrfree(actionPayload);
+    bool result = reply.success && reply.kind == prb_remote_MsgKind_Need;
+    return result;
+}
+#endif
+
+function void
+resetCopyActions(prb_Arena* arena, prb_Action* actions, i32 actionsCount) {
+    for (i32 actionIndex = 0; actionIndex < actionsCount; actionIndex++) {
+        prb_Action* action = actions + actionIndex;
+        action->status = prb_ProcessStatus_NotLaunched;
+        action->ranRemotely = false;
+        for (i32 outputIndex = 0; outputIndex < action->outputsCount; outputIndex++) {
+            prb_assert(prb_removePathIfExists(arena, action->outputs[outputIndex]));
+        }
+    }
+}
+
+function void
+checkCopyActions(prb_Arena* arena, prb_Action* actions, i32 actionsCount, bool remote) {
+    for (i32 actionIndex = 0; actionIndex < actionsCount; actionIndex++) {
+        prb_Action* action = actions + actionIndex;
+        prb_assert(action->status == prb_ProcessStatus_CompletedSuccess);
+        prb_assert(action->ranRemotely == remote);
+        prb_ReadEntireFileResult input = prb_readEntireFile(arena, action->inputs[0]);
+        prb_ReadEntireFileResult output = prb_readEntireFile(arena, action->outputs[0]);
+        prb_assert(input.success && output.success);
+        prb_assert(prb_streq(prb_strFromBytes(output.content), prb_fmt(arena, "copied:%.*s", prb_LIT(prb_strFromBytes(input.content)))));
+    }
+}
+
+function void
+test_remoteExecution(prb_Arena* arena) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+    prb_Str        dir = getTempPath(arena, __FUNCTION__);
+    prb_assert(prb_clearDir(arena, dir));
+
+    prb_Str copySrc = prb_pathJoin(arena, dir, prb_STR("copy.c"));
+    prb_Str copyCode = prb_STR(
+        "#include <stdio.h>\n"
+        "int main(int argc, char** argv) {\n"
+        "if (argc != 3) {return 1;}\n"
+        "FILE* in = fopen(argv[1], \"rb\");\n"
+        "FILE* out = fopen(argv[2], \"wb\");\n"
+        "if (!in || !out) {return 1;}\n"
+        "fputs(\"copied:\", out);\n"
+        "for (int ch = fgetc(in); ch != EOF; ch = fgetc(in)) {fputc(ch, out);}\n"
+        "fclose(in);\n"
+        "fclose(out);\n"
+        "return 0;\n"
+        "}"
+    );
+    prb_assert(prb_writeEntireFile(arena, copySrc, copyCode.ptr, copyCode.len));
+    prb_Str copyExe = prb_replaceExt(arena, copySrc, prb_STR("exe"));
+    {
+        prb_Process proc = prb_createProcess(prb_fmt(arena, "clang %.*s -o %.*s", prb_LIT(copySrc), prb_LIT(copyExe)), (prb_ProcessSpec) {});
+        prb_assert(prb_launchProcesses(arena, &proc, 1, prb_Background_No));
+    }
+
+    // NOTE(khvorov) Some inputs have the same content so that workers can reuse them
+    prb_Str     execRoot = prb_pathJoin(arena, dir, prb_STR("root"));
+    i32         actionsCount = 10;
+    i32         distinctInputs = 5;
+    prb_Action* actions = prb_arenaAllocArray(arena, prb_Action, actionsCount);
+    for (i32 actionIndex = 0; actionIndex < actionsCount; actionIndex++) {
+        prb_Action* action = actions + actionIndex;
+        action->execRoot = execRoot;
+        action->inputs = prb_arenaAllocArray(arena, prb_Str, 1);
+        action->inputs[0] = prb_pathJoin(arena, execRoot, prb_fmt(arena, "in/%d.txt", actionIndex));
+        action->inputsCount = 1;
+        action->outputs = prb_arenaAllocArray(arena, prb_Str, 1);
+        action->outputs[0] = prb_pathJoin(arena, execRoot, prb_fmt(arena, "out/%d.txt", actionIndex));
+        action->outputsCount = 1;
+        action->cmd = prb_fmt(arena, "%.*s %.*s %.*s", prb_LIT(copyExe), prb_LIT(action->inputs[0]), prb_LIT(action->outputs[0]));
+        prb_Str content = prb_fmt(arena, "input %d", actionIndex % distinctInputs);
+        prb_assert(prb_writeEntireFile(arena, action->inputs[0], content.ptr, content.len));
+        prb_assert(prb_createDirIfNotExists(arena, prb_getParentDir(arena, action->outputs[0])));
+    }
+
+    {
+        prb_ExecSpec spec = {};
+        spec.localSlots = 3;
+        prb_assert(prb_executeActions(arena, actions, actionsCount, spec));
+        checkCopyActions(arena, actions, actionsCount, false);
+    }
+
+    // NOTE(khvorov) Only paths inside the root can be sent to workers
+    {
+        prb_Str root = prb_STR("/a/b");
+        prb_assert(prb_streq(prb_remote_relPath(root, prb_STR("/a/b/c.txt")), prb_STR("c.txt")));
+        prb_assert(prb_streq(prb_remote_relPath(prb_STR("/a/b/"), prb_STR("/a/b/c/d.txt")), prb_STR("c/d.txt")));
+        prb_assert(prb_remote_relPath(root, prb_STR("/a/bc/d.txt")).len == 0);
+        prb_assert(prb_remote_relPath(root, prb_STR("/a/b")).len == 0);
+        prb_assert(prb_remote_relPath(root, prb_STR("/x/b/c.txt")).len == 0);
+
+        prb_assert(prb_remote_isSandboxPath(prb_STR("in/0.txt")));
+        prb_assert(prb_remote_isSandboxPath(prb_STR("in/..txt")));
+        prb_assert(!prb_remote_isSandboxPath(prb_STR("")));
+        prb_assert(!prb_remote_isSandboxPath(prb_STR("/etc/passwd")));
+        prb_assert(!prb_remote_isSandboxPath(prb_STR("..")));
+        prb_assert(!prb_remote_isSandboxPath(prb_STR("in/../../escape.txt")));
+    }
+
+    // NOTE(khvorov) Unreachable workers leave everything to local slots
+    {
+        resetCopyActions(arena, actions, actionsCount);
+        prb_Str      missingWorker = prb_STR("unix:/this/path/does/not/exist");
+        prb_ExecSpec spec = {};
+        spec.workers = &missingWorker;
+        spec.workersCount = 1;
+        prb_assert(prb_executeActions(arena, actions, actionsCount, spec));
+        checkCopyActions(arena, actions, actionsCount, false);
+
+        // NOTE(khvorov) Even without local slots
+        resetCopyActions(arena, actions, actionsCount);
+        spec.localSlots = -1;
+        prb_assert(prb_executeActions(arena, actions, actionsCount, spec));
+        checkCopyActions(arena, actions, actionsCount, false);
+    }
+
+#if prb_PLATFORM_LINUX
+    // NOTE(khvorov) Blobs are cached by SHA-256, the inputs cover padding that fits in the last block and padding that doesn't
+    {
+        const char* inputs[] = {"", "abc", "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"};
+        const char* digests[] = {
+            "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855",
+            "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+            "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1",
+        };
+        for (i32 inputIndex = 0; inputIndex < prb_arrayCount(inputs); inputIndex++) {
+            prb_remote_Digest digest = prb_remote_sha256(inputs[inputIndex], prb_strlen(inputs[inputIndex]));
+            prb_Str           casPath = prb_remote_casPath(arena, prb_STR("cas"), digest);
+            prb_assert(prb_streq(prb_getLastEntryInPath(casPath), prb_STR(digests[inputIndex])));
+        }
+    }
+
+    {
+        // NOTE(khvorov) Unix socket paths are short so can't put it in the test dir
+        WorkerJobSpec workerSpec = {};
+        prb_Str       socketPath = prb_fmt(arena, "/tmp/cbuild-test-worker-%.*s.sock", prb_LIT(globalSuffix));
+        workerSpec.address = prb_fmt(arena, "unix:%.*s", prb_LIT(socketPath));
+        workerSpec.workDir = prb_pathJoin(arena, dir, prb_STR("worker"));
+        workerSpec.token = prb_STR("test-token");
+        // NOTE(khvorov) A killed run leaves its socket behind, sockets aren't files so prb_removePathIfExists skips them
+        unlink(prb_strGetNullTerminated(arena, socketPath));
+
+        // NOTE(khvorov) Workers can't run without a token
+        {
+            WorkerJobSpec noToken = workerSpec;
+            noToken.token = prb_STR("");
+            workerJob(arena, &noToken);
+            prb_assert(noToken.status == prb_Failure);
+            prb_assert(!prb_pathExists(arena, socketPath));
+        }
+
+        // NOTE(khvorov) Workers fork handlers so they refuse to run next to other threads
+        {
+            WorkerJobSpec withThreads = workerSpec;
+            prb_Job       workerJobHandle = prb_createJob(workerJob, &withThreads, arena, 10 * prb_MEGABYTE);
+            prb_assert(prb_launchJobs(&workerJobHandle, 1, prb_Background_Yes));
+            prb_assert(prb_waitForJobs(&workerJobHandle, 1));
+            prb_assert(withThreads.status == prb_Failure);
+            prb_assert(!prb_pathExists(arena, socketPath));
+        }
+
+        // NOTE(khvorov) The coordinator below uses threads so the worker gets its own process
+        pid_t workerPid = fork();
+        prb_assert(workerPid != -1);
+        if (workerPid == 0) {
+            // NOTE(khvorov) Don't outlive a failed test
+            prctl(PR_SET_PDEATHSIG, SIGKILL);
+            workerJob(arena, &workerSpec);
+            _exit(workerSpec.status == prb_Success ? 0 : 1);
+        }
+        while (!prb_pathExists(arena, socketPath)) {
+            prb_sleep(1);
+        }
+
+        // NOTE(khvorov) A connection that never sends anything doesn't hold up the others
+        prb_linux_OpenSocketResult silent = prb_linux_openSocket(arena, workerSpec.address, false);
+        prb_assert(silent.success);
+
+        // NOTE(khvorov) A wrong token neither runs anything nor stops the worker
+        resetCopyActions(arena, actions, actionsCount);
+        prb_ExecSpec spec = {};
+        spec.localSlots = 1;
+        spec.workers = &workerSpec.address;
+        spec.workersCount = 1;
+        spec.workerToken = prb_STR("test-tokem");
+        prb_assert(prb_executeActions(arena, actions, actionsCount, spec));
+        checkCopyActions(arena, actions, actionsCount, false);
+        prb_assert(prb_stopWorker(arena, workerSpec.address, spec.workerToken));
+
+        resetCopyActions(arena, actions, actionsCount);
+        spec.localSlots = -1;
+        spec.workerToken = workerSpec.token;
+        spec.slotsPerWorker = 4;
+        prb_assert(prb_executeActions(arena, actions, actionsCount, spec));
+        checkCopyActions(arena, actions, actionsCount, true);
+
+        // NOTE(khvorov) Actions with paths outside the root stay local
+        {
+            prb_Action outside = actions[0];
+            outside.execRoot = prb_fmt(arena, "%.*s/i", prb_LIT(execRoot));
+            outside.inputs = prb_arenaAllocArray(arena, prb_Str, 1);
+            outside.inputs[0] = prb_pathJoin(arena, execRoot, prb_STR("in/0.txt"));
+            outside.status = prb_ProcessStatus_NotLaunched;
+            prb_assert(prb_removePathIfExists(arena, outside.outputs[0]));
+            prb_ExecSpec withLocal = spec;
+            withLocal.localSlots = 1;
+            prb_assert(prb_executeActions(arena, &outside, 1, withLocal));
+            prb_assert(!outside.ranRemotely);
+        }
+
+        // NOTE(khvorov) The worker drops actions that try to leave the sandbox or claim more entries than they have
+        {
+            uint8_t* payload = 0;
+            prb_remote_putStr(&payload, prb_STR("true"));
+            prb_remote_putStr(&payload, prb_STR(""));
+            prb_remote_putStr(&payload, execRoot);
+            prb_remote_putU64(&payload, 1);
+            prb_remote_putStr(&payload, prb_STR("in/0.txt"));
+            prb_remote_putDigest(&payload, prb_remote_sha256("", 0));
+            prb_remote_putU64(&payload, 1);
+            prb_remote_putStr(&payload, prb_STR("out/0.txt"));
+            prb_assert(workerAcceptsAction(arena, &workerSpec, payload));
+
+            const char* badPaths[] = {"../escape.txt", "/tmp/escape.txt", "in/../../escape.txt"};
+            for (i32 pathIndex = 0; pathIndex < prb_arrayCount(badPaths); pathIndex++) {
+                for (i32 asOutput = 0; asOutput < 2; asOutput++) {
+                    payload = 0;
+                    prb_remote_putStr(&payload, prb_STR("true"));
+                    prb_remote_putStr(&payload, prb_STR(""));
+                    prb_remote_putStr(&payload, execRoot);
+                    prb_remote_putU64(&payload, 1);
+                    prb_remote_putStr(&payload, asOutput ? prb_STR("in/0.txt") : prb_STR(badPaths[pathIndex]));
+                    prb_remote_putDigest(&payload, prb_remote_sha256("", 0));
+                    prb_remote_putU64(&payload, 1);
+                    prb_remote_putStr(&payload, asOutput ? prb_STR(badPaths[pathIndex]) : prb_STR("out/0.txt"));
+                    prb_assert(!workerAcceptsAction(arena, &workerSpec, payload));
+                }
+            }
+
+            payload = 0;
+            prb_remote_putStr(&payload, prb_STR("true"));
+            prb_remote_putStr(&payload, prb_STR(""));
+            prb_remote_putStr(&payload, execRoot);
+            prb_remote_putU64(&payload, (u64)INT32_MAX);
+            prb_assert(!workerAcceptsAction(arena, &workerSpec, payload));
+        }
+
+        prb_Str* blobs = prb_getAllDirEntries(arena, prb_pathJoin(arena, workerSpec.workDir, prb_STR("cas")), prb_Recursive_No);
+        prb_assert(arrlen(blobs) == distinctInputs);
+        arrfree(blobs);
+
+        // NOTE(khvorov) Mixed local and remote
+        resetCopyActions(arena, actions, actionsCount);
+        spec.localSlots = 2;
+        spec.slotsPerWorker = 2;
+        prb_assert(prb_executeActions(arena, actions, actionsCount, spec));
+        for (i32 actionIndex = 0; actionIndex < actionsCount; actionIndex++) {
+            prb_assert(actions[actionIndex].status == prb_ProcessStatus_CompletedSuccess);
+        }
+
+        // NOTE(khvorov) Failure on the worker
+        {
+            prb_Action failing = {};
+            failing.execRoot = execRoot;
+            failing.cmd = prb_fmt(arena, "%.*s %.*s/in/missing.txt %.*s/out/missing.txt", prb_LIT(copyExe), prb_LIT(execRoot), prb_LIT(execRoot));
+            spec.localSlots = -1;
+            prb_assert(prb_executeActions(arena, &failing, 1, spec) == prb_Failure);
+            prb_assert(failing.status == prb_ProcessStatus_CompletedFailed);
+            prb_assert(failing.ranRemotely);
+        }
+
+        close(silent.sock);
+        prb_assert(prb_stopWorker(arena, workerSpec.address, workerSpec.token));
+        int workerStatus = 0;
+        prb_assert(waitpid(workerPid, &workerStatus, 0) == workerPid);
+        prb_assert(WIFEXITED(workerStatus) && WEXITSTATUS(workerStatus) == 0);
+        prb_assert(!prb_pathExists(arena, socketPath));
+    }
+#endif
+
+    prb_assert(prb_removePathIfExists(arena, dir));
+    prb_endTempMemory(temp);
+}
+
+//
+// SECTION Static libraries
+//
+
+function prb_FileTimestamp*
+getObjTimestamps(prb_Arena* arena, prb_StaticLib* lib, prb_Str* objNames, i32 objNamesCount) {
+    prb_FileTimestamp* result = prb_arenaAllocArray(arena, prb_FileTimestamp, objNamesCount);
+    for (i32 objIndex = 0; objIndex < objNamesCount; objIndex++) {
+        result[objIndex] = prb_getLastModified(arena, prb_pathJoin(arena, lib->spec.objDir, objNames[objIndex]));
+        prb_assert(result[objIndex].valid);
+    }
+    return result;
+}
+
+function void
+test_staticLibs(prb_Arena* arena) {
+    prb_TempMemory temp = prb_beginTempMemory(arena);
+    prb_Str        dir = getTempPath(arena, __FUNCTION__);
+    prb_assert(prb_clearDir(arena, dir));
+
+    // NOTE(khvorov) Headers are told apart by their whole path however long it is
+    {
+        prb_Str prefix = prb_fmt(arena, "%0*d", 5000, 0);
+        prb_Str preprocessed = prb_fmt(arena, "# 1 \"%.*s/a.h\"\nint a;\n# 1 \"%.*s/b.h\"\nint b;\n", prb_LIT(prefix), prb_LIT(prefix));
+        prb_Str fileHashes = prb_lib_fileHashes(arena, preprocessed);
+        prb_Str changed = prb_lib_changedFiles(arena, fileHashes, prb_lib_fileHashes(arena, prb_fmt(arena, "%.*sint c;\n", prb_LIT(preprocessed))));
+        prb_assert(prb_streq(changed, prb_fmt(arena, "changed %.*s/b.h", prb_LIT(prefix))));
+    }
+
+    prb_Str srcDir = prb_pathJoin(arena, dir, prb_STR("src"));
+    prb_Str files[][2] = {
+        {prb_STR("lib/a.c"), prb_STR("int a(void) {return 1;}")},
+        {prb_STR("lib/b.c"), prb_STR("int b(void) {return 2;}")},
+        {prb_STR("lib/notes.txt"), prb_STR("not a source")},
+        {prb_STR("cpp/c.cpp"), prb_STR("extern \"C\" int c(void) {return 3;}")},
+    };
+    for (i32 fileIndex = 0; fileIndex < prb_arrayCount(files); fileIndex++) {
+        prb_Str path = prb_pathJoin(arena, srcDir, files[fileIndex][0]);
+        prb_assert(prb_writeEntireFile(arena, path, files[fileIndex][1].ptr, files[fileIndex][1].len));
+    }
+
+#if prb_PLATFORM_WINDOWS
+    prb_Str libExt = prb_STR("lib");
+#elif prb_PLATFORM_LINUX
+    prb_Str libExt = prb_STR("a");
+#else
+#error unimplemented
+#endif
+
+    prb_Str           cSources[] = {prb_STR("lib/*.c")};
+    prb_StaticLibSpec cSpec = {};
+    cSpec.name = prb_STR("c");
+    cSpec.srcDir = srcDir;
+    cSpec.sources = cSources;
+    cSpec.sourcesCount = prb_arrayCount(cSources);
+    cSpec.flags = prb_STR("-O1");
+    cSpec.objDir = prb_pathJoin(arena, dir, prb_STR("obj-c"));
+    cSpec.libFile = prb_pathJoin(arena, dir, prb_fmt(arena, "c.%.*s", prb_LIT(libExt)));
+
+    prb_Str           cppSources[] = {prb_STR("cpp/c.cpp")};
+    prb_StaticLibSpec cppSpec = {};
+    cppSpec.name = prb_STR("cpp");
+    cppSpec.srcDir = srcDir;
+    cppSpec.sources = cppSources;
+    cppSpec.sourcesCount = prb_arrayCount(cppSources);
+    cppSpec.objDir = prb_pathJoin(arena, dir, prb_STR("obj-cpp"));
+    cppSpec.libFile = prb_pathJoin(arena, dir, prb_fmt(arena, "cpp.%.*s", prb_LIT(libExt)));
+    cppSpec.cpp = true;
+
+    {
+        prb_StaticLib libs[] = {prb_createStaticLib(arena, cSpec), prb_createStaticLib(arena, cppSpec)};
+        prb_assert(libs[0].prevLog == 0 && libs[1].prevLog == 0);
+        prb_assert(prb_compileStaticLibs(arena, libs, prb_arrayCount(libs), (prb_ExecSpec) {}));
+        prb_assert(libs[0].status == prb_ProcessStatus_CompletedSuccess);
+        prb_assert(libs[1].status == prb_ProcessStatus_CompletedSuccess);
+        prb_assert(prb_isFile(arena, cSpec.libFile));
+        prb_assert(prb_isFile(arena, cppSpec.libFile));
+        prb_assert(prb_isFile(arena, prb_pathJoin(arena, cSpec.objDir, prb_STR("a.obj"))));
+        prb_assert(prb_isFile(arena, prb_pathJoin(arena, cSpec.objDir, prb_STR("b.obj"))));
+        prb_assert(!prb_isFile(arena, prb_pathJoin(arena, cSpec.objDir, prb_STR("notes.obj"))));
+        prb_assert(prb_isFile(arena, prb_pathJoin(arena, cppSpec.objDir, prb_STR("c.ii"))));
+    }
+
+    // NOTE(khvorov) Link a program against the libraries to make sure they are usable
+    {
+        prb_Str mainSrc = prb_pathJoin(arena, dir, prb_STR("main.c"));
+        prb_Str mainCode = prb_STR("int a(void); int b(void); int c(void); int main() {return a() + b() + c() == 6 ? 0 : 1;}");
+        prb_assert(prb_writeEntireFile(arena, mainSrc, mainCode.ptr, mainCode.len));
+        prb_Str     mainExe = prb_replaceExt(arena, mainSrc, prb_STR("exe"));
+        prb_Str     cmd = prb_fmt(arena, "clang %.*s %.*s %.*s -o %.*s", prb_LIT(mainSrc), prb_LIT(cSpec.libFile), prb_LIT(cppSpec.libFile), prb_LIT(mainExe));
+        prb_Process proc = prb_createProcess(cmd, (prb_ProcessSpec) {});
+        prb_assert(prb_launchProcesses(arena, &proc, 1, prb_Background_No));
+        proc = prb_createProcess(mainExe, (prb_ProcessSpec) {});
+        prb_assert(prb_launchProcesses(arena, &proc, 1, prb_Background_No));
+    }
+
+    // NOTE(khvorov) Several configurations of the same library in one call
+    {
+        prb_StaticLib libs[2] = {};
+        for (i32 libIndex = 0; libIndex < prb_arrayCount(libs); libIndex++) {
+            prb_StaticLibSpec spec = cSpec;
+            spec.flags = libIndex == 0 ? prb_STR("-O0") : prb_STR("-O2");
+            spec.objDir = prb_pathJoin(arena, dir, prb_fmt(arena, "obj-matrix%d", libIndex));
+            spec.libFile = prb_pathJoin(arena, dir, prb_fmt(arena, "matrix%d.%.*s", libIndex, prb_LIT(libExt)));
+            libs[libIndex] = prb_createStaticLib(arena, spec);
+        }
+        prb_assert(prb_compileStaticLibs(arena, libs, prb_arrayCount(libs), (prb_ExecSpec) {}));
+        for (i32 libIndex = 0; libIndex < prb_arrayCount(libs); libIndex++) {
+            prb_assert(libs[libIndex].status == prb_ProcessStatus_CompletedSuccess);
+            prb_assert(prb_isFile(arena, libs[libIndex].spec.libFile));
+            prb_assert(prb_isFile(arena, prb_pathJoin(arena, libs[libIndex].spec.objDir, prb_STR("a.obj"))));
+            prb_assert(prb_isFile(arena, prb_pathJoin(arena, libs[libIndex].spec.objDir, prb_STR("b.obj"))));
+        }
+    }
+
+    // NOTE(khvorov) Nothing changed so nothing is recompiled
+    prb_Str objNames[] = {prb_STR("a.obj"), prb_STR("b.obj")};
+    {
+        prb_StaticLib      lib = prb_createStaticLib(arena, cSpec);
+        prb_FileTimestamp* before = getObjTimestamps(arena, &lib, objNames, prb_arrayCount(objNames));
+        prb_FileTimestamp  libBefore = prb_getLastModified(arena, cSpec.libFile);
+        prb_assert(lib.prevLogObjs.count == 2);
+        prb_assert(prb_compileStaticLibs(arena, &lib, 1, (prb_ExecSpec) {}));
+        prb_FileTimestamp* after = getObjTimestamps(arena, &lib, objNames, prb_arrayCount(objNames));
+        prb_FileTimestamp  libAfter = prb_getLastModified(arena, cSpec.libFile);
+        prb_assert(before[0].timestamp == after[0].timestamp && before[1].timestamp == after[1].timestamp);
+        prb_assert(libBefore.timestamp == libAfter.timestamp);
+    }
+
+    // NOTE(khvorov) The log goes next to the object directory and whether workers are used doesn't change the logged commands
+    {
+        prb_assert(prb_isFile(arena, prb_pathJoin(arena, dir, prb_STR("obj-c-log.csv"))));
+        prb_StaticLib      lib = prb_createStaticLib(arena, cSpec);
+        prb_FileTimestamp* before = getObjTimestamps(arena, &lib, objNames, prb_arrayCount(objNames));
+        prb_Str            missingWorker = prb_STR("unix:/this/path/does/not/exist");
+        prb_ExecSpec       spec = {};
+        spec.workers = &missingWorker;
+        spec.workersCount = 1;
+        prb_assert(prb_compileStaticLibs(arena, &lib, 1, spec));
+        prb_FileTimestamp* after = getObjTimestamps(arena, &lib, objNames, prb_arrayCount(objNames));
+        prb_assert(before[0].timestamp == after[0].timestamp && before[1].timestamp == after[1].timestamp);
+    }
+
+    // NOTE(khvorov) Only the changed file is recompiled
+    {
+        prb_Str newB = prb_STR("int b(void) {return 2 + 0;}");
+        prb_assert(prb_writeEntireFile(arena, prb_pathJoin(arena, srcDir, prb_STR("lib/b.c")), newB.ptr, newB.len));
+        prb_StaticLib      lib = prb_createStaticLib(arena, cSpec);
+        prb_FileTimestamp* before = getObjTimestamps(arena, &lib, objNames, prb_arrayCount(objNames));
+        prb_sleep(10);
+        prb_assert(prb_compileStaticLibs(arena, &lib, 1, (prb_ExecSpec) {}));
+        prb_FileTimestamp* after = getObjTimestamps(arena, &lib, objNames, prb_arrayCount(objNames));
+        prb_assert(before[0].timestamp == after[0].timestamp);
+        prb_assert(before[1].timestamp != after[1].timestamp);
+
+        // NOTE(khvorov) 2 preprocess, 1 compile, 1 archive
+        prb_assert(lib.recordsCount == 4);
+        prb_assert(lib.records[0].step == prb_BuildStep_Preprocess && lib.records[0].reason == prb_RebuildReason_AlwaysRuns);
+        prb_BuildRecord compileRecord = lib.records[2];
+        prb_assert(compileRecord.step == prb_BuildStep_Compile && compileRecord.reason == prb_RebuildReason_SourceChanged);
+        prb_assert(prb_streq(compileRecord.output, prb_pathJoin(arena, cSpec.objDir, prb_STR("b.obj"))));
+        prb_assert(prb_strStartsWith(compileRecord.causes, prb_STR("changed ")) && prb_strEndsWith(compileRecord.causes, prb_STR("b.c")));
+        prb_assert(compileRecord.durationMs > 0);
+        prb_assert(lib.records[3].step == prb_BuildStep_Archive && lib.records[3].reason == prb_RebuildReason_ObjsChanged);
+    }
+
+    // NOTE(khvorov) Changing flags recompiles everything
+    {
+        prb_StaticLibSpec spec = cSpec;
+        spec.flags = prb_STR("-O2");
+        prb_StaticLib      lib = prb_createStaticLib(arena, spec);
+        prb_FileTimestamp* before = getObjTimestamps(arena, &lib, objNames, prb_arrayCount(objNames));
+        prb_sleep(10);
+        prb_assert(prb_compileStaticLibs(arena, &lib, 1, (prb_ExecSpec) {}));
+        prb_FileTimestamp* after = getObjTimestamps(arena, &lib, objNames, prb_arrayCount(objNames));
+        prb_assert(before[0].timestamp != after[0].timestamp);
+        prb_assert(before[1].timestamp != after[1].timestamp);
+
+        prb_assert(lib.records[2].reason == prb_RebuildReason_CmdChanged);
+        prb_assert(prb_streq(lib.records[2].causes, prb_STR("added arg -O2\nremoved arg -O1")));
+
+        prb_Str report = prb_explainStaticLibs(arena, &lib, 1, 10);
+        prb_assert(prb_strStartsWith(report, prb_STR("5 actions took ")));
+        prb_StrFindSpec findSpec = {};
+        findSpec.pattern = prb_STR("     2 added arg -O2\n");
+        prb_assert(prb_strFind(report, findSpec).found);
+        findSpec.pattern = prb_STR("     2 command changed\n");
+        prb_assert(prb_strFind(report, findSpec).found);
+    }
+
+    // NOTE(khvorov) Slowest first, equal ones in the order they ran
+    {
+        prb_BuildRecord records[4] = {};
+        float           durations[] = {1.5f, 20.0f, 0.0f, 1.5f};
+        const char*     outputs[] = {"a.obj", "b.obj", "c.obj", "d.obj"};
+        for (i32 recordIndex = 0; recordIndex < prb_arrayCount(records); recordIndex++) {
+            records[recordIndex].step = prb_BuildStep_Compile;
+            records[recordIndex].reason = prb_RebuildReason_NotInLog;
+            records[recordIndex].output = prb_STR(outputs[recordIndex]);
+            records[recordIndex].durationMs = durations[recordIndex];
+        }
+        prb_StaticLib lib = {};
+        lib.records = records;
+        lib.recordsCount = prb_arrayCount(records);
+        prb_Str         report = prb_explainStaticLibs(arena, &lib, 1, 10);
+        prb_StrFindSpec findSpec = {};
+        findSpec.pattern = prb_STR("slowest:\n");
+        prb_Str slowest = prb_strFind(report, findSpec).afterMatch;
+        prb_assert(prb_streq(
+            slowest,
+            prb_STR(
+                "       20.00ms compile b.obj (not in log)\n"
+                "        1.50ms compile a.obj (not in log)\n"
+                "        1.50ms compile d.obj (not in log)\n"
+                "        0.00ms compile c.obj (not in log)\n"
+            )
+        ));
+    }
+
+    // NOTE(khvorov) The header that changed is what gets blamed
+    {
+        prb_Str hdrDir = prb_pathJoin(arena, srcDir, prb_STR("hdr"));
+        prb_Str header = prb_pathJoin(arena, hdrDir, prb_STR("dep.h"));
+        prb_Str mainSrc = prb_STR("#include \"dep.h\"\nint hdr(void) {return 1;}");
+        prb_assert(prb_writeEntireFile(arena, prb_pathJoin(arena, hdrDir, prb_STR("hdr.c")), mainSrc.ptr, mainSrc.len));
+        prb_Str headerContent = prb_STR("int dep1;\n");
+        prb_assert(prb_writeEntireFile(arena, header, headerContent.ptr, headerContent.len));
+
+        prb_Str           hdrSources[] = {prb_STR("hdr/hdr.c")};
+        prb_StaticLibSpec spec = {};
+        spec.name = prb_STR("hdr");
+        spec.srcDir = srcDir;
+        spec.sources = hdrSources;
+        spec.sourcesCount = prb_arrayCount(hdrSources);
+        spec.objDir = prb_pathJoin(arena, dir, prb_STR("obj-hdr"));
+        spec.libFile = prb_pathJoin(arena, dir, prb_fmt(arena, "hdr.%.*s", prb_LIT(libExt)));
+        {
+            prb_StaticLib lib = prb_createStaticLib(arena, spec);
+            prb_assert(prb_compileStaticLibs(arena, &lib, 1, (prb_ExecSpec) {}));
+            prb_assert(lib.records[1].reason == prb_RebuildReason_NotInLog);
+        }
+        {
+            headerContent = prb_STR("int dep2;\n");
+            prb_assert(prb_writeEntireFile(arena, header, headerContent.ptr, headerContent.len));
+            prb_StaticLib lib = prb_createStaticLib(arena, spec);
+            prb_assert(prb_compileStaticLibs(arena, &lib, 1, (prb_ExecSpec) {}));
+            prb_assert(lib.records[1].reason == prb_RebuildReason_SourceChanged);
+            prb_assert(prb_streq(lib.records[1].causes, prb_fmt(arena, "changed %.*s", prb_LIT(header))));
+        }
+    }
+
+    // NOTE(khvorov) Changing an extra input recompiles everything
+    {
+        prb_Str profile = prb_pathJoin(arena, dir, prb_STR("profile.txt"));
+        prb_assert(prb_writeEntireFile(arena, profile, "v1", 2));
+        prb_StaticLibSpec spec = cSpec;
+        spec.flags = prb_STR("-O2");
+        spec.extraInputs = &profile;
+        spec.extraInputsCount = 1;
+        {
+            prb_StaticLib lib = prb_createStaticLib(arena, spec);
+            prb_assert(prb_compileStaticLibs(arena, &lib, 1, (prb_ExecSpec) {}));
+        }
+        {
+            prb_StaticLib      lib = prb_createStaticLib(arena, spec);
+            prb_FileTimestamp* before = getObjTimestamps(arena, &lib, objNames, prb_arrayCount(objNames));
+            prb_assert(prb_compileStaticLibs(arena, &lib, 1, (prb_ExecSpec) {}));
+            prb_FileTimestamp* after = getObjTimestamps(arena, &lib, objNames, prb_arrayCount(objNames));
+            prb_assert(before[0].timestamp == after[0].timestamp && before[1].timestamp == after[1].timestamp);
+        }
+        {
+            prb_assert(prb_writeEntireFile(arena, profile, "v2", 2));
+            prb_StaticLib      lib = prb_createStaticLib(arena, spec);
+            prb_FileTimestamp* before = getObjTimestamps(arena, &lib, objNames, prb_arrayCount(objNames));
+            prb_sleep(10);
+            prb_assert(prb_compileStaticLibs(arena, &lib, 1, (prb_ExecSpec) {}));
+            prb_FileTimestamp* after = getObjTimestamps(arena, &lib, objNames, prb_arrayCount(objNames));
+            prb_assert(before[0].timestamp != after[0].timestamp && before[1].timestamp != after[1].timestamp);
+        }
+        {
+            prb_assert(prb_removePathIfExists(arena, profile));
+            prb_StaticLib lib = prb_createStaticLib(arena, spec);
+            prb_assert(prb_compileStaticLibs(arena, &lib, 1, (prb_ExecSpec) {}) == prb_Failure);
+        }
+    }
+
+#if prb_PLATFORM_LINUX
+    // NOTE(khvorov) Side outputs are required for an object to be up to date and get removed when no longer produced
+    {
+        prb_Str           dwo = prb_STR("dwo");
+        prb_StaticLibSpec spec = cSpec;
+        spec.flags = prb_STR("-g -gsplit-dwarf");
+        spec.sideOutputExts = &dwo;
+        spec.sideOutputExtsCount = 1;
+        prb_Str aDwo = prb_pathJoin(arena, cSpec.objDir, prb_STR("a.dwo"));
+        prb_Str bDwo = prb_pathJoin(arena, cSpec.objDir, prb_STR("b.dwo"));
+        {
+            prb_StaticLib lib = prb_createStaticLib(arena, spec);
+            prb_assert(prb_compileStaticLibs(arena, &lib, 1, (prb_ExecSpec) {}));
+            prb_assert(prb_isFile(arena, aDwo) && prb_isFile(arena, bDwo));
+        }
+        {
+            prb_assert(prb_removePathIfExists(arena, bDwo));
+            prb_StaticLib      lib = prb_createStaticLib(arena, spec);
+            prb_FileTimestamp* before = getObjTimestamps(arena, &lib, objNames, prb_arrayCount(objNames));
+            prb_sleep(10);
+            prb_assert(prb_compileStaticLibs(arena, &lib, 1, (prb_ExecSpec) {}));
+            prb_FileTimestamp* after = getObjTimestamps(arena, &lib, objNames, prb_arrayCount(objNames));
+            prb_assert(before[0].timestamp == after[0].timestamp);
+            prb_assert(before[1].timestamp != after[1].timestamp);
+            prb_assert(prb_isFile(arena, bDwo));
+        }
+        {
+            prb_StaticLib lib = prb_createStaticLib(arena, cSpec);
+            prb_assert(prb_compileStaticLibs(arena, &lib, 1, (prb_ExecSpec) {}));
+            prb_assert(!prb_isFile(arena, aDwo) && !prb_isFile(arena, bDwo));
+        }
+    }
+#endif
+
+    // NOTE(khvorov) Objects of removed sources are removed
+    {
+        prb_StaticLibSpec spec = cSpec;
+        prb_Str           onlyA = prb_STR("lib/a.c");
+        spec.sources = &onlyA;
+        spec.sourcesCount = 1;
+        prb_StaticLib lib = prb_createStaticLib(arena, spec);
+        prb_assert(prb_compileStaticLibs(arena, &lib, 1, (prb_ExecSpec) {}));
+        prb_assert(prb_isFile(arena, prb_pathJoin(arena, cSpec.objDir, prb_STR("a.obj"))));
+        prb_assert(!prb_isFile(arena, prb_pathJoin(arena, cSpec.objDir, prb_STR("b.obj"))));
+        prb_assert(!prb_isFile(arena, prb_pathJoin(arena, cSpec.objDir, prb_STR("b.i"))));
+    }
+
+    // NOTE(khvorov) Missing sources and compile errors fail only their library
+    {
+        prb_StaticLibSpec missingSpec = cSpec;
+        prb_Str           missing = prb_STR("lib/missing.c");
+        missingSpec.sources = &missing;
+        missingSpec.sourcesCount = 1;
+
+        prb_Str broken = prb_STR("int c(void) {return}");
+        prb_assert(prb_writeEntireFile(arena, prb_pathJoin(arena, srcDir, prb_STR("cpp/c.cpp")), broken.ptr, broken.len));
+
+        prb_StaticLib libs[] = {prb_createStaticLib(arena, missingSpec), prb_createStaticLib(arena, cppSpec), prb_createStaticLib(arena, cSpec)};
+        prb_assert(prb_compileStaticLibs(arena, libs, prb_arrayCount(libs), (prb_ExecSpec) {}) == prb_Failure);
+        prb_assert(libs[0].status == prb_ProcessStatus_CompletedFailed);
+        prb_assert(libs[1].status == prb_ProcessStatus_CompletedFailed);
+        prb_assert(libs[2].status == prb_ProcessStatus_CompletedSuccess);
+    }
+
+    prb_assert(prb_removePathIfExists(arena, dir));
+    prb_endTempMemory(temp);
+}
+
 // SECTION Random numbers
 
 function void
@@ -3150,11 +5528,13 @@ main(void) {
     test_replaceExt(arena);
     test_pathEntryIter(arena);
     test_getAllDirEntries(arena);
+    test_pathTrie(arena);
     test_getLastModified(arena);
     test_createMultitime(arena);
     test_multitimeAdd(arena);
     test_readEntireFile(arena);
     test_writeEntireFile(arena);
+    test_writeChunksToFile(arena);
     test_getFileHash(arena);
 
     // SECTION Strings
@@ -3165,17 +5545,35 @@ main(void) {
     test_strTrimSide(arena);
     test_strTrim(arena);
     test_strFind(arena);
+    test_strFinder(arena);
     test_strStartsWith(arena);
     test_strEndsWith(arena);
     test_stringsJoin(arena);
+    test_strSplit(arena);
     test_growingStr(arena);
     test_fmt(arena);
     test_writeToStdout(arena);
     test_utf8CharIter(arena);
+    test_utf8Validate(arena);
+    test_utf32(arena);
+    test_utf16(arena);
     test_strScanner(arena);
+    test_lineIndex(arena);
     test_parseUint(arena);
     test_parseNumber(arena);
+    test_parseNumbers(arena);
     test_binaryToCArray(arena);
+    test_binaryToCString(arena);
+    test_embedFile(arena);
+    test_hashBytes(arena);
+    test_hashStr(arena);
+    test_strInterner(arena);
+    test_strMap(arena);
+    test_sharedStrMap(arena);
+    test_multiFinder(arena);
+    test_regex(arena);
+    test_sortU64(arena);
+    test_sortStrs(arena);
 
     // SECTION Processes
     test_terminate(arena);
@@ -3187,6 +5585,7 @@ main(void) {
     test_sleep(arena);
     test_debuggerPresent(arena);
     test_env(arena);
+    test_rebuildSelfIfChanged(arena);
 
     // SECTION Timing
     test_timer(arena);
@@ -3194,6 +5593,12 @@ main(void) {
     // SECTION Multithreading
     test_jobs(arena);
 
+    // SECTION Remote execution
+    test_remoteExecution(arena);
+
+    // SECTION Static libraries
+    test_staticLibs(arena);
+
     // SECTION Random numbers
     test_createRng(arena);
     test_randomU32(arena);